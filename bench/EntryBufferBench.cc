@@ -0,0 +1,251 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+//
+/// \file B4/B4a/bench/EntryBufferBench.cc
+/// \brief Micro-benchmark of the per-event detector entry buffer
+///
+/// Feeds the same synthetic entry stream (mostly single-entry muon-like
+/// events plus a tail of high-multiplicity hadronic showers) through
+///   - the former layout: seven parallel std::vector, push_back per column,
+///   - EntryBuffer: one contiguous record per entry in a reused arena,
+/// and reports the time per entry and the arena high-water memory.
+/// It then bins the stream into the theta-p DenseH2 of EntryHistograms and
+/// times the end-of-run merge into a G4H2: the former per-bin
+/// get_bin_content/set_bin_content loop against DenseH2::MergeInto().
+///
+/// usage: b4entrybench [nEvents]
+
+#include "EntryBuffer.hh"
+#include "EntryHistograms.hh"
+
+#include "G4ThreeVector.hh"
+#include "G4SystemOfUnits.hh"
+
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+#include <random>
+#include <vector>
+
+namespace
+{
+
+struct SyntheticEntry
+{
+  G4int pdg;
+  G4double E;
+  G4ThreeVector dir;
+  G4ThreeVector mom;
+};
+
+// 合成的入射流：70% 单粒子事件，30% 多重数服从指数分布的簇射事件
+std::vector<std::vector<SyntheticEntry>> MakeStream(std::size_t nEvents)
+{
+  std::mt19937_64 rng(12345);
+  std::uniform_real_distribution<G4double> flat(0., 1.);
+  std::exponential_distribution<G4double> shower(1. / 300.);
+  const G4int pdgs[] = {211, -211, 13, -13, 2212, 2112, 22, 11, -11};
+
+  std::vector<std::vector<SyntheticEntry>> stream(nEvents);
+  for (auto& event : stream) {
+    std::size_t n = (flat(rng) < 0.7) ? 1 : 1 + (std::size_t)shower(rng);
+    event.reserve(n);
+    for (std::size_t i = 0; i < n; ++i) {
+      G4double cost = 2. * flat(rng) - 1.;
+      G4double phi = CLHEP::twopi * flat(rng);
+      G4ThreeVector dir(std::sqrt(1. - cost*cost) * std::cos(phi),
+                        std::sqrt(1. - cost*cost) * std::sin(phi), cost);
+      G4double E = 5000. * MeV * flat(rng);
+      event.push_back({pdgs[i % 9], E, dir, E * dir});
+    }
+  }
+  return stream;
+}
+
+// 原来的七个并行 vector
+struct LegacyBuffer
+{
+  std::vector<G4int> pdg;
+  std::vector<G4double> theta, phi, px, py, pz, E;
+
+  void Clear()
+  {
+    pdg.clear(); theta.clear(); phi.clear();
+    px.clear(); py.clear(); pz.clear(); E.clear();
+  }
+  void Record(const SyntheticEntry& e)
+  {
+    pdg.push_back(e.pdg);
+    theta.push_back(e.dir.theta() / deg);
+    phi.push_back(e.dir.phi() / deg);
+    px.push_back(e.mom.x());
+    py.push_back(e.mom.y());
+    pz.push_back(e.mom.z());
+    E.push_back(e.E);
+  }
+  G4double Flush() const
+  {
+    G4double sum = 0.;
+    for (std::size_t i = 0; i < theta.size(); ++i) {
+      sum += pdg[i] + std::sqrt(px[i]*px[i] + py[i]*py[i] + pz[i]*pz[i])
+           + E[i] + theta[i] + phi[i];
+    }
+    return sum;
+  }
+};
+
+G4double FlushArena(const B4::EntryBuffer& buffer)
+{
+  G4double sum = 0.;
+  for (const auto& e : buffer) {
+    sum += e.pdg + std::sqrt(e.px*e.px + e.py*e.py + e.pz*e.pz)
+         + e.E + e.theta + e.phi;
+  }
+  return sum;
+}
+
+// 原来的合并：每个 bin 从目标取出、相加、写回 (source 为本线程的内容)
+template <class Data>
+void MergePerBin(const Data& source, G4H2& h, G4int nx, G4int ny)
+{
+  using Entries = typename decltype(source.m_bin_entries)::value_type;
+  for (G4int iy = 0; iy < ny; ++iy) {
+    for (G4int ix = 0; ix < nx; ++ix) {
+      G4int bin = ix + iy * nx;
+      if (source.m_bin_entries[bin] == 0) continue;
+      Entries n = 0;
+      G4double sw = 0., sw2 = 0., sxw = 0., sx2w = 0., syw = 0., sy2w = 0.;
+      h.get_bin_content(ix, iy, n, sw, sw2, sxw, sx2w, syw, sy2w);
+      h.set_bin_content(ix, iy, n + source.m_bin_entries[bin], sw + source.m_bin_Sw[bin],
+                        sw2 + source.m_bin_Sw2[bin], sxw + source.m_bin_Sxw[bin][0],
+                        sx2w + source.m_bin_Sx2w[bin][0], syw + source.m_bin_Sxw[bin][1],
+                        sy2w + source.m_bin_Sx2w[bin][1]);
+    }
+  }
+}
+
+}  // namespace
+
+int main(int argc, char** argv)
+{
+  std::size_t nEvents = (argc > 1) ? std::strtoul(argv[1], nullptr, 10) : 20000;
+  auto stream = MakeStream(nEvents);
+  std::size_t nEntries = 0;
+  for (const auto& event : stream) nEntries += event.size();
+
+  using clock = std::chrono::steady_clock;
+
+  // 1) legacy layout
+  LegacyBuffer legacy;
+  G4double legacySum = 0.;
+  auto t0 = clock::now();
+  for (const auto& event : stream) {
+    legacy.Clear();
+    for (const auto& e : event) legacy.Record(e);
+    legacySum += legacy.Flush();
+  }
+  auto t1 = clock::now();
+
+  // 2) arena-backed records
+  B4::EntryBuffer arena;
+  G4double arenaSum = 0.;
+  for (const auto& event : stream) {
+    arena.Clear();
+    for (const auto& e : event) {
+      auto& r = arena.Append();
+      r.pdg = e.pdg;
+      r.px = e.mom.x();
+      r.py = e.mom.y();
+      r.pz = e.mom.z();
+      r.E = e.E;
+      r.theta = e.dir.theta() / deg;
+      r.phi = e.dir.phi() / deg;
+    }
+    arenaSum += FlushArena(arena);
+  }
+  auto t2 = clock::now();
+
+  std::chrono::duration<double, std::nano> dLegacy = t1 - t0;
+  std::chrono::duration<double, std::nano> dArena = t2 - t1;
+  std::size_t legacyBytes = legacy.pdg.capacity() * sizeof(G4int)
+                          + 6 * legacy.theta.capacity() * sizeof(G4double);
+
+  std::cout << "events               : " << nEvents << "\n"
+            << "entries              : " << nEntries << "\n"
+            << "legacy  ns/entry     : " << dLegacy.count() / nEntries << "\n"
+            << "arena   ns/entry     : " << dArena.count() / nEntries << "\n"
+            << "speed-up             : " << dLegacy.count() / dArena.count() << "\n"
+            << "legacy  memory (kB)  : " << legacyBytes / 1024. << "\n"
+            << "arena   high water   : " << arena.HighWater() << " entries/event\n"
+            << "arena   memory (kB)  : " << arena.MemoryBytes() / 1024. << "\n"
+            << "checksum             : " << (legacySum == arenaSum ? "ok" : "MISMATCH")
+            << std::endl;
+
+  // 3) run 结束时的直方图合并：theta-p (EntryHistograms 的分箱)
+  using ThetaAxis = B4::EntryHistograms::ThetaAxis;
+  using PAxis = B4::EntryHistograms::PAxis;
+  B4::DenseH2<ThetaAxis, PAxis> dense;
+  for (const auto& event : stream) {
+    for (const auto& e : event) {
+      G4double theta = e.dir.theta() / deg;
+      G4double p = e.mom.mag();
+      dense.Fill(ThetaAxis::Index(theta), PAxis::Index(p), theta, p, 1.);
+    }
+  }
+  const G4H2 empty("theta_p", ThetaAxis::kBins, ThetaAxis::kMin, ThetaAxis::kMax, PAxis::kBins,
+                   PAxis::kMin, PAxis::kMax);
+  G4H2 single(empty);
+  dense.MergeInto(&single);
+  const auto source = single.get_histo_data();
+
+  // 每个 worker 合并一次：重复 nMerges 次，两种方法加到各自的目标上
+  const G4int nMerges = 200;
+  G4H2 perBin(empty);
+  G4H2 bulk(empty);
+  auto t3 = clock::now();
+  for (G4int i = 0; i < nMerges; ++i) MergePerBin(source, perBin, ThetaAxis::kSize, PAxis::kSize);
+  auto t4 = clock::now();
+  for (G4int i = 0; i < nMerges; ++i) dense.MergeInto(&bulk);
+  auto t5 = clock::now();
+
+  std::chrono::duration<double, std::micro> dPerBin = t4 - t3;
+  std::chrono::duration<double, std::micro> dBulk = t5 - t4;
+  const auto perBinData = perBin.get_histo_data();
+  const auto bulkData = bulk.get_histo_data();
+  G4bool mergeOk = perBinData.m_bin_entries == bulkData.m_bin_entries
+                   && perBinData.m_bin_Sw == bulkData.m_bin_Sw
+                   && perBinData.m_bin_Sw2 == bulkData.m_bin_Sw2
+                   && perBinData.m_bin_Sxw == bulkData.m_bin_Sxw
+                   && perBinData.m_bin_Sx2w == bulkData.m_bin_Sx2w;
+
+  std::cout << "H2 bins              : " << ThetaAxis::kSize * PAxis::kSize << "\n"
+            << "per-bin merge (us)   : " << dPerBin.count() / nMerges << "\n"
+            << "bulk merge (us)      : " << dBulk.count() / nMerges << "\n"
+            << "merge speed-up       : " << dPerBin.count() / dBulk.count() << "\n"
+            << "merge checksum       : " << (mergeOk ? "ok" : "MISMATCH") << std::endl;
+  return (legacySum == arenaSum && mergeOk) ? 0 : 1;
+}
@@ -0,0 +1,172 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+//
+/// \file B4/B4a/bench/NavigationBench.cc
+/// \brief Navigation benchmark of the two detector shell builds
+///
+/// Builds the geometry of DetectorConstruction twice, once with the
+/// G4SubtractionSolid shell and once with the primitive barrel + end cap,
+/// closes it (voxelisation) and traces the same straight rays through both
+/// worlds with a G4Navigator: isotropic rays starting in the target, as
+/// the secondaries leaving the target do. Physics is left out, so the time
+/// is the pure geometry cost. For each build it reports the navigation
+/// steps, the steps per second, the time per ray, and the number of shell
+/// entries, which must agree between the two builds.
+///
+/// For the full simulation (steps/s and wall time per event with physics)
+/// run nav_bench.mac.
+///
+/// usage: b4navbench [nRays]
+
+#include "DetectorConstruction.hh"
+
+#include "G4GeometryManager.hh"
+#include "G4LogicalVolume.hh"
+#include "G4Navigator.hh"
+#include "G4SystemOfUnits.hh"
+#include "G4ThreeVector.hh"
+#include "G4VPhysicalVolume.hh"
+
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+#include <random>
+#include <vector>
+
+namespace
+{
+
+struct Ray
+{
+  G4ThreeVector position;
+  G4ThreeVector direction;
+};
+
+struct Result
+{
+  std::size_t steps = 0;
+  std::size_t entries = 0;
+  double seconds = 0.;
+};
+
+// 从靶内各向同性出发的射线 (两种几何使用同一组)
+std::vector<Ray> MakeRays(std::size_t n, const B4::DetectorConstruction& det)
+{
+  std::mt19937_64 rng(12345);
+  std::uniform_real_distribution<double> flat(0., 1.);
+  std::vector<Ray> rays(n);
+  G4ThreeVector centre = det.GetTargetPosition();
+  for (auto& ray : rays) {
+    double r = det.GetTargetRadius() * std::sqrt(flat(rng));
+    double phi = CLHEP::twopi * flat(rng);
+    double z = (flat(rng) - 0.5) * det.GetTargetLength();
+    ray.position = centre + G4ThreeVector(r * std::cos(phi), r * std::sin(phi), z);
+    double cost = 2. * flat(rng) - 1.;
+    double sint = std::sqrt(1. - cost * cost);
+    double dphi = CLHEP::twopi * flat(rng);
+    ray.direction.set(sint * std::cos(dphi), sint * std::sin(dphi), cost);
+  }
+  return rays;
+}
+
+Result Trace(G4VPhysicalVolume* world, const std::vector<Ray>& rays,
+             const G4LogicalVolume* shell, const G4LogicalVolume* endCap)
+{
+  auto inShell = [&](const G4LogicalVolume* lv) {
+    return lv && (lv == shell || lv == endCap);
+  };
+
+  G4Navigator navigator;
+  navigator.SetWorldVolume(world);
+  Result result;
+
+  auto start = std::chrono::steady_clock::now();
+  for (const auto& ray : rays) {
+    G4ThreeVector p = ray.position;
+    G4ThreeVector v = ray.direction;
+    auto* pv = navigator.LocateGlobalPointAndSetup(p, &v, false, false);
+    const G4LogicalVolume* previous = pv ? pv->GetLogicalVolume() : nullptr;
+    while (pv) {
+      G4double safety = 0.;
+      G4double step = navigator.ComputeStep(p, v, kInfinity, safety);
+      if (step == kInfinity) break;
+      p += step * v;
+      navigator.SetGeometricallyLimitedStep();
+      pv = navigator.LocateGlobalPointAndSetup(p, &v, true);
+      ++result.steps;
+      const G4LogicalVolume* current = pv ? pv->GetLogicalVolume() : nullptr;
+      // 与 SteppingAction 相同的入射判断
+      if (!inShell(previous) && inShell(current)) ++result.entries;
+      previous = current;
+    }
+  }
+  std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+  result.seconds = elapsed.count();
+  return result;
+}
+
+void Print(const char* name, const Result& result, std::size_t nRays)
+{
+  std::cout << name << " steps                : " << result.steps << "\n"
+            << name << " steps/s              : " << result.steps / result.seconds << "\n"
+            << name << " us/ray               : " << 1e6 * result.seconds / nRays << "\n"
+            << name << " shell entries        : " << result.entries << "\n";
+}
+
+}  // namespace
+
+int main(int argc, char** argv)
+{
+  std::size_t nRays = (argc > 1) ? std::strtoul(argv[1], nullptr, 10) : 1000000;
+
+  // 同一个 DetectorConstruction 先后建立两种外壳
+  B4::DetectorConstruction det;
+  det.SetDetectorBuild(B4::DetectorConstruction::DetectorBuild::Boolean);
+  G4VPhysicalVolume* booleanWorld = det.Construct();
+  const G4LogicalVolume* booleanShell = det.GetDetectorLogical();
+
+  det.SetDetectorBuild(B4::DetectorConstruction::DetectorBuild::Primitive);
+  G4VPhysicalVolume* primitiveWorld = det.Construct();
+  const G4LogicalVolume* barrel = det.GetDetectorLogical();
+  const G4LogicalVolume* endCap = det.GetEndCapLogical();
+
+  G4GeometryManager::GetInstance()->CloseGeometry(true);
+
+  auto rays = MakeRays(nRays, det);
+  Result boolean = Trace(booleanWorld, rays, booleanShell, nullptr);
+  Result primitive = Trace(primitiveWorld, rays, barrel, endCap);
+
+  std::cout << "rays                         : " << nRays << "\n";
+  Print("boolean  ", boolean, nRays);
+  Print("primitive", primitive, nRays);
+  std::cout << "speed-up (time)              : " << boolean.seconds / primitive.seconds << "\n"
+            << "entries                      : "
+            << (boolean.entries == primitive.entries ? "ok" : "MISMATCH") << std::endl;
+
+  G4GeometryManager::GetInstance()->OpenGeometry();
+  return (boolean.entries == primitive.entries) ? 0 : 1;
+}
@@ -0,0 +1,337 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+//
+/// \file B4/B4a/bench/ScalingBench.cc
+/// \brief Reproducible benchmark suite with a thread-scaling report
+///
+/// Runs the canonical workloads with a fixed seed, each once per thread
+/// count (1, 2, 4, ... up to the number of cores, plus the core count
+/// itself), every time in a fresh exampleB4a process so that the peak
+/// RSS and the initialisation time belong to that configuration alone:
+///
+///   mu+    5 GeV   default target
+///   pi+    2 GeV   20 cm G4_Pb target
+///   e+   300 MeV   3 cm G4_Pb target, about 5 X0 (electromagnetic shower)
+///
+/// From the run summary printed by the master it takes the events and
+/// steps and the wall time of the event loop; the initialisation time is
+/// the time from the start of the process to the end of the run minus the
+/// event loop. It prints events/s, steps/s, peak RSS, initialisation time,
+/// speed-up and strong-scaling efficiency (speed-up / threads), and writes
+/// everything as JSON. With a fixed seed the step count of a workload does
+/// not depend on the thread count; a difference is reported. A run whose
+/// summary reports another target material than the workload asked for is
+/// not recorded, so a geometry command that did not take effect cannot
+/// pass for a timing of the intended workload.
+///
+/// The sweep can be repeated for several run managers (-k mt,tasking) and
+/// with a given event chunk (-c, the event modulo). From the profile of
+/// the master it also takes the tail of the run (first to last thread
+/// done) and the idle thread time, which show what work stealing gains
+/// at high thread counts when event times are skewed (pi+ in Pb).
+///
+/// usage: b4bench [-e exampleB4a] [-n events] [-t maxThreads] [-s seed]
+///                [-w workload] [-k mt,tasking] [-c chunk] [-o b4bench.json]
+
+#include <sys/resource.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <ctime>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace
+{
+
+struct Workload
+{
+  std::string name;
+  std::string particle;
+  double energyMeV;
+  std::string material;               // run summary 中应报告的靶材料
+  long events;                        // 默认事件数 (单线程约数十秒)
+  std::vector<std::string> commands;  // /run/initialize 之前的几何设置
+};
+
+struct Measurement
+{
+  int threads = 0;
+  long events = 0;
+  long steps = 0;
+  double loopSeconds = 0.;  // master 打印的事件循环时间
+  double initSeconds = 0.;
+  double peakRssMB = 0.;
+  double tailSeconds = 0.;  // 需要 B4_PROFILING
+  double idleSeconds = 0.;
+  std::string material;     // master 报告的靶材料
+  bool ok = false;
+
+  double EventsPerSecond() const { return loopSeconds > 0. ? events / loopSeconds : 0.; }
+  double StepsPerSecond() const { return loopSeconds > 0. ? steps / loopSeconds : 0.; }
+};
+
+const std::vector<Workload> kWorkloads = {
+  {"mu+_5GeV", "mu+", 5000., "liquidH2", 20000, {}},
+  {"pi+_2GeV_Pb", "pi+", 2000., "G4_Pb", 2000,
+   {"/det/targetMaterial G4_Pb", "/det/targetLength 20 cm"}},
+  {"e+_300MeV_Pb", "e+", 300., "G4_Pb", 5000,
+   {"/det/targetMaterial G4_Pb", "/det/targetLength 3 cm"}},
+};
+
+std::string WriteMacro(const Workload& w, long events)
+{
+  std::string path = "b4bench_" + w.name + ".mac";
+  std::ofstream mac(path);
+  mac << "/control/verbose 0\n/run/verbose 0\n";
+  for (const auto& cmd : w.commands) mac << cmd << "\n";
+  mac << "/run/initialize\n"
+      << "/run/printProgress 0\n"
+      << "/run/output/enableRoot false\n"
+      << "/run/output/profile\n"
+      << "/gun/particle " << w.particle << "\n"
+      << "/gun/energy " << w.energyMeV << " MeV\n"
+      << "/run/beamOn " << events << "\n";
+  return path;
+}
+
+// " Steps                 : 12345" -> 12345
+bool ParseField(const std::string& line, const char* key, double& value)
+{
+  if (line.compare(0, std::char_traits<char>::length(key), key) != 0) return false;
+  auto colon = line.find(':');
+  if (colon == std::string::npos) return false;
+  value = std::strtod(line.c_str() + colon + 1, nullptr);
+  return true;
+}
+
+// " Target material       : G4_Pb (20 cm)" -> "G4_Pb"
+bool ParseWord(const std::string& line, const char* key, std::string& word)
+{
+  if (line.compare(0, std::char_traits<char>::length(key), key) != 0) return false;
+  auto colon = line.find(':');
+  if (colon == std::string::npos) return false;
+  std::istringstream(line.substr(colon + 1)) >> word;
+  return true;
+}
+
+Measurement Run(const std::string& exe, const std::string& macro, int threads, long seed,
+                const std::string& runManager, int chunk)
+{
+  Measurement m;
+  m.threads = threads;
+
+  int fd[2];
+  if (pipe(fd) != 0) return m;
+  auto start = std::chrono::steady_clock::now();
+  pid_t pid = fork();
+  if (pid == 0) {
+    dup2(fd[1], STDOUT_FILENO);
+    close(fd[0]);
+    close(fd[1]);
+    std::vector<std::string> args = {exe, "-m", macro, "-t", std::to_string(threads),
+                                     "-s", std::to_string(seed), "--runManager", runManager};
+    if (chunk > 0) {
+      args.push_back("--chunk");
+      args.push_back(std::to_string(chunk));
+    }
+    std::vector<char*> argv;
+    for (auto& arg : args) argv.push_back(arg.data());
+    argv.push_back(nullptr);
+    execv(exe.c_str(), argv.data());
+    std::perror(exe.c_str());
+    _exit(127);
+  }
+  close(fd[1]);
+  if (pid < 0) {
+    close(fd[0]);
+    return m;
+  }
+
+  // 逐行读取子进程输出，记录 run 结束 (summary 中的 Wall time) 的时刻；
+  // 只取 Merged Run Summary 的第一个 Wall time (profile 中的是 Run wall time)
+  FILE* out = fdopen(fd[0], "r");
+  char buffer[4096];
+  std::chrono::steady_clock::time_point runEnd = start;
+  double value = 0.;
+  while (std::fgets(buffer, sizeof(buffer), out)) {
+    std::string line(buffer);
+    if (ParseField(line, " Events                ", value)) m.events = static_cast<long>(value);
+    else if (ParseField(line, " Steps                 ", value)) m.steps = static_cast<long>(value);
+    else if (m.loopSeconds <= 0. && ParseField(line, " Wall time             ", value)) {
+      m.loopSeconds = value;
+      runEnd = std::chrono::steady_clock::now();
+    }
+    else if (ParseField(line, " Tail                  ", value)) m.tailSeconds = value;
+    else if (ParseField(line, " Idle (all threads)    ", value)) m.idleSeconds = value;
+    else ParseWord(line, " Target material       ", m.material);
+  }
+  std::fclose(out);
+
+  int status = 0;
+  struct rusage usage {};
+  wait4(pid, &status, 0, &usage);
+  m.peakRssMB = usage.ru_maxrss / 1024.;  // Linux: kB
+  m.initSeconds =
+    std::max(0., std::chrono::duration<double>(runEnd - start).count() - m.loopSeconds);
+  m.ok = WIFEXITED(status) && WEXITSTATUS(status) == 0 && m.loopSeconds > 0.;
+  return m;
+}
+
+std::vector<int> ThreadCounts(int maxThreads)
+{
+  std::vector<int> counts;
+  for (int n = 1; n < maxThreads; n *= 2) counts.push_back(n);
+  counts.push_back(maxThreads);
+  return counts;
+}
+
+}  // namespace
+
+int main(int argc, char** argv)
+{
+  std::string exe = "./exampleB4a";
+  std::string output = "b4bench.json";
+  std::string only;
+  std::vector<std::string> runManagers = {"default"};
+  int chunk = 0;
+  long events = 0;  // 0: 每个工作负载的默认事件数
+  long seed = 12345;
+  int maxThreads = std::max(1u, std::thread::hardware_concurrency());
+
+  for (int i = 1; i + 1 < argc; i += 2) {
+    std::string opt = argv[i];
+    if (opt == "-e") exe = argv[i + 1];
+    else if (opt == "-n") events = std::atol(argv[i + 1]);
+    else if (opt == "-t") maxThreads = std::max(1, std::atoi(argv[i + 1]));
+    else if (opt == "-s") seed = std::atol(argv[i + 1]);
+    else if (opt == "-w") only = argv[i + 1];
+    else if (opt == "-o") output = argv[i + 1];
+    else if (opt == "-c") chunk = std::atoi(argv[i + 1]);
+    else if (opt == "-k") {
+      runManagers.clear();
+      std::istringstream list(argv[i + 1]);
+      for (std::string type; std::getline(list, type, ',');) runManagers.push_back(type);
+    }
+    else {
+      std::cerr << "usage: b4bench [-e exampleB4a] [-n events] [-t maxThreads] [-s seed]"
+                   " [-w workload] [-k mt,tasking] [-c chunk] [-o b4bench.json]" << std::endl;
+      return 1;
+    }
+  }
+
+  std::ofstream json(output);
+  auto now = std::time(nullptr);
+  json << std::setprecision(6) << "{\n"
+       << "  \"date\": \"" << std::put_time(std::localtime(&now), "%Y-%m-%dT%H:%M:%S") << "\",\n"
+       << "  \"executable\": \"" << exe << "\",\n"
+       << "  \"seed\": " << seed << ",\n"
+       << "  \"event_chunk\": " << chunk << ",\n"
+       << "  \"hardware_threads\": " << std::thread::hardware_concurrency() << ",\n"
+       << "  \"workloads\": [";
+
+  bool allOk = true;
+  bool firstWorkload = true;
+  for (const auto& w : kWorkloads) {
+    if (!only.empty() && only != w.name) continue;
+    long n = events > 0 ? events : w.events;
+    std::string macro = WriteMacro(w, n);
+
+    json << (firstWorkload ? "\n" : ",\n") << "    {\"name\": \"" << w.name
+         << "\", \"particle\": \"" << w.particle << "\", \"energy_MeV\": " << w.energyMeV
+         << ", \"material\": \"" << w.material << "\", \"events\": " << n << ", \"runs\": [";
+    firstWorkload = false;
+
+    long referenceSteps = -1;
+    bool reproducible = true;
+    bool firstRun = true;
+    for (const auto& runManager : runManagers) {
+      std::cout << "\n" << w.name << "  (" << n << " events, seed " << seed << ", run manager "
+                << runManager << ")\n"
+                << std::setw(8) << "threads" << std::setw(12) << "events/s" << std::setw(14)
+                << "steps/s" << std::setw(10) << "init [s]" << std::setw(10) << "RSS [MB]"
+                << std::setw(10) << "speed-up" << std::setw(12) << "efficiency"
+                << std::setw(10) << "tail [s]" << std::setw(10) << "idle [%]" << std::endl;
+
+      double reference = 0.;  // 单线程 events/s
+      for (int threads : ThreadCounts(maxThreads)) {
+        Measurement m = Run(exe, macro, threads, seed, runManager, chunk);
+        if (!m.ok) {
+          std::cout << std::setw(8) << threads << "  FAILED" << std::endl;
+          allOk = false;
+          continue;
+        }
+        if (m.material != w.material) {
+          std::cout << std::setw(8) << threads << "  target material "
+                    << (m.material.empty() ? "not reported" : m.material) << ", expected "
+                    << w.material << " (not recorded)" << std::endl;
+          allOk = false;
+          continue;
+        }
+        if (reference <= 0.) reference = m.EventsPerSecond() / threads;
+        if (referenceSteps < 0) referenceSteps = m.steps;
+        reproducible = reproducible && (m.steps == referenceSteps);
+        double speedup = reference > 0. ? m.EventsPerSecond() / reference : 0.;
+        double idle = m.loopSeconds > 0. ? 100. * m.idleSeconds / (m.loopSeconds * threads) : 0.;
+
+        std::cout << std::fixed << std::setprecision(2) << std::setw(8) << threads
+                  << std::setw(12) << m.EventsPerSecond() << std::setw(14) << std::setprecision(0)
+                  << m.StepsPerSecond() << std::setprecision(2) << std::setw(10) << m.initSeconds
+                  << std::setw(10) << m.peakRssMB << std::setw(10) << speedup << std::setw(12)
+                  << speedup / threads << std::setw(10) << m.tailSeconds << std::setw(10)
+                  << std::setprecision(1) << idle << std::defaultfloat << std::endl;
+
+        json << (firstRun ? "\n" : ",\n") << "      {\"run_manager\": \"" << runManager
+             << "\", \"threads\": " << threads
+             << ", \"events\": " << m.events << ", \"steps\": " << m.steps
+             << ", \"loop_time_s\": " << m.loopSeconds << ", \"events_per_s\": "
+             << m.EventsPerSecond() << ", \"steps_per_s\": " << m.StepsPerSecond()
+             << ", \"init_time_s\": " << m.initSeconds << ", \"peak_rss_MB\": " << m.peakRssMB
+             << ", \"speedup\": " << speedup << ", \"efficiency\": " << speedup / threads
+             << ", \"tail_s\": " << m.tailSeconds << ", \"idle_s\": " << m.idleSeconds << "}";
+        firstRun = false;
+      }
+    }
+    json << "\n    ], \"reproducible_steps\": " << (reproducible ? "true" : "false") << "}";
+    if (!reproducible) {
+      std::cout << "warning: step count depends on the thread count or run manager" << std::endl;
+    }
+    std::remove(macro.c_str());
+  }
+  json << "\n  ]\n}\n";
+
+  std::cout << "\nresults written to " << output << std::endl;
+  return allOk ? 0 : 1;
+}
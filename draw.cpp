@@ -39,6 +39,9 @@ void DrawVariable(const char *rootFileName, const char *treeName, const char *va
     return;
   }
 
+  // 只画探测器的入射 (虚拟计分平面的穿过 plane >= 0 也在同一个 tree 中)
+  const char *selection = tree->GetBranch("plane") ? "plane<0" : "";
+
   // 创建画布
   TCanvas *c1 = new TCanvas("c1", "Canvas", 800, 600);
   c1->cd();
@@ -46,7 +49,7 @@ void DrawVariable(const char *rootFileName, const char *treeName, const char *va
   // 自动设置X轴范围
   if (autoRange)
   {
-    tree->Draw(Form("%s>>htemp", variableName));
+    tree->Draw(Form("%s>>htemp", variableName), selection);
     TH1 *h1 = (TH1 *)gPad->GetPrimitive("htemp");
     if (h1)
     {
@@ -64,7 +67,7 @@ void DrawVariable(const char *rootFileName, const char *treeName, const char *va
 
   // 绘制变量
   TString drawCmd = Form("%s>>hvar", variableName);
-  tree->Draw(drawCmd);
+  tree->Draw(drawCmd, selection);
 
   // 获取直方图并设置属性
   TH1 *hvar = (TH1 *)gPad->GetPrimitive("hvar");
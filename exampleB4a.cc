@@ -29,9 +29,23 @@
 
 #include "ActionInitialization.hh"
 #include "DetectorConstruction.hh"
+#include "SweepManager.hh"
+#include "AdaptiveRun.hh"
+#include "Checkpoint.hh"
+#include "CutTuner.hh"
+#include "SeedService.hh"
+#include "ImportanceWorld.hh"
+#include "FastTarget.hh"
+#include "FastStart.hh"
 #include "FTFP_BERT.hh"
+#include "G4StepLimiterPhysics.hh"
+#include "G4GeometrySampler.hh"
+#include "G4ImportanceBiasing.hh"
+#include "G4ParallelWorldPhysics.hh"
+#include "G4FastSimulationPhysics.hh"
 
 #include "G4RunManagerFactory.hh"
+#include "G4MTRunManager.hh"
 #include "G4SteppingVerbose.hh"
 #include "G4UIExecutive.hh"
 #include "G4UIcommand.hh"
@@ -40,6 +54,12 @@
 // #include "Randomize.hh"
 #include "EventAction.hh"  // 包含EventAction头文件
 #include "G4Threading.hh" // 多线程支持
+
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <sstream>
+#include <vector>
 //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
 
 namespace
@@ -47,8 +67,24 @@ namespace
 void PrintUsage()
 {
   G4cerr << " Usage: " << G4endl;
-  G4cerr << " exampleB4a [-m macro ] [-u UIsession] [-t nThreads] [-vDefault]" << G4endl;
+  G4cerr << " exampleB4a [-m macro ] [-u UIsession] [-t nThreads] [-s seed] [-r engine]"
+         << " [--shard k/N] [--runManager type] [--chunk n] [--importance p1,p2]"
+         << " [--fastsim p1,p2] [--cache dir|off] [-vDefault]" << G4endl;
   G4cerr << "   note: -t option is available only for multi-threaded mode." << G4endl;
+  G4cerr << "   -s: 64-bit master seed (reproducible runs); default is a unique seed" << G4endl;
+  G4cerr << "   -r: random engine mixmax (default), ranecu, ranluxpp or mtwist" << G4endl;
+  G4cerr << "   --shard k/N: simulate slice k (0..N-1) of N; /run/beamOn M is per shard,"
+         << " merge with b4merge" << G4endl;
+  G4cerr << "   --runManager: default, serial, mt or tasking (task pool with work stealing)"
+         << G4endl;
+  G4cerr << "   --chunk n: events handed to a thread at a time (event modulo, MT/tasking)"
+         << G4endl;
+  G4cerr << "   --importance: split/roulette these particles (e.g. mu-,mu+) in importance"
+         << " slabs through the target, see /det/importance/" << G4endl;
+  G4cerr << "   --fastsim: replace these primaries in the target by a trained table"
+         << " (fast model), see /fastsim/" << G4endl;
+  G4cerr << "   --cache: physics tables and validated geometries, default $B4_CACHE_DIR"
+         << " or .b4cache in batch mode (-m), off in interactive mode" << G4endl;
 }
 }  // namespace
 
@@ -56,9 +92,12 @@ void PrintUsage()
 
 int main(int argc, char** argv)
 {
+  // 启动耗时从这里开始计 (第一个事件开始时打印)
+  auto fastStart = new B4::FastStart();
+
   // Evaluate arguments
   //
-  if (argc > 7) {
+  if (argc > 23) {
     PrintUsage();
     return 1;
   }
@@ -66,6 +105,16 @@ int main(int argc, char** argv)
   G4String macro;
   G4String session;
   G4bool verboseBestUnits = true;
+  std::uint64_t masterSeed = 0;  // 0: 自动生成唯一的种子
+  G4String engine = "mixmax";
+  G4int shardIndex = 0;
+  G4int shardCount = 0;  // 0: 不分片
+  G4RunManagerType runManagerType = G4RunManagerType::Default;
+  G4int eventChunk = 0;  // 0: 由 run manager 决定
+  std::vector<G4String> importanceParticles;  // 空: 不做重要性抽样
+  std::vector<G4String> fastParticles;        // 空: 不注册快速模拟
+  G4String cacheDir;
+  G4bool cacheGiven = false;
 #ifdef G4MULTITHREADED
   G4int nThreads = 0;
 #endif
@@ -79,6 +128,48 @@ int main(int argc, char** argv)
       nThreads = G4UIcommand::ConvertToInt(argv[i + 1]);
     }
 #endif
+    else if (G4String(argv[i]) == "-s") {
+      masterSeed = std::strtoull(argv[i + 1], nullptr, 10);
+    }
+    else if (G4String(argv[i]) == "-r") {
+      engine = argv[i + 1];
+    }
+    else if (G4String(argv[i]) == "--shard") {
+      // k/N
+      if (std::sscanf(argv[i + 1], "%d/%d", &shardIndex, &shardCount) != 2
+          || shardCount < 1 || shardIndex < 0 || shardIndex >= shardCount) {
+        PrintUsage();
+        return 1;
+      }
+    }
+    else if (G4String(argv[i]) == "--runManager") {
+      // 事件耗时差别很大 (穿过的 mu 与 Pb 中的强子簇射) 时，tasking 的
+      // 任务池可以从忙的线程窃取工作，减少 run 末尾的空闲
+      G4String type = argv[i + 1];
+      if (type == "default") runManagerType = G4RunManagerType::Default;
+      else if (type == "serial") runManagerType = G4RunManagerType::Serial;
+      else if (type == "mt") runManagerType = G4RunManagerType::MT;
+      else if (type == "tasking") runManagerType = G4RunManagerType::Tasking;
+      else {
+        PrintUsage();
+        return 1;
+      }
+    }
+    else if (G4String(argv[i]) == "--chunk") {
+      eventChunk = G4UIcommand::ConvertToInt(argv[i + 1]);
+    }
+    else if (G4String(argv[i]) == "--importance" || G4String(argv[i]) == "--fastsim") {
+      auto& particles = (G4String(argv[i]) == "--importance") ? importanceParticles : fastParticles;
+      std::istringstream list(argv[i + 1]);
+      G4String particle;
+      while (std::getline(list, particle, ',')) {
+        if (!particle.empty()) particles.push_back(particle);
+      }
+    }
+    else if (G4String(argv[i]) == "--cache") {
+      cacheDir = (G4String(argv[i + 1]) == "off") ? "" : argv[i + 1];
+      cacheGiven = true;
+    }
     else if (G4String(argv[i]) == "-vDefault") {
       verboseBestUnits = false;
       --i;  // this option is not followed with a parameter
@@ -89,6 +180,12 @@ int main(int argc, char** argv)
     }
   }
 
+  // 各分片必须使用同一个主种子，才是同一组事件的不同部分
+  if (shardCount > 0 && masterSeed == 0) {
+    G4cerr << " --shard needs the common master seed of all shards (-s seed)" << G4endl;
+    return 1;
+  }
+
   // Detect interactive mode (if no macro provided) and define UI session
   //
   G4UIExecutive* ui = nullptr;
@@ -96,8 +193,13 @@ int main(int argc, char** argv)
     ui = new G4UIExecutive(argc, argv, session);
   }
 
-  // Optionally: choose a different Random engine...
-  // G4Random::setTheEngine(new CLHEP::MTwistEngine);
+  // 批处理 (run_batch.sh 每个参数点启动一个进程) 默认使用缓存：
+  // 物理表从磁盘读取，已验证的几何不再检查重叠
+  if (!cacheGiven && macro.size()) {
+    const char* dir = std::getenv("B4_CACHE_DIR");
+    cacheDir = dir ? dir : ".b4cache";
+  }
+  fastStart->SetCacheDirectory(cacheDir);
 
   // Use G4SteppingVerboseWithUnits
   if (verboseBestUnits) {
@@ -105,40 +207,102 @@ int main(int argc, char** argv)
     G4SteppingVerbose::UseBestUnit(precision);
   }
 
-  // 利用时间设置随机种子，确保每次run的种子随机获取
-  CLHEP::HepRandom::setTheEngine(new CLHEP::RanecuEngine());
-  long seeds[2] = { time(nullptr),  // 当前时间
-                    G4Random::getTheSeed() }; // geant4 默认种子
-  CLHEP::HepRandom::setTheSeeds(seeds);
+  // 随机数引擎和主种子：每个事件的种子由 (主种子, run, event) 导出。
+  // 给定 -s 时结果可复现 (基准测试、回归比较)；否则生成唯一的种子并打印，
+  // 同时启动的多个作业也不会共用种子
+  auto seedService = new B4::SeedService();
+  if (!seedService->InstallEngine(engine)) seedService->InstallEngine("mixmax");
+  seedService->SetMasterSeed(masterSeed != 0 ? masterSeed : B4::SeedService::MakeUniqueSeed());
+  if (shardCount > 0) seedService->SetShard(shardIndex, shardCount);
+  // 分片元数据和检查点的配置散列包含命令历史，保留全部历史 (默认只保留 20 条)
+  G4UImanager::GetUIpointer()->SetMaxHistSize(1000000);
+  seedService->Print();
 
 
   // Construct the default run manager
   //
-  auto runManager = G4RunManagerFactory::CreateRunManager(G4RunManagerType::Default);
+  auto runManager = G4RunManagerFactory::CreateRunManager(runManagerType);
+  fastStart->MarkRunManager();
   // auto runManager = G4RunManagerFactory::CreateRunManager(G4RunManagerType::Serial);
 #ifdef G4MULTITHREADED
   if (nThreads > 0) {
     runManager->SetNumberOfThreads(nThreads);
   }
+  // 每次分给一个线程的事件数 (/run/eventModulo 也可以在宏里设置)；
+  // 小块负载更均衡，大块减少同步
+  if (auto* mtRunManager = dynamic_cast<G4MTRunManager*>(runManager)) {
+    if (eventChunk > 0) mtRunManager->SetEventModulo(eventChunk);
+  }
 #endif
 
   // Set mandatory initialization classes
   //
   auto detConstruction = new B4::DetectorConstruction();
+  detConstruction->SetPrintMaterials(ui != nullptr);
+  detConstruction->SetGeometryCache(cacheDir);
   runManager->SetUserInitialization(detConstruction);
 
   auto physicsList = new FTFP_BERT;
+  // 区域的 G4UserLimits (/det/region/maxStep, minEkin) 需要步长限制物理
+  physicsList->RegisterPhysics(new G4StepLimiterPhysics());
+  // 物理表缓存的键：物理列表和附加的物理
+  G4String physicsDescription = "FTFP_BERT+StepLimiter";
+
+  // 重要性抽样：厚靶中按 slab 分裂/轮盘赌，径迹带权重，输出按权重统计。
+  // 并行世界的体积在几何构造后才存在，G4ImportanceBiasing 会为采样器设置
+  std::vector<G4GeometrySampler*> samplers;
+  if (!importanceParticles.empty()) {
+    physicsDescription += "+Importance";
+    auto importanceWorld = new B4::ImportanceWorld("ImportanceWorld", detConstruction);
+    detConstruction->RegisterParallelWorld(importanceWorld);
+    for (const auto& particle : importanceParticles) {
+      physicsDescription += " " + particle;
+      auto sampler = new G4GeometrySampler(importanceWorld->GetWorldVolume(), particle);
+      sampler->SetParallel(true);
+      physicsList->RegisterPhysics(new G4ImportanceBiasing(sampler, importanceWorld->GetName()));
+      samplers.push_back(sampler);
+    }
+    physicsList->RegisterPhysics(new G4ParallelWorldPhysics(importanceWorld->GetName()));
+  }
+
+  // 靶的快速模拟：/fastsim/train 训练 (完整模拟)，--fastsim 的粒子进入靶时
+  // 由训练表抽样代替 (Target 区域上的 G4VFastSimulationModel)
+  auto fastTarget = new B4::FastTarget(detConstruction);
+  detConstruction->SetFastTarget(fastTarget);
+  if (!fastParticles.empty()) {
+    fastTarget->SetParticles(fastParticles);
+    physicsDescription += "+FastSimulation";
+    auto fastSimulationPhysics = new G4FastSimulationPhysics();
+    for (const auto& particle : fastParticles) {
+      physicsDescription += " " + particle;
+      fastSimulationPhysics->ActivateFastSimulation(particle);
+    }
+    physicsList->RegisterPhysics(fastSimulationPhysics);
+  }
   runManager->SetUserInitialization(physicsList);
+  fastStart->SetPhysicsList(physicsList, physicsDescription);
 
-  auto actionInitialization = new B4::ActionInitialization(detConstruction);
+  auto actionInitialization = new B4::ActionInitialization(detConstruction, seedService);
   runManager->SetUserInitialization(actionInitialization);
 
-  // Initialize visualization
+  // In-process parameter sweep (/sweep/ commands)
+  auto sweepManager = new B4::SweepManager(detConstruction);
+  // Production-cut tuning against a reference run (/tune/ commands)
+  auto cutTuner = new B4::CutTuner(detConstruction);
+  // Convergence-driven run length (/run/beamUntil)
+  auto adaptiveRun = new B4::AdaptiveRun();
+  // Checkpointed, resumable and extendable runs (/run/checkpoint/ commands)
+  auto checkpoint = new B4::Checkpoint(seedService);
+
+  // Initialize visualization (interactive mode only; batch jobs never draw)
   //
-  auto visManager = new G4VisExecutive;
-  // G4VisExecutive can take a verbosity argument - see /vis/verbose guidance.
-  // auto visManager = new G4VisExecutive("Quiet");
-  visManager->Initialize();
+  G4VisManager* visManager = nullptr;
+  if (ui) {
+    visManager = new G4VisExecutive;
+    // G4VisExecutive can take a verbosity argument - see /vis/verbose guidance.
+    // auto visManager = new G4VisExecutive("Quiet");
+    visManager->Initialize();
+  }
 
   // Get the pointer to the User Interface manager
   auto UImanager = G4UImanager::GetUIpointer();
@@ -165,8 +329,16 @@ int main(int argc, char** argv)
   // owned and deleted by the run manager, so they should not be deleted
   // in the main() program !
 
+  delete checkpoint;
+  delete adaptiveRun;
+  delete fastTarget;
+  delete cutTuner;
+  delete seedService;
+  delete sweepManager;
   delete visManager;
+  delete fastStart;
   delete runManager;
+  for (auto* sampler : samplers) delete sampler;
 }
 
 //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo.....
@@ -37,6 +37,9 @@ namespace B4
 {
 class PrimaryGeneratorAction;
 class DetectorConstruction;
+class StackingPolicy;
+class BeamSource;
+class SeedService;
 
 /// Action initialization class.
 /// initialize the actions like runAction, eventAction, steppingAction, GeneratorPrimaryAction by SetUserAction()
@@ -44,8 +47,9 @@ class DetectorConstruction;
 class ActionInitialization : public G4VUserActionInitialization
 {
   public:
-    ActionInitialization(B4::DetectorConstruction* detConstruction);
-    ~ActionInitialization() override = default;
+    ActionInitialization(B4::DetectorConstruction* detConstruction,
+                         const SeedService* seeds = nullptr);
+    ~ActionInitialization() override;
 
     void BuildForMaster() const override;
     void Build() const override;
@@ -53,6 +57,9 @@ class ActionInitialization : public G4VUserActionInitialization
   private:
     B4::DetectorConstruction* fDetConstruction = nullptr;
     PrimaryGeneratorAction* fGenAction;
+    StackingPolicy* fStackingPolicy = nullptr;  // 所有 worker 共享，master 上由 /stack/ 命令配置
+    BeamSource* fBeamSource = nullptr;          // 所有 worker 共享，master 上由 /beam/ 命令配置
+    const SeedService* fSeeds = nullptr;        // main 所有，逐事件播种
 };
 
 }  // namespace B4
@@ -0,0 +1,102 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+//
+/// \file B4/B4a/include/AdaptiveRun.hh
+/// \brief Definition of the B4::AdaptiveRun class
+
+#ifndef B4AdaptiveRun_h
+#define B4AdaptiveRun_h 1
+
+#include "EntryObservables.hh"
+#include "globals.hh"
+
+#include <utility>
+#include <vector>
+
+namespace B4
+{
+
+class AdaptiveRunMessenger;
+
+/// Convergence-driven run length (/run/beamUntil).
+///
+/// The events are simulated in chunks, each chunk a normal /run/beamOn,
+/// so the workers only synchronise at the chunk boundaries. After every
+/// chunk the merged results of the master RunAction (transmitted and
+/// blocked primaries, entry observables) are added to the running totals,
+/// and the run stops when the relative uncertainty of the transmission
+/// and of the selected spectrum bins is below the target, or when the
+/// event or wall-time budget is used up.
+///
+/// The next chunk is sized from the current uncertainty (1/sqrt(N)
+/// scaling), so easy points stop after the first chunk and hard points
+/// need only a few synchronisation points. A chunk grows to at most four
+/// times the events simulated so far, stays at the minimum size while
+/// nothing has been counted, and never goes past the event limit.
+
+class AdaptiveRun
+{
+  public:
+    enum class Spectrum { Energy, Theta };
+
+    AdaptiveRun();
+    ~AdaptiveRun();
+
+    void SetChunkSize(G4int n) { fChunkSize = n; }
+    void SetMinEvents(G4long n) { fMinEvents = n; }
+    void SetMaxEvents(G4long n) { fMaxEvents = n; }
+    void SetWallTime(G4double seconds) { fWallTime = seconds; }
+    void AddBin(Spectrum spectrum, G4int bin) { fBins.emplace_back(spectrum, bin); }
+    void ClearBins() { fBins.clear(); }
+
+    // 运行直到相对不确定度 <= relError (或达到事例数/时间上限)
+    void BeamUntil(G4double relError);
+
+  private:
+    G4double TransmissionError() const;
+    G4double BinError(std::size_t index) const;
+    G4String BinName(std::size_t index) const;
+
+    AdaptiveRunMessenger* fMessenger = nullptr;
+
+    G4int fChunkSize = 10000;
+    G4long fMinEvents = 0;
+    G4long fMaxEvents = 100000000;
+    G4double fWallTime = 0.;  // s, 0 = 不限
+    std::vector<std::pair<Spectrum, G4int>> fBins;
+
+    // 各 chunk 的累计
+    G4long fEvents = 0;
+    G4long fPassed = 0;
+    G4long fBlocked = 0;
+    G4double fTransmitted = 0.;   // sum of transmitted weight per primary
+    G4double fTransmitted2 = 0.;
+    EntryObservables fTotal;
+};
+
+}  // namespace B4
+
+#endif
@@ -0,0 +1,42 @@
+#ifndef B4AdaptiveRunMessenger_h
+#define B4AdaptiveRunMessenger_h
+
+#include "G4UImessenger.hh"
+
+class G4UIdirectory;
+class G4UIcommand;
+class G4UIcmdWithAString;
+class G4UIcmdWithADouble;
+class G4UIcmdWithADoubleAndUnit;
+class G4UIcmdWithAnInteger;
+class G4UIcmdWithoutParameter;
+
+namespace B4 {
+
+class AdaptiveRun;
+
+// define commands to run until the results reach a given precision
+
+class AdaptiveRunMessenger : public G4UImessenger {
+public:
+  explicit AdaptiveRunMessenger(AdaptiveRun* adaptive);
+  ~AdaptiveRunMessenger() override;
+
+  void SetNewValue(G4UIcommand* cmd, G4String val) override;
+
+private:
+  AdaptiveRun*                fAdaptive;
+
+  G4UIdirectory*              fUntilDir;       // /run/until/
+  G4UIcmdWithADouble*         fBeamUntilCmd;   // /run/beamUntil 目标相对不确定度
+  G4UIcmdWithAnInteger*       fChunkCmd;       // 最小 chunk 事例数
+  G4UIcmdWithAnInteger*       fMinEventsCmd;   // 最少事例数
+  G4UIcmdWithAnInteger*       fMaxEventsCmd;   // 最多事例数
+  G4UIcmdWithADoubleAndUnit*  fWallTimeCmd;    // 时间预算
+  G4UIcmdWithAString*         fBinCmd;         // 需要收敛的谱 bin
+  G4UIcmdWithoutParameter*    fClearBinsCmd;
+};
+
+}  // namespace B4
+
+#endif  // B4AdaptiveRunMessenger_h
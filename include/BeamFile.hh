@@ -0,0 +1,71 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+//
+/// \file B4/B4a/include/BeamFile.hh
+/// \brief Definition of the B4::BeamFile class
+
+#ifndef B4BeamFile_h
+#define B4BeamFile_h 1
+
+#include "BeamFileFormat.hh"
+#include "globals.hh"
+
+#include <cstddef>
+
+namespace B4
+{
+
+/// Read-only memory mapping of a beam file (see BeamFileFormat.hh).
+///
+/// The file is opened once on the master; the mapping is shared by all
+/// worker threads, which only read from it. Pages are loaded by the OS on
+/// first access, so opening a large file costs nothing up front.
+
+class BeamFile
+{
+  public:
+    explicit BeamFile(const G4String& path);
+    ~BeamFile();
+
+    G4bool IsOpen() const { return fRecords != nullptr; }
+    const G4String& GetPath() const { return fPath; }
+    std::size_t Size() const { return fSize; }
+    const BeamFormat::Record& operator[](std::size_t i) const { return fRecords[i]; }
+
+  private:
+    G4String fPath;
+    void* fAddress = nullptr;
+    std::size_t fLength = 0;
+    const BeamFormat::Record* fRecords = nullptr;
+    std::size_t fSize = 0;
+
+    BeamFile(const BeamFile&) = delete;
+    BeamFile& operator=(const BeamFile&) = delete;
+};
+
+}  // namespace B4
+
+#endif
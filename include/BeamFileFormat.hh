@@ -0,0 +1,97 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+//
+/// \file B4/B4a/include/BeamFileFormat.hh
+/// \brief On-disk layout of a B4 beam file
+///
+/// A beam file holds measured (or externally simulated) primaries:
+///
+///   [FileHeader, 64 bytes][Record 0][Record 1]...[Record n-1]
+///
+/// Records are fixed width (8 doubles, native byte order), so a mapped
+/// file is used directly as an array. Positions are relative to the
+/// source plane centre (upstream face of the world), in mm; directions
+/// need not be normalised; energies are kinetic, in MeV; times in ns.
+/// The header only depends on the standard library, so converters do not
+/// need Geant4 (see tools/b4beamconv.cc).
+
+#ifndef B4BeamFileFormat_h
+#define B4BeamFileFormat_h 1
+
+#include <cstdint>
+#include <cstring>
+
+namespace B4
+{
+namespace BeamFormat
+{
+
+constexpr char kMagic[8] = {'B', '4', 'B', 'E', 'A', 'M', 0, 0};
+constexpr std::uint32_t kVersion = 1;
+
+struct Record
+{
+  double x, y, z;     // mm
+  double dx, dy, dz;  // direction
+  double energy;      // kinetic energy, MeV
+  double time;        // ns, added to the event time
+};
+
+static_assert(sizeof(Record) == 64, "beam record must be 64 bytes");
+
+struct FileHeader
+{
+  char magic[8];
+  std::uint32_t version;
+  std::uint32_t recordSize;
+  std::uint64_t nrecords;
+  char reserved[40];
+};
+
+static_assert(sizeof(FileHeader) == 64, "beam file header must be 64 bytes");
+
+inline FileHeader MakeHeader(std::uint64_t nrecords)
+{
+  FileHeader header;
+  std::memset(&header, 0, sizeof(header));
+  std::memcpy(header.magic, kMagic, sizeof(kMagic));
+  header.version = kVersion;
+  header.recordSize = sizeof(Record);
+  header.nrecords = nrecords;
+  return header;
+}
+
+inline bool IsValid(const FileHeader& header)
+{
+  return std::memcmp(header.magic, kMagic, sizeof(kMagic)) == 0
+      && header.version == kVersion
+      && header.recordSize == sizeof(Record);
+}
+
+}  // namespace BeamFormat
+}  // namespace B4
+
+#endif
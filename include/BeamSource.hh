@@ -0,0 +1,159 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+//
+/// \file B4/B4a/include/BeamSource.hh
+/// \brief Definition of the B4::BeamSource class
+
+#ifndef B4BeamSource_h
+#define B4BeamSource_h 1
+
+#include "G4ThreeVector.hh"
+#include "globals.hh"
+
+#include <memory>
+#include <vector>
+
+namespace B4
+{
+
+class BeamFile;
+class BeamSourceMessenger;
+
+/// One pre-sampled primary: offset from the source plane centre,
+/// direction, kinetic energy, time offset and species.
+
+struct BeamParticle
+{
+  G4ThreeVector position;
+  G4ThreeVector direction;
+  G4double energy = 0.;
+  G4double time = 0.;
+  G4int species = -1;  // /beam/species 列表中的序号，-1 为 /gun/particle
+};
+
+/// Per-thread batch of primaries, owned by each PrimaryGeneratorAction.
+/// The random numbers of a whole batch are drawn with one array call.
+
+struct BeamBatch
+{
+  std::vector<BeamParticle> particles;
+  std::vector<G4double> gauss;
+  std::vector<G4double> flat;
+  std::size_t next = 0;
+
+  void Clear() { particles.clear(); next = 0; }
+  G4bool Empty() const { return next >= particles.size(); }
+};
+
+/// Beam phase-space description, configured with /beam/ commands on the
+/// master and read by the PrimaryGeneratorAction of every worker.
+///
+/// Transverse profile (spot and divergence):
+///  - uniform   : uniform disk, parallel beam (the original gun)
+///  - gaussian  : Gaussian spot and divergence, uncorrelated
+///  - emittance : Gaussian phase space from emittance and Twiss beta/alpha
+/// Energy spectrum around the /gun/energy value:
+///  - mono, gauss (relative spread), flat (range), logflat (range, uniform
+///    in log E), table (file), list (discrete energies, equally often)
+/// Species: the /gun/particle, or a weighted mix (/beam/species) sampled
+/// per primary. A mixed beam with an energy list covers a whole
+/// species x energy scan in one run; the primary of every entry is
+/// written to the output so the points can be separated afterwards.
+/// With /beam/file the primaries are instead read from a measured beam
+/// file (BeamFileFormat.hh), record = event ID modulo the file size.
+
+class BeamSource
+{
+  public:
+    enum class Profile { Uniform, Gaussian, Emittance };
+    enum class Spectrum { Mono, Gauss, Flat, LogFlat, Table, List };
+
+    BeamSource();
+    ~BeamSource();
+
+    // 填满一个批次 (worker 调用，使用本线程的随机数引擎)
+    void Fill(BeamBatch& batch, G4double nominalEnergy) const;
+
+    const BeamFile* GetBeamFile() const { return fFile.get(); }
+    std::size_t GetBatchSize() const { return fBatchSize; }
+
+    void SetProfile(Profile profile) { fProfile = profile; }
+    void SetRadius(G4double radius) { fRadius = radius; }
+    void SetSigma(G4double sx, G4double sy) { fSigmaX = sx; fSigmaY = sy; }
+    void SetDivergence(G4double sx, G4double sy) { fDivX = sx; fDivY = sy; }
+    void SetEmittance(G4double ex, G4double ey) { fEmitX = ex; fEmitY = ey; }
+    void SetTwiss(G4double betaX, G4double alphaX, G4double betaY, G4double alphaY);
+    void SetSpectrum(Spectrum spectrum) { fSpectrum = spectrum; }
+    void SetEnergySpread(G4double spread) { fEnergySpread = spread; }
+    void SetEnergyRange(G4double emin, G4double emax) { fEmin = emin; fEmax = emax; }
+    G4bool LoadSpectrum(const G4String& path);
+    // 离散能量，等概率抽样 (选择 list 谱)
+    G4bool SetEnergyList(const std::vector<G4double>& energies);
+    // 粒子种类及其相对权重；空列表：回到 /gun/particle
+    G4bool SetSpecies(const std::vector<G4String>& names, const std::vector<G4double>& weights);
+    void OpenBeamFile(const G4String& path);
+    void SetBatchSize(std::size_t n) { fBatchSize = n; }
+
+    Spectrum GetSpectrum() const { return fSpectrum; }
+    const std::vector<G4String>& GetSpecies() const { return fSpeciesNames; }
+    // 初级粒子逐个抽样种类或离散能量 (输出需要按初级粒子区分)
+    G4bool IsMixed() const
+    {
+      return !fFile && (!fSpeciesNames.empty() || fSpectrum == Spectrum::List);
+    }
+
+    void Print() const;
+
+  private:
+    G4double SampleTable(G4double u) const;
+
+    BeamSourceMessenger* fMessenger = nullptr;
+
+    Profile fProfile = Profile::Uniform;
+    G4double fRadius;
+    G4double fSigmaX, fSigmaY;
+    G4double fDivX = 0., fDivY = 0.;
+    G4double fEmitX, fEmitY;
+    G4double fBetaX, fAlphaX = 0.;
+    G4double fBetaY, fAlphaY = 0.;
+
+    Spectrum fSpectrum = Spectrum::Mono;
+    G4double fEnergySpread = 0.;
+    G4double fEmin = 0., fEmax = 0.;
+    std::vector<G4double> fTableEdges;  // 分段常数谱：bin 边界
+    std::vector<G4double> fTableCdf;    // 累积概率，与 fTableEdges 同长
+    std::vector<G4double> fEnergyList;  // list 谱的能量点
+
+    std::vector<G4String> fSpeciesNames;
+    std::vector<G4double> fSpeciesCdf;  // 累积概率，最后一个为 1
+
+    std::unique_ptr<BeamFile> fFile;
+    std::size_t fBatchSize = 256;
+};
+
+}  // namespace B4
+
+#endif
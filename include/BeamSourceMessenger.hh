@@ -0,0 +1,50 @@
+#ifndef B4BeamSourceMessenger_h
+#define B4BeamSourceMessenger_h
+
+#include "G4UImessenger.hh"
+
+class G4UIdirectory;
+class G4UIcommand;
+class G4UIcmdWithAString;
+class G4UIcmdWithADouble;
+class G4UIcmdWithADoubleAndUnit;
+class G4UIcmdWithAnInteger;
+class G4UIcmdWithoutParameter;
+
+namespace B4 {
+
+class BeamSource;
+
+// define commands to describe the beam phase space and energy spectrum
+
+class BeamSourceMessenger : public G4UImessenger {
+public:
+  explicit BeamSourceMessenger(BeamSource* beam);
+  ~BeamSourceMessenger() override;
+
+  void SetNewValue(G4UIcommand* cmd, G4String val) override;
+
+private:
+  BeamSource*                 fBeam;
+
+  G4UIdirectory*              fBeamDir;        // /beam/
+  G4UIcmdWithAString*         fProfileCmd;     // uniform / gaussian / emittance
+  G4UIcmdWithADoubleAndUnit*  fRadiusCmd;      // 均匀束斑半径
+  G4UIcommand*                fSigmaCmd;       // 高斯束斑 sigma x y
+  G4UIcommand*                fDivergenceCmd;  // 高斯发散角 sigma x' y'
+  G4UIcommand*                fEmittanceCmd;   // 发射度 x y [mm mrad]
+  G4UIcommand*                fTwissCmd;       // beta/alpha
+  G4UIcmdWithAString*         fSpectrumCmd;    // mono / gauss / flat / table / list
+  G4UIcmdWithADouble*         fSpreadCmd;      // 相对能散
+  G4UIcommand*                fRangeCmd;       // 平谱范围
+  G4UIcmdWithAString*         fSpectrumFileCmd;
+  G4UIcmdWithAString*         fEnergiesCmd;    // list 谱的能量点
+  G4UIcmdWithAString*         fSpeciesCmd;     // 混合束流的粒子种类和权重
+  G4UIcmdWithAString*         fFileCmd;        // 实测束流文件
+  G4UIcmdWithAnInteger*       fBatchCmd;
+  G4UIcmdWithoutParameter*    fPrintCmd;
+};
+
+}  // namespace B4
+
+#endif  // B4BeamSourceMessenger_h
@@ -0,0 +1,113 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+//
+/// \file B4/B4a/include/Checkpoint.hh
+/// \brief Definition of the B4::Checkpoint class
+
+#ifndef B4Checkpoint_h
+#define B4Checkpoint_h 1
+
+#include "globals.hh"
+
+#include <cstdint>
+#include <vector>
+
+namespace B4
+{
+
+class CheckpointMessenger;
+class SeedService;
+
+/// Checkpointed runs (/run/checkpoint/beamOn, /run/checkpoint/extend).
+///
+/// The events of a dataset are simulated in chunks of /run/checkpoint/every
+/// events, each chunk a normal run whose outputs are closed at its end
+/// (ROOT file with ntuple and histograms, columnar segments, summary or
+/// response matrix) together with "<output>.shard", the metadata with all
+/// merged accumulables. After every chunk the master rewrites the
+/// checkpoint file atomically: configuration hash, master seed, engine,
+/// the next event key, the running totals and the list of finished chunks.
+///
+/// Every event is reseeded from (master seed, run, event) by SeedService,
+/// so the next event key is the complete random-number state: a dataset
+/// continued in another process, after a crash or a preemption, is the
+/// same events as one uninterrupted run. /run/checkpoint/beamOn with an
+/// existing checkpoint of the same configuration continues where it
+/// stopped (only the unfinished chunk is simulated again);
+/// /run/checkpoint/extend adds events to a finished dataset. The chunks are
+/// combined with tools/b4merge like the shards of a sharded job.
+
+class Checkpoint
+{
+  public:
+    Checkpoint(SeedService* seeds);
+    ~Checkpoint();
+
+    void SetFile(const G4String& path) { fFile = path; }
+    void SetChunkSize(G4int n) { fChunkSize = n; }
+
+    // 共 events 个事件的数据集；已有相同配置的检查点时从中断处继续
+    void BeamOn(G4long events);
+    // 已有的数据集再加 events 个事件
+    void Extend(G4long events);
+    void Print() const;
+
+  private:
+    struct State
+    {
+      std::uint64_t configHash = 0;
+      std::uint64_t masterSeed = 0;
+      G4String engine;
+      G4int shard = 0;
+      G4int shards = 0;
+      G4int run = 0;             // 事件键的 run
+      G4long firstEvent = 0;     // 第一个事件键
+      G4long targetEvents = 0;
+      G4long doneEvents = 0;
+      G4String outputFormat;
+      std::vector<G4String> chunks;  // 已完成 chunk 的元数据 (.shard)
+      G4long passed = 0;
+      G4long blocked = 0;
+      G4double transmitted = 0.;
+      G4double transmitted2 = 0.;
+      G4long steps = 0;
+    };
+
+    G4String FilePath() const;
+    G4bool Load(State& state) const;
+    G4bool Matches(const State& state) const;
+    G4bool Save(const State& state) const;
+    void Run(State& state);
+
+    SeedService* fSeeds;
+    CheckpointMessenger* fMessenger = nullptr;
+    G4String fFile = "b4run.ckpt";
+    G4int fChunkSize = 10000;
+};
+
+}  // namespace B4
+
+#endif
@@ -0,0 +1,38 @@
+#ifndef B4CheckpointMessenger_h
+#define B4CheckpointMessenger_h
+
+#include "G4UImessenger.hh"
+
+class G4UIdirectory;
+class G4UIcommand;
+class G4UIcmdWithAString;
+class G4UIcmdWithAnInteger;
+class G4UIcmdWithoutParameter;
+
+namespace B4 {
+
+class Checkpoint;
+
+// define commands for checkpointed, resumable and extendable runs
+
+class CheckpointMessenger : public G4UImessenger {
+public:
+  explicit CheckpointMessenger(Checkpoint* checkpoint);
+  ~CheckpointMessenger() override;
+
+  void SetNewValue(G4UIcommand* cmd, G4String val) override;
+
+private:
+  Checkpoint*                 fCheckpoint;
+
+  G4UIdirectory*              fCheckpointDir;  // /run/checkpoint/
+  G4UIcmdWithAString*         fFileCmd;        // 检查点文件
+  G4UIcmdWithAnInteger*       fEveryCmd;       // 每个 chunk 的事例数
+  G4UIcmdWithAnInteger*       fBeamOnCmd;      // 运行 (或继续) 一个数据集
+  G4UIcmdWithAnInteger*       fExtendCmd;      // 数据集再加 N 个事例
+  G4UIcmdWithoutParameter*    fPrintCmd;
+};
+
+}  // namespace B4
+
+#endif  // B4CheckpointMessenger_h
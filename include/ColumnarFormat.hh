@@ -0,0 +1,110 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+//
+/// \file B4/B4a/include/ColumnarFormat.hh
+/// \brief On-disk layout of the B4 columnar output
+///
+/// A columnar dataset is a directory. Every worker thread owns one segment
+/// and appends each column to its own file "<column>.<segment>.col":
+///
+///   [FileHeader, 64 bytes][value 0][value 1]...[value nrows-1]
+///
+/// Values are fixed width, native (little-endian) byte order, and start on
+/// a 64-byte boundary, so a mapped file can be used directly as an array.
+/// The header only depends on the standard library, so readers do not need
+/// Geant4.
+
+#ifndef B4ColumnarFormat_h
+#define B4ColumnarFormat_h 1
+
+#include <cstdint>
+#include <cstring>
+#include <string>
+
+namespace B4
+{
+namespace Columnar
+{
+
+constexpr char kMagic[8] = {'B', '4', 'C', 'O', 'L', 'S', 0, 0};
+constexpr std::uint32_t kVersion = 1;
+
+enum class DType : std::uint32_t
+{
+  Int32 = 0,
+  Float64 = 1
+};
+
+inline std::uint32_t SizeOf(DType type)
+{
+  return (type == DType::Int32) ? 4 : 8;
+}
+
+struct FileHeader
+{
+  char magic[8];
+  std::uint32_t version;
+  std::uint32_t dtype;      // DType
+  std::uint64_t nrows;      // patched when the segment is closed
+  std::uint32_t elemSize;
+  std::int32_t segment;
+  char column[32];          // zero terminated column name
+};
+
+static_assert(sizeof(FileHeader) == 64, "columnar header must be 64 bytes");
+
+inline FileHeader MakeHeader(const std::string& column, DType type, std::int32_t segment)
+{
+  FileHeader header;
+  std::memset(&header, 0, sizeof(header));
+  std::memcpy(header.magic, kMagic, sizeof(kMagic));
+  header.version = kVersion;
+  header.dtype = static_cast<std::uint32_t>(type);
+  header.elemSize = SizeOf(type);
+  header.segment = segment;
+  std::strncpy(header.column, column.c_str(), sizeof(header.column) - 1);
+  return header;
+}
+
+inline bool IsValid(const FileHeader& header)
+{
+  return std::memcmp(header.magic, kMagic, sizeof(kMagic)) == 0
+      && header.version == kVersion
+      && header.elemSize == SizeOf(static_cast<DType>(header.dtype));
+}
+
+inline std::string SegmentFileName(const std::string& column, std::int32_t segment)
+{
+  return column + "." + std::to_string(segment) + ".col";
+}
+
+// run description written by the master next to the segments
+constexpr const char* kRunInfoFile = "run.info";
+
+}  // namespace Columnar
+}  // namespace B4
+
+#endif
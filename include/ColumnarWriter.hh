@@ -0,0 +1,78 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+//
+/// \file B4/B4a/include/ColumnarWriter.hh
+/// \brief Definition of the B4::ColumnarWriter class
+
+#ifndef B4ColumnarWriter_h
+#define B4ColumnarWriter_h 1
+
+#include "ColumnarFormat.hh"
+#include "globals.hh"
+
+#include <cstdint>
+#include <cstdio>
+#include <vector>
+
+namespace B4
+{
+
+class EntryBuffer;
+
+/// Append-only writer of one columnar segment (see ColumnarFormat.hh).
+///
+/// Each worker thread owns its own writer and files, so appending needs no
+/// lock. Append() writes a whole event buffer column by column, one fwrite
+/// per column; the row count in the headers is patched in Close().
+
+class ColumnarWriter
+{
+  public:
+    ColumnarWriter(const G4String& directory, G4int segment);
+    ~ColumnarWriter();
+
+    void Append(const EntryBuffer& entries);
+    void Close();
+
+    std::uint64_t GetNumberOfRows() const { return fNofRows; }
+
+  private:
+    struct Column
+    {
+      const char* name;
+      Columnar::DType type;
+      std::FILE* file;
+    };
+
+    std::vector<Column> fColumns;
+    std::vector<G4double> fDoubleScratch;  // 复用的列缓冲区
+    std::vector<std::int32_t> fIntScratch;
+    std::uint64_t fNofRows = 0;
+};
+
+}  // namespace B4
+
+#endif
@@ -0,0 +1,84 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+//
+/// \file B4/B4a/include/CutTuner.hh
+/// \brief Definition of the B4::CutTuner class
+
+#ifndef B4CutTuner_h
+#define B4CutTuner_h 1
+
+#include "globals.hh"
+
+#include <vector>
+
+namespace B4
+{
+
+class DetectorConstruction;
+class CutTunerMessenger;
+
+/// Automatic tuning of the production cuts of one region.
+///
+/// /tune/run first runs a reference with the current cuts, then raises the
+/// cuts of the selected particles by a constant factor, one run per step,
+/// until the detector-entry observables (entries per event, energy and
+/// theta spectra) are no longer statistically compatible with the
+/// reference. The last compatible cut is kept and reported together with
+/// the step and CPU saving of every step. If the current cut times the
+/// factor already exceeds the maximum cut, nothing is run.
+
+class CutTuner
+{
+  public:
+    CutTuner(DetectorConstruction* det);
+    ~CutTuner();
+
+    void SetRegion(const G4String& region) { fRegion = region; }
+    void SetParticles(const std::vector<G4String>& names) { fParticles = names; }
+    void SetFactor(G4double factor) { fFactor = factor; }
+    void SetMaxCut(G4double cut) { fMaxCut = cut; }
+    void SetNumberOfEvents(G4int n) { fNofEvents = n; }
+    void SetPValue(G4double p) { fPValue = p; }
+
+    void Run();
+
+  private:
+    void SetCut(G4double cut);
+
+    DetectorConstruction* fDet = nullptr;
+    CutTunerMessenger* fMessenger = nullptr;
+
+    G4String fRegion = "Target";
+    std::vector<G4String> fParticles = { "gamma", "e-", "e+" };
+    G4double fFactor = 2.;
+    G4double fMaxCut;
+    G4int fNofEvents = 2000;
+    G4double fPValue = 0.01;
+};
+
+}  // namespace B4
+
+#endif
@@ -0,0 +1,41 @@
+#ifndef B4CutTunerMessenger_h
+#define B4CutTunerMessenger_h
+
+#include "G4UImessenger.hh"
+
+class G4UIdirectory;
+class G4UIcmdWithAString;
+class G4UIcmdWithADouble;
+class G4UIcmdWithADoubleAndUnit;
+class G4UIcmdWithAnInteger;
+class G4UIcmdWithoutParameter;
+
+namespace B4 {
+
+class CutTuner;
+
+// define commands to configure and run the automatic cut tuning
+
+class CutTunerMessenger : public G4UImessenger {
+public:
+  explicit CutTunerMessenger(CutTuner* tuner);
+  ~CutTunerMessenger() override;
+
+  void SetNewValue(G4UIcommand* cmd, G4String val) override;
+
+private:
+  CutTuner*                   fTuner;
+
+  G4UIdirectory*              fTuneDir;       // /tune/
+  G4UIcmdWithAString*         fRegionCmd;     // 调节的区域
+  G4UIcmdWithAString*         fParticlesCmd;  // 调节的粒子
+  G4UIcmdWithADouble*         fFactorCmd;     // 每步放大倍数
+  G4UIcmdWithADoubleAndUnit*  fMaxCutCmd;     // 阈值上限
+  G4UIcmdWithAnInteger*       fEventsCmd;     // 每步事例数
+  G4UIcmdWithADouble*         fPValueCmd;     // 一致性判据
+  G4UIcmdWithoutParameter*    fRunCmd;
+};
+
+}  // namespace B4
+
+#endif  // B4CutTunerMessenger_h
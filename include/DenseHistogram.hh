@@ -0,0 +1,183 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+//
+/// \file B4/B4a/include/DenseHistogram.hh
+/// \brief Definition of the B4::Binning, B4::DenseH1 and B4::DenseH2 templates
+
+#ifndef B4DenseHistogram_h
+#define B4DenseHistogram_h 1
+
+#include "G4AnalysisManager.hh"
+#include "globals.hh"
+
+#include <array>
+#include <cstddef>
+
+namespace B4
+{
+
+/// Compile-time uniform binning: NBins bins over [Min, Max) (integer edges,
+/// in the internal units of the filled quantity), plus underflow (index 0)
+/// and overflow (index NBins + 1), the same layout as the tools histograms
+/// behind G4H1/G4H2.
+
+template <G4int NBins, G4int Min, G4int Max>
+struct Binning
+{
+  static_assert(NBins > 0 && Max > Min, "invalid binning");
+  static constexpr G4int kBins = NBins;
+  static constexpr G4int kSize = NBins + 2;  // with under/overflow
+  static constexpr G4double kMin = Min;
+  static constexpr G4double kMax = Max;
+  static constexpr G4double kScale = NBins / (kMax - kMin);
+
+  // 先夹紧再取整 (下溢 -> -1，上溢和 NaN -> NBins)，无分支，
+  // 编译器可以向量化整个索引循环
+  static G4int Index(G4double v)
+  {
+    G4double u = (v - kMin) * kScale;
+    u = (u < 0.) ? -1. : ((u < NBins) ? u : G4double(NBins));
+    return static_cast<G4int>(u) + 1;
+  }
+};
+
+/// Dense per-thread weighted H1: per bin the entries and the sums of w, w^2,
+/// w*x and w*x^2, in flat cache-aligned arrays. MergeInto() adds the content
+/// to a G4H1 of the same binning in one pass over the bin arrays (exact:
+/// same bins, same sums).
+
+template <class X>
+class DenseH1
+{
+  public:
+    void Fill(G4int ix, G4double x, G4double w)
+    {
+      fEntries[ix] += 1.;
+      fSw[ix] += w;
+      fSw2[ix] += w * w;
+      fSx[ix] += w * x;
+      fSx2[ix] += w * x * x;
+    }
+
+    void Reset()
+    {
+      fEntries.fill(0.);
+      fSw.fill(0.);
+      fSw2.fill(0.);
+      fSx.fill(0.);
+      fSx2.fill(0.);
+    }
+
+    void MergeInto(G4H1* h) const
+    {
+      if (!h) return;
+      // 本线程的数组整体写进一个同样分箱的直方图，再用 add() 一次加到目标上，
+      // 不再每个 bin 经过 get_bin_content/set_bin_content
+      G4H1 part(*h);
+      auto data = part.get_histo_data();
+      for (G4int i = 0; i < X::kSize; ++i) {
+        data.m_bin_entries[i] = static_cast<std::size_t>(fEntries[i]);
+        data.m_bin_Sw[i] = fSw[i];
+        data.m_bin_Sw2[i] = fSw2[i];
+        data.m_bin_Sxw[i][0] = fSx[i];
+        data.m_bin_Sx2w[i][0] = fSx2[i];
+      }
+      part.copy_from_data(data);
+      h->add(part);
+    }
+
+  private:
+    alignas(64) std::array<G4double, X::kSize> fEntries{};
+    alignas(64) std::array<G4double, X::kSize> fSw{};
+    alignas(64) std::array<G4double, X::kSize> fSw2{};
+    alignas(64) std::array<G4double, X::kSize> fSx{};
+    alignas(64) std::array<G4double, X::kSize> fSx2{};
+};
+
+/// Dense per-thread weighted H2 (see DenseH1); bin (ix, iy) is
+/// stored at ix + iy * X::kSize like in tools::histo::h2.
+
+template <class X, class Y>
+class DenseH2
+{
+  public:
+    static constexpr G4int kSize = X::kSize * Y::kSize;
+
+    void Fill(G4int ix, G4int iy, G4double x, G4double y, G4double w)
+    {
+      G4int bin = ix + iy * X::kSize;
+      fEntries[bin] += 1.;
+      fSw[bin] += w;
+      fSw2[bin] += w * w;
+      fSx[bin] += w * x;
+      fSx2[bin] += w * x * x;
+      fSy[bin] += w * y;
+      fSy2[bin] += w * y * y;
+    }
+
+    void Reset()
+    {
+      fEntries.fill(0.);
+      fSw.fill(0.);
+      fSw2.fill(0.);
+      fSx.fill(0.);
+      fSx2.fill(0.);
+      fSy.fill(0.);
+      fSy2.fill(0.);
+    }
+
+    void MergeInto(G4H2* h) const
+    {
+      if (!h) return;
+      // 与 DenseH1 相同：一次写入临时直方图，一次 add()。两者的 bin 布局相同
+      G4H2 part(*h);
+      auto data = part.get_histo_data();
+      for (G4int bin = 0; bin < kSize; ++bin) {
+        data.m_bin_entries[bin] = static_cast<std::size_t>(fEntries[bin]);
+        data.m_bin_Sw[bin] = fSw[bin];
+        data.m_bin_Sw2[bin] = fSw2[bin];
+        data.m_bin_Sxw[bin][0] = fSx[bin];
+        data.m_bin_Sx2w[bin][0] = fSx2[bin];
+        data.m_bin_Sxw[bin][1] = fSy[bin];
+        data.m_bin_Sx2w[bin][1] = fSy2[bin];
+      }
+      part.copy_from_data(data);
+      h->add(part);
+    }
+
+  private:
+    alignas(64) std::array<G4double, kSize> fEntries{};
+    alignas(64) std::array<G4double, kSize> fSw{};
+    alignas(64) std::array<G4double, kSize> fSw2{};
+    alignas(64) std::array<G4double, kSize> fSx{};
+    alignas(64) std::array<G4double, kSize> fSx2{};
+    alignas(64) std::array<G4double, kSize> fSy{};
+    alignas(64) std::array<G4double, kSize> fSy2{};
+};
+
+}  // namespace B4
+
+#endif
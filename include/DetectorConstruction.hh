@@ -33,21 +33,42 @@
 
 #include "G4VUserDetectorConstruction.hh"
 #include "G4Material.hh"
+#include "G4ThreeVector.hh"
 #include "G4Threading.hh"
 #include "G4String.hh"
 #include "globals.hh"
 
+#include <cstdint>
+#include <map>
+#include <vector>
+
 class G4GlobalMagFieldMessenger;
 class G4LogicalVolume;
+class G4Region;
+class G4Tubs;
+class G4UserLimits;
 class EventAction;
 
 namespace B4
 {
   class DetectorConstructionMessenger;
+  class FastTarget;
+  class MaterialRegistry;
+  class TargetFastModel;
 
   class DetectorConstruction : public G4VUserDetectorConstruction
   {
   public:
+    /// How entries into the detector shell are scored:
+    /// SteppingAction checks every step in every volume, while the
+    /// sensitive detector is only called for steps inside the shell.
+    enum class EntryScoring { Stepping, SensitiveDetector };
+
+    /// How the detector shell is built: one G4SubtractionSolid of two
+    /// tubes, or two primitive G4Tubs placements (barrel + end cap)
+    /// covering the same region, which are cheaper to navigate.
+    enum class DetectorBuild { Boolean, Primitive };
+
     DetectorConstruction();
     ~DetectorConstruction() override;
 
@@ -62,22 +83,94 @@ namespace B4
     G4String GetTargetMaterialName() const {
       return fTargetMaterial ? fTargetMaterial->GetName() : "unknown";
     }
+    // 靶中心位置 (位于探测器上游端面)
+    G4ThreeVector GetTargetPosition() const { return G4ThreeVector(0., 0., -fDetectorLength/2); }
+    // 探测器外壳：外半径、壁厚、长度，中心位于原点
+    G4double GetDetectorRadius() const { return fDetectorRadius; }
+    G4double GetDetectorThickness() const { return fDetectorThickness; }
+    G4double GetDetectorLength() const { return fDetectorLength; }
     // 定义敏感探测器：保存虚拟探测层逻辑体积(线程私有)
     G4LogicalVolume* GetTargetLogical() const { return fTargetLogical; }
     G4LogicalVolume* GetDetectorLogical() const { return fDetectorLogical; }
+    // primitive 模式下的端盖 (boolean 模式为空)
+    G4LogicalVolume* GetEndCapLogical() const { return fEndCapLogical; }
+    // 属于探测器外壳的逻辑体积 (两种模式下都可用于入射判断)
+    G4bool IsDetectorVolume(const G4LogicalVolume* volume) const {
+      return volume && (volume == fDetectorLogical || volume == fEndCapLogical);
+    }
+    // primitive 模式下 barrel 与端盖之间的内部接缝 (穿过它不是入射)
+    G4bool IsInternalJoin(const G4ThreeVector& position) const;
 
+    // 几何已构造时原地更新：靶的实体改尺寸、逻辑体积换材料，
+    // 只刷新导航的体素和物质-阈值对，不重建几何树
     void SetTargetMaterial(const G4String& name);
-    void SetTargetLength(G4double val) { fTargetLength = val; }
-    void SetTargetRadius(G4double val) { fTargetRadius = val; }
+    void SetTargetLength(G4double val);
+    void SetTargetRadius(G4double val);
 
     void SetDetectorMaterial(const G4String& name);
-    void SetDetectorLength(G4double val) { fDetectorLength = val; }
+    // 下一次 (重新) 构造几何时生效
+    void SetDetectorLength(G4double val);
+
+    // 虚拟计分平面：距靶前表面的深度 (按深度排序)，可以在靶内或靶后。
+    // 平面不是几何体积，不限制步长，由 SteppingAction 按步的 z 范围判断穿过
+    void SetPlaneDepths(const std::vector<G4double>& depths);
+    const std::vector<G4double>& GetPlaneDepths() const { return fPlaneDepths; }
+    // 各平面的 z 位置 (随靶长度和探测器长度更新)
+    const std::vector<G4double>& GetPlaneZ() const { return fPlaneZ; }
+
+    EntryScoring GetEntryScoring() const { return fEntryScoring; }
+    void SetEntryScoring(EntryScoring mode) { fEntryScoring = mode; }
+
+    DetectorBuild GetDetectorBuild() const { return fDetectorBuild; }
+    void SetDetectorBuild(DetectorBuild mode) { fDetectorBuild = mode; }
+
+    // 区域设置：World (默认区域)、Target、Detector
+    // 产生阈值作用于 G4Region，步长限制作用于区域的逻辑体积
+    static const std::vector<G4String>& GetRegionNames();
+    void SetRegionCut(const G4String& region, const G4String& particle, G4double cut);
+    G4double GetRegionCut(const G4String& region, const G4String& particle) const;
+    void SetRegionMaxStep(const G4String& region, G4double step);
+    void SetRegionMinEkin(const G4String& region, G4double ekin);
+    void PrintRegions() const;
+
+    // 靶的快速模拟 (训练与快速模型)，由 main() 设置
+    void SetFastTarget(FastTarget* fastTarget) { fFastTarget = fastTarget; }
+    FastTarget* GetFastTarget() const { return fFastTarget; }
+
+    // 启动：批处理不打印材料表；重叠检查可关闭，给定缓存目录时
+    // 已验证过的几何参数不再检查
+    void SetPrintMaterials(G4bool val) { fPrintMaterials = val; }
+    void PrintMaterials() const;
+    void SetCheckOverlaps(G4bool val) { fCheckOverlaps = val; }
+    void SetGeometryCache(const G4String& dir) { fGeometryCache = dir; }
 
   private:
     // methods
     //
     void DefineMaterials();
     G4VPhysicalVolume* DefineVolumes();
+    void BuildBooleanShell(G4LogicalVolume* worldLV);
+    void BuildPrimitiveShell(G4LogicalVolume* worldLV);
+    void SetupRegion(const G4String& name, const std::vector<G4LogicalVolume*>& volumes);
+    G4Region* FindRegion(const G4String& name) const;
+    std::vector<G4LogicalVolume*> FindRegionVolumes(const G4String& name) const;
+    void ApplyRegionSettings();
+    G4Material* FindMaterial(const G4String& name) const;
+    // 几何已构造且不等待重建时可以原地更新
+    G4bool IsBuilt() const { return fTargetSolid && !fRebuildPending; }
+    void UpdateTargetShape();
+    void MaterialsModified();
+    void UpdatePlanes();
+    std::uint64_t GeometryKey(const G4VPhysicalVolume* worldPV) const;
+    void ValidateGeometry(const G4VPhysicalVolume* worldPV) const;
+
+    struct RegionSettings
+    {
+      std::map<G4String, G4double> cuts;  // particle -> range cut
+      G4double maxStep = DBL_MAX;
+      G4double minEkin = 0.;
+      G4UserLimits* limits = nullptr;
+    };
 
     // data members
     //
@@ -85,17 +178,37 @@ namespace B4
     G4double fTargetRadius;            
     G4Material* fTargetMaterial;           
     G4LogicalVolume* fTargetLogical;
+    G4Tubs* fTargetSolid = nullptr;
 
     G4double fDetectorLength;              
     G4Material* fDetectorMaterial;             
     G4LogicalVolume* fDetectorLogical;
+    G4LogicalVolume* fEndCapLogical = nullptr;
     G4double fDetectorRadius;   
+    G4double fDetectorThickness;
+
+    G4LogicalVolume* fWorldLogical = nullptr;
+    G4VPhysicalVolume* fWorldPhysical = nullptr;
+    G4bool fRebuildPending = false;  // ReinitializeGeometry 之后、重新构造之前
+    MaterialRegistry* fMaterials = nullptr;
 
     G4bool fCheckOverlaps;
+    G4bool fPrintMaterials = true;
+    G4String fGeometryCache;  // 空: 每次都检查重叠
+    EntryScoring fEntryScoring;
+    DetectorBuild fDetectorBuild = DetectorBuild::Boolean;
+    std::map<G4String, RegionSettings> fRegionSettings;
 
     // 线程私有的磁场管理器
     static G4ThreadLocal G4GlobalMagFieldMessenger* fMagFieldMessenger;
 
+    std::vector<G4double> fPlaneDepths;
+    std::vector<G4double> fPlaneZ;
+
+    FastTarget* fFastTarget = nullptr;
+    // 线程私有的靶快速模拟模型 (重建几何时保留)
+    static G4ThreadLocal TargetFastModel* fFastModel;
+
     DetectorConstructionMessenger* fMessenger;
 };
 
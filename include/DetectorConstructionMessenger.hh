@@ -3,8 +3,12 @@
 
 #include "G4UImessenger.hh"
 
+class G4UIdirectory;
+class G4UIcommand;
 class G4UIcmdWithAString;
 class G4UIcmdWithADoubleAndUnit;
+class G4UIcmdWithoutParameter;
+class G4UIcmdWithABool;
 
 namespace B4 {
 
@@ -24,6 +28,18 @@ private:
   G4UIcmdWithADoubleAndUnit*    fTargetLengthCmd;
   G4UIcmdWithADoubleAndUnit*    fTargetRadiusCmd;
   G4UIcmdWithAString*           fTargetMaterialCmd;
+  G4UIcmdWithAString*           fEntryScoringCmd;
+  G4UIcmdWithAString*           fDetectorBuildCmd;
+
+  G4UIdirectory*                fRegionDir;        // /det/region/
+  G4UIcommand*                  fRegionCutCmd;     // 区域产生阈值
+  G4UIcommand*                  fRegionMaxStepCmd; // 区域最大步长
+  G4UIcommand*                  fRegionMinEkinCmd; // 区域最小动能
+  G4UIcmdWithoutParameter*      fRegionPrintCmd;
+
+  G4UIcmdWithABool*             fCheckOverlapsCmd;   // 构造后检查重叠
+  G4UIcmdWithAString*           fScoringPlanesCmd;   // 虚拟计分平面
+  G4UIcmdWithoutParameter*      fPrintMaterialsCmd;  // 打印材料表
 };
 
 }  // namespace B4
@@ -0,0 +1,67 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+//
+/// \file B4/B4a/include/DetectorSD.hh
+/// \brief Definition of the B4::DetectorSD class
+
+#ifndef B4DetectorSD_h
+#define B4DetectorSD_h 1
+
+#include "G4VSensitiveDetector.hh"
+#include "globals.hh"
+
+class G4Step;
+class G4TouchableHistory;
+
+namespace B4
+{
+
+class DetectorConstruction;
+class EventAction;
+
+/// Sensitive detector attached to the detector shell.
+///
+/// ProcessHits() is only invoked for steps inside the shell, so the entry
+/// test reduces to "the step starts on the geometry boundary". The
+/// kinematics at that point are handed to the thread's EventAction, exactly
+/// as SteppingAction does in the stepping scoring mode.
+
+class DetectorSD : public G4VSensitiveDetector
+{
+  public:
+    DetectorSD(const G4String& name, DetectorConstruction* det);
+    ~DetectorSD() override = default;
+
+    G4bool ProcessHits(G4Step* step, G4TouchableHistory* history) override;
+
+  private:
+    DetectorConstruction* fDet = nullptr;
+    EventAction* fEventAction = nullptr;  // 线程私有，首次命中时获取
+};
+
+}  // namespace B4
+
+#endif
@@ -0,0 +1,106 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+//
+/// \file B4/B4a/include/EntryBuffer.hh
+/// \brief Definition of the B4::EntryRecord and B4::EntryBuffer classes
+
+#ifndef B4EntryBuffer_h
+#define B4EntryBuffer_h 1
+
+#include "globals.hh"
+
+#include <cstddef>
+#include <vector>
+
+namespace B4
+{
+
+/// One detector entry: all quantities of a crossing in one contiguous record.
+/// Crossings of a virtual scoring plane use the same record with the plane
+/// index set. The primary of the event is repeated in every record, so a
+/// mixed-beam run can be split by primary species and energy afterwards.
+
+struct EntryRecord
+{
+  G4double px = 0.;
+  G4double py = 0.;
+  G4double pz = 0.;
+  G4double E = 0.;
+  G4double theta = 0.;  // deg
+  G4double phi = 0.;    // deg
+  G4double weight = 1.; // 径迹权重 (重要性抽样)
+  G4double primaryE = 0.;  // 本事件初级粒子的动能
+  G4int pdg = 0;
+  G4int plane = -1;     // 虚拟计分平面的序号，-1 为探测器的入射
+  G4int primaryPdg = 0; // 本事件初级粒子的种类
+};
+
+/// Per-event entry buffer backed by an arena that lives as long as its
+/// owner (one EventAction per worker thread).
+///
+/// Clear() only resets the fill level, so the storage is reused event after
+/// event. The arena grows (doubling) only when an event exceeds the previous
+/// high-water mark; in steady state Append() is a bounds check and a store,
+/// with no allocation and no element construction.
+
+class EntryBuffer
+{
+  public:
+    explicit EntryBuffer(std::size_t initialCapacity = 1024)
+      : fArena(initialCapacity) {}
+
+    void Clear() { fSize = 0; }
+
+    EntryRecord& Append()
+    {
+      if (fSize == fArena.size()) Grow();
+      EntryRecord& record = fArena[fSize++];
+      if (fSize > fHighWater) fHighWater = fSize;
+      return record;
+    }
+
+    EntryRecord* begin() { return fArena.data(); }
+    EntryRecord* end() { return fArena.data() + fSize; }
+    const EntryRecord* begin() const { return fArena.data(); }
+    const EntryRecord* end() const { return fArena.data() + fSize; }
+    std::size_t Size() const { return fSize; }
+    G4bool Empty() const { return fSize == 0; }
+
+    std::size_t Capacity() const { return fArena.size(); }
+    std::size_t HighWater() const { return fHighWater; }
+    std::size_t MemoryBytes() const { return fArena.size() * sizeof(EntryRecord); }
+
+  private:
+    void Grow() { fArena.resize(fArena.empty() ? 1024 : 2 * fArena.size()); }
+
+    std::vector<EntryRecord> fArena;
+    std::size_t fSize = 0;
+    std::size_t fHighWater = 0;
+};
+
+}  // namespace B4
+
+#endif
@@ -0,0 +1,100 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+//
+/// \file B4/B4a/include/EntryHistograms.hh
+/// \brief Definition of the B4::EntryHistograms class
+
+#ifndef B4EntryHistograms_h
+#define B4EntryHistograms_h 1
+
+#include "DenseHistogram.hh"
+#include "globals.hh"
+
+#include <array>
+#include <vector>
+
+class G4AnalysisManager;
+
+namespace B4
+{
+
+class EntryBuffer;
+
+/// Weighted histograms of the detector entries, filled per thread in dense arrays
+/// and merged into the analysis manager's H1/H2 at the end of the run:
+///
+///  - theta_px, theta_py, theta_pz, theta_p (H2, as before)
+///  - per species (gamma, e-, e+, mu-, mu+, pi-, pi+, proton, neutron,
+///    other): log10(E/MeV) spectrum "logE_<name>" and "theta_<name>" (H1)
+///
+/// Fill() bins a whole event in passes over flat scratch arrays: gather
+/// the columns, compute p and log10(E) and all bin indices (vectorisable
+/// loops), then scatter into the bins. The analysis layer is only touched
+/// in MergeInto(), once per run.
+
+class EntryHistograms
+{
+  public:
+    using ThetaAxis = Binning<90, 0, 180>;     // deg
+    using PtAxis = Binning<100, -20, 20>;      // px, py [MeV]
+    using PAxis = Binning<100, 0, 6000>;       // pz, p [MeV]
+    using LogEAxis = Binning<80, -3, 5>;       // log10(E/MeV)
+    using SpeciesThetaAxis = Binning<36, 0, 180>;
+
+    static constexpr G4int kSpecies = 10;
+
+    // 在分析管理器中创建 H2/H1 (RunAction 构造时，各线程相同的顺序)
+    void Book(G4AnalysisManager* analysis);
+
+    // 一个事件的全部入射
+    void Fill(const EntryBuffer& entries);
+
+    // worker：加到分析管理器的 H1/H2 上 (Write 之前)，然后清零
+    void MergeInto(G4AnalysisManager* analysis);
+    void Reset();
+
+    static G4int SpeciesIndex(G4int pdg);
+    static const char* SpeciesName(G4int index);
+
+  private:
+    G4int fFirstH2 = -1;
+    G4int fFirstH1 = -1;
+
+    DenseH2<ThetaAxis, PtAxis> fThetaPx;
+    DenseH2<ThetaAxis, PtAxis> fThetaPy;
+    DenseH2<ThetaAxis, PAxis> fThetaPz;
+    DenseH2<ThetaAxis, PAxis> fThetaP;
+    std::array<DenseH1<LogEAxis>, kSpecies> fLogE;
+    std::array<DenseH1<SpeciesThetaAxis>, kSpecies> fTheta;
+
+    // 每事件复用的列 (SoA)
+    std::vector<G4double> fPx, fPy, fPz, fP, fLog, fThetaDeg, fWeight;
+    std::vector<G4int> fSpecies, fIxTheta, fIxPx, fIxPy, fIxPz, fIxP, fIxLogE, fIxTheta36;
+};
+
+}  // namespace B4
+
+#endif
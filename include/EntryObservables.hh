@@ -0,0 +1,111 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+//
+/// \file B4/B4a/include/EntryObservables.hh
+/// \brief Definition of the B4::EntryObservables class
+
+#ifndef B4EntryObservables_h
+#define B4EntryObservables_h 1
+
+#include "G4VAccumulable.hh"
+#include "globals.hh"
+
+#include <array>
+#include <ostream>
+
+namespace B4
+{
+
+class EntryBuffer;
+
+/// Result of comparing the entry observables of two runs.
+/// Each p-value is the probability of a difference at least as large
+/// if both runs sample the same distribution.
+
+struct EntryCompatibility
+{
+  G4double rateZ = 0.;         // entries/event difference in standard deviations
+  G4double ratePValue = 1.;
+  G4double energyChi2 = 0.;
+  G4int energyNdf = 0;
+  G4double energyPValue = 1.;
+  G4double thetaChi2 = 0.;
+  G4int thetaNdf = 0;
+  G4double thetaPValue = 1.;
+
+  G4bool IsCompatible(G4double pMin) const
+  {
+    return ratePValue >= pMin && energyPValue >= pMin && thetaPValue >= pMin;
+  }
+};
+
+/// Accumulable summary of the detector entries of a run: entries per
+/// event, and coarse kinetic-energy (log) and theta spectra.
+/// Cheap enough to fill for every event; used to check that a change of
+/// cuts or of the stacking policy leaves the recorded entries unchanged.
+
+class EntryObservables : public G4VAccumulable
+{
+  public:
+    static constexpr G4int kEnergyBins = 48;  // log10(E/MeV) in [-3, 5)
+    static constexpr G4double kLogEMin = -3.;
+    static constexpr G4double kLogEMax = 5.;
+    static constexpr G4int kThetaBins = 36;   // theta in [0, 180) deg
+
+    EntryObservables(const G4String& name) : G4VAccumulable(name) {}
+    ~EntryObservables() override = default;
+
+    // 一个事件的全部入射
+    void Fill(const EntryBuffer& entries);
+
+    void Merge(const G4VAccumulable& other) override;
+    void Reset() override;
+
+    // 以 "key.xxx = ..." 行写出全部内容 (分片元数据，tools/b4merge 可精确合并)
+    void Write(std::ostream& os, const G4String& key) const;
+
+    G4long GetEvents() const { return fEvents; }
+    G4long GetEntries() const { return fEntries; }
+    G4double GetEntriesPerEvent() const;
+    G4double GetEntriesPerEventError() const;
+    const std::array<G4double, kEnergyBins>& GetEnergySpectrum() const { return fEnergy; }
+    const std::array<G4double, kThetaBins>& GetThetaSpectrum() const { return fTheta; }
+
+    // 两个 run 的入射观测量是否在统计上一致
+    static EntryCompatibility Compare(const EntryObservables& reference,
+                                      const EntryObservables& test);
+
+  private:
+    G4long fEvents = 0;
+    G4long fEntries = 0;
+    G4double fEntries2 = 0.;  // sum of (entries per event)^2
+    std::array<G4double, kEnergyBins> fEnergy{};
+    std::array<G4double, kThetaBins> fTheta{};
+};
+
+}  // namespace B4
+
+#endif
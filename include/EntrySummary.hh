@@ -0,0 +1,132 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+//
+/// \file B4/B4a/include/EntrySummary.hh
+/// \brief Definition of the B4::EntrySummary class
+
+#ifndef B4EntrySummary_h
+#define B4EntrySummary_h 1
+
+#include "G4VAccumulable.hh"
+#include "globals.hh"
+
+#include <array>
+#include <ostream>
+#include <vector>
+
+namespace B4
+{
+
+class EntryBuffer;
+
+/// Streaming per-species statistics of the detector entries, for the
+/// "summary" output format (no per-entry rows at all).
+///
+/// Per PDG code: number of entries, sum of weights and weights^2, the
+/// weighted first and second moments of E, |p| and theta, and a coarse
+/// log10(E) spectrum. Each species owns one cache-line aligned slot, so
+/// the per-thread copies filled in the event loop never share a line;
+/// the slots are merged by PDG code at the end of the run.
+///
+/// For a mixed beam (BeamSource::IsMixed) the slots are also keyed by the
+/// primary species (and, for an energy list, the primary energy), and each
+/// primary group counts its primaries and transmitted weight, so any
+/// monoenergetic point or beam composition can be recovered from one run.
+
+class EntrySummary : public G4VAccumulable
+{
+  public:
+    static constexpr G4int kEnergyBins = 48;  // log10(E/MeV) in [-3, 5)
+    static constexpr G4double kLogEMin = -3.;
+    static constexpr G4double kLogEMax = 5.;
+
+    struct alignas(64) Species
+    {
+      G4int pdg = 0;
+      G4int primaryPdg = 0;        // 分组的初级粒子 (不分组时为 0)
+      G4double primaryEnergy = 0.;
+      G4long entries = 0;
+      G4double sumW = 0.;
+      G4double sumW2 = 0.;
+      G4double sumE = 0.;   // sum w*E
+      G4double sumE2 = 0.;  // sum w*E^2
+      G4double sumP = 0.;
+      G4double sumP2 = 0.;
+      G4double sumTheta = 0.;   // deg
+      G4double sumTheta2 = 0.;
+      std::array<G4double, kEnergyBins> logE{};  // weighted
+    };
+
+    // 一组初级粒子：数目与透射权重 (透射率的分母和分子)
+    struct Primary
+    {
+      G4int pdg = 0;
+      G4double energy = 0.;
+      G4long primaries = 0;
+      G4double sumT = 0.;
+      G4double sumT2 = 0.;
+    };
+
+    EntrySummary(const G4String& name) : G4VAccumulable(name) {}
+    ~EntrySummary() override = default;
+
+    // 按初级粒子分组 (混合束流)；resolveEnergy 时还按初级粒子的能量分组
+    void SetPrimaryGrouping(G4bool enable, G4bool resolveEnergy);
+    G4bool IsGrouped() const { return fGrouped; }
+
+    // 一个事件的全部入射 (按径迹权重)
+    void Fill(const EntryBuffer& entries);
+    // 一个初级粒子及其透射权重 (只在分组时记录)
+    void AddPrimary(G4int pdg, G4double energy, G4double transmitted);
+
+    void Merge(const G4VAccumulable& other) override;
+    void Reset() override;
+
+    const std::vector<Species>& GetSpecies() const { return fSpecies; }
+    const std::vector<Primary>& GetPrimaries() const { return fPrimaries; }
+    G4long GetTotalEntries() const;
+
+    // 按粒子打印：数目、<E>、<p>、<theta> (带 RMS)
+    void Print(std::ostream& os) const;
+    // 以 "key.<pdg>.xxx = ..." 行写出全部内容 (tools/b4merge 可精确合并)；
+    // 分组时为 "key.primary.<初级 pdg>[@<E MeV>].<pdg>.xxx"
+    void Write(std::ostream& os, const G4String& key) const;
+
+  private:
+    Species& Find(G4int pdg, G4int primaryPdg, G4double primaryEnergy);
+    Primary& FindPrimary(G4int pdg, G4double energy);
+    G4double GroupEnergy(G4double energy) const { return fResolveEnergy ? energy : 0.; }
+
+    std::vector<Species> fSpecies;
+    std::vector<Primary> fPrimaries;
+    std::size_t fLast = 0;  // 上一次命中的 slot
+    G4bool fGrouped = false;
+    G4bool fResolveEnergy = false;
+};
+
+}  // namespace B4
+
+#endif
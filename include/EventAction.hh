@@ -33,42 +33,108 @@
 #include "G4UserEventAction.hh"
 #include "globals.hh"
 #include "G4ThreeVector.hh"
-#include <vector>  // 添加vector支持
+#include "G4AnalysisManager.hh"
+#include "EntryBuffer.hh"
+#include <array>
 #include <fstream>
 #include <mutex>
+#include <vector>
 class G4Event;
+class G4Step;
+class G4StepPoint;
+class G4Track;
 
 namespace B4
 {
 
 class RunAction;
 class PrimaryGeneratorAction;
+class StackingPolicy;
 
 class EventAction : public G4UserEventAction
 {
 public:
-  EventAction();
+  EventAction(RunAction* runAction, const StackingPolicy* policy = nullptr);
   virtual ~EventAction() = default;
 
   virtual void BeginOfEventAction(const G4Event*);
   virtual void EndOfEventAction(const G4Event*);
 
-  // 仅记录入射角
-  void RecordEntry(G4int pdg,G4double E, const G4ThreeVector& pDir, const G4ThreeVector& pMom);
+  // 记录进入探测器的粒子 (point 为入射点)；/stack/killOnEntry 时随后终止径迹
+  void RecordEntry(G4Track* track, const G4StepPoint* point);
+  // 本事件是否有 /stack/killOnEntry 规则 (没有时不必调用下面两个函数)
+  G4bool HasEntryKills() const { return fHasEntryKills; }
+  // SteppingAction：入射时终止的径迹在这一步产生的次级粒子
+  void NoteEntryProducts(const G4Step* step);
+  // StackingAction：新径迹是否为上述次级粒子 (每个只返回一次 true)
+  G4bool TakeEntryProduct(const G4Track* track);
+  // 记录穿过虚拟计分平面 plane 的粒子 (point 为该步起点，direction 为该步的方向)
+  void RecordCrossing(const G4Track* track, const G4StepPoint* point, G4int plane,
+                      const G4ThreeVector& direction);
+
+  // StackingAction 验证模式：本应被杀掉的径迹及其后代
+  void FlagTrack(G4int trackID) { SetTrackFlag(trackID, kFlagged); }
+  G4bool IsFlagged(G4int trackID) const { return (TrackFlags(trackID) & kFlagged) != 0; }
+  // StackingAction：每个新径迹 (重要性抽样的副本归入其初级粒子)
+  void NoteSecondary(const G4Track* track);
   // 文本输出配置
   static void EnableTextOutput(const G4String& filename);
+
+  const EntryBuffer& GetEntryBuffer() const { return fEntries; }
+  const EntryBuffer& GetCrossingBuffer() const { return fCrossings; }
+
 private:
-  //G4bool fRecorded;      // 是否已记录入射方向
-  //G4double fTheta;       // 入射方向θ（单位：度）
-  //G4double fPhi;         // 入射方向φ（单位：度）
-    // 改用vector存储多个粒子数据
-  std::vector<G4int> fPDGs;
-  std::vector<G4double> fThetas;  // 所有粒子的θ角度(度)
-  std::vector<G4double> fPhis;    // 所有粒子的φ角度(度)
-  std::vector<G4double> fpx; 
-  std::vector<G4double> fpy;
-  std::vector<G4double> fpz;
-  std::vector<G4double> fE;   
+  void ComputeAngles(EntryBuffer& entries);
+  void FlushEntries();
+  // 按径迹号的标记：验证模式下本应被杀掉的径迹，入射时终止 (或本应终止) 的径迹
+  enum TrackFlag : char { kFlagged = 1, kEntryKilled = 2 };
+  char TrackFlags(G4int trackID) const
+  {
+    return trackID < static_cast<G4int>(fTrackFlags.size()) ? fTrackFlags[trackID] : 0;
+  }
+  void SetTrackFlag(G4int trackID, char flag)
+  {
+    if (trackID >= static_cast<G4int>(fTrackFlags.size())) fTrackFlags.resize(trackID + 1, 0);
+    fTrackFlags[trackID] |= flag;
+  }
+  // 径迹号对应的线 (-1：不是初级粒子或其副本)
+  G4int LineOf(G4int trackID) const
+  {
+    return trackID < static_cast<G4int>(fTrackLine.size()) ? fTrackLine[trackID] : -1;
+  }
+
+  RunAction* fRunAction = nullptr;
+  const StackingPolicy* fPolicy = nullptr;
+  G4bool fHasEntryKills = false;
+  // 径迹标记 (径迹号 -> TrackFlag 的组合)，跨事件复用
+  std::vector<char> fTrackFlags;
+  // /stack/killOnEntry：入射时终止的径迹在入射那一步 (验证模式下还有之后各步)
+  // 产生的次级粒子。次级粒子在母径迹结束时才入栈并分配径迹号，因此按指针识别；
+  // 通常只有几个，线性查找
+  std::vector<const G4Track*> fEntryProducts;
+
+  // 线程私有的入射记录缓冲区：跨事件复用，稳态下不分配内存
+  EntryBuffer fEntries;
+  // 初级粒子及其重要性抽样副本 (“线”)：径迹号 -> 线的序号 (-1 不是线)，
+  // 以及每条线所属的初级粒子序号和是否已入射。按序号索引的数组跨事件复用，
+  // 稳态下不分配内存
+  std::vector<G4int> fTrackLine;
+  std::vector<G4int> fLinePrimary;
+  std::vector<char> fLineEntered;
+  // 每个初级粒子到达探测器的权重之和
+  std::vector<G4double> fPrimaryWeight;
+  // 虚拟计分平面的穿过：与入射相同的记录 (带平面序号)，单独的缓冲区，
+  // 入射的统计、直方图和响应矩阵只使用探测器的入射
+  EntryBuffer fCrossings;
+  std::size_t fPlanes = 0;
+  // 每个初级粒子在每个平面上的透射权重和返回权重 [初级粒子 * 平面数 + 平面]
+  std::vector<G4double> fPlaneWeight;
+  std::vector<G4double> fPlaneReturned;
+  // 各线在各平面上的状态 [线 * 平面数 + 平面]：0 未穿过，1 已穿过，2 已返回
+  std::vector<char> fLineCrossed;
+  // 第一个初级粒子的种类和动能 (response 格式按它分箱)
+  G4int fPrimaryPdg = 0;
+  G4double fPrimaryEnergy = 0.;
 
 };
 
@@ -0,0 +1,101 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+//
+/// \file B4/B4a/include/FastStart.hh
+/// \brief Definition of the B4::FastStart class
+
+#ifndef B4FastStart_h
+#define B4FastStart_h 1
+
+#include "G4VStateDependent.hh"
+#include "globals.hh"
+
+#include <chrono>
+#include <cstdint>
+
+class G4VUserPhysicsList;
+
+namespace B4
+{
+
+/// Start-up of batch jobs (exampleB4a -m): physics table cache and timing.
+///
+/// Building the FTFP_BERT tables dominates the start of a short job. With a
+/// cache directory the master keys the tables by the physics list, the
+/// production cuts of all regions, the material table and the Geant4
+/// version; at the start of a run (Idle -> Init) it retrieves them from
+/// "<cache>/physics-<key>" when present, otherwise the tables are built
+/// as usual and stored there once closed (Idle -> GeomClosed). The store
+/// goes to a temporary directory renamed into place, so parallel jobs
+/// (run_batch.sh) never read a half-written cache. Geant4 checks the
+/// retrieved cuts and materials itself and rebuilds on a mismatch.
+///
+/// The same directory holds the validated geometry hashes used by
+/// DetectorConstruction to skip repeated overlap checks.
+///
+/// The time from main() (and, on Linux, from the process start) to the
+/// run manager, /run/initialize, the physics tables and the first event
+/// is printed when the first event starts.
+
+class FastStart : public G4VStateDependent
+{
+  public:
+    FastStart();
+    ~FastStart() override = default;
+
+    // 空: 不缓存物理表
+    void SetCacheDirectory(const G4String& dir) { fCacheDir = dir; }
+    const G4String& GetCacheDirectory() const { return fCacheDir; }
+    // 物理表的键包含物理列表的描述 (名称和注册的附加物理)
+    void SetPhysicsList(G4VUserPhysicsList* physicsList, const G4String& description);
+
+    void MarkRunManager();
+    G4bool Notify(G4ApplicationState requestedState) override;
+
+    // 第一个事件开始时打印启动耗时 (任意线程，只打印一次)
+    static void FirstEvent();
+
+    // 缓存目录中的键值列表 (几何验证)
+    static std::uint64_t Hash(const G4String& text);
+    static G4bool HasKey(const G4String& dir, const G4String& file, std::uint64_t key);
+    static void AddKey(const G4String& dir, const G4String& file, std::uint64_t key);
+
+  private:
+    std::uint64_t PhysicsKey() const;
+    void PreparePhysicsTables();
+    void StorePhysicsTables();
+
+    G4String fCacheDir;
+    G4VUserPhysicsList* fPhysicsList = nullptr;
+    G4String fPhysicsDescription;
+    G4String fPendingStore;  // 本次 run 构建后要保存的缓存目录
+    G4bool fInitialized = false;
+    G4bool fTablesReady = false;
+};
+
+}  // namespace B4
+
+#endif
@@ -0,0 +1,110 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+//
+/// \file B4/B4a/include/FastTarget.hh
+/// \brief Definition of the B4::FastTarget class
+
+#ifndef B4FastTarget_h
+#define B4FastTarget_h 1
+
+#include "TargetExitTable.hh"
+#include "globals.hh"
+
+#include <memory>
+#include <vector>
+
+namespace B4
+{
+
+class DetectorConstruction;
+class FastTargetMessenger;
+
+/// Fast-simulation parameterisation of the target (/fastsim/ commands).
+///
+/// Training: with /fastsim/train <dir> every run is a full simulation that
+/// also records the particles leaving the target (TargetExitTable); the
+/// master writes the merged table to <dir>/<particle>_<E>MeV_<material>_
+/// <length>mm.fastsim and keeps it in the library. /sweep/run with training
+/// on produces the tables of a whole scan.
+///
+/// Fast mode: exampleB4a --fastsim p1,p2 registers the fast-simulation
+/// process for these particles and a TargetFastModel on the Target region.
+/// A primary entering the target is replaced by a sample of the table of
+/// the current configuration (particle, energy within 5%, material,
+/// length); without a matching table it is simulated in full.
+///
+/// /fastsim/validate n runs n events in full and n events fast and
+/// compares the detector-entry observables, the transmission and the
+/// event rate. The library is only modified by the master between runs;
+/// the workers read it during the event loop.
+
+class FastTarget
+{
+  public:
+    static constexpr G4double kEnergyTolerance = 0.05;  // 相对能量差
+
+    FastTarget(DetectorConstruction* det);
+    ~FastTarget();
+
+    // exampleB4a --fastsim 中注册了快速模拟的粒子
+    void SetParticles(const std::vector<G4String>& names) { fParticles = names; }
+    G4bool IsModelRegistered() const { return !fParticles.empty(); }
+
+    void SetEnabled(G4bool flag) { fEnabled = flag; }
+    G4bool IsEnabled() const { return fEnabled; }
+    // 训练表的输出目录，空字符串表示不训练
+    void SetTrainingDirectory(const G4String& dir) { fTrainingDir = dir; }
+    G4bool IsTraining() const { return !fTrainingDir.empty() || fValidating; }
+
+    // 读入一个 .fastsim 文件，或目录中的全部 .fastsim 文件
+    void Load(const G4String& path);
+    void Clear() { fTables.clear(); }
+    void Print() const;
+
+    // master：训练 run 结束时合并后的表
+    void AddTrainingResult(const TargetExitTable& table);
+    // 当前几何下给定初级粒子的表 (没有时为空)，worker 在事件循环中调用
+    const TargetExitTable* Find(const G4String& particle, G4double energy) const;
+
+    void Validate(G4int nofEvents);
+
+  private:
+    void AddTable(const TargetExitTable& table);
+    TargetExitTable* FindKey(const TargetExitTable& key) const;
+
+    DetectorConstruction* fDet = nullptr;
+    FastTargetMessenger* fMessenger = nullptr;
+
+    std::vector<G4String> fParticles;
+    G4bool fEnabled = true;
+    G4String fTrainingDir;
+    G4bool fValidating = false;
+    std::vector<std::unique_ptr<TargetExitTable>> fTables;
+};
+
+}  // namespace B4
+
+#endif
@@ -0,0 +1,40 @@
+#ifndef B4FastTargetMessenger_h
+#define B4FastTargetMessenger_h
+
+#include "G4UImessenger.hh"
+
+class G4UIdirectory;
+class G4UIcommand;
+class G4UIcmdWithAString;
+class G4UIcmdWithABool;
+class G4UIcmdWithAnInteger;
+class G4UIcmdWithoutParameter;
+
+namespace B4 {
+
+class FastTarget;
+
+// define commands to train, load and validate the fast target model
+
+class FastTargetMessenger : public G4UImessenger {
+public:
+  explicit FastTargetMessenger(FastTarget* fastTarget);
+  ~FastTargetMessenger() override;
+
+  void SetNewValue(G4UIcommand* cmd, G4String val) override;
+
+private:
+  FastTarget*               fFastTarget;
+
+  G4UIdirectory*            fFastSimDir;   // /fastsim/
+  G4UIcmdWithABool*         fEnableCmd;    // 打开/关闭快速模型
+  G4UIcmdWithAString*       fTrainCmd;     // 训练表的输出目录
+  G4UIcmdWithAString*       fLoadCmd;      // 读入训练表
+  G4UIcmdWithoutParameter*  fClearCmd;
+  G4UIcmdWithoutParameter*  fPrintCmd;
+  G4UIcmdWithAnInteger*     fValidateCmd;  // 完整模拟与快速模拟的比较
+};
+
+}  // namespace B4
+
+#endif  // B4FastTargetMessenger_h
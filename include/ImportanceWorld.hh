@@ -0,0 +1,96 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+//
+/// \file B4/B4a/include/ImportanceWorld.hh
+/// \brief Definition of the B4::ImportanceWorld class
+
+#ifndef B4ImportanceWorld_h
+#define B4ImportanceWorld_h 1
+
+#include "G4VUserParallelWorld.hh"
+#include "globals.hh"
+
+#include <vector>
+
+class G4VPhysicalVolume;
+
+namespace B4
+{
+
+class DetectorConstruction;
+class ImportanceWorldMessenger;
+
+/// Parallel geometry for importance splitting / Russian roulette through
+/// the target (exampleB4a --importance particles).
+///
+/// The target length is divided into slabs along z, one importance cell
+/// each, followed by one cell from the end of the target to the end of the
+/// detector that keeps the importance of the last slab. The cells cover the
+/// full detector radius, so tracks leaving the target sideways towards the
+/// barrel are not rouletted. Everything else (upstream, outside the
+/// detector) is the world cell with importance 1.
+///
+/// Importances are set with /det/importance/ (explicit values or a
+/// geometric ratio between neighbouring slabs). The G4IStore is thread
+/// local and is filled in ConstructSD(), i.e. on every worker whenever the
+/// geometry is (re)built.
+
+class ImportanceWorld : public G4VUserParallelWorld
+{
+  public:
+    ImportanceWorld(const G4String& worldName, const DetectorConstruction* det);
+    ~ImportanceWorld() override;
+
+    void Construct() override;
+    void ConstructSD() override;
+
+    // 在 Construct() 之前为空 (G4GeometrySampler 之后由物理构造器设置)
+    G4VPhysicalVolume* GetWorldVolume() const { return fGhostWorld; }
+
+    void SetNumberOfSlabs(G4int n) { fNofSlabs = n; }
+    void SetRatio(G4double ratio);
+    void SetImportances(const std::vector<G4double>& values) { fValues = values; }
+    G4int GetNumberOfSlabs() const { return fNofSlabs; }
+
+    // 第 i 个 slab 的重要性 (显式值，否则 ratio^i)
+    G4double GetImportance(G4int slab) const;
+    void Print() const;
+
+  private:
+    const DetectorConstruction* fDet = nullptr;
+    ImportanceWorldMessenger* fMessenger = nullptr;
+
+    G4int fNofSlabs = 10;
+    G4double fRatio = 2.;
+    std::vector<G4double> fValues;
+
+    G4VPhysicalVolume* fGhostWorld = nullptr;
+    std::vector<G4VPhysicalVolume*> fCells;  // slabs, then the downstream cell
+};
+
+}  // namespace B4
+
+#endif
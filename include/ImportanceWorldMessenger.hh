@@ -0,0 +1,38 @@
+#ifndef B4ImportanceWorldMessenger_h
+#define B4ImportanceWorldMessenger_h
+
+#include "G4UImessenger.hh"
+
+class G4UIdirectory;
+class G4UIcommand;
+class G4UIcmdWithAString;
+class G4UIcmdWithADouble;
+class G4UIcmdWithAnInteger;
+class G4UIcmdWithoutParameter;
+
+namespace B4 {
+
+class ImportanceWorld;
+
+// define commands for the importance slabs of the target
+
+class ImportanceWorldMessenger : public G4UImessenger {
+public:
+  explicit ImportanceWorldMessenger(ImportanceWorld* world);
+  ~ImportanceWorldMessenger() override;
+
+  void SetNewValue(G4UIcommand* cmd, G4String val) override;
+
+private:
+  ImportanceWorld*          fWorld;
+
+  G4UIdirectory*            fImportanceDir;  // /det/importance/
+  G4UIcmdWithAnInteger*     fSlabsCmd;       // slab 数
+  G4UIcmdWithADouble*       fRatioCmd;       // 相邻 slab 的重要性之比
+  G4UIcmdWithAString*       fValuesCmd;      // 显式的重要性列表
+  G4UIcmdWithoutParameter*  fPrintCmd;
+};
+
+}  // namespace B4
+
+#endif  // B4ImportanceWorldMessenger_h
@@ -0,0 +1,66 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+//
+/// \file B4/B4a/include/MaterialRegistry.hh
+/// \brief Definition of the B4::MaterialRegistry class
+
+#ifndef B4MaterialRegistry_h
+#define B4MaterialRegistry_h 1
+
+#include "globals.hh"
+
+#include <map>
+
+class G4Material;
+
+namespace B4
+{
+
+/// The materials of the setup, built once.
+///
+/// The constructor defines the custom materials (liquid hydrogen) and the
+/// default world and detector materials; NIST materials are built on first
+/// use. Geometry rebuilds and material scans look the materials up here,
+/// so no G4Material is ever defined twice and the material table (and the
+/// material-cuts couples) stays the same size however often the target
+/// material is switched.
+
+class MaterialRegistry
+{
+  public:
+    MaterialRegistry();
+    ~MaterialRegistry() = default;
+
+    // 自定义材料、已有材料或 NIST 材料；找不到时返回 nullptr
+    G4Material* Find(const G4String& name);
+
+  private:
+    std::map<G4String, G4Material*> fMaterials;
+};
+
+}  // namespace B4
+
+#endif
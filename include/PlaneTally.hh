@@ -0,0 +1,121 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+//
+/// \file B4/B4a/include/PlaneTally.hh
+/// \brief Definition of the B4::PlaneTally class
+
+#ifndef B4PlaneTally_h
+#define B4PlaneTally_h 1
+
+#include "G4VAccumulable.hh"
+#include "globals.hh"
+
+#include <ostream>
+#include <vector>
+
+namespace B4
+{
+
+/// Accumulable of the virtual scoring planes (/det/scoringPlanes).
+///
+/// A plane is a disc of the target radius at its depth; crossings outside
+/// it (particles that left the target through its side) are not counted.
+/// Per plane: the transmission of the primaries, i.e. the weight with
+/// which each primary (or its importance copies) first crosses the plane
+/// forward, and its square; the weight of primaries that come back
+/// through the plane after crossing it; and the forward and backward
+/// crossings of all species. The history of a primary up to its first
+/// forward crossing of a depth does not depend on the material behind it,
+/// so the transmission at each plane is that of a target cut at its
+/// depth. The backward crossings measure the backscatter from the
+/// material downstream, which the plane spectra contain and a thinner
+/// target would not.
+
+class PlaneTally : public G4VAccumulable
+{
+  public:
+    struct Plane
+    {
+      G4double depth = 0.;          // 距靶前表面
+      G4double transmitted = 0.;    // Σ 初级粒子的透射权重
+      G4double transmitted2 = 0.;   // Σ 其平方
+      G4double returned = 0.;       // Σ 穿过后又返回的初级粒子权重
+      G4long forward = 0;           // 所有粒子的向前穿过
+      G4long backward = 0;          // 所有粒子的向后穿过
+      G4double forwardWeight = 0.;
+      G4double backwardWeight = 0.;
+    };
+
+    PlaneTally(const G4String& name) : G4VAccumulable(name) {}
+    ~PlaneTally() override = default;
+
+    // 每个 run 开始时在所有线程上设置 (平面定义在 run 之间可以改变)
+    void SetPlanes(const std::vector<G4double>& depths);
+    std::size_t GetNumberOfPlanes() const { return fPlanes.size(); }
+
+    // 一个初级粒子在平面 plane 上的透射权重和返回权重
+    void AddPrimary(std::size_t plane, G4double transmitted, G4double returned)
+    {
+      Plane& p = fPlanes[plane];
+      p.transmitted += transmitted;
+      p.transmitted2 += transmitted * transmitted;
+      p.returned += returned;
+    }
+    void AddPrimaries(G4long n) { fPrimaries += n; }
+    void AddCrossing(std::size_t plane, G4bool forward, G4double weight)
+    {
+      Plane& p = fPlanes[plane];
+      if (forward) {
+        ++p.forward;
+        p.forwardWeight += weight;
+      }
+      else {
+        ++p.backward;
+        p.backwardWeight += weight;
+      }
+    }
+
+    void Merge(const G4VAccumulable& other) override;
+    void Reset() override;
+
+    const std::vector<Plane>& GetPlanes() const { return fPlanes; }
+    G4long GetPrimaries() const { return fPrimaries; }
+    // 平面上的透射率及其统计误差
+    G4double GetTransmission(std::size_t plane, G4double& error) const;
+
+    // 每个平面一行：深度、透射率、返回比例、穿过数
+    void Print(std::ostream& os) const;
+    // 以 "key.xxx = ..." 行写出全部内容 (分片元数据，tools/b4merge 可精确合并)
+    void Write(std::ostream& os, const G4String& key) const;
+
+  private:
+    std::vector<Plane> fPlanes;
+    G4long fPrimaries = 0;
+};
+
+}  // namespace B4
+
+#endif
@@ -33,6 +33,10 @@
 #include "G4VUserPrimaryGeneratorAction.hh"
 #include "G4ParticleDefinition.hh"
 #include "G4ParticleGun.hh"
+#include "BeamSource.hh"
+#include "SeedService.hh"
+
+#include <vector>
 
 class G4ParticleGun;
 class G4Event;
@@ -46,19 +50,34 @@ namespace B4
   /// perpendicular to the input face. The type of the particle
   /// can be changed via the G4 build-in commands of G4ParticleGun class
   /// (see the macros provided with this example).
+  ///
+  /// Position, direction and energy come from the shared BeamSource:
+  /// pre-sampled in per-thread batches, or read from a beam file. The
+  /// source plane (upstream face of the world) is resolved once per run
+  /// in PrepareRun().
+  ///
+  /// With a mixed beam (/beam/species) the species of each primary is
+  /// sampled with its energy; the gun particle is used otherwise.
+  ///
+  /// With a SeedService every event is reseeded from (run, event) and the
+  /// batches become fixed blocks of event numbers, each sampled from its
+  /// own seed, so an event (and its primary) can be replayed on its own.
 
   class PrimaryGeneratorAction : public G4VUserPrimaryGeneratorAction
   {
   public:
-    PrimaryGeneratorAction();
+    PrimaryGeneratorAction(const BeamSource* beam = nullptr, const SeedService* seeds = nullptr);
     ~PrimaryGeneratorAction() override;
 
     void GeneratePrimaries(G4Event* event) override;
+    // 每个 run 开始时由 RunAction 调用：确定源平面，清空批次
+    void PrepareRun();
 
     void SetParticle(const G4String &name);
     void SetEnergy(G4double energy);
 
     G4ParticleGun* GetParticleGun() const { return fParticleGun; }
+    const BeamSource* GetBeamSource() const { return fBeam; }
 
     G4ParticleDefinition* GetParticleDefinition() const{
       return fParticleGun->GetParticleDefinition();
@@ -70,7 +89,15 @@ namespace B4
   private:
     G4ParticleGun* fParticleGun;  // G4 particle gun
     G4double fBeamRate; // 束流率(粒子/秒)
-    G4double fBeamRadius;  // 束斑半径
+    const BeamSource* fBeam = nullptr;
+    BeamBatch fBatch;             // 本线程预先抽样的初级粒子
+    G4double fSourceZ = 0.;       // 源平面 z (世界上游端面)
+    G4double fNominalEnergy = 0.; // 本 run 的 /gun/energy
+    std::vector<G4ParticleDefinition*> fSpecies;  // 本 run 的 /beam/species
+    const SeedService* fSeeds = nullptr;
+    G4int fRunID = 0;
+    G4long fEventsInRun = 0;
+    G4long fBatchBlock = -1;      // 当前批次对应的事件块 (逐事件播种时)
 };
 
 }  // namespace B4
@@ -0,0 +1,338 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+//
+/// \file B4/B4a/include/ResponseFormat.hh
+/// \brief On-disk layout of a B4 transmission response matrix
+///
+/// A response matrix answers "what enters the detector per incident
+/// primary" for a grid of primary energies, so that any beam spectrum can
+/// be folded offline (tools/b4fold.cc) instead of being simulated:
+///
+///   [FileHeader, 128 bytes]
+///   [PrimaryBin x nPrimarySpecies*nPrimaryBins]   primaries, transmission
+///   [BlockKey x nBlocks]                          (primary, entry) species
+///   [mean     x nBlocks*nPrimaryBins*nEnergyBins*nThetaBins]
+///   [variance x nBlocks*nPrimaryBins*nEnergyBins*nThetaBins]
+///   [total variance  x nBlocks*nPrimaryBins]
+///   [E variance      x nBlocks*nPrimaryBins*nEnergyBins]
+///   [theta variance  x nBlocks*nPrimaryBins*nThetaBins]
+///
+/// Primary bins are logarithmic in kinetic energy; a block holds, for one
+/// primary species and one entry species, the mean weighted number of
+/// entries per primary in (log10 E_entry, theta) cells and the variance of
+/// that mean. The entries of one event are correlated, so the variances
+/// are computed from per-event sums, (S2 - S1^2/N) / N^2, and the variance
+/// of a sum of cells is not the sum of the cell variances: the variance of
+/// the block total and of its E and theta projections are stored as well.
+/// Native byte order; the header only depends on the standard library, so
+/// the folding tool does not need Geant4.
+
+#ifndef B4ResponseFormat_h
+#define B4ResponseFormat_h 1
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <string>
+#include <vector>
+
+namespace B4
+{
+namespace Response
+{
+
+constexpr char kMagic[8] = {'B', '4', 'R', 'E', 'S', 'P', 0, 0};
+constexpr std::uint32_t kVersion = 2;
+
+// 入射粒子的 (能量, 角度) 网格，与 EntrySummary 的能量范围相同
+constexpr std::uint32_t kEnergyBins = 48;  // log10(E/MeV) in [-3, 5)
+constexpr double kLogEMin = -3.;
+constexpr double kLogEMax = 5.;
+constexpr std::uint32_t kThetaBins = 36;   // theta in [0, 180) deg
+constexpr double kThetaMax = 180.;
+
+struct FileHeader
+{
+  char magic[8];
+  std::uint32_t version;
+  std::uint32_t nPrimarySpecies;
+  std::uint32_t nPrimaryBins;
+  std::uint32_t nBlocks;
+  std::uint32_t nEnergyBins;
+  std::uint32_t nThetaBins;
+  double primaryEmin;     // MeV, lower edge of the first primary bin
+  double primaryEmax;     // MeV, upper edge of the last primary bin
+  double logEMin, logEMax;
+  double thetaMax;        // deg
+  double targetLength;    // mm
+  double targetRadius;    // mm
+  std::uint64_t outOfRange;  // primaries outside the grid (not scored)
+  char material[32];      // zero terminated target material name
+};
+
+static_assert(sizeof(FileHeader) == 128, "response header must be 128 bytes");
+
+struct PrimaryBin
+{
+  std::int32_t pdg;
+  std::int32_t bin;
+  double primaries;     // number of primaries simulated in the bin
+  double transmitted;   // sum of the transmitted weight per primary
+  double transmitted2;  // sum of its square
+};
+
+static_assert(sizeof(PrimaryBin) == 32, "primary bin record must be 32 bytes");
+
+struct BlockKey
+{
+  std::int32_t primaryPdg;
+  std::int32_t entryPdg;
+};
+
+/// A whole matrix in memory
+
+struct Matrix
+{
+  FileHeader header;
+  std::vector<PrimaryBin> bins;  // species-major, sorted by pdg
+  std::vector<BlockKey> blocks;
+  std::vector<double> mean;
+  std::vector<double> variance;
+  std::vector<double> totalVariance;   // [block][primary bin]
+  std::vector<double> energyVariance;  // [block][primary bin][E bin]
+  std::vector<double> thetaVariance;   // [block][primary bin][theta bin]
+
+  std::size_t Cells() const { return std::size_t(header.nEnergyBins) * header.nThetaBins; }
+  // 块 block、初级能量区间 bin 的 (E, theta) 二维分布的起点
+  std::size_t Offset(std::size_t block, std::size_t bin) const
+  {
+    return (block * header.nPrimaryBins + bin) * Cells();
+  }
+  // 块 block、初级能量区间 bin 的总数和投影的位置
+  std::size_t TotalOffset(std::size_t block, std::size_t bin) const
+  {
+    return block * header.nPrimaryBins + bin;
+  }
+  std::size_t EnergyOffset(std::size_t block, std::size_t bin) const
+  {
+    return TotalOffset(block, bin) * header.nEnergyBins;
+  }
+  std::size_t ThetaOffset(std::size_t block, std::size_t bin) const
+  {
+    return TotalOffset(block, bin) * header.nThetaBins;
+  }
+  double PrimaryEdge(std::size_t i) const
+  {
+    return header.primaryEmin
+           * std::pow(header.primaryEmax / header.primaryEmin, double(i) / header.nPrimaryBins);
+  }
+  // 初级粒子种类 pdg 的第一个 PrimaryBin，不存在时为 nullptr
+  const PrimaryBin* FindPrimary(std::int32_t pdg) const
+  {
+    for (std::size_t i = 0; i < bins.size(); i += header.nPrimaryBins) {
+      if (bins[i].pdg == pdg) return &bins[i];
+    }
+    return nullptr;
+  }
+};
+
+inline FileHeader MakeHeader(double emin, double emax, std::uint32_t nbins)
+{
+  FileHeader header;
+  std::memset(&header, 0, sizeof(header));
+  std::memcpy(header.magic, kMagic, sizeof(kMagic));
+  header.version = kVersion;
+  header.nPrimaryBins = nbins;
+  header.nEnergyBins = kEnergyBins;
+  header.nThetaBins = kThetaBins;
+  header.primaryEmin = emin;
+  header.primaryEmax = emax;
+  header.logEMin = kLogEMin;
+  header.logEMax = kLogEMax;
+  header.thetaMax = kThetaMax;
+  return header;
+}
+
+inline bool IsValid(const FileHeader& header)
+{
+  return std::memcmp(header.magic, kMagic, sizeof(kMagic)) == 0
+      && header.version == kVersion
+      && header.nPrimaryBins > 0 && header.nEnergyBins > 0 && header.nThetaBins > 0
+      && header.primaryEmin > 0. && header.primaryEmax > header.primaryEmin;
+}
+
+inline bool Write(const std::string& path, const Matrix& m)
+{
+  std::ofstream out(path, std::ios::binary | std::ios::trunc);
+  FileHeader header = m.header;
+  header.nPrimarySpecies = static_cast<std::uint32_t>(m.bins.size() / header.nPrimaryBins);
+  header.nBlocks = static_cast<std::uint32_t>(m.blocks.size());
+  out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+  out.write(reinterpret_cast<const char*>(m.bins.data()), m.bins.size() * sizeof(PrimaryBin));
+  out.write(reinterpret_cast<const char*>(m.blocks.data()), m.blocks.size() * sizeof(BlockKey));
+  out.write(reinterpret_cast<const char*>(m.mean.data()), m.mean.size() * sizeof(double));
+  out.write(reinterpret_cast<const char*>(m.variance.data()), m.variance.size() * sizeof(double));
+  out.write(reinterpret_cast<const char*>(m.totalVariance.data()),
+            m.totalVariance.size() * sizeof(double));
+  out.write(reinterpret_cast<const char*>(m.energyVariance.data()),
+            m.energyVariance.size() * sizeof(double));
+  out.write(reinterpret_cast<const char*>(m.thetaVariance.data()),
+            m.thetaVariance.size() * sizeof(double));
+  return static_cast<bool>(out);
+}
+
+inline bool Read(const std::string& path, Matrix& m)
+{
+  std::ifstream in(path, std::ios::binary);
+  if (!in.read(reinterpret_cast<char*>(&m.header), sizeof(m.header)) || !IsValid(m.header)) {
+    return false;
+  }
+  m.bins.resize(std::size_t(m.header.nPrimarySpecies) * m.header.nPrimaryBins);
+  m.blocks.resize(m.header.nBlocks);
+  m.mean.resize(m.blocks.size() * m.header.nPrimaryBins * m.Cells());
+  m.variance.resize(m.mean.size());
+  m.totalVariance.resize(m.blocks.size() * m.header.nPrimaryBins);
+  m.energyVariance.resize(m.totalVariance.size() * m.header.nEnergyBins);
+  m.thetaVariance.resize(m.totalVariance.size() * m.header.nThetaBins);
+  in.read(reinterpret_cast<char*>(m.bins.data()), m.bins.size() * sizeof(PrimaryBin));
+  in.read(reinterpret_cast<char*>(m.blocks.data()), m.blocks.size() * sizeof(BlockKey));
+  in.read(reinterpret_cast<char*>(m.mean.data()), m.mean.size() * sizeof(double));
+  in.read(reinterpret_cast<char*>(m.variance.data()), m.variance.size() * sizeof(double));
+  in.read(reinterpret_cast<char*>(m.totalVariance.data()),
+          m.totalVariance.size() * sizeof(double));
+  in.read(reinterpret_cast<char*>(m.energyVariance.data()),
+          m.energyVariance.size() * sizeof(double));
+  in.read(reinterpret_cast<char*>(m.thetaVariance.data()),
+          m.thetaVariance.size() * sizeof(double));
+  return static_cast<bool>(in);
+}
+
+/// Adds the statistics of b to a (same grid, e.g. two shards): the means
+/// are re-weighted with the number of primaries per bin, the variances of
+/// the independent samples with its square.
+inline bool Merge(Matrix& a, const Matrix& b)
+{
+  const auto& ha = a.header;
+  const auto& hb = b.header;
+  if (ha.nPrimaryBins != hb.nPrimaryBins || ha.nEnergyBins != hb.nEnergyBins
+      || ha.nThetaBins != hb.nThetaBins || ha.primaryEmin != hb.primaryEmin
+      || ha.primaryEmax != hb.primaryEmax) {
+    return false;
+  }
+  const std::size_t nbins = ha.nPrimaryBins;
+  const std::size_t cells = a.Cells();
+
+  // 初级粒子数 (合并前的)，按 pdg 查找
+  auto primaries = [](const Matrix& m, std::int32_t pdg, std::size_t bin) {
+    const PrimaryBin* first = m.FindPrimary(pdg);
+    return first ? first[bin].primaries : 0.;
+  };
+  auto findBlock = [](const Matrix& m, const BlockKey& key) -> std::ptrdiff_t {
+    for (std::size_t i = 0; i < m.blocks.size(); ++i) {
+      if (m.blocks[i].primaryPdg == key.primaryPdg && m.blocks[i].entryPdg == key.entryPdg) {
+        return static_cast<std::ptrdiff_t>(i);
+      }
+    }
+    return -1;
+  };
+
+  const Matrix& ca = a;
+  Matrix c;
+  c.header = ha;
+  c.header.outOfRange = ha.outOfRange + hb.outOfRange;
+  // 两边出现过的全部初级粒子和块
+  std::vector<std::int32_t> pdgs;
+  for (const Matrix* m : {&ca, &b}) {
+    for (std::size_t i = 0; i < m->bins.size(); i += nbins) pdgs.push_back(m->bins[i].pdg);
+  }
+  std::sort(pdgs.begin(), pdgs.end());
+  pdgs.erase(std::unique(pdgs.begin(), pdgs.end()), pdgs.end());
+  for (std::int32_t pdg : pdgs) {
+    const PrimaryBin* pa = a.FindPrimary(pdg);
+    const PrimaryBin* pb = b.FindPrimary(pdg);
+    for (std::size_t i = 0; i < nbins; ++i) {
+      PrimaryBin bin{pdg, static_cast<std::int32_t>(i), 0., 0., 0.};
+      for (const PrimaryBin* p : {pa, pb}) {
+        if (!p) continue;
+        bin.primaries += p[i].primaries;
+        bin.transmitted += p[i].transmitted;
+        bin.transmitted2 += p[i].transmitted2;
+      }
+      c.bins.push_back(bin);
+    }
+  }
+  c.blocks = a.blocks;
+  for (const auto& key : b.blocks) {
+    if (findBlock(c, key) < 0) c.blocks.push_back(key);
+  }
+  std::sort(c.blocks.begin(), c.blocks.end(), [](const BlockKey& x, const BlockKey& y) {
+    return x.primaryPdg != y.primaryPdg ? x.primaryPdg < y.primaryPdg : x.entryPdg < y.entryPdg;
+  });
+
+  c.mean.assign(c.blocks.size() * nbins * cells, 0.);
+  c.variance.assign(c.mean.size(), 0.);
+  c.totalVariance.assign(c.blocks.size() * nbins, 0.);
+  c.energyVariance.assign(c.totalVariance.size() * ha.nEnergyBins, 0.);
+  c.thetaVariance.assign(c.totalVariance.size() * ha.nThetaBins, 0.);
+  for (std::size_t k = 0; k < c.blocks.size(); ++k) {
+    const BlockKey& key = c.blocks[k];
+    for (std::size_t i = 0; i < nbins; ++i) {
+      // 按初级粒子数加权：均值乘 n / N，均值的方差乘 (n / N)^2
+      double total = primaries(a, key.primaryPdg, i) + primaries(b, key.primaryPdg, i);
+      if (total <= 0.) continue;
+      double* mean = &c.mean[c.Offset(k, i)];
+      double* variance = &c.variance[c.Offset(k, i)];
+      double* energyVariance = &c.energyVariance[c.EnergyOffset(k, i)];
+      double* thetaVariance = &c.thetaVariance[c.ThetaOffset(k, i)];
+      for (const Matrix* m : {&ca, &b}) {
+        std::ptrdiff_t block = findBlock(*m, key);
+        double n = primaries(*m, key.primaryPdg, i);
+        if (block < 0 || n <= 0.) continue;
+        const double f = n / total;
+        const double* mm = &m->mean[m->Offset(block, i)];
+        const double* mv = &m->variance[m->Offset(block, i)];
+        for (std::size_t j = 0; j < cells; ++j) {
+          mean[j] += mm[j] * f;
+          variance[j] += mv[j] * f * f;
+        }
+        c.totalVariance[c.TotalOffset(k, i)] += m->totalVariance[m->TotalOffset(block, i)] * f * f;
+        const double* ev = &m->energyVariance[m->EnergyOffset(block, i)];
+        for (std::size_t e = 0; e < ha.nEnergyBins; ++e) energyVariance[e] += ev[e] * f * f;
+        const double* tv = &m->thetaVariance[m->ThetaOffset(block, i)];
+        for (std::size_t t = 0; t < ha.nThetaBins; ++t) thetaVariance[t] += tv[t] * f * f;
+      }
+    }
+  }
+  a = std::move(c);
+  return true;
+}
+
+}  // namespace Response
+}  // namespace B4
+
+#endif
@@ -0,0 +1,128 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+//
+/// \file B4/B4a/include/ResponseMatrix.hh
+/// \brief Definition of the B4::ResponseMatrix class
+
+#ifndef B4ResponseMatrix_h
+#define B4ResponseMatrix_h 1
+
+#include "G4VAccumulable.hh"
+#include "globals.hh"
+
+#include <vector>
+
+namespace B4
+{
+
+class EntryBuffer;
+
+/// Transmission response matrix, for the "response" output format.
+///
+/// The primaries are binned logarithmically in kinetic energy (per primary
+/// species). For every primary bin the number of primaries and the
+/// transmitted weight are counted, and the detector entries of its events
+/// are binned in (log10 E, theta) per entry species. The entries of one
+/// event are correlated, so the second moments are sums over events of the
+/// squared per-event sums: per cell, per entry species (all cells) and per
+/// E and theta projection. One block (primary species, entry species) is
+/// allocated on first use.
+/// Write() normalises per primary and stores the matrix in the layout of
+/// ResponseFormat.hh; tools/b4fold folds beam spectra through it.
+
+class ResponseMatrix : public G4VAccumulable
+{
+  public:
+    ResponseMatrix(const G4String& name);
+    ~ResponseMatrix() override = default;
+
+    // 初级粒子能量网格 (对数)，同时清空已有内容
+    void SetGrid(G4double emin, G4double emax, G4int nbins);
+    G4double GetEmin() const { return fEmin; }
+    G4double GetEmax() const { return fEmax; }
+    G4int GetBins() const { return fBins; }
+
+    // 一个初级粒子 (一个事件)：种类、动能、透射权重及其全部入射
+    void Fill(G4int primaryPdg, G4double primaryEnergy, G4double transmitted,
+              const EntryBuffer& entries);
+
+    void Merge(const G4VAccumulable& other) override;
+    void Reset() override;
+
+    G4double GetPrimaries() const;
+    G4long GetOutOfRange() const { return fOutOfRange; }
+    std::size_t GetBlockCount() const { return fBlocks.size(); }
+
+    // 按初级粒子归一后写出 (ResponseFormat.hh)，失败时返回 false
+    G4bool Write(const G4String& path, const G4String& material, G4double length,
+                 G4double radius) const;
+
+  private:
+    struct Primary
+    {
+      G4int pdg = 0;
+      std::vector<G4double> primaries;     // per primary bin
+      std::vector<G4double> transmitted;
+      std::vector<G4double> transmitted2;
+    };
+    struct Block
+    {
+      G4int primaryPdg = 0;
+      G4int entryPdg = 0;
+      std::vector<G4double> sumW;      // [primary bin][E bin][theta bin]
+      std::vector<G4double> sumW2;     // 每个事件在单元内的权重和的平方之和
+      std::vector<G4double> sumT2;     // [primary bin]：每个事件的总权重
+      std::vector<G4double> sumE2;     // [primary bin][E bin]：每个事件的 E 投影
+      std::vector<G4double> sumTheta2; // [primary bin][theta bin]：theta 投影
+    };
+    // 一个事件中的一个入射 (块序号, 初级能量区间内的单元, 权重)
+    struct Deposit
+    {
+      std::size_t block;
+      std::size_t cell;
+      G4double weight;
+    };
+
+    G4int PrimaryBin(G4double energy) const;  // 网格之外为 -1
+    Primary& FindPrimary(G4int pdg);
+    Block& FindBlock(G4int primaryPdg, G4int entryPdg);
+
+    G4double fEmin;
+    G4double fEmax;
+    G4int fBins;
+    std::vector<Primary> fPrimaries;
+    std::vector<Block> fBlocks;
+    std::size_t fLastBlock = 0;  // 上一次命中的块
+    G4long fOutOfRange = 0;
+    // Fill 的工作区，跨事件复用
+    std::vector<Deposit> fEvent;
+    std::vector<G4double> fEventE;
+    std::vector<G4double> fEventTheta;
+};
+
+}  // namespace B4
+
+#endif
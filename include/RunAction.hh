@@ -35,14 +35,32 @@
 #include "G4Accumulable.hh"
 #include "G4AccumulableManager.hh"
 #include "G4AnalysisManager.hh"
+#include "G4Timer.hh"
+#include "SpeciesTally.hh"
+#include "EntryObservables.hh"
+#include "EntrySummary.hh"
+#include "StackingPolicy.hh"
+#include "RunProfile.hh"
+#include "EntryHistograms.hh"
+#include "TargetExitTable.hh"
+#include "ResponseMatrix.hh"
+#include "PlaneTally.hh"
+
+#include <cstdint>
+#include <memory>
 
 
 namespace B4
 {
 
 class PrimaryGeneratorAction;
+class BeamSource;
 class DetectorConstruction;
 class RunActionMessenger;
+class ColumnarWriter;
+class EntryBuffer;
+class SeedService;
+class SteppingAction;
 
 /// Run action class
 ///
@@ -52,12 +70,35 @@ class RunActionMessenger;
 ///
 /// In EndOfRunAction(),the shield information, particle information is printed.
 /// And analysis is saved in the ROOT file.
+///
+/// In shard mode (exampleB4a --shard k/N) the output name carries the shard
+/// instead of a timestamp, and the master writes "<output>.shard" next to
+/// it: configuration hash, seed, event range and all accumulables, which
+/// tools/b4merge uses to combine the shards exactly. The same metadata is
+/// written for every chunk of a checkpointed run (see Checkpoint).
+///
+/// With /run/output/format summary no per-entry rows are written: the
+/// per-species moments (EntrySummary) and the transmitted/blocked primaries
+/// are accumulated per thread, merged, printed and written by the master
+/// to "<output>.summary".
+///
+/// With /run/output/format response the entries of every primary are
+/// binned by primary species and energy (ResponseMatrix) and the master
+/// writes the normalised response matrix to "<output>.resp"; beam spectra
+/// are then folded offline with tools/b4fold.
 
 class RunAction : public G4UserRunAction
 {
   public:
-    RunAction(bool isMaster, PrimaryGeneratorAction* genAction, DetectorConstruction* det);
-    ~RunAction() override = default;
+    /// Output of the detector entries: ROOT ntuple (G4AnalysisManager) or
+    /// per-thread fixed-width column files (see ColumnarFormat.hh), or
+    /// only the merged per-species summary, or the response matrix per
+    /// primary species and energy bin
+    enum class OutputFormat { Root, Columnar, Summary, Response };
+
+    RunAction(bool isMaster, PrimaryGeneratorAction* genAction, DetectorConstruction* det,
+              const SeedService* seeds = nullptr);
+    ~RunAction() override;
 
     void BeginOfRunAction(const G4Run* ) override;
     void EndOfRunAction(const G4Run* ) override;
@@ -66,25 +107,136 @@ class RunAction : public G4UserRunAction
     void SetEnableOutput(bool flag) { fEnableOutput = flag; }
     void SetFileName(G4String& name) { fFileName = name; }
     void SetDirectory(G4String& dir) { fDirectory = dir; }
+    // 输出名用 run 号代替时间戳 (/run/beamUntil 的各 chunk，master 上设置)
+    void SetRunTagging(G4bool flag) { fRunTagging = flag; }
+    // 输出名中代替 run 号的标记 (检查点的 chunk 用第一个事件键，跨进程唯一)
+    void SetOutputTag(const G4String& tag) { fOutputTag = tag; }
+    // 不分片时也写 "<output>.shard" (检查点的 chunk 元数据)
+    void SetWriteShardInfo(G4bool flag) { fWriteShardInfo = flag; }
+    // 本 run 的分片元数据文件名 (master 在 EndOfRunAction 之后有效)
+    G4String GetShardInfoPath() const;
+    // 配置的指纹 (影响结果的全部命令，以及几何、初级粒子和物理列表的散列)
+    static std::uint64_t ConfigHash();
+
+    void SetOutputFormat(OutputFormat format) { fOutputFormat = format; }
+    // 性能剖析报告 (JSON) 的文件名，空字符串表示不写
+    void SetProfileFile(const G4String& name) { fProfileFile = name; }
 
     bool IsOutputEnabled() const { return fEnableOutput; }
+    // 束流描述 (master 上由 /beam/ 命令配置)，没有时为 nullptr
+    const BeamSource* GetBeamSource() const;
+    OutputFormat GetOutputFormat() const { return fOutputFormat; }
+    // 当前 run 的列式输出 (仅 worker，且 format 为 columnar 时非空)
+    ColumnarWriter* GetColumnarWriter() const { return fColumnar.get(); }
+    // 本线程的入射直方图 (输出关闭时为空)
+    EntryHistograms* GetHistograms() const { return fHistograms.get(); }
 
     // define counters
     void AddPassedParticles(G4int n) {fPassed += n;}
     void AddBlockedParticles(G4int n) { fBlocked += n; }
+    // 一个初级粒子到达探测器的权重 (重要性抽样下透射率的无偏估计)
+    void AddTransmission(G4double weight)
+    {
+      fTransmitted += weight;
+      fTransmitted2 += weight * weight;
+    }
+    void AddSteps(G4int n) { fSteps += n; }
+    void AddEventEntries(const EntryBuffer& entries) { fObservables.Fill(entries); }
+    // summary 格式：按粒子的流式统计
+    void AddSummaryEntries(const EntryBuffer& entries) { fSummary.Fill(entries); }
+    // summary 格式：一个初级粒子及其透射权重 (混合束流时按初级粒子分组)
+    void AddSummaryPrimary(G4int pdg, G4double energy, G4double transmitted)
+    {
+      fSummary.AddPrimary(pdg, energy, transmitted);
+    }
+    // response 格式：一个初级粒子的全部入射，按初级粒子种类和能量分箱
+    void AddResponseEvent(G4int primaryPdg, G4double primaryEnergy, G4double transmitted,
+                          const EntryBuffer& entries)
+    {
+      fResponse.Fill(primaryPdg, primaryEnergy, transmitted, entries);
+    }
+    // 响应矩阵的初级粒子能量网格 (对数)
+    void SetResponseGrid(G4double emin, G4double emax, G4int nbins)
+    {
+      fResponse.SetGrid(emin, emax, nbins);
+    }
+
+    // StackingAction 杀掉 (或验证模式下本应杀掉) 的径迹
+    void AddStackKill(G4int pdg, G4double energy, StackingPolicy::KillReason reason);
+    // 验证模式：被标记径迹的入射，即启用杀除后会丢失的入射
+    void AddValidationLoss(G4int pdg, G4double energy) { fValidationLost.Add(pdg, energy); }
+    // /stack/killOnEntry 在入射后终止 (或验证模式下标记) 的径迹及其入射动能，
+    // 包括入射那一步产生的次级粒子 (及其产生时的动能)
+    void AddEntryKill(G4int pdg, G4double energy) { fEntryKilled.Add(pdg, energy); }
+
+    // 合并后的结果 (master 在 EndOfRunAction 之后有效)
+    const EntryObservables& GetEntryObservables() const { return fObservables; }
+    G4long GetSteps() const { return fSteps.GetValue(); }
+    G4int GetPassed() const { return fPassed.GetValue(); }
+    G4int GetBlocked() const { return fBlocked.GetValue(); }
+    G4double GetTransmitted() const { return fTransmitted.GetValue(); }
+    G4double GetTransmitted2() const { return fTransmitted2.GetValue(); }
+    // 透射率及其统计误差 (合并后)
+    G4double GetTransmission(G4double& error) const;
+
+    // worker：本线程的 SteppingAction，run 开始时确定它的逐步工作
+    void SetSteppingAction(SteppingAction* action) { fSteppingAction = action; }
+
+    // 本线程的性能剖析计数 (仅在 B4_PROFILING 打开时被填充)
+    RunProfile& GetProfile() { return fProfile; }
+    // 快速模拟训练：本线程记录的穿出靶的粒子 (/fastsim/train)
+    TargetExitTable& GetTargetExits() { return fTargetExits; }
+    // 虚拟计分平面 (/det/scoringPlanes)：本线程的透射和穿过统计
+    PlaneTally& GetPlaneTally() { return fPlaneTally; }
 
   private:
+    G4String BuildOutputName() const;
+    void WriteColumnarRunInfo(const G4Run* run) const;
+    void WriteShardInfo(const G4Run* run) const;
+    void WriteSummary(const G4Run* run) const;
+    void WriteResponse(const G4Run* run) const;
+    void PrintStackingSummary() const;
+    void WriteProfile(const G4Run* run) const;
+
     const  bool fIsMaster;
     PrimaryGeneratorAction* fGenAction;
     DetectorConstruction* fDet;
+    const SeedService* fSeeds;
+    SteppingAction* fSteppingAction = nullptr;
     G4Accumulable<G4int> fPassed;
     G4Accumulable<G4int> fBlocked;
+    G4Accumulable<G4double> fTransmitted;   // sum of transmitted weight per primary
+    G4Accumulable<G4double> fTransmitted2;  // sum of its square
+    G4Accumulable<G4long> fSteps;
+    EntryObservables fObservables;
+    EntrySummary fSummary;
+    SpeciesTally fStackKilled;
+    SpeciesTally fValidationLost;
+    SpeciesTally fEntryKilled;
+    G4Accumulable<G4long> fKilledByEnergy;
+    G4Accumulable<G4long> fKilledByTime;
+    G4Accumulable<G4long> fKilledByGeometry;
+    TargetExitTable fTargetExits;
+    ResponseMatrix fResponse;
+    PlaneTally fPlaneTally;
+    RunProfile fProfile;
+    G4Timer fTimer;  // master: wall time of the event loop
     G4AnalysisManager* fAnalysisManager;
     RunActionMessenger* fRunMessenger;
 
     bool fEnableOutput;
+    G4bool fRunTagging = false;
+    G4String fOutputTag;
+    G4bool fWriteShardInfo = false;
     G4String fFileName;
     G4String fDirectory;
+    OutputFormat fOutputFormat = OutputFormat::Root;
+    std::unique_ptr<ColumnarWriter> fColumnar;
+    std::unique_ptr<EntryHistograms> fHistograms;
+    G4String fProfileFile = "b4profile.json";
+
+    // 本次 run 的输出名，由 master 确定后供所有 worker 使用
+    static G4String fgOutputName;
 
     G4String fMaterial;
     G4String fPtype;
@@ -26,6 +26,9 @@ private:
   G4UIcmdWithABool*       fCmdEnable;      // enable/disable ROOT 输出
   G4UIcmdWithAString*     fCmdFileName;    // 自定义文件名
   G4UIcmdWithAString*     fCmdDirectory;   // 自定义输出目录
+  G4UIcmdWithAString*     fCmdFormat;      // 输出格式 root/columnar
+  G4UIcmdWithAString*     fCmdProfile;     // 性能剖析报告文件名
+  G4UIcommand*            fCmdResponseGrid; // 响应矩阵的初级能量网格
 };
 
 } // namespace B4
@@ -0,0 +1,147 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+//
+/// \file B4/B4a/include/RunProfile.hh
+/// \brief Definition of the B4::RunProfile class
+
+#ifndef B4RunProfile_h
+#define B4RunProfile_h 1
+
+#include "G4VAccumulable.hh"
+#include "globals.hh"
+
+#include <chrono>
+#include <map>
+#include <ostream>
+#include <utility>
+#include <vector>
+
+class G4LogicalVolume;
+class G4Track;
+
+namespace B4
+{
+
+/// Compile-time switch of the profiler (CMake option B4_PROFILING).
+/// When it is off the hooks in the user actions are discarded by the
+/// compiler (if constexpr) and nothing is counted or timed.
+#ifdef B4_PROFILING
+constexpr G4bool kProfilingEnabled = true;
+#else
+constexpr G4bool kProfilingEnabled = false;
+#endif
+
+/// Where the simulation time goes: steps per logical volume, tracks,
+/// steps and tracking time per particle species, wall time per event,
+/// and the load of every worker thread.
+///
+/// Each worker fills its own instance (owned by its RunAction) through
+/// cheap hooks: one pointer comparison per step, two clock reads per
+/// track and per event. The fast per-thread caches are folded into the
+/// mergeable maps in EndRun(), before the accumulables are merged into
+/// the master, which writes the report (WriteJson).
+///
+/// Per thread it also records when the thread finished its last event,
+/// so the master can report the idle time of each thread and the tail of
+/// the run (first to last thread done): the cost of a static event
+/// distribution when event times are skewed.
+
+class RunProfile : public G4VAccumulable
+{
+  public:
+    struct SpeciesStats
+    {
+      G4long tracks = 0;
+      G4long steps = 0;
+      G4double time = 0.;  // s, tracking time excluding secondaries
+    };
+
+    struct ThreadStats
+    {
+      G4long events = 0;
+      G4long steps = 0;
+      G4double eventTime = 0.;  // s, sum of event wall times
+      G4double runTime = 0.;    // s, BeginOfRun to EndOfRun
+      G4double finished = 0.;   // s, steady clock at the end of the last event
+    };
+
+    using Clock = std::chrono::steady_clock;
+
+    RunProfile(const G4String& name) : G4VAccumulable(name) {}
+    ~RunProfile() override = default;
+
+    // worker 线程的钩子 (BeginRun 也在 master 上调用)
+    void BeginRun();
+    void EndRun(G4int threadID);
+    // master (或串行模式)：事件循环结束，确定墙钟时间
+    void MarkRunEnd();
+    void BeginEvent() { fEventStart = Clock::now(); }
+    void EndEvent(G4int eventID);
+    void BeginTrack() { fTrackStart = Clock::now(); }
+    void EndTrack(const G4Track* track);
+    void AddStep(const G4LogicalVolume* volume)
+    {
+      // 连续的步大多在同一个体积内：只比较一次指针
+      if (volume != fLastVolume) SelectVolume(volume);
+      ++fVolumeCache[fLastSlot].second;
+    }
+
+    void Merge(const G4VAccumulable& other) override;
+    void Reset() override;
+
+    G4long GetEvents() const { return fEvents; }
+    void Print(std::ostream& os) const;
+    void WriteJson(std::ostream& os, G4int runID) const;
+
+  private:
+    void SelectVolume(const G4LogicalVolume* volume);
+    // 全部线程的空闲时间之和，以及最早与最晚完成的线程之差
+    std::pair<G4double, G4double> IdleAndTail() const;
+
+    // 合并的结果
+    std::map<G4String, G4long> fVolumeSteps;
+    std::map<G4int, SpeciesStats> fSpecies;
+    std::map<G4int, ThreadStats> fThreads;
+    G4long fEvents = 0;
+    G4double fEventTime = 0.;   // s
+    G4double fEventTime2 = 0.;  // s^2
+    G4double fMaxEventTime = 0.;
+    G4int fSlowestEvent = -1;
+    G4double fWall = 0.;  // s, master 的 run 时间 (MarkRunEnd)
+
+    // 线程私有的快速路径
+    std::vector<std::pair<const G4LogicalVolume*, G4long>> fVolumeCache;
+    const G4LogicalVolume* fLastVolume = nullptr;
+    std::size_t fLastSlot = 0;
+    Clock::time_point fRunStart;
+    Clock::time_point fEventStart;
+    Clock::time_point fLastEventEnd;
+    Clock::time_point fTrackStart;
+};
+
+}  // namespace B4
+
+#endif
@@ -0,0 +1,137 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+//
+/// \file B4/B4a/include/SeedService.hh
+/// \brief Definition of the B4::SeedService class
+
+#ifndef B4SeedService_h
+#define B4SeedService_h 1
+
+#include "globals.hh"
+
+#include <cstdint>
+
+namespace B4
+{
+
+class SeedServiceMessenger;
+
+/// Deterministic seeding of the random engines.
+///
+/// One 64-bit master seed (exampleB4a -s, or /seed/master) determines
+/// everything: the engine of every thread is reseeded at the start of each
+/// event from a hash of (master seed, run, event), so an event does not
+/// depend on the events simulated before it, on the thread that runs it,
+/// or on the number of threads. Without an explicit seed one is drawn from
+/// the clock, the process ID and std::random_device, and printed, so that
+/// parallel jobs never share seeds and any run can be reproduced.
+///
+/// Replay (/seed/replay <event> [run]) shifts the event keys: the next
+/// /run/beamOn 1 re-simulates exactly that event of that run.
+///
+/// Sharding (exampleB4a --shard k/N) splits one configuration over N
+/// processes: with /run/beamOn M, shard k simulates the events with keys
+/// k*M ... k*M+M-1, so the N shards together are the same events as one
+/// job of N*M events, and their outputs can be merged (tools/b4merge).
+///
+/// An event window (Checkpoint) maps the events of consecutive runs onto
+/// one key range: event i of the next run gets the key (run, first + i),
+/// so a dataset simulated in chunks, resumed or extended in another
+/// process is the same events as one uninterrupted run.
+///
+/// The engine (MixMax by default) is selected with exampleB4a -r: it has
+/// to be installed before the run manager is created, which keeps the
+/// master engine and gives each worker an engine of the same type.
+
+class SeedService
+{
+  public:
+    /// Identity of an event for seeding, beam-file records and event time
+    struct EventKey
+    {
+      G4int run = 0;
+      G4long event = 0;
+    };
+
+    /// Independent random streams of one event
+    enum class Stream : std::uint64_t { Physics = 0, Beam = 1 };
+
+    SeedService();
+    ~SeedService();
+
+    // 选择随机数引擎 (mixmax, ranecu, ranluxpp, mtwist)，在创建 run manager 之前调用
+    G4bool InstallEngine(const G4String& name);
+    const G4String& GetEngineName() const { return fEngineName; }
+
+    void SetMasterSeed(std::uint64_t seed);
+    std::uint64_t GetMasterSeed() const { return fMasterSeed; }
+    // 由时钟、进程号和 random_device 生成主种子
+    static std::uint64_t MakeUniqueSeed();
+
+    void SetReplay(G4long event, G4int run = -1);
+    G4bool IsReplay() const { return fReplayEvent >= 0; }
+
+    // 第 index 个分片 (共 count 个)；count = 0 表示不分片
+    void SetShard(G4int index, G4int count);
+    G4bool IsSharded() const { return fShardCount > 0; }
+    G4int GetShardIndex() const { return fShardIndex; }
+    G4int GetShardCount() const { return fShardCount; }
+    // 本分片在一个 eventsInRun 个事件的 run 中的第一个事件键
+    G4long GetFirstEvent(G4long eventsInRun) const
+    {
+      return fWindowFirst >= 0 ? fWindowFirst : fShardIndex * eventsInRun;
+    }
+
+    // 下一个 run 的事件键为 (run, first + eventID)，代替分片的平移；first < 0 取消
+    void SetEventWindow(G4int run, G4long first)
+    {
+      fWindowRun = run;
+      fWindowFirst = first;
+    }
+    void ClearEventWindow() { fWindowFirst = -1; }
+
+    // worker：本事件的键 (分片、replay 时平移)
+    EventKey KeyFor(G4int runID, G4int eventID, G4long eventsInRun) const;
+    // 用 (master, run, event, stream) 重新设定当前线程的引擎
+    void Reseed(const EventKey& key, Stream stream) const;
+
+    void Print() const;
+
+  private:
+    SeedServiceMessenger* fMessenger = nullptr;
+    G4String fEngineName = "mixmax";
+    std::uint64_t fMasterSeed = 0;
+    G4long fReplayEvent = -1;
+    G4int fReplayRun = -1;
+    G4int fShardIndex = 0;
+    G4int fShardCount = 0;
+    G4int fWindowRun = 0;
+    G4long fWindowFirst = -1;
+};
+
+}  // namespace B4
+
+#endif
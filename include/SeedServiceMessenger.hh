@@ -0,0 +1,35 @@
+#ifndef B4SeedServiceMessenger_h
+#define B4SeedServiceMessenger_h
+
+#include "G4UImessenger.hh"
+
+class G4UIdirectory;
+class G4UIcommand;
+class G4UIcmdWithAString;
+class G4UIcmdWithoutParameter;
+
+namespace B4 {
+
+class SeedService;
+
+// define commands for the master seed and event replay
+
+class SeedServiceMessenger : public G4UImessenger {
+public:
+  explicit SeedServiceMessenger(SeedService* seeds);
+  ~SeedServiceMessenger() override;
+
+  void SetNewValue(G4UIcommand* cmd, G4String val) override;
+
+private:
+  SeedService*                fSeeds;
+
+  G4UIdirectory*              fSeedDir;     // /seed/
+  G4UIcmdWithAString*         fMasterCmd;   // 64 位主种子
+  G4UIcommand*                fReplayCmd;   // 重放 <event> [run]
+  G4UIcmdWithoutParameter*    fPrintCmd;
+};
+
+}  // namespace B4
+
+#endif  // B4SeedServiceMessenger_h
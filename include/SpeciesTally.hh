@@ -0,0 +1,83 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+//
+/// \file B4/B4a/include/SpeciesTally.hh
+/// \brief Definition of the B4::SpeciesTally class
+
+#ifndef B4SpeciesTally_h
+#define B4SpeciesTally_h 1
+
+#include "G4VAccumulable.hh"
+#include "globals.hh"
+
+#include <map>
+#include <ostream>
+
+namespace B4
+{
+
+/// Accumulable counting tracks and summing their kinetic energy per
+/// particle species (PDG code). Merged into the master at the end of run
+/// like the other accumulables of RunAction.
+
+class SpeciesTally : public G4VAccumulable
+{
+  public:
+    struct Entry
+    {
+      G4long count = 0;
+      G4double energy = 0.;
+    };
+
+    SpeciesTally(const G4String& name) : G4VAccumulable(name) {}
+    ~SpeciesTally() override = default;
+
+    void Add(G4int pdg, G4double energy)
+    {
+      auto& entry = fEntries[pdg];
+      ++entry.count;
+      entry.energy += energy;
+    }
+
+    void Merge(const G4VAccumulable& other) override;
+    void Reset() override { fEntries.clear(); }
+
+    const std::map<G4int, Entry>& GetEntries() const { return fEntries; }
+    G4long GetTotalCount() const;
+    G4double GetTotalEnergy() const;
+
+    // 按粒子打印：名称、数目、总能量
+    void Print(std::ostream& os, const G4String& title) const;
+    // "key = pdg:count:energy[MeV] ..." 一行 (分片元数据)
+    void Write(std::ostream& os, const G4String& key) const;
+
+  private:
+    std::map<G4int, Entry> fEntries;
+};
+
+}  // namespace B4
+
+#endif
@@ -0,0 +1,69 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+//
+/// \file B4/B4a/include/StackingAction.hh
+/// \brief Definition of the B4::StackingAction class
+
+#ifndef B4StackingAction_h
+#define B4StackingAction_h 1
+
+#include "G4UserStackingAction.hh"
+#include "globals.hh"
+
+namespace B4
+{
+
+class StackingPolicy;
+class RunAction;
+class EventAction;
+
+/// Stacking action class.
+///
+/// Applies the shared StackingPolicy to every new secondary: tracks the
+/// policy rejects are killed and tallied per species in the RunAction;
+/// in validation mode they are kept and flagged in the EventAction
+/// together with their descendants instead.
+
+class StackingAction : public G4UserStackingAction
+{
+  public:
+    StackingAction(const StackingPolicy* policy, RunAction* runAction,
+                   EventAction* eventAction);
+    ~StackingAction() override = default;
+
+    G4ClassificationOfNewTrack ClassifyNewTrack(const G4Track* track) override;
+    void PrepareNewEvent() override;
+
+  private:
+    const StackingPolicy* fPolicy = nullptr;
+    RunAction* fRunAction = nullptr;
+    EventAction* fEventAction = nullptr;
+    G4double fEventT0 = 0.;  // 初级顶点时间 (束流时间随事件号增加)
+};
+
+}  // namespace B4
+
+#endif
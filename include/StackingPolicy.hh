@@ -0,0 +1,126 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+//
+/// \file B4/B4a/include/StackingPolicy.hh
+/// \brief Definition of the B4::StackingPolicy class
+
+#ifndef B4StackingPolicy_h
+#define B4StackingPolicy_h 1
+
+#include "G4ThreeVector.hh"
+#include "globals.hh"
+
+#include <map>
+#include <set>
+#include <vector>
+
+class G4Track;
+
+namespace B4
+{
+
+class DetectorConstruction;
+class StackingPolicyMessenger;
+
+/// Track killing and stack prioritisation rules, configured with /stack/
+/// commands on the master and read by the StackingAction of every worker.
+///
+/// A new secondary is killed when
+///  - its kinetic energy is below the energy cut of its species,
+///  - its time since the primary vertex is above the time cut of its species,
+///  - or (/stack/killUnreachable) its straight-line path can reach neither
+///    the target nor the detector shell. This test is skipped when a
+///    magnetic field is set.
+/// Cuts given for "all" apply to species without their own cut.
+///
+/// Scoring ends at the detector shell: with /stack/killOnEntry a track is
+/// stopped as soon as its detector entry has been recorded, for all
+/// species or selected species and energy ranges. Secondaries it made
+/// before the entry are transported as usual; only those of the entry
+/// step itself are killed. In validation mode nothing is stopped, and the
+/// later entries of the track and of the secondaries it makes from the
+/// entry step on are counted as lost.
+
+class StackingPolicy
+{
+  public:
+    enum class KillReason { None = 0, Energy, Time, Geometry };
+
+    StackingPolicy(const DetectorConstruction* det);
+    ~StackingPolicy();
+
+    KillReason Classify(const G4Track* track, G4double eventT0) const;
+    G4bool IsWaiting(G4int pdg) const { return fWaiting.count(pdg) > 0; }
+
+    // pdg = 0 : all species
+    void SetEnergyCut(G4int pdg, G4double cut) { fEnergyCuts[pdg] = cut; }
+    void SetTimeCut(G4int pdg, G4double cut) { fTimeCuts[pdg] = cut; }
+    void AddWaiting(G4int pdg) { fWaiting.insert(pdg); }
+    void SetKillUnreachable(G4bool flag) { fKillUnreachable = flag; }
+    void SetValidation(G4bool flag) { fValidation = flag; }
+    // emax <= 0 : 无上限
+    void AddEntryKill(G4int pdg, G4double emin, G4double emax)
+    {
+      fEntryKills.push_back({pdg, emin, emax});
+    }
+    void Reset();
+
+    G4bool IsActive() const;
+    G4bool IsValidation() const { return fValidation; }
+    G4bool HasEntryKills() const { return !fEntryKills.empty(); }
+    // 记录入射之后是否终止这条径迹
+    G4bool KillOnEntry(G4int pdg, G4double energy) const;
+    void Print() const;
+
+    // 直线传播能否到达探测器外壳 (或靶，靶内可能散射)
+    G4bool CanReachDetector(const G4ThreeVector& position,
+                            const G4ThreeVector& direction) const;
+
+  private:
+    static G4double FindCut(const std::map<G4int, G4double>& cuts, G4int pdg);
+
+    // 入射后终止的规则：粒子 (0 为全部) 及动能范围 [emin, emax)
+    struct EntryKill
+    {
+      G4int pdg;
+      G4double emin;
+      G4double emax;
+    };
+
+    const DetectorConstruction* fDet = nullptr;
+    StackingPolicyMessenger* fMessenger = nullptr;
+
+    std::map<G4int, G4double> fEnergyCuts;
+    std::map<G4int, G4double> fTimeCuts;
+    std::set<G4int> fWaiting;
+    std::vector<EntryKill> fEntryKills;
+    G4bool fKillUnreachable = false;
+    G4bool fValidation = false;
+};
+
+}  // namespace B4
+
+#endif
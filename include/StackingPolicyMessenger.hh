@@ -0,0 +1,45 @@
+#ifndef B4StackingPolicyMessenger_h
+#define B4StackingPolicyMessenger_h
+
+#include "G4UImessenger.hh"
+#include "globals.hh"
+
+class G4UIdirectory;
+class G4UIcommand;
+class G4UIcmdWithAString;
+class G4UIcmdWithABool;
+class G4UIcmdWithoutParameter;
+
+namespace B4 {
+
+class StackingPolicy;
+
+// define commands to configure track killing and stack priorities
+
+class StackingPolicyMessenger : public G4UImessenger {
+public:
+  explicit StackingPolicyMessenger(StackingPolicy* policy);
+  ~StackingPolicyMessenger() override;
+
+  void SetNewValue(G4UIcommand* cmd, G4String val) override;
+
+private:
+  // "all" -> 0, 否则为粒子的 PDG 编码；未知粒子返回 false
+  G4bool ParticleCode(const G4String& name, G4int& pdg) const;
+
+  StackingPolicy*           fPolicy;
+
+  G4UIdirectory*            fStackDir;          // /stack/
+  G4UIcommand*              fEnergyCutCmd;
+  G4UIcommand*              fTimeCutCmd;
+  G4UIcmdWithAString*       fWaitingCmd;
+  G4UIcmdWithABool*         fUnreachableCmd;
+  G4UIcommand*              fKillOnEntryCmd;    // 入射后终止：粒子 [能量范围]
+  G4UIcmdWithABool*         fValidateCmd;
+  G4UIcmdWithoutParameter*  fResetCmd;
+  G4UIcmdWithoutParameter*  fPrintCmd;
+};
+
+}  // namespace B4
+
+#endif  // B4StackingPolicyMessenger_h
@@ -32,6 +32,9 @@
 
 #include "G4UserSteppingAction.hh"
 #include "globals.hh"
+#include "RunProfile.hh"
+
+#include <vector>
 
 
 namespace B4{
@@ -39,6 +42,7 @@ namespace B4{
   class EventAction;
   class DetectorConstruction;
   class PrimaryGeneratorAction;
+  class TargetExitTable;
 
 
   /// Stepping action class.
@@ -46,19 +50,41 @@ namespace B4{
   /// SteppingAction counts particles passed the shield,
   /// and define algorithm for getting the energy of particles passed the shield.
   /// then transmit the energy to the event action.
+  /// With B4_PROFILING (off by default) every step is counted per logical
+  /// volume. In a fast-simulation training run the particles leaving the
+  /// target are recorded in the thread's TargetExitTable.
+  /// Crossings of the virtual scoring planes (/det/scoringPlanes) are found
+  /// from the z range of every step and passed to the event action.
+  /// Which of these a run needs is decided once in BeginRun(); a run with
+  /// none of them returns from every step after a single test.
 
 class SteppingAction : public G4UserSteppingAction{
 
   public:
-    SteppingAction(DetectorConstruction* detConstruction, EventAction* eventAction, PrimaryGeneratorAction* genAction);
+    SteppingAction(DetectorConstruction* detConstruction, EventAction* eventAction,
+                   PrimaryGeneratorAction* genAction, RunProfile* profile,
+                   TargetExitTable* targetExits);
     ~SteppingAction() override = default;
 
     void UserSteppingAction(const G4Step* step) override;
+    // RunAction (worker) 在 run 开始时调用：本 run 需要的逐步工作
+    void BeginRun();
 
   private:
+    void RecordPlaneCrossings(const G4Step* step, const std::vector<G4double>& planes);
+    void RecordTargetExit(const G4Step* step);
+
     PrimaryGeneratorAction* fGenAction;
     DetectorConstruction* fDet;
     EventAction* fEventAction;
+    RunProfile* fProfile;
+    TargetExitTable* fTargetExits;
+
+    // 本 run 的逐步工作
+    G4bool fTraining = false;
+    G4bool fPlanes = false;
+    G4bool fSteppingEntry = false;
+    G4bool fStepWork = false;  // 以上任意一项
 };
 
 }  // namespace B4
@@ -0,0 +1,87 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+//
+/// \file B4/B4a/include/SweepManager.hh
+/// \brief Definition of the B4::SweepManager class
+
+#ifndef B4SweepManager_h
+#define B4SweepManager_h 1
+
+#include "globals.hh"
+
+#include <vector>
+
+namespace B4
+{
+
+class DetectorConstruction;
+class SweepMessenger;
+
+/// Parameter sweep driven from one initialised run manager.
+///
+/// The sweep grid (particles x energies x materials x lengths) is filled
+/// with the /sweep/ commands and executed by /sweep/run. The geometry loops
+/// are the outer ones, so the geometry is only rebuilt when the material or
+/// the length changes; between the inner points only the gun is changed.
+/// Every point is a separate /run/beamOn with its own output file.
+
+class SweepManager
+{
+  public:
+    SweepManager(DetectorConstruction* det);
+    ~SweepManager();
+
+    void SetParticles(const std::vector<G4String>& names) { fParticles = names; }
+    void SetEnergies(const std::vector<G4double>& values) { fEnergies = values; }
+    void SetMaterials(const std::vector<G4String>& names) { fMaterials = names; }
+    void SetLengths(const std::vector<G4double>& values) { fLengths = values; }
+    void SetNumberOfEvents(G4int n) { fNofEvents = n; }
+    void SetDirectory(const G4String& dir) { fDirectory = dir; }
+    void Clear();
+
+    std::size_t GetNumberOfPoints() const;
+
+    // 依次运行所有扫描点
+    void Run();
+
+  private:
+    G4String PointFileName(const G4String& particle, G4double energy,
+                           const G4String& material, G4double length) const;
+
+    DetectorConstruction* fDet = nullptr;
+    SweepMessenger* fMessenger = nullptr;
+
+    std::vector<G4String> fParticles;
+    std::vector<G4double> fEnergies;
+    std::vector<G4String> fMaterials;
+    std::vector<G4double> fLengths;
+    G4int fNofEvents = 1000;
+    G4String fDirectory;
+};
+
+}  // namespace B4
+
+#endif
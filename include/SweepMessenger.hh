@@ -0,0 +1,41 @@
+#ifndef B4SweepMessenger_h
+#define B4SweepMessenger_h
+
+#include "G4UImessenger.hh"
+
+class G4UIdirectory;
+class G4UIcommand;
+class G4UIcmdWithAString;
+class G4UIcmdWithAnInteger;
+class G4UIcmdWithoutParameter;
+
+namespace B4 {
+
+class SweepManager;
+
+// define commands to fill and run an in-process parameter sweep
+
+class SweepMessenger : public G4UImessenger {
+public:
+  explicit SweepMessenger(SweepManager* sweep);
+  ~SweepMessenger() override;
+
+  void SetNewValue(G4UIcommand* cmd, G4String val) override;
+
+private:
+  SweepManager*             fSweep;
+
+  G4UIdirectory*            fSweepDir;       // /sweep/
+  G4UIcmdWithAString*       fParticlesCmd;   // 粒子列表
+  G4UIcmdWithAString*       fEnergiesCmd;    // 能量列表 + 单位
+  G4UIcmdWithAString*       fMaterialsCmd;   // 靶材料列表
+  G4UIcmdWithAString*       fLengthsCmd;     // 靶长度列表 + 单位
+  G4UIcmdWithAnInteger*     fEventsCmd;      // 每个点的事例数
+  G4UIcmdWithAString*       fDirectoryCmd;   // 输出目录
+  G4UIcmdWithoutParameter*  fClearCmd;
+  G4UIcmdWithoutParameter*  fRunCmd;
+};
+
+}  // namespace B4
+
+#endif  // B4SweepMessenger_h
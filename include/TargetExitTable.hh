@@ -0,0 +1,156 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+//
+/// \file B4/B4a/include/TargetExitTable.hh
+/// \brief Definition of the B4::TargetExitTable class
+
+#ifndef B4TargetExitTable_h
+#define B4TargetExitTable_h 1
+
+#include "G4VAccumulable.hh"
+#include "G4ThreeVector.hh"
+#include "globals.hh"
+
+#include <array>
+#include <istream>
+#include <ostream>
+#include <unordered_set>
+#include <vector>
+
+namespace B4
+{
+
+/// One particle leaving the target, as sampled by the fast model.
+struct TargetExit
+{
+  G4int pdg = 0;
+  G4bool survivor = false;  // 初级粒子本身穿出
+  G4double energy = 0.;     // kinetic
+  G4ThreeVector position;   // global, just outside the target surface
+  G4ThreeVector direction;
+};
+
+/// Distribution of the particles leaving the target per primary, for one
+/// configuration (particle, energy, target material, target length).
+///
+/// Filled in a full-simulation training run (/fastsim/train): for every
+/// primary, the first exit of each track born in the target (and of the
+/// primary itself) is recorded. Per species (PDG code, with the surviving
+/// primary as a species of its own) the table keeps the multiplicity
+/// distribution, a log10(E) x cos(theta) histogram and the exit point on
+/// the target surface (upstream face, side, downstream face).
+///
+/// The fast model (TargetFastModel) samples the species independently
+/// from these factorised distributions: the mean multiplicities and the
+/// single-particle spectra are reproduced, correlations between the exits
+/// of one primary are not.
+
+class TargetExitTable : public G4VAccumulable
+{
+  public:
+    static constexpr G4int kMaxMultiplicity = 64;  // 最后一个 bin 含更多
+    static constexpr G4int kEnergyBins = 64;        // log10(E/MeV) in [-3, 5)
+    static constexpr G4double kLogEMin = -3.;
+    static constexpr G4double kLogEMax = 5.;
+    static constexpr G4int kCosBins = 40;           // cos(theta) in [-1, 1]
+    static constexpr G4int kPositionBins = 30;      // surface coordinate in [0, 3)
+
+    struct Species
+    {
+      G4int pdg = 0;
+      G4bool survivor = false;
+      std::array<G4double, kMaxMultiplicity + 1> multiplicity{};  // 只有 n >= 1，n = 0 由初级数导出
+      std::vector<G4double> energyAngle = std::vector<G4double>(kEnergyBins * kCosBins, 0.);
+      std::array<G4double, kPositionBins> position{};
+
+      // 抽样用的累积分布 (Prepare() 建立)
+      std::vector<G4double> multiplicityCdf;
+      std::vector<G4double> energyAngleCdf;
+      std::vector<G4double> positionCdf;
+    };
+
+    explicit TargetExitTable(const G4String& name = "TargetExitTable") : G4VAccumulable(name) {}
+    ~TargetExitTable() override = default;
+
+    // 训练：一个初级粒子的全部穿出 (worker)
+    void SetTraining(G4bool flag) { fTraining = flag; }
+    G4bool IsTraining() const { return fTraining; }
+    void BeginPrimary();
+    void AddExit(G4int trackID, G4int pdg, G4bool survivor, G4double energy, G4double cosTheta,
+                 G4double surface);
+    void EndPrimary();
+
+    void Merge(const G4VAccumulable& other) override;
+    void Reset() override;
+
+    // 表的配置 (master 在训练 run 结束时设置)
+    void SetKey(const G4String& particle, G4double energy, const G4String& material,
+                G4double length);
+    const G4String& GetParticle() const { return fParticle; }
+    G4double GetEnergy() const { return fEnergy; }
+    const G4String& GetMaterial() const { return fMaterial; }
+    G4double GetLength() const { return fLength; }
+    G4double GetPrimaries() const { return fPrimaries; }
+    const std::vector<Species>& GetSpecies() const { return fSpecies; }
+    // 每个初级粒子平均穿出的粒子数
+    G4double GetMeanMultiplicity() const;
+
+    // 以 "key = value" 行写出/读入 (format = B4FASTSIM)；格式或分箱不符、
+    // 缺少键或值无效时 Read 返回 false，表保持为空
+    void Write(std::ostream& os) const;
+    G4bool Read(std::istream& is);
+    // 训练结果的默认文件名
+    G4String FileName() const;
+
+    // 建立累积分布，之后可以 (多线程只读地) 抽样
+    void Prepare();
+    void Sample(G4double radius, G4double length, const G4ThreeVector& center,
+                std::vector<TargetExit>& exits) const;
+
+    // 靶表面上的坐标 u：上游端面 [0,1) 为 r/R，侧面 [1,2) 为 (z-z0)/L，
+    // 下游端面 [2,3) 为 r/R；local 相对靶中心
+    static G4double SurfaceCoordinate(const G4ThreeVector& local, G4double radius,
+                                      G4double length);
+
+  private:
+    std::size_t Find(G4int pdg, G4bool survivor);
+
+    G4String fParticle;
+    G4double fEnergy = 0.;
+    G4String fMaterial;
+    G4double fLength = 0.;
+    G4double fPrimaries = 0.;
+    std::vector<Species> fSpecies;
+
+    // 训练中当前初级粒子的状态 (线程私有的副本)
+    G4bool fTraining = false;
+    std::vector<G4int> fCounts;           // 按 fSpecies 的序号
+    std::unordered_set<G4int> fExited;    // 已经穿出过的径迹
+};
+
+}  // namespace B4
+
+#endif
@@ -0,0 +1,74 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+//
+/// \file B4/B4a/include/TargetFastModel.hh
+/// \brief Definition of the B4::TargetFastModel class
+
+#ifndef B4TargetFastModel_h
+#define B4TargetFastModel_h 1
+
+#include "G4VFastSimulationModel.hh"
+#include "TargetExitTable.hh"
+
+#include <vector>
+
+namespace B4
+{
+
+class DetectorConstruction;
+class FastTarget;
+
+/// Fast-simulation model of the Target region (envelope: the target).
+///
+/// Triggers for a primary entering the target when the fast mode is
+/// enabled and FastTarget has a table for its particle and energy in the
+/// current geometry. The exits are sampled from the table: the surviving
+/// primary (if sampled) is moved to its exit point, otherwise it is
+/// killed; all other exits are created as secondaries just outside the
+/// target surface and tracked normally from there. The energy not carried
+/// away is deposited in the target. One instance per thread.
+
+class TargetFastModel : public G4VFastSimulationModel
+{
+  public:
+    TargetFastModel(const G4String& name, G4Region* envelope, const FastTarget* fastTarget,
+                    const DetectorConstruction* det);
+    ~TargetFastModel() override = default;
+
+    G4bool IsApplicable(const G4ParticleDefinition&) override { return true; }
+    G4bool ModelTrigger(const G4FastTrack& fastTrack) override;
+    void DoIt(const G4FastTrack& fastTrack, G4FastStep& fastStep) override;
+
+  private:
+    const FastTarget* fFastTarget = nullptr;
+    const DetectorConstruction* fDet = nullptr;
+    const TargetExitTable* fTable = nullptr;  // ModelTrigger 找到的表
+    std::vector<TargetExit> fExits;           // 跨事件复用
+};
+
+}  // namespace B4
+
+#endif
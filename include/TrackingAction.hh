@@ -0,0 +1,65 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+//
+/// \file B4/B4a/include/TrackingAction.hh
+/// \brief Definition of the B4::TrackingAction class
+
+#ifndef B4TrackingAction_h
+#define B4TrackingAction_h 1
+
+#include "G4UserTrackingAction.hh"
+#include "globals.hh"
+
+class G4Track;
+
+namespace B4
+{
+
+class RunAction;
+
+/// Tracking action class.
+///
+/// At the end of each track the number of steps it took is added to the
+/// run's step counter, so the run summary can quote steps/s without
+/// touching the per-step path. With B4_PROFILING it also times every
+/// track for the per-species profile (see RunProfile).
+
+class TrackingAction : public G4UserTrackingAction
+{
+  public:
+    TrackingAction(RunAction* runAction);
+    ~TrackingAction() override = default;
+
+    void PreUserTrackingAction(const G4Track* track) override;
+    void PostUserTrackingAction(const G4Track* track) override;
+
+  private:
+    RunAction* fRunAction = nullptr;
+};
+
+}  // namespace B4
+
+#endif
@@ -1,5 +1,14 @@
 #!/bin/bash
 
+# 每个参数点启动一个新进程；同样的扫描可在单个进程内完成：
+#   ./exampleB4a -m sweep.mac -t 8
+# 粒子和能量也可以在一个 run 中混合抽样 (每种几何一个 run，输出按初级粒子区分)：
+#   ./exampleB4a -m mixed.mac -t 8
+
+# 所有任务共用一个缓存：物理表只在第一批构建并保存，之后的进程直接读取；
+# 验证过的几何参数不再检查重叠 (exampleB4a --cache，默认 .b4cache)
+export B4_CACHE_DIR="${B4_CACHE_DIR:-$PWD/.b4cache}"
+
 # 定义参数数组
 PARTICLES=("pi+" "pi-" "mu+" "mu-")
 ENERGIES=("1 GeV" "1.5 GeV" "2 GeV" "3 GeV" "4 GeV" "5 GeV" "6 GeV" "7 GeV")
@@ -0,0 +1,25 @@
+#!/bin/bash
+
+# 把一个配置分成 N 个分片在本机并行运行，再用 b4merge 合并。
+# 在批处理集群上每个节点运行一个分片即可 (同一个宏、同一个种子)：
+#   ./exampleB4a -m job.mac -s <seed> --shard k/N
+# 用法: ./run_shards.sh <macro> <N> [seed] [threads/分片]
+
+MACRO=${1:?用法: $0 <macro> <N> [seed] [threads]}
+SHARDS=${2:?用法: $0 <macro> <N> [seed] [threads]}
+SEED=${3:-12345}
+THREADS=${4:-1}
+
+for ((k = 0; k < SHARDS; k++)); do
+  echo "启动分片 $k/$SHARDS"
+  ./exampleB4a -m "$MACRO" -s "$SEED" -t "$THREADS" --shard "$k/$SHARDS" > "shard${k}of${SHARDS}.log" 2>&1 &
+done
+wait
+
+# 每个 run 合并一次 (分片输出名中含 _shard<k>of<N>_run<R>)
+for first in *_shard0of${SHARDS}_run*.shard; do
+  [ -e "$first" ] || { echo "没有找到分片元数据 (*.shard)"; exit 1; }
+  base=${first%_shard0of${SHARDS}_run*}
+  run=${first##*_run}; run=${run%.shard}
+  ./b4merge -o "${base}_merged_run${run}" "${base}"_shard*of${SHARDS}_run${run}.shard
+done
@@ -15,6 +15,10 @@ print_help() {
   -t, --thickness <厚度>     屏蔽厚度 (默认: 50 cm)
                             格式: <数值> <单位> (如: 10 cm, 0.5 m)
   -n, --particle_num <数量>  模拟粒子数量 (默认: 100000)
+                            与 -u 一起使用时为事例数上限
+  -u, --until <相对误差>     按收敛运行 (/run/beamUntil)：透射率的相对
+                            不确定度达到该值即停止 (如: 0.01)
+  -w, --walltime <秒>        -u 模式的时间预算 (默认: 不限)
   -o, --output <前缀>        输出文件前缀 (默认: simulation)
   -h, --help                 显示此帮助信息
 
@@ -45,6 +49,14 @@ while [[ $# -gt 0 ]]; do
             PARTICLE_NUM="$2"
             shift 2
             ;;
+        -u|--until)
+            UNTIL_ERROR="$2"
+            shift 2
+            ;;
+        -w|--walltime)
+            WALL_TIME="$2"
+            shift 2
+            ;;
         -o|--output)
             OUTPUT_PREFIX="$2"
             shift 2
@@ -67,6 +79,18 @@ done
 : ${SHIELD_THICKNESS:="50 cm"}
 : ${PARTICLE_NUM:="100000"}
 : ${OUTPUT_PREFIX:="simulation"}
+: ${WALL_TIME:="0"}
+
+# 固定事例数，或按收敛运行 (事例数为上限)
+if [ -n "$UNTIL_ERROR" ]; then
+    BEAM_COMMANDS="/run/until/maxEvents $PARTICLE_NUM
+/run/until/wallTime $WALL_TIME s
+/run/beamUntil $UNTIL_ERROR"
+    SUMMARY_TITLE="Adaptive Run Summary"
+else
+    BEAM_COMMANDS="/run/beamOn $PARTICLE_NUM"
+    SUMMARY_TITLE="Merged Run Summary"
+fi
 
 # 清理文件名中的特殊字符
 clean_name() {
@@ -90,7 +114,7 @@ cat > "$TMP_MAC" <<EOF
 /run/initialize
 /gun/particle $PARTICLE_TYPE
 /gun/energy $PARTICLE_ENERGY
-/run/beamOn $PARTICLE_NUM
+$BEAM_COMMANDS
 EOF
 
 echo "生成的MAC文件内容:"
@@ -115,7 +139,7 @@ echo
 # [参数解析、默认值设置等保持不变...]
 
 # 运行程序并精确提取 Merged Run Summary
-./exampleB4a -m "$TMP_MAC" -t 5 2>&1 | awk '
+./exampleB4a -m "$TMP_MAC" -t 5 2>&1 | awk -v title="$SUMMARY_TITLE" '
     BEGIN {
         in_merged_block = 0
         merged_block = ""
@@ -124,7 +148,7 @@ echo
     }
     
     # 精确匹配 Merged Run Summary 开始行
-    $0 ~ /^={5,} Merged Run Summary ={5,}$/ {
+    $0 ~ ("^=====+ " title " =====+$") {
         in_merged_block = 1
         merged_block = $0
         separator_count = 0
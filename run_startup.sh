@@ -0,0 +1,81 @@
+#!/bin/bash
+
+# 批处理启动时间的测量：一个事件的作业，分别在
+#   baseline : 不使用缓存 (--cache off)，或 BASELINE_EXE 指定的旧版本程序
+#   cold     : 空缓存 (第一个作业构建物理表并保存)
+#   warm     : 同一缓存 (之后的作业读取物理表，几何不再检查重叠)
+# 三种情况下各运行 REPEAT 次，打印进程总时间的中位数和 exampleB4a 的
+# "Startup" 行 (到 /run/initialize、物理表和第一个事件的时间)。
+# 用法: ./run_startup.sh [macro] [repeat] [threads]
+#   macro 默认为一个只有 /run/initialize 和 /run/beamOn 1 的宏
+
+MACRO=${1:-}
+REPEAT=${2:-5}
+THREADS=${3:-1}
+EXE=${EXE:-./exampleB4a}
+BASELINE_EXE=${BASELINE_EXE:-$EXE}
+
+# 没有构建好的程序时立即停止，不打印无意义的时间
+for exe in "$EXE" "$BASELINE_EXE"; do
+  if [ ! -x "$exe" ]; then
+    echo "找不到可执行文件 $exe：先构建 exampleB4a，或用 EXE=/BASELINE_EXE= 指定" >&2
+    exit 1
+  fi
+done
+
+TMP_MACRO=""
+if [ -z "$MACRO" ]; then
+  TMP_MACRO=$(mktemp --suffix=.mac)
+  MACRO=$TMP_MACRO
+  printf '/run/initialize\n/run/printProgress 0\n/run/output/enableRoot false\n/run/beamOn 1\n' > "$MACRO"
+fi
+CACHE=$(mktemp -d)
+trap 'rm -rf "$CACHE" $TMP_MACRO' EXIT
+
+# 运行一次，输出 "毫秒 Startup 行"
+run_once() {
+  local exe=$1; shift
+  local log
+  log=$(mktemp)
+  local start end
+  start=$(date +%s%N)
+  "$exe" -m "$MACRO" -t "$THREADS" "$@" > "$log" 2>&1 || { echo "失败: $exe $*" >&2; cat "$log" >&2; rm -f "$log"; exit 1; }
+  end=$(date +%s%N)
+  echo "$(( (end - start) / 1000000 )) $(grep -m1 ' Startup (ms since main())' "$log")"
+  rm -f "$log"
+}
+
+# 中位数 (毫秒)
+median() {
+  sort -n | awk '{ v[NR] = $1 } END { print (NR % 2) ? v[(NR + 1) / 2] : (v[NR / 2] + v[NR / 2 + 1]) / 2 }'
+}
+
+measure() {
+  local name=$1; shift
+  local times=()
+  local line=""
+  for ((i = 0; i < REPEAT; i++)); do
+    line=$(run_once "$@") || exit 1
+    times+=("${line%% *}")
+  done
+  printf '%-9s %8s ms   (%s runs)  last:%s\n' "$name" \
+    "$(printf '%s\n' "${times[@]}" | median)" "$REPEAT" "${line#* }"
+}
+
+echo "宏: $MACRO，每种情况 $REPEAT 次，$THREADS 个线程"
+# 旧版本没有 --cache 选项
+if [ "$BASELINE_EXE" = "$EXE" ]; then
+  measure baseline "$EXE" --cache off
+else
+  measure baseline "$BASELINE_EXE"
+fi
+# cold：每次都从空缓存开始
+times=()
+for ((i = 0; i < REPEAT; i++)); do
+  rm -rf "$CACHE"; mkdir -p "$CACHE"
+  line=$(run_once "$EXE" --cache "$CACHE") || exit 1
+  times+=("${line%% *}")
+done
+printf '%-9s %8s ms   (%s runs)  last:%s\n' cold \
+  "$(printf '%s\n' "${times[@]}" | median)" "$REPEAT" "${line#* }"
+measure warm "$EXE" --cache "$CACHE"
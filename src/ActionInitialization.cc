@@ -34,6 +34,10 @@
 #include "RunAction.hh"
 #include "EventAction.hh"
 #include "SteppingAction.hh"
+#include "TrackingAction.hh"
+#include "StackingAction.hh"
+#include "StackingPolicy.hh"
+#include "BeamSource.hh"
 
 
 
@@ -42,9 +46,21 @@ namespace B4
 
 //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
 
-ActionInitialization::ActionInitialization(DetectorConstruction* detConstruction)
+ActionInitialization::ActionInitialization(DetectorConstruction* detConstruction,
+                                           const SeedService* seeds)
   : G4VUserActionInitialization(),
-    fDetConstruction(detConstruction) {}
+    fDetConstruction(detConstruction),
+    fStackingPolicy(new StackingPolicy(detConstruction)),
+    fBeamSource(new BeamSource),
+    fSeeds(seeds) {}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+ActionInitialization::~ActionInitialization()
+{
+  delete fStackingPolicy;
+  delete fBeamSource;
+}
 
 //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
 
@@ -53,11 +69,13 @@ void ActionInitialization::BuildForMaster() const
   // master和worker各自注册primary generator action
   // Master 线程只注册 RunAction，通过generatorAction把粒子能量类型等信息传递给RunAction
 
-  auto* genActionMaster = new PrimaryGeneratorAction;
+  // 束流描述只用来读取 (混合束流的标记)，master 不产生初级粒子
+  auto* genActionMaster = new PrimaryGeneratorAction(fBeamSource);
   // SetUserAction(genActionMaster);
   SetUserAction(new RunAction(/*isMaster=*/true,
                               /*genAction=*/genActionMaster,
-                              /*det=*/fDetConstruction));
+                              /*det=*/fDetConstruction,
+                              /*seeds=*/fSeeds));
 }
 
 //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
@@ -65,19 +83,27 @@ void ActionInitialization::BuildForMaster() const
 void ActionInitialization::Build() const
 {
   // worker 线程：注册各自的动作
-  auto* genActionWorker = new PrimaryGeneratorAction;
+  auto* genActionWorker = new PrimaryGeneratorAction(fBeamSource, fSeeds);
   auto* runActionWorker = new RunAction(/*isMaster=*/false,
                                         /*genAction=*/genActionWorker,
-                                        /*det=*/fDetConstruction);
+                                        /*det=*/fDetConstruction,
+                                        /*seeds=*/fSeeds);
+
 
+  auto* evtAction = new EventAction(runActionWorker, fStackingPolicy);
+  auto* stepAction = new SteppingAction(fDetConstruction, evtAction, genActionWorker,
+                                        &runActionWorker->GetProfile(),
+                                        &runActionWorker->GetTargetExits());
+  runActionWorker->SetSteppingAction(stepAction);
+  auto* trackAction = new TrackingAction(runActionWorker);
+  auto* stackAction = new StackingAction(fStackingPolicy, runActionWorker, evtAction);
 
-  auto* evtAction = new EventAction;
-  auto* stepAction = new SteppingAction(fDetConstruction, evtAction, genActionWorker);
-  
   SetUserAction(genActionWorker);
   SetUserAction(runActionWorker);
   SetUserAction(evtAction);
   SetUserAction(stepAction);
+  SetUserAction(trackAction);
+  SetUserAction(stackAction);
 }
 
 //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
@@ -0,0 +1,235 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+//
+/// \file B4/B4a/src/AdaptiveRun.cc
+/// \brief Implementation of the B4::AdaptiveRun class
+
+#include "AdaptiveRun.hh"
+#include "AdaptiveRunMessenger.hh"
+#include "RunAction.hh"
+
+#include "G4RunManager.hh"
+#include "G4Run.hh"
+#include "G4Timer.hh"
+#include "G4Exception.hh"
+#include "G4ios.hh"
+
+#include <algorithm>
+#include <climits>
+#include <cmath>
+#include <iomanip>
+#include <limits>
+#include <sstream>
+
+namespace
+{
+constexpr G4double kInfinite = std::numeric_limits<G4double>::infinity();
+// 一个 chunk 最多是已模拟事例数的这个倍数：少量计数给出的估计不可靠
+constexpr G4double kMaxGrowth = 4.;
+}  // namespace
+
+namespace B4
+{
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+AdaptiveRun::AdaptiveRun()
+  : fTotal("AdaptiveRunTotal")
+{
+  fMessenger = new AdaptiveRunMessenger(this);
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+AdaptiveRun::~AdaptiveRun()
+{
+  delete fMessenger;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+G4double AdaptiveRun::TransmissionError() const
+{
+  // 每个初级粒子的透射权重 t：<t> 的相对标准误差
+  // (无偏置时 t 为 0 或 1，即二项分布的 sqrt((1-p)/(N p)))
+  G4long primaries = fPassed + fBlocked;
+  if (fTransmitted <= 0. || primaries == 0) return kInfinite;
+  G4double mean = fTransmitted / primaries;
+  G4double variance = std::max(fTransmitted2 / primaries - mean * mean, 0.);
+  return std::sqrt(variance / primaries) / mean;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+G4double AdaptiveRun::BinError(std::size_t index) const
+{
+  auto [spectrum, bin] = fBins[index];
+  G4double n = (spectrum == Spectrum::Energy) ? fTotal.GetEnergySpectrum()[bin]
+                                              : fTotal.GetThetaSpectrum()[bin];
+  return n > 0. ? 1. / std::sqrt(n) : kInfinite;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+G4String AdaptiveRun::BinName(std::size_t index) const
+{
+  auto [spectrum, bin] = fBins[index];
+  return (spectrum == Spectrum::Energy ? "energy[" : "theta[") + std::to_string(bin) + "]";
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void AdaptiveRun::BeamUntil(G4double relError)
+{
+  auto* runManager = G4RunManager::GetRunManager();
+  auto* runAction = dynamic_cast<RunAction*>(
+    const_cast<G4UserRunAction*>(runManager->GetUserRunAction()));
+  if (!runAction || relError <= 0.) {
+    G4ExceptionDescription msg;
+    msg << "beamUntil needs the run action and a relative uncertainty > 0.";
+    G4Exception("AdaptiveRun::BeamUntil()", "MyCode0013", JustWarning, msg);
+    return;
+  }
+
+  fEvents = 0;
+  fPassed = 0;
+  fBlocked = 0;
+  fTransmitted = 0.;
+  fTransmitted2 = 0.;
+  fTotal.Reset();
+
+  // 每个 chunk 一个 run：输出名带 run 号，各 chunk 的文件不会互相覆盖
+  runAction->SetRunTagging(true);
+
+  G4Timer timer;
+  timer.Start();
+  G4int chunks = 0;
+  G4int firstRun = -1;
+  G4int lastRun = -1;
+  G4double error = kInfinite;
+  G4String worst = "transmission";
+  G4String reason;
+  G4long next = std::min<G4long>(fChunkSize, fMaxEvents);
+
+  while (true) {
+    runManager->BeamOn(static_cast<G4int>(next));
+    const G4Run* run = runManager->GetCurrentRun();
+    if (run) {
+      if (firstRun < 0) firstRun = run->GetRunID();
+      lastRun = run->GetRunID();
+    }
+    ++chunks;
+
+    // 合并后的结果 (master 的 RunAction 在 EndOfRunAction 之后有效)
+    fEvents += run ? run->GetNumberOfEvent() : next;
+    fPassed += runAction->GetPassed();
+    fBlocked += runAction->GetBlocked();
+    fTransmitted += runAction->GetTransmitted();
+    fTransmitted2 += runAction->GetTransmitted2();
+    fTotal.Merge(runAction->GetEntryObservables());
+
+    // 最差的相对不确定度
+    error = TransmissionError();
+    worst = "transmission";
+    for (std::size_t i = 0; i < fBins.size(); ++i) {
+      G4double binError = BinError(i);
+      if (binError > error) {
+        error = binError;
+        worst = BinName(i);
+      }
+    }
+
+    timer.Stop();
+    G4double elapsed = timer.GetRealElapsed();
+    G4cout << "===== beamUntil chunk " << chunks << " : " << fEvents << " events, "
+           << "relative uncertainty " << error << " (" << worst << "), " << elapsed << " s"
+           << G4endl;
+
+    if (error <= relError && fEvents >= fMinEvents) {
+      reason = "converged";
+      break;
+    }
+    if (fEvents >= fMaxEvents) {
+      reason = "event limit";
+      break;
+    }
+    if (fWallTime > 0. && elapsed >= fWallTime) {
+      reason = "wall-time budget";
+      break;
+    }
+
+    // 下一个 chunk：按 1/sqrt(N) 估计还需要的事例数 (多留 10%)，最多为
+    // 已有事例数的 kMaxGrowth 倍；还没有任何计数时不放大，保持最小 chunk
+    G4double needed = std::isfinite(error)
+      ? std::min(1.1 * fEvents * (error * error / (relError * relError) - 1.),
+                 kMaxGrowth * fEvents)
+      : 0.;
+    needed = std::max<G4double>(needed, fMinEvents - fEvents);
+    next = std::max<G4long>(fChunkSize, static_cast<G4long>(std::min<G4double>(needed, LLONG_MAX)));
+    next = std::min(next, fMaxEvents - fEvents);
+    if (fWallTime > 0.) {
+      G4double rate = fEvents / elapsed;
+      auto affordable = static_cast<G4long>((fWallTime - elapsed) * rate);
+      if (affordable < 1) {
+        reason = "wall-time budget";
+        break;
+      }
+      next = std::min(next, affordable);
+    }
+    next = std::min<G4long>(next, INT_MAX);
+  }
+
+  runAction->SetRunTagging(false);
+
+  G4long primaries = fPassed + fBlocked;
+  G4double transmission = primaries > 0 ? fTransmitted / primaries : 0.;
+  G4double relative = TransmissionError();
+  std::ostringstream os;
+  os << "========== Adaptive Run Summary ==========\n"
+     << " Stopped by            : " << reason << "\n"
+     << " Target uncertainty    : " << relError << "\n"
+     << " Reached uncertainty   : " << error << " (" << worst << ")\n"
+     << " Chunks (runs)         : " << chunks << " (run " << firstRun << " ... " << lastRun
+     << ")\n"
+     << " Events                : " << fEvents << "\n"
+     << " Transmission          : " << transmission << " +- "
+     << (std::isfinite(relative) ? relative * transmission : 0.)
+     << "  (" << fPassed << " of " << primaries << " primaries reached the detector)\n"
+     << " Detector entries      : " << fTotal.GetEntries() << " ("
+     << fTotal.GetEntriesPerEvent() << " +- " << fTotal.GetEntriesPerEventError()
+     << " per event)\n";
+  for (std::size_t i = 0; i < fBins.size(); ++i) {
+    os << " " << std::left << std::setw(22) << BinName(i) << std::right << ": relative "
+       << BinError(i) << "\n";
+  }
+  os << " Elapsed time          : " << timer.GetRealElapsed() << " s\n"
+     << "=================================";
+  G4cout << os.str() << G4endl;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+}  // namespace B4
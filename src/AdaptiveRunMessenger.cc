@@ -0,0 +1,133 @@
+#include "AdaptiveRunMessenger.hh"
+#include "AdaptiveRun.hh"
+#include "EntryObservables.hh"
+
+#include "G4UIdirectory.hh"
+#include "G4UIcmdWithAString.hh"
+#include "G4UIcmdWithADouble.hh"
+#include "G4UIcmdWithADoubleAndUnit.hh"
+#include "G4UIcmdWithAnInteger.hh"
+#include "G4UIcmdWithoutParameter.hh"
+#include "G4Exception.hh"
+#include "G4SystemOfUnits.hh"
+
+#include <sstream>
+
+namespace B4 {
+
+AdaptiveRunMessenger::AdaptiveRunMessenger(AdaptiveRun* adaptive)
+ : fAdaptive(adaptive)
+{
+  fUntilDir = new G4UIdirectory("/run/until/");
+  fUntilDir->SetGuidance("Limits and observables of /run/beamUntil");
+
+  // 只在 master 上执行：chunk 由 master 的 BeamOn 驱动
+
+  fBeamUntilCmd = new G4UIcmdWithADouble("/run/beamUntil", this);
+  fBeamUntilCmd->SetGuidance("Run in chunks of events until the relative uncertainty of the");
+  fBeamUntilCmd->SetGuidance("transmission and of the /run/until/bin bins is below the value,");
+  fBeamUntilCmd->SetGuidance("or until /run/until/maxEvents or /run/until/wallTime is reached.");
+  fBeamUntilCmd->SetGuidance("Every chunk is a separate run; output names carry the run number.");
+  fBeamUntilCmd->SetParameterName("relError", false);
+  fBeamUntilCmd->SetRange("relError>0");
+  fBeamUntilCmd->AvailableForStates(G4State_Idle);
+  fBeamUntilCmd->SetToBeBroadcasted(false);
+
+  fChunkCmd = new G4UIcmdWithAnInteger("/run/until/chunk", this);
+  fChunkCmd->SetGuidance("Set the smallest number of events per chunk");
+  fChunkCmd->SetGuidance("(later chunks are sized from the current uncertainty)");
+  fChunkCmd->SetParameterName("n", false);
+  fChunkCmd->SetRange("n>0");
+  fChunkCmd->AvailableForStates(G4State_PreInit, G4State_Idle);
+  fChunkCmd->SetToBeBroadcasted(false);
+
+  fMinEventsCmd = new G4UIcmdWithAnInteger("/run/until/minEvents", this);
+  fMinEventsCmd->SetGuidance("Never stop as converged before this number of events");
+  fMinEventsCmd->SetParameterName("n", false);
+  fMinEventsCmd->SetRange("n>=0");
+  fMinEventsCmd->AvailableForStates(G4State_PreInit, G4State_Idle);
+  fMinEventsCmd->SetToBeBroadcasted(false);
+
+  fMaxEventsCmd = new G4UIcmdWithAnInteger("/run/until/maxEvents", this);
+  fMaxEventsCmd->SetGuidance("Stop after this number of events even if not converged");
+  fMaxEventsCmd->SetParameterName("n", false);
+  fMaxEventsCmd->SetRange("n>0");
+  fMaxEventsCmd->AvailableForStates(G4State_PreInit, G4State_Idle);
+  fMaxEventsCmd->SetToBeBroadcasted(false);
+
+  fWallTimeCmd = new G4UIcmdWithADoubleAndUnit("/run/until/wallTime", this);
+  fWallTimeCmd->SetGuidance("Set the wall-time budget (0 = no limit); no chunk is started");
+  fWallTimeCmd->SetGuidance("that is expected to end after the budget");
+  fWallTimeCmd->SetParameterName("time", false);
+  fWallTimeCmd->SetRange("time>=0");
+  fWallTimeCmd->SetDefaultUnit("s");
+  fWallTimeCmd->AvailableForStates(G4State_PreInit, G4State_Idle);
+  fWallTimeCmd->SetToBeBroadcasted(false);
+
+  fBinCmd = new G4UIcmdWithAString("/run/until/bin", this);
+  fBinCmd->SetGuidance("Also require the relative uncertainty in a bin of the entry spectra:");
+  fBinCmd->SetGuidance("  energy <i> : log10(E/MeV) bin, 48 bins in [-3, 5)");
+  fBinCmd->SetGuidance("  theta <i>  : theta bin, 36 bins in [0, 180) deg");
+  fBinCmd->SetParameterName("spectrumAndBin", false);
+  fBinCmd->AvailableForStates(G4State_PreInit, G4State_Idle);
+  fBinCmd->SetToBeBroadcasted(false);
+
+  fClearBinsCmd = new G4UIcmdWithoutParameter("/run/until/clearBins", this);
+  fClearBinsCmd->SetGuidance("Only the transmission decides the convergence");
+  fClearBinsCmd->AvailableForStates(G4State_PreInit, G4State_Idle);
+  fClearBinsCmd->SetToBeBroadcasted(false);
+}
+
+AdaptiveRunMessenger::~AdaptiveRunMessenger()
+{
+  delete fBeamUntilCmd;
+  delete fChunkCmd;
+  delete fMinEventsCmd;
+  delete fMaxEventsCmd;
+  delete fWallTimeCmd;
+  delete fBinCmd;
+  delete fClearBinsCmd;
+  delete fUntilDir;
+}
+
+void AdaptiveRunMessenger::SetNewValue(G4UIcommand* cmd, G4String val)
+{
+  if (cmd == fBeamUntilCmd) {
+    fAdaptive->BeamUntil(fBeamUntilCmd->GetNewDoubleValue(val));
+  }
+  else if (cmd == fChunkCmd) {
+    fAdaptive->SetChunkSize(fChunkCmd->GetNewIntValue(val));
+  }
+  else if (cmd == fMinEventsCmd) {
+    fAdaptive->SetMinEvents(fMinEventsCmd->GetNewIntValue(val));
+  }
+  else if (cmd == fMaxEventsCmd) {
+    fAdaptive->SetMaxEvents(fMaxEventsCmd->GetNewIntValue(val));
+  }
+  else if (cmd == fWallTimeCmd) {
+    fAdaptive->SetWallTime(fWallTimeCmd->GetNewDoubleValue(val) / s);
+  }
+  else if (cmd == fBinCmd) {
+    std::istringstream is(val);
+    G4String spectrum;
+    G4int bin = -1;
+    is >> spectrum >> bin;
+    G4int bins = (spectrum == "energy") ? EntryObservables::kEnergyBins
+               : (spectrum == "theta") ? EntryObservables::kThetaBins : 0;
+    if (bin < 0 || bin >= bins) {
+      G4ExceptionDescription msg;
+      msg << "Invalid spectrum bin \"" << val << "\" (energy 0..."
+          << EntryObservables::kEnergyBins - 1 << " or theta 0..."
+          << EntryObservables::kThetaBins - 1 << ")";
+      G4Exception("AdaptiveRunMessenger::SetNewValue()", "MyCode0013", JustWarning, msg);
+      return;
+    }
+    fAdaptive->AddBin(spectrum == "energy" ? AdaptiveRun::Spectrum::Energy
+                                           : AdaptiveRun::Spectrum::Theta, bin);
+  }
+  else if (cmd == fClearBinsCmd) {
+    fAdaptive->ClearBins();
+  }
+}
+
+}  // namespace B4
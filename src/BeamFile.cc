@@ -0,0 +1,92 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+//
+/// \file B4/B4a/src/BeamFile.cc
+/// \brief Implementation of the B4::BeamFile class
+
+#include "BeamFile.hh"
+
+#include "G4Exception.hh"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace B4
+{
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+BeamFile::BeamFile(const G4String& path)
+  : fPath(path)
+{
+  G4ExceptionDescription msg;
+  int fd = ::open(path.c_str(), O_RDONLY);
+  struct stat st;
+  if (fd < 0 || ::fstat(fd, &st) != 0
+      || (std::size_t)st.st_size < sizeof(BeamFormat::FileHeader)) {
+    if (fd >= 0) ::close(fd);
+    msg << "Cannot open beam file " << path << ".";
+    G4Exception("BeamFile::BeamFile()", "MyCode0007", JustWarning, msg);
+    return;
+  }
+
+  fLength = st.st_size;
+  void* addr = ::mmap(nullptr, fLength, PROT_READ, MAP_SHARED, fd, 0);
+  ::close(fd);
+  if (addr == MAP_FAILED) {
+    msg << "Cannot map beam file " << path << ".";
+    G4Exception("BeamFile::BeamFile()", "MyCode0007", JustWarning, msg);
+    return;
+  }
+  fAddress = addr;
+
+  const auto* header = static_cast<const BeamFormat::FileHeader*>(fAddress);
+  std::size_t available = (fLength - sizeof(BeamFormat::FileHeader)) / sizeof(BeamFormat::Record);
+  if (!BeamFormat::IsValid(*header) || header->nrecords == 0 || header->nrecords > available) {
+    msg << path << " is not a valid beam file (or it is empty).";
+    G4Exception("BeamFile::BeamFile()", "MyCode0007", JustWarning, msg);
+    return;
+  }
+
+  // 事件号大体递增，按顺序读取：提示内核预读
+  ::madvise(fAddress, fLength, MADV_SEQUENTIAL);
+  fRecords = reinterpret_cast<const BeamFormat::Record*>(
+    static_cast<const char*>(fAddress) + sizeof(BeamFormat::FileHeader));
+  fSize = header->nrecords;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+BeamFile::~BeamFile()
+{
+  if (fAddress) ::munmap(fAddress, fLength);
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+}  // namespace B4
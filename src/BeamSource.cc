@@ -0,0 +1,345 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+//
+/// \file B4/B4a/src/BeamSource.cc
+/// \brief Implementation of the B4::BeamSource class
+
+#include "BeamSource.hh"
+#include "BeamSourceMessenger.hh"
+#include "BeamFile.hh"
+
+#include "G4Exception.hh"
+#include "G4ParticleTable.hh"
+#include "G4PhysicalConstants.hh"
+#include "G4SystemOfUnits.hh"
+#include "G4UnitsTable.hh"
+#include "G4ios.hh"
+#include "Randomize.hh"
+
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <sstream>
+
+namespace B4
+{
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+BeamSource::BeamSource()
+  : fRadius(2.5*cm),
+    fSigmaX(1.*cm), fSigmaY(1.*cm),
+    fEmitX(1.*mm*mrad), fEmitY(1.*mm*mrad),
+    fBetaX(1.*m), fBetaY(1.*m)
+{
+  fMessenger = new BeamSourceMessenger(this);
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+BeamSource::~BeamSource()
+{
+  delete fMessenger;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void BeamSource::SetTwiss(G4double betaX, G4double alphaX, G4double betaY, G4double alphaY)
+{
+  if (betaX <= 0. || betaY <= 0.) {
+    G4ExceptionDescription msg;
+    msg << "Twiss beta must be positive, command ignored.";
+    G4Exception("BeamSource::SetTwiss()", "MyCode0008", JustWarning, msg);
+    return;
+  }
+  fBetaX = betaX;
+  fAlphaX = alphaX;
+  fBetaY = betaY;
+  fAlphaY = alphaY;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void BeamSource::Fill(BeamBatch& batch, G4double nominalEnergy) const
+{
+  const std::size_t n = std::max<std::size_t>(fBatchSize, 1);
+  batch.particles.resize(n);
+  batch.next = 0;
+
+  // 整批一次取随机数：每个粒子需要的高斯数与均匀数
+  std::size_t nGauss = (fProfile == Profile::Uniform ? 0 : 4)
+                     + (fSpectrum == Spectrum::Gauss ? 1 : 0);
+  std::size_t nFlat = (fProfile == Profile::Uniform ? 2 : 0)
+                    + (fSpectrum == Spectrum::Flat || fSpectrum == Spectrum::LogFlat
+                       || fSpectrum == Spectrum::Table || fSpectrum == Spectrum::List ? 1 : 0)
+                    + (fSpeciesCdf.size() > 1 ? 1 : 0);
+  batch.gauss.resize(n * nGauss);
+  batch.flat.resize(n * nFlat);
+  if (nGauss > 0) G4RandGauss::shootArray((G4int)batch.gauss.size(), batch.gauss.data());
+  if (nFlat > 0) G4RandFlat::shootArray((G4int)batch.flat.size(), batch.flat.data());
+
+  const G4double* g = batch.gauss.data();
+  const G4double* u = batch.flat.data();
+  for (auto& particle : batch.particles) {
+    G4double x = 0., y = 0., xp = 0., yp = 0.;
+    switch (fProfile) {
+      case Profile::Uniform: {
+        G4double r = fRadius * std::sqrt(u[0]);
+        G4double phi = twopi * u[1];
+        x = r * std::cos(phi);
+        y = r * std::sin(phi);
+        u += 2;
+        break;
+      }
+      case Profile::Gaussian:
+        x = fSigmaX * g[0];
+        y = fSigmaY * g[1];
+        xp = fDivX * g[2];
+        yp = fDivY * g[3];
+        g += 4;
+        break;
+      case Profile::Emittance:
+        // x = sqrt(eps*beta) g1, x' = sqrt(eps/beta) (g2 - alpha g1)
+        x = std::sqrt(fEmitX * fBetaX) * g[0];
+        xp = std::sqrt(fEmitX / fBetaX) * (g[1] - fAlphaX * g[0]);
+        y = std::sqrt(fEmitY * fBetaY) * g[2];
+        yp = std::sqrt(fEmitY / fBetaY) * (g[3] - fAlphaY * g[2]);
+        g += 4;
+        break;
+    }
+    particle.position.set(x, y, 0.);
+    particle.direction = G4ThreeVector(xp, yp, 1.).unit();
+    particle.time = 0.;
+
+    G4double energy = nominalEnergy;
+    switch (fSpectrum) {
+      case Spectrum::Mono:
+        break;
+      case Spectrum::Gauss:
+        energy = std::max(nominalEnergy * (1. + fEnergySpread * g[0]), 0.);
+        g += 1;
+        break;
+      case Spectrum::Flat:
+        energy = fEmin + (fEmax - fEmin) * u[0];
+        u += 1;
+        break;
+      case Spectrum::LogFlat:
+        // 每个对数能量区间的初级粒子数相同 (响应矩阵的能量网格)
+        energy = fEmin * std::pow(fEmax / fEmin, u[0]);
+        u += 1;
+        break;
+      case Spectrum::Table:
+        energy = fTableCdf.empty() ? nominalEnergy : SampleTable(u[0]);
+        u += 1;
+        break;
+      case Spectrum::List: {
+        std::size_t n = fEnergyList.size();
+        energy = n == 0 ? nominalEnergy : fEnergyList[std::min(std::size_t(u[0] * n), n - 1)];
+        u += 1;
+        break;
+      }
+    }
+    particle.energy = energy;
+
+    // 混合束流：按权重选择粒子种类
+    particle.species = -1;
+    if (fSpeciesCdf.size() == 1) {
+      particle.species = 0;
+    }
+    else if (fSpeciesCdf.size() > 1) {
+      auto it = std::upper_bound(fSpeciesCdf.begin(), fSpeciesCdf.end(), u[0]);
+      particle.species = static_cast<G4int>(
+        std::min<std::ptrdiff_t>(it - fSpeciesCdf.begin(), fSpeciesCdf.size() - 1));
+      u += 1;
+    }
+  }
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+G4double BeamSource::SampleTable(G4double u) const
+{
+  // 累积分布中查找 bin，在 bin 内线性插值
+  auto it = std::upper_bound(fTableCdf.begin(), fTableCdf.end(), u);
+  std::size_t i = std::min<std::size_t>(std::max<std::ptrdiff_t>(it - fTableCdf.begin(), 1),
+                                        fTableCdf.size() - 1) - 1;
+  G4double width = fTableCdf[i + 1] - fTableCdf[i];
+  G4double f = width > 0. ? (u - fTableCdf[i]) / width : 0.;
+  return fTableEdges[i] + f * (fTableEdges[i + 1] - fTableEdges[i]);
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+G4bool BeamSource::LoadSpectrum(const G4String& path)
+{
+  // 每行：bin 下边界 [MeV]  权重；最后一行只给出上边界
+  std::ifstream in(path.c_str());
+  std::vector<G4double> edges, weights;
+  std::string line;
+  while (std::getline(in, line)) {
+    if (line.empty() || line[0] == '#') continue;
+    std::istringstream is(line);
+    G4double edge = 0., weight = 0.;
+    if (!(is >> edge)) continue;
+    is >> weight;
+    edges.push_back(edge * MeV);
+    weights.push_back(std::max(weight, 0.));
+  }
+
+  std::vector<G4double> cdf(edges.size(), 0.);
+  for (std::size_t i = 1; i < edges.size(); ++i) cdf[i] = cdf[i - 1] + weights[i - 1];
+  G4bool sorted = std::is_sorted(edges.begin(), edges.end());
+  if (edges.size() < 2 || !sorted || cdf.back() <= 0.) {
+    G4ExceptionDescription msg;
+    msg << "Cannot read an energy spectrum from " << path << "." << G4endl
+        << "Expected lines \"lower edge [MeV] weight\" with increasing edges.";
+    G4Exception("BeamSource::LoadSpectrum()", "MyCode0008", JustWarning, msg);
+    return false;
+  }
+  for (auto& value : cdf) value /= cdf.back();
+
+  fTableEdges = std::move(edges);
+  fTableCdf = std::move(cdf);
+  fSpectrum = Spectrum::Table;
+  return true;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+G4bool BeamSource::SetEnergyList(const std::vector<G4double>& energies)
+{
+  if (energies.empty()
+      || std::any_of(energies.begin(), energies.end(), [](G4double e) { return e <= 0.; })) {
+    G4ExceptionDescription msg;
+    msg << "The energy list must contain positive energies, command ignored.";
+    G4Exception("BeamSource::SetEnergyList()", "MyCode0020", JustWarning, msg);
+    return false;
+  }
+  fEnergyList = energies;
+  fSpectrum = Spectrum::List;
+  return true;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+G4bool BeamSource::SetSpecies(const std::vector<G4String>& names,
+                              const std::vector<G4double>& weights)
+{
+  // 粒子在物理列表注册时已经构造，这里就可以检查名字
+  auto* table = G4ParticleTable::GetParticleTable();
+  std::vector<G4double> cdf;
+  G4double sum = 0.;
+  for (std::size_t i = 0; i < names.size(); ++i) {
+    if (!table->FindParticle(names[i]) || weights[i] <= 0.) {
+      G4ExceptionDescription msg;
+      msg << "Unknown particle or non-positive weight in the beam species: " << names[i]
+          << " " << weights[i] << ", command ignored.";
+      G4Exception("BeamSource::SetSpecies()", "MyCode0020", JustWarning, msg);
+      return false;
+    }
+    sum += weights[i];
+    cdf.push_back(sum);
+  }
+  for (auto& value : cdf) value /= sum;
+
+  fSpeciesNames = names;
+  fSpeciesCdf = std::move(cdf);
+  return true;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void BeamSource::OpenBeamFile(const G4String& path)
+{
+  fFile.reset();
+  if (path.empty()) return;
+
+  auto file = std::make_unique<BeamFile>(path);
+  if (file->IsOpen()) {
+    G4cout << "Beam file " << path << " : " << file->Size() << " records" << G4endl;
+    fFile = std::move(file);
+  }
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void BeamSource::Print() const
+{
+  G4cout << "========== Beam Source ==========\n";
+  if (fFile) {
+    G4cout << " beam file  : " << fFile->GetPath() << " (" << fFile->Size() << " records)\n"
+           << "=================================" << G4endl;
+    return;
+  }
+
+  switch (fProfile) {
+    case Profile::Uniform:
+      G4cout << " profile    : uniform disk, radius " << G4BestUnit(fRadius, "Length") << "\n";
+      break;
+    case Profile::Gaussian:
+      G4cout << " profile    : gaussian, sigma " << G4BestUnit(fSigmaX, "Length") << " x "
+             << G4BestUnit(fSigmaY, "Length") << ", divergence " << fDivX / mrad << " x "
+             << fDivY / mrad << " mrad\n";
+      break;
+    case Profile::Emittance:
+      G4cout << " profile    : emittance " << fEmitX / (mm*mrad) << " x " << fEmitY / (mm*mrad)
+             << " mm mrad, beta " << G4BestUnit(fBetaX, "Length") << " x "
+             << G4BestUnit(fBetaY, "Length") << ", alpha " << fAlphaX << " x " << fAlphaY << "\n";
+      break;
+  }
+
+  G4cout << " spectrum   : ";
+  switch (fSpectrum) {
+    case Spectrum::Mono: G4cout << "mono (/gun/energy)\n"; break;
+    case Spectrum::Gauss: G4cout << "gauss, relative spread " << fEnergySpread << "\n"; break;
+    case Spectrum::Flat:
+      G4cout << "flat " << G4BestUnit(fEmin, "Energy") << " - " << G4BestUnit(fEmax, "Energy") << "\n";
+      break;
+    case Spectrum::LogFlat:
+      G4cout << "logflat " << G4BestUnit(fEmin, "Energy") << " - " << G4BestUnit(fEmax, "Energy")
+             << "\n";
+      break;
+    case Spectrum::Table: G4cout << "table, " << fTableCdf.size() << " edges\n"; break;
+    case Spectrum::List:
+      G4cout << "list,";
+      for (G4double e : fEnergyList) G4cout << " " << G4BestUnit(e, "Energy");
+      G4cout << "\n";
+      break;
+  }
+  G4cout << " species    : ";
+  if (fSpeciesNames.empty()) G4cout << "/gun/particle";
+  for (std::size_t i = 0; i < fSpeciesNames.size(); ++i) {
+    G4double fraction = fSpeciesCdf[i] - (i > 0 ? fSpeciesCdf[i - 1] : 0.);
+    G4cout << fSpeciesNames[i] << " (" << fraction << ") ";
+  }
+  G4cout << "\n";
+  G4cout << " batch size : " << fBatchSize << "\n"
+         << "=================================" << G4endl;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+}  // namespace B4
@@ -0,0 +1,261 @@
+#include "BeamSourceMessenger.hh"
+#include "BeamSource.hh"
+
+#include "G4UIdirectory.hh"
+#include "G4UIcommand.hh"
+#include "G4UIparameter.hh"
+#include "G4UIcmdWithAString.hh"
+#include "G4UIcmdWithADouble.hh"
+#include "G4UIcmdWithADoubleAndUnit.hh"
+#include "G4UIcmdWithAnInteger.hh"
+#include "G4UIcmdWithoutParameter.hh"
+#include "G4SystemOfUnits.hh"
+
+#include <cstdlib>
+#include <sstream>
+#include <vector>
+
+namespace
+{
+// <x> <y> [unit] 形式的命令
+G4UIcommand* MakePairCommand(const char* path, G4UImessenger* messenger,
+                             const char* defaultUnit)
+{
+  auto* cmd = new G4UIcommand(path, messenger);
+  cmd->SetParameter(new G4UIparameter("x", 'd', false));
+  cmd->SetParameter(new G4UIparameter("y", 'd', false));
+  auto* unit = new G4UIparameter("unit", 's', true);
+  unit->SetDefaultValue(defaultUnit);
+  cmd->SetParameter(unit);
+  cmd->AvailableForStates(G4State_PreInit, G4State_Idle);
+  return cmd;
+}
+
+// 整个 token 是一个数
+G4bool IsNumber(const G4String& token)
+{
+  char* end = nullptr;
+  std::strtod(token.c_str(), &end);
+  return end != token.c_str() && *end == '\0';
+}
+}  // namespace
+
+namespace B4 {
+
+BeamSourceMessenger::BeamSourceMessenger(BeamSource* beam)
+ : fBeam(beam)
+{
+  fBeamDir = new G4UIdirectory("/beam/");
+  fBeamDir->SetGuidance("Beam phase space, energy spectrum and beam-file input");
+  fBeamDir->SetGuidance("The particle and the nominal energy are set with /gun/particle, /gun/energy");
+
+  fProfileCmd = new G4UIcmdWithAString("/beam/profile", this);
+  fProfileCmd->SetGuidance("Select the transverse profile (spot and divergence)");
+  fProfileCmd->SetGuidance("  uniform   : uniform disk (/beam/radius), parallel (default)");
+  fProfileCmd->SetGuidance("  gaussian  : /beam/sigma and /beam/divergence, uncorrelated");
+  fProfileCmd->SetGuidance("  emittance : /beam/emittance and /beam/twiss");
+  fProfileCmd->SetParameterName("profile", false);
+  fProfileCmd->SetCandidates("uniform gaussian emittance");
+  fProfileCmd->AvailableForStates(G4State_PreInit, G4State_Idle);
+
+  fRadiusCmd = new G4UIcmdWithADoubleAndUnit("/beam/radius", this);
+  fRadiusCmd->SetGuidance("Set the radius of the uniform spot");
+  fRadiusCmd->SetParameterName("radius", false);
+  fRadiusCmd->SetRange("radius>=0");
+  fRadiusCmd->SetDefaultUnit("cm");
+  fRadiusCmd->AvailableForStates(G4State_PreInit, G4State_Idle);
+
+  fSigmaCmd = MakePairCommand("/beam/sigma", this, "mm");
+  fSigmaCmd->SetGuidance("Set the Gaussian spot size sigma_x sigma_y");
+
+  fDivergenceCmd = MakePairCommand("/beam/divergence", this, "mrad");
+  fDivergenceCmd->SetGuidance("Set the Gaussian divergence sigma_x' sigma_y'");
+
+  fEmittanceCmd = new G4UIcommand("/beam/emittance", this);
+  fEmittanceCmd->SetGuidance("Set the rms emittance eps_x eps_y in mm mrad");
+  fEmittanceCmd->SetParameter(new G4UIparameter("x", 'd', false));
+  fEmittanceCmd->SetParameter(new G4UIparameter("y", 'd', false));
+  fEmittanceCmd->AvailableForStates(G4State_PreInit, G4State_Idle);
+
+  fTwissCmd = new G4UIcommand("/beam/twiss", this);
+  fTwissCmd->SetGuidance("Set the Twiss parameters at the source: betaX alphaX betaY alphaY [unit of beta]");
+  fTwissCmd->SetParameter(new G4UIparameter("betaX", 'd', false));
+  fTwissCmd->SetParameter(new G4UIparameter("alphaX", 'd', false));
+  fTwissCmd->SetParameter(new G4UIparameter("betaY", 'd', false));
+  fTwissCmd->SetParameter(new G4UIparameter("alphaY", 'd', false));
+  auto* betaUnit = new G4UIparameter("unit", 's', true);
+  betaUnit->SetDefaultValue("m");
+  fTwissCmd->SetParameter(betaUnit);
+  fTwissCmd->AvailableForStates(G4State_PreInit, G4State_Idle);
+
+  fSpectrumCmd = new G4UIcmdWithAString("/beam/spectrum", this);
+  fSpectrumCmd->SetGuidance("Select the energy spectrum");
+  fSpectrumCmd->SetGuidance("  mono  : /gun/energy (default)");
+  fSpectrumCmd->SetGuidance("  gauss : /gun/energy with the relative /beam/energySpread");
+  fSpectrumCmd->SetGuidance("  flat  : uniform in /beam/energyRange");
+  fSpectrumCmd->SetGuidance("  logflat : uniform in log E over /beam/energyRange (response matrices)");
+  fSpectrumCmd->SetGuidance("  table : spectrum read with /beam/spectrumFile");
+  fSpectrumCmd->SetGuidance("  list  : the energies of /beam/energies, equally often");
+  fSpectrumCmd->SetParameterName("spectrum", false);
+  fSpectrumCmd->SetCandidates("mono gauss flat logflat table list");
+  fSpectrumCmd->AvailableForStates(G4State_PreInit, G4State_Idle);
+
+  fSpreadCmd = new G4UIcmdWithADouble("/beam/energySpread", this);
+  fSpreadCmd->SetGuidance("Set the relative rms energy spread of the gauss spectrum");
+  fSpreadCmd->SetParameterName("spread", false);
+  fSpreadCmd->SetRange("spread>=0");
+  fSpreadCmd->AvailableForStates(G4State_PreInit, G4State_Idle);
+
+  fRangeCmd = MakePairCommand("/beam/energyRange", this, "MeV");
+  fRangeCmd->SetGuidance("Set the kinetic energy range of the flat and logflat spectra");
+
+  fSpectrumFileCmd = new G4UIcmdWithAString("/beam/spectrumFile", this);
+  fSpectrumFileCmd->SetGuidance("Read a binned spectrum and select it: lines \"lower edge [MeV] weight\",");
+  fSpectrumFileCmd->SetGuidance("the last line gives the upper edge of the last bin");
+  fSpectrumFileCmd->SetParameterName("file", false);
+  fSpectrumFileCmd->AvailableForStates(G4State_PreInit, G4State_Idle);
+
+  fEnergiesCmd = new G4UIcmdWithAString("/beam/energies", this);
+  fEnergiesCmd->SetGuidance("Set a list of kinetic energies and select it: \"e1 e2 ... [unit]\"");
+  fEnergiesCmd->SetGuidance("(default unit MeV). Every primary takes one of them, equally often");
+  fEnergiesCmd->SetParameterName("energies", false);
+  fEnergiesCmd->AvailableForStates(G4State_PreInit, G4State_Idle);
+
+  fSpeciesCmd = new G4UIcmdWithAString("/beam/species", this);
+  fSpeciesCmd->SetGuidance("Mixed beam: \"name [weight] name [weight] ...\" (default weight 1),");
+  fSpeciesCmd->SetGuidance("the species is sampled per primary. No argument: /gun/particle only");
+  fSpeciesCmd->SetParameterName("species", true);
+  fSpeciesCmd->SetDefaultValue("");
+  fSpeciesCmd->AvailableForStates(G4State_PreInit, G4State_Idle);
+
+  fFileCmd = new G4UIcmdWithAString("/beam/file", this);
+  fFileCmd->SetGuidance("Read the primaries from a beam file (see tools/b4beamconv);");
+  fFileCmd->SetGuidance("event i uses record i modulo the file size. No argument: back to sampling");
+  fFileCmd->SetParameterName("file", true);
+  fFileCmd->SetDefaultValue("");
+  fFileCmd->AvailableForStates(G4State_PreInit, G4State_Idle);
+
+  fBatchCmd = new G4UIcmdWithAnInteger("/beam/batchSize", this);
+  fBatchCmd->SetGuidance("Number of primaries sampled at once per thread.");
+  fBatchCmd->SetGuidance("With 1 every primary is sampled in its own event (event-by-event reproducible)");
+  fBatchCmd->SetParameterName("n", false);
+  fBatchCmd->SetRange("n>0");
+  fBatchCmd->AvailableForStates(G4State_PreInit, G4State_Idle);
+
+  fPrintCmd = new G4UIcmdWithoutParameter("/beam/print", this);
+  fPrintCmd->SetGuidance("Print the beam description");
+  fPrintCmd->AvailableForStates(G4State_PreInit, G4State_Idle);
+}
+
+BeamSourceMessenger::~BeamSourceMessenger()
+{
+  delete fProfileCmd;
+  delete fRadiusCmd;
+  delete fSigmaCmd;
+  delete fDivergenceCmd;
+  delete fEmittanceCmd;
+  delete fTwissCmd;
+  delete fSpectrumCmd;
+  delete fSpreadCmd;
+  delete fRangeCmd;
+  delete fSpectrumFileCmd;
+  delete fEnergiesCmd;
+  delete fSpeciesCmd;
+  delete fFileCmd;
+  delete fBatchCmd;
+  delete fPrintCmd;
+  delete fBeamDir;
+}
+
+void BeamSourceMessenger::SetNewValue(G4UIcommand* cmd, G4String val)
+{
+  if (cmd == fProfileCmd) {
+    fBeam->SetProfile(val == "gaussian"    ? BeamSource::Profile::Gaussian
+                      : val == "emittance" ? BeamSource::Profile::Emittance
+                                           : BeamSource::Profile::Uniform);
+  }
+  else if (cmd == fRadiusCmd) {
+    fBeam->SetRadius(fRadiusCmd->GetNewDoubleValue(val));
+  }
+  else if (cmd == fSigmaCmd || cmd == fDivergenceCmd || cmd == fRangeCmd) {
+    std::istringstream is(val);
+    G4double x = 0., y = 0.;
+    G4String unit;
+    is >> x >> y >> unit;
+    G4double scale = G4UIcommand::ValueOf(unit);
+    if (cmd == fSigmaCmd) fBeam->SetSigma(x * scale, y * scale);
+    else if (cmd == fDivergenceCmd) fBeam->SetDivergence(x * scale, y * scale);
+    else fBeam->SetEnergyRange(x * scale, y * scale);
+  }
+  else if (cmd == fEmittanceCmd) {
+    std::istringstream is(val);
+    G4double x = 0., y = 0.;
+    is >> x >> y;
+    fBeam->SetEmittance(x * mm*mrad, y * mm*mrad);
+  }
+  else if (cmd == fTwissCmd) {
+    std::istringstream is(val);
+    G4double betaX = 0., alphaX = 0., betaY = 0., alphaY = 0.;
+    G4String unit;
+    is >> betaX >> alphaX >> betaY >> alphaY >> unit;
+    G4double scale = G4UIcommand::ValueOf(unit);
+    fBeam->SetTwiss(betaX * scale, alphaX, betaY * scale, alphaY);
+  }
+  else if (cmd == fSpectrumCmd) {
+    fBeam->SetSpectrum(val == "gauss"   ? BeamSource::Spectrum::Gauss
+                       : val == "flat"  ? BeamSource::Spectrum::Flat
+                       : val == "logflat" ? BeamSource::Spectrum::LogFlat
+                       : val == "table" ? BeamSource::Spectrum::Table
+                       : val == "list"  ? BeamSource::Spectrum::List
+                                        : BeamSource::Spectrum::Mono);
+  }
+  else if (cmd == fSpreadCmd) {
+    fBeam->SetEnergySpread(fSpreadCmd->GetNewDoubleValue(val));
+  }
+  else if (cmd == fSpectrumFileCmd) {
+    fBeam->LoadSpectrum(val);
+  }
+  else if (cmd == fEnergiesCmd) {
+    // 最后一个 token 不是数时为单位
+    std::istringstream is(val);
+    std::vector<G4String> tokens;
+    G4String token;
+    while (is >> token) tokens.push_back(token);
+    G4double scale = MeV;
+    if (!tokens.empty() && !IsNumber(tokens.back())) {
+      scale = G4UIcommand::ValueOf(tokens.back());
+      tokens.pop_back();
+    }
+    std::vector<G4double> energies;
+    for (const auto& value : tokens) energies.push_back(std::strtod(value.c_str(), nullptr) * scale);
+    fBeam->SetEnergyList(energies);
+  }
+  else if (cmd == fSpeciesCmd) {
+    // 粒子名后面可以跟一个权重
+    std::istringstream is(val);
+    std::vector<G4String> names;
+    std::vector<G4double> weights;
+    G4String token;
+    while (is >> token) {
+      if (IsNumber(token) && !names.empty()) {
+        weights.back() = std::strtod(token.c_str(), nullptr);
+      }
+      else {
+        names.push_back(token);
+        weights.push_back(1.);
+      }
+    }
+    fBeam->SetSpecies(names, weights);
+  }
+  else if (cmd == fFileCmd) {
+    fBeam->OpenBeamFile(val);
+  }
+  else if (cmd == fBatchCmd) {
+    fBeam->SetBatchSize(fBatchCmd->GetNewIntValue(val));
+  }
+  else if (cmd == fPrintCmd) {
+    fBeam->Print();
+  }
+}
+
+}  // namespace B4
@@ -0,0 +1,387 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+//
+/// \file B4/B4a/src/Checkpoint.cc
+/// \brief Implementation of the B4::Checkpoint class
+
+#include "Checkpoint.hh"
+#include "CheckpointMessenger.hh"
+#include "RunAction.hh"
+#include "SeedService.hh"
+
+#include "G4RunManager.hh"
+#include "G4Run.hh"
+#include "G4Timer.hh"
+#include "G4Exception.hh"
+#include "G4ios.hh"
+
+#include <algorithm>
+#include <climits>
+#include <cmath>
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include <map>
+#include <sstream>
+
+namespace
+{
+G4String FormatName(const B4::RunAction* runAction)
+{
+  if (!runAction->IsOutputEnabled()) return "none";
+  switch (runAction->GetOutputFormat()) {
+    case B4::RunAction::OutputFormat::Columnar: return "columnar";
+    case B4::RunAction::OutputFormat::Summary: return "summary";
+    case B4::RunAction::OutputFormat::Response: return "response";
+    default: return "root";
+  }
+}
+}  // namespace
+
+namespace B4
+{
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+Checkpoint::Checkpoint(SeedService* seeds)
+  : fSeeds(seeds)
+{
+  fMessenger = new CheckpointMessenger(this);
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+Checkpoint::~Checkpoint()
+{
+  delete fMessenger;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+G4String Checkpoint::FilePath() const
+{
+  // 分片作业：每个分片一个检查点 (xxx.ckpt -> xxx_shard<k>of<N>.ckpt)
+  if (!fSeeds->IsSharded()) return fFile;
+  std::filesystem::path path(fFile.c_str());
+  G4String ext = path.has_extension() ? path.extension().string() : ".ckpt";
+  path.replace_filename(path.stem().string() + "_shard" + std::to_string(fSeeds->GetShardIndex())
+                        + "of" + std::to_string(fSeeds->GetShardCount()) + ext);
+  return path.string();
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+G4bool Checkpoint::Load(State& state) const
+{
+  // key = value，与分片元数据相同的格式；每个 chunk 一行 "chunk = ..."
+  std::ifstream in(FilePath().c_str());
+  if (!in) return false;
+  std::map<G4String, G4String> info;
+  std::vector<G4String> chunks;
+  std::string line;
+  while (std::getline(in, line)) {
+    auto eq = line.find(" = ");
+    if (eq == std::string::npos) continue;
+    G4String key = line.substr(0, eq);
+    G4String value = line.substr(eq + 3);
+    if (key == "chunk") chunks.push_back(value);
+    else info[key] = value;
+  }
+  if (info["format"] != "B4CHECKPOINT") {
+    G4ExceptionDescription msg;
+    msg << FilePath() << " is not a checkpoint file.";
+    G4Exception("Checkpoint::Load()", "MyCode0017", JustWarning, msg);
+    return false;
+  }
+  try {
+    state.configHash = std::stoull(info.at("config_hash"), nullptr, 16);
+    state.masterSeed = std::stoull(info.at("master_seed"));
+    state.engine = info.at("engine");
+    state.shard = std::stoi(info.at("shard"));
+    state.shards = std::stoi(info.at("shards"));
+    state.run = std::stoi(info.at("run"));
+    state.firstEvent = std::stoll(info.at("first_event"));
+    state.targetEvents = std::stoll(info.at("target_events"));
+    state.doneEvents = std::stoll(info.at("done_events"));
+    state.outputFormat = info.at("output_format");
+    state.passed = std::stoll(info.at("passed"));
+    state.blocked = std::stoll(info.at("blocked"));
+    state.transmitted = std::stod(info.at("transmitted"));
+    state.transmitted2 = std::stod(info.at("transmitted2"));
+    state.steps = std::stoll(info.at("steps"));
+  }
+  catch (const std::exception&) {
+    G4ExceptionDescription msg;
+    msg << "The checkpoint " << FilePath() << " is incomplete or damaged.";
+    G4Exception("Checkpoint::Load()", "MyCode0017", JustWarning, msg);
+    return false;
+  }
+  state.chunks = std::move(chunks);
+  return true;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+G4bool Checkpoint::Matches(const State& state) const
+{
+  G4String reason;
+  if (state.configHash != RunAction::ConfigHash()) reason = "configuration (commands, geometry, beam or physics)";
+  else if (state.engine != fSeeds->GetEngineName()) reason = "random engine (exampleB4a -r)";
+  else if (state.shard != fSeeds->GetShardIndex() || state.shards != fSeeds->GetShardCount()) {
+    reason = "shard (exampleB4a --shard)";
+  }
+  if (reason.empty()) return true;
+
+  G4ExceptionDescription msg;
+  msg << "The checkpoint " << FilePath() << " belongs to a different " << reason << "."
+      << G4endl << "Run the same macro and options, or select another /run/checkpoint/file.";
+  G4Exception("Checkpoint::Matches()", "MyCode0017", JustWarning, msg);
+  return false;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+G4bool Checkpoint::Save(const State& state) const
+{
+  // 先写临时文件再改名：进程在任何时刻中断，检查点都是完整的
+  G4String path = FilePath();
+  G4String temporary = path + ".tmp";
+  {
+    std::ofstream out(temporary.c_str(), std::ios::trunc);
+    out << "format = B4CHECKPOINT\n"
+        << "version = 1\n"
+        << "config_hash = " << std::hex << state.configHash << std::dec << "\n"
+        << "master_seed = " << state.masterSeed << "\n"
+        << "engine = " << state.engine << "\n"
+        << "shard = " << state.shard << "\n"
+        << "shards = " << state.shards << "\n"
+        << "run = " << state.run << "\n"
+        << "first_event = " << state.firstEvent << "\n"
+        << "target_events = " << state.targetEvents << "\n"
+        << "done_events = " << state.doneEvents << "\n"
+        << "next_event = " << state.firstEvent + state.doneEvents << "\n"
+        << "output_format = " << state.outputFormat << "\n"
+        << "passed = " << state.passed << "\n"
+        << "blocked = " << state.blocked << "\n"
+        << std::setprecision(17)
+        << "transmitted = " << state.transmitted << "\n"
+        << "transmitted2 = " << state.transmitted2 << "\n"
+        << std::setprecision(6)
+        << "steps = " << state.steps << "\n";
+    for (const auto& chunk : state.chunks) out << "chunk = " << chunk << "\n";
+    out.flush();
+    if (!out) {
+      G4ExceptionDescription msg;
+      msg << "Cannot write the checkpoint " << temporary;
+      G4Exception("Checkpoint::Save()", "MyCode0017", JustWarning, msg);
+      return false;
+    }
+  }
+  std::error_code error;
+  std::filesystem::rename(temporary.c_str(), path.c_str(), error);
+  if (error) {
+    G4ExceptionDescription msg;
+    msg << "Cannot replace the checkpoint " << path << ": " << error.message();
+    G4Exception("Checkpoint::Save()", "MyCode0017", JustWarning, msg);
+    return false;
+  }
+  return true;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void Checkpoint::BeamOn(G4long events)
+{
+  State state;
+  if (Load(state)) {
+    if (!Matches(state)) return;
+    if (state.targetEvents != events) {
+      G4ExceptionDescription msg;
+      msg << "The checkpoint " << FilePath() << " is a dataset of " << state.targetEvents
+          << " events, not " << events << "." << G4endl
+          << "Use /run/checkpoint/extend to add events to it.";
+      G4Exception("Checkpoint::BeamOn()", "MyCode0017", JustWarning, msg);
+      return;
+    }
+    G4cout << "Checkpoint " << FilePath() << " : " << state.doneEvents << " of "
+           << state.targetEvents << " events done, continuing at event key "
+           << state.firstEvent + state.doneEvents << G4endl;
+  }
+  else {
+    const auto* current = G4RunManager::GetRunManager()->GetCurrentRun();
+    state.configHash = RunAction::ConfigHash();
+    state.masterSeed = fSeeds->GetMasterSeed();
+    state.engine = fSeeds->GetEngineName();
+    state.shard = fSeeds->GetShardIndex();
+    state.shards = fSeeds->GetShardCount();
+    state.run = current ? current->GetRunID() + 1 : 0;
+    // 与分片作业相同的划分：分片 k 的事件键从 k * events 开始
+    state.firstEvent = fSeeds->GetShardIndex() * events;
+    state.targetEvents = events;
+    // 第一个 chunk 之前就写下主种子，第一个 chunk 中断也能复现
+    if (!Save(state)) return;
+  }
+  Run(state);
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void Checkpoint::Extend(G4long events)
+{
+  State state;
+  if (!Load(state)) {
+    G4ExceptionDescription msg;
+    msg << "No checkpoint " << FilePath() << " to extend; start the dataset with"
+        << " /run/checkpoint/beamOn.";
+    G4Exception("Checkpoint::Extend()", "MyCode0017", JustWarning, msg);
+    return;
+  }
+  if (!Matches(state)) return;
+  if (state.shards > 0) {
+    // 分片 k 的事件键范围是 [k*N, (k+1)*N)，加长后会与下一个分片重叠
+    G4ExceptionDescription msg;
+    msg << "A sharded dataset cannot be extended (the event ranges of the shards"
+        << " would overlap); run more shards instead.";
+    G4Exception("Checkpoint::Extend()", "MyCode0017", JustWarning, msg);
+    return;
+  }
+  state.targetEvents += events;
+  G4cout << "Checkpoint " << FilePath() << " : extending to " << state.targetEvents
+         << " events" << G4endl;
+  Run(state);
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void Checkpoint::Run(State& state)
+{
+  auto* runManager = G4RunManager::GetRunManager();
+  auto* runAction = dynamic_cast<RunAction*>(
+    const_cast<G4UserRunAction*>(runManager->GetUserRunAction()));
+  if (!runAction) {
+    G4Exception("Checkpoint::Run()", "MyCode0017", JustWarning,
+                "checkpointed runs need the run action.");
+    return;
+  }
+
+  // 随机数状态 = (主种子, 下一个事件键)：主种子取检查点中的
+  if (fSeeds->GetMasterSeed() != state.masterSeed) {
+    G4cout << "Checkpoint: master seed " << state.masterSeed << " of the dataset" << G4endl;
+    fSeeds->SetMasterSeed(state.masterSeed);
+  }
+  // 每个 chunk 都写出带全部 accumulables 的元数据，供 b4merge 合并
+  runAction->SetWriteShardInfo(true);
+
+  G4Timer timer;
+  timer.Start();
+  G4long simulated = 0;
+  while (state.doneEvents < state.targetEvents) {
+    G4long first = state.firstEvent + state.doneEvents;
+    auto n = static_cast<G4int>(
+      std::min<G4long>({fChunkSize, state.targetEvents - state.doneEvents, INT_MAX}));
+    fSeeds->SetEventWindow(state.run, first);
+    runAction->SetOutputTag("ev" + std::to_string(first));
+    runManager->BeamOn(n);
+
+    // 中止的 chunk 不记入检查点，下次从它的第一个事件重新开始
+    const G4Run* run = runManager->GetCurrentRun();
+    if (!run || run->GetNumberOfEvent() != n) {
+      G4ExceptionDescription msg;
+      msg << "The chunk starting at event key " << first << " did not complete;"
+          << " it is not checkpointed.";
+      G4Exception("Checkpoint::Run()", "MyCode0017", JustWarning, msg);
+      break;
+    }
+    state.doneEvents += n;
+    simulated += n;
+    state.chunks.push_back(runAction->GetShardInfoPath());
+    state.outputFormat = FormatName(runAction);
+    state.passed += runAction->GetPassed();
+    state.blocked += runAction->GetBlocked();
+    state.transmitted += runAction->GetTransmitted();
+    state.transmitted2 += runAction->GetTransmitted2();
+    state.steps += runAction->GetSteps();
+    if (!Save(state)) break;
+
+    timer.Stop();
+    G4cout << "===== checkpoint : " << state.doneEvents << " of " << state.targetEvents
+           << " events (" << state.chunks.size() << " chunks), " << timer.GetRealElapsed()
+           << " s" << G4endl;
+  }
+
+  fSeeds->ClearEventWindow();
+  runAction->SetOutputTag("");
+  runAction->SetWriteShardInfo(false);
+
+  // 整个数据集 (包括以前的进程完成的 chunk)
+  G4long primaries = state.passed + state.blocked;
+  G4double transmission = primaries > 0 ? state.transmitted / primaries : 0.;
+  G4double variance = primaries > 0 ? state.transmitted2 / primaries - transmission * transmission
+                                    : 0.;
+  G4double error = primaries > 0 ? std::sqrt(std::max(variance, 0.) / primaries) : 0.;
+  timer.Stop();
+  std::ostringstream os;
+  os << "========== Checkpointed Run Summary ==========\n"
+     << " Checkpoint            : " << FilePath() << "\n"
+     << " Events                : " << state.doneEvents << " of " << state.targetEvents
+     << " (" << simulated << " in this process)\n"
+     << " Chunks                : " << state.chunks.size() << "\n"
+     << " Transmission          : " << transmission << " +- " << error << "\n"
+     << " Steps                 : " << state.steps << "\n"
+     << " Elapsed time          : " << timer.GetRealElapsed() << " s\n";
+  if (!state.chunks.empty()) {
+    os << " Merge with            : b4merge -o <dataset>";
+    for (const auto& chunk : state.chunks) os << " " << chunk;
+    os << "\n";
+  }
+  os << "=================================";
+  G4cout << os.str() << G4endl;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void Checkpoint::Print() const
+{
+  G4cout << "========== Checkpoint ==========\n"
+         << " File                  : " << FilePath() << "\n"
+         << " Events per chunk      : " << fChunkSize << "\n";
+  State state;
+  if (Load(state)) {
+    G4cout << " Dataset               : " << state.doneEvents << " of " << state.targetEvents
+           << " events, " << state.chunks.size() << " chunks, next event key "
+           << state.firstEvent + state.doneEvents << "\n"
+           << " Master seed           : " << state.masterSeed << " (" << state.engine << ")\n"
+           << " Output format         : " << state.outputFormat << "\n";
+  }
+  else {
+    G4cout << " Dataset               : none\n";
+  }
+  G4cout << "=================================" << G4endl;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+}  // namespace B4
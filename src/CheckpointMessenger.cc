@@ -0,0 +1,87 @@
+#include "CheckpointMessenger.hh"
+#include "Checkpoint.hh"
+
+#include "G4UIdirectory.hh"
+#include "G4UIcmdWithAString.hh"
+#include "G4UIcmdWithAnInteger.hh"
+#include "G4UIcmdWithoutParameter.hh"
+
+namespace B4 {
+
+CheckpointMessenger::CheckpointMessenger(Checkpoint* checkpoint)
+ : fCheckpoint(checkpoint)
+{
+  fCheckpointDir = new G4UIdirectory("/run/checkpoint/");
+  fCheckpointDir->SetGuidance("Checkpointed runs: resume after a crash, extend a dataset");
+
+  // 只在 master 上执行：chunk 由 master 的 BeamOn 驱动
+
+  fFileCmd = new G4UIcmdWithAString("/run/checkpoint/file", this);
+  fFileCmd->SetGuidance("Set the checkpoint file (default b4run.ckpt);");
+  fFileCmd->SetGuidance("sharded jobs use <name>_shard<k>of<N>.ckpt");
+  fFileCmd->SetParameterName("file", false);
+  fFileCmd->AvailableForStates(G4State_PreInit, G4State_Idle);
+  fFileCmd->SetToBeBroadcasted(false);
+
+  fEveryCmd = new G4UIcmdWithAnInteger("/run/checkpoint/every", this);
+  fEveryCmd->SetGuidance("Set the number of events per chunk: a checkpoint is written");
+  fEveryCmd->SetGuidance("after every chunk, at most one chunk is lost on a crash");
+  fEveryCmd->SetParameterName("n", false);
+  fEveryCmd->SetRange("n>0");
+  fEveryCmd->AvailableForStates(G4State_PreInit, G4State_Idle);
+  fEveryCmd->SetToBeBroadcasted(false);
+
+  fBeamOnCmd = new G4UIcmdWithAnInteger("/run/checkpoint/beamOn", this);
+  fBeamOnCmd->SetGuidance("Simulate a dataset of n events in checkpointed chunks.");
+  fBeamOnCmd->SetGuidance("If the checkpoint file holds the same dataset (same commands,");
+  fBeamOnCmd->SetGuidance("engine and shard), continue where it stopped.");
+  fBeamOnCmd->SetGuidance("Every chunk is a separate run; output names carry its first event.");
+  fBeamOnCmd->SetParameterName("n", false);
+  fBeamOnCmd->SetRange("n>0");
+  fBeamOnCmd->AvailableForStates(G4State_Idle);
+  fBeamOnCmd->SetToBeBroadcasted(false);
+
+  fExtendCmd = new G4UIcmdWithAnInteger("/run/checkpoint/extend", this);
+  fExtendCmd->SetGuidance("Add n events to the dataset of the checkpoint file");
+  fExtendCmd->SetGuidance("(the same commands as the dataset must have been executed)");
+  fExtendCmd->SetParameterName("n", false);
+  fExtendCmd->SetRange("n>0");
+  fExtendCmd->AvailableForStates(G4State_Idle);
+  fExtendCmd->SetToBeBroadcasted(false);
+
+  fPrintCmd = new G4UIcmdWithoutParameter("/run/checkpoint/print", this);
+  fPrintCmd->SetGuidance("Print the checkpoint settings and the state of its dataset");
+  fPrintCmd->AvailableForStates(G4State_PreInit, G4State_Idle);
+  fPrintCmd->SetToBeBroadcasted(false);
+}
+
+CheckpointMessenger::~CheckpointMessenger()
+{
+  delete fFileCmd;
+  delete fEveryCmd;
+  delete fBeamOnCmd;
+  delete fExtendCmd;
+  delete fPrintCmd;
+  delete fCheckpointDir;
+}
+
+void CheckpointMessenger::SetNewValue(G4UIcommand* cmd, G4String val)
+{
+  if (cmd == fFileCmd) {
+    fCheckpoint->SetFile(val);
+  }
+  else if (cmd == fEveryCmd) {
+    fCheckpoint->SetChunkSize(fEveryCmd->GetNewIntValue(val));
+  }
+  else if (cmd == fBeamOnCmd) {
+    fCheckpoint->BeamOn(fBeamOnCmd->GetNewIntValue(val));
+  }
+  else if (cmd == fExtendCmd) {
+    fCheckpoint->Extend(fExtendCmd->GetNewIntValue(val));
+  }
+  else if (cmd == fPrintCmd) {
+    fCheckpoint->Print();
+  }
+}
+
+}  // namespace B4
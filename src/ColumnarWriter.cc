@@ -0,0 +1,135 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+//
+/// \file B4/B4a/src/ColumnarWriter.cc
+/// \brief Implementation of the B4::ColumnarWriter class
+
+#include "ColumnarWriter.hh"
+#include "EntryBuffer.hh"
+
+#include "G4Exception.hh"
+
+#include <cstddef>
+
+namespace
+{
+// 列名与 ROOT ntuple 的列名一致，方便转换
+struct ColumnSpec
+{
+  const char* name;
+  B4::Columnar::DType type;
+  G4double B4::EntryRecord::* value;
+  G4int B4::EntryRecord::* intValue;
+};
+
+const ColumnSpec kColumns[] = {
+  {"PDG",   B4::Columnar::DType::Int32,   nullptr, &B4::EntryRecord::pdg},
+  {"px",    B4::Columnar::DType::Float64, &B4::EntryRecord::px, nullptr},
+  {"py",    B4::Columnar::DType::Float64, &B4::EntryRecord::py, nullptr},
+  {"pz",    B4::Columnar::DType::Float64, &B4::EntryRecord::pz, nullptr},
+  {"pE",    B4::Columnar::DType::Float64, &B4::EntryRecord::E, nullptr},
+  {"theta", B4::Columnar::DType::Float64, &B4::EntryRecord::theta, nullptr},
+  {"phi",   B4::Columnar::DType::Float64, &B4::EntryRecord::phi, nullptr},
+  {"weight", B4::Columnar::DType::Float64, &B4::EntryRecord::weight, nullptr},
+  {"plane", B4::Columnar::DType::Int32,   nullptr, &B4::EntryRecord::plane},
+  {"primaryPDG", B4::Columnar::DType::Int32, nullptr, &B4::EntryRecord::primaryPdg},
+  {"primaryE", B4::Columnar::DType::Float64, &B4::EntryRecord::primaryE, nullptr},
+};
+
+constexpr std::size_t kBufferSize = 1 << 20;
+}  // namespace
+
+namespace B4
+{
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+ColumnarWriter::ColumnarWriter(const G4String& directory, G4int segment)
+{
+  for (const auto& spec : kColumns) {
+    G4String path = directory + "/" + Columnar::SegmentFileName(spec.name, segment);
+    std::FILE* file = std::fopen(path.c_str(), "wb");
+    if (!file) {
+      G4ExceptionDescription msg;
+      msg << "Cannot open columnar segment " << path;
+      G4Exception("ColumnarWriter::ColumnarWriter()", "MyCode0004", FatalException, msg);
+      return;
+    }
+    std::setvbuf(file, nullptr, _IOFBF, kBufferSize);
+    auto header = Columnar::MakeHeader(spec.name, spec.type, segment);
+    std::fwrite(&header, sizeof(header), 1, file);
+    fColumns.push_back({spec.name, spec.type, file});
+  }
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+ColumnarWriter::~ColumnarWriter()
+{
+  Close();
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void ColumnarWriter::Append(const EntryBuffer& entries)
+{
+  std::size_t n = entries.Size();
+  if (n == 0 || fColumns.empty()) return;
+
+  if (fDoubleScratch.size() < n) fDoubleScratch.resize(n);
+  if (fIntScratch.size() < n) fIntScratch.resize(n);
+
+  const EntryRecord* records = entries.begin();
+  for (std::size_t c = 0; c < fColumns.size(); ++c) {
+    const auto& spec = kColumns[c];
+    if (spec.type == Columnar::DType::Int32) {
+      for (std::size_t i = 0; i < n; ++i) fIntScratch[i] = records[i].*spec.intValue;
+      std::fwrite(fIntScratch.data(), sizeof(std::int32_t), n, fColumns[c].file);
+    }
+    else {
+      for (std::size_t i = 0; i < n; ++i) fDoubleScratch[i] = records[i].*spec.value;
+      std::fwrite(fDoubleScratch.data(), sizeof(G4double), n, fColumns[c].file);
+    }
+  }
+  fNofRows += n;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void ColumnarWriter::Close()
+{
+  // 关闭时回写各列的行数
+  for (auto& column : fColumns) {
+    std::fseek(column.file, offsetof(Columnar::FileHeader, nrows), SEEK_SET);
+    std::fwrite(&fNofRows, sizeof(fNofRows), 1, column.file);
+    std::fclose(column.file);
+  }
+  fColumns.clear();
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+}  // namespace B4
@@ -0,0 +1,172 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+//
+/// \file B4/B4a/src/CutTuner.cc
+/// \brief Implementation of the B4::CutTuner class
+
+#include "CutTuner.hh"
+#include "CutTunerMessenger.hh"
+#include "DetectorConstruction.hh"
+#include "EntryObservables.hh"
+#include "RunAction.hh"
+
+#include "G4RunManager.hh"
+#include "G4UImanager.hh"
+#include "G4UnitsTable.hh"
+#include "G4SystemOfUnits.hh"
+#include "G4Timer.hh"
+#include "G4Exception.hh"
+#include "G4ios.hh"
+
+#include <iomanip>
+#include <sstream>
+
+namespace B4
+{
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+CutTuner::CutTuner(DetectorConstruction* det)
+  : fDet(det),
+    fMaxCut(10.*cm)
+{
+  fMessenger = new CutTunerMessenger(this);
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+CutTuner::~CutTuner()
+{
+  delete fMessenger;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void CutTuner::SetCut(G4double cut)
+{
+  for (const auto& particle : fParticles) fDet->SetRegionCut(fRegion, particle, cut);
+  // 广播到 worker，下一次 BeamOn 时重建物理表
+  G4UImanager::GetUIpointer()->ApplyCommand("/run/physicsModified");
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void CutTuner::Run()
+{
+  auto* runManager = G4RunManager::GetRunManager();
+  auto* runAction = dynamic_cast<const RunAction*>(runManager->GetUserRunAction());
+  if (!runAction || fParticles.empty() || fFactor <= 1.) {
+    G4ExceptionDescription msg;
+    msg << "Cut tuning needs the run action, at least one particle and a factor > 1.";
+    G4Exception("CutTuner::Run()", "MyCode0006", JustWarning, msg);
+    return;
+  }
+
+  // 起点 (参考 run)：当前阈值，取第一个粒子的值。区域没有自己的阈值时
+  // 这是 World 的默认值，可能已经超过上限，此时没有可以调节的步
+  G4double startCut = fDet->GetRegionCut(fRegion, fParticles.front());
+  if (startCut * fFactor > fMaxCut) {
+    G4ExceptionDescription msg;
+    msg << "The current cut of region " << fRegion << " (" << G4BestUnit(startCut, "Length")
+        << ") times the factor " << fFactor << " is above the maximum cut "
+        << G4BestUnit(fMaxCut, "Length") << "; nothing to tune." << G4endl
+        << "Set a smaller start cut with /det/region/cut " << fRegion
+        << " or raise /tune/maxCut.";
+    G4Exception("CutTuner::Run()", "MyCode0006", JustWarning, msg);
+    return;
+  }
+
+  // 调节过程中不写输出文件
+  auto* uiManager = G4UImanager::GetUIpointer();
+  G4bool outputEnabled = runAction->IsOutputEnabled();
+  uiManager->ApplyCommand("/run/output/enableRoot false");
+
+  struct Step
+  {
+    G4double cut;
+    G4double wallTime;
+    G4long steps;
+    EntryCompatibility compatibility;
+  };
+  std::vector<Step> steps;
+
+  auto beamOn = [&](G4double cut) {
+    G4Timer timer;
+    timer.Start();
+    runManager->BeamOn(fNofEvents);
+    timer.Stop();
+    steps.push_back({ cut, timer.GetRealElapsed(), runAction->GetSteps(), {} });
+  };
+
+  G4cout << "===== Cut tuning of region " << fRegion << ": reference with "
+         << G4BestUnit(startCut, "Length") << G4endl;
+  SetCut(startCut);
+  beamOn(startCut);
+  EntryObservables reference = runAction->GetEntryObservables();
+
+  G4double accepted = startCut;
+  for (G4double cut = startCut * fFactor; cut <= fMaxCut; cut *= fFactor) {
+    G4cout << "===== Cut tuning: " << G4BestUnit(cut, "Length") << G4endl;
+    SetCut(cut);
+    beamOn(cut);
+    steps.back().compatibility =
+      EntryObservables::Compare(reference, runAction->GetEntryObservables());
+    if (!steps.back().compatibility.IsCompatible(fPValue)) break;
+    accepted = cut;
+  }
+
+  // 保留最后一个兼容的阈值
+  SetCut(accepted);
+  if (outputEnabled) uiManager->ApplyCommand("/run/output/enableRoot true");
+
+  const auto& ref = steps.front();
+  std::ostringstream os;
+  os << "========== Cut Tuning Summary ==========\n"
+     << " region " << fRegion << ", " << fNofEvents << " events per step, p-value limit "
+     << fPValue << "\n"
+     << std::setw(12) << "cut [mm]" << std::setw(10) << "steps" << std::setw(10) << "time"
+     << std::setw(10) << "p(rate)" << std::setw(10) << "p(E)" << std::setw(10)
+     << "p(theta)" << "\n"
+     << std::setprecision(3);
+  for (const auto& step : steps) {
+    const auto& c = step.compatibility;
+    os << std::setw(12) << step.cut / mm
+       << std::setw(10) << (ref.steps > 0 ? (G4double)step.steps / ref.steps : 0.)
+       << std::setw(10) << (ref.wallTime > 0. ? step.wallTime / ref.wallTime : 0.)
+       << std::setw(10) << c.ratePValue << std::setw(10) << c.energyPValue
+       << std::setw(10) << c.thetaPValue << "\n";
+  }
+  os << " (steps and time relative to the reference)\n"
+     << " kept cut: " << accepted / mm << " mm for";
+  for (const auto& particle : fParticles) os << " " << particle;
+  os << " in " << fRegion << "\n"
+     << "========================================";
+  G4cout << os.str() << G4endl;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+}  // namespace B4
@@ -0,0 +1,103 @@
+#include "CutTunerMessenger.hh"
+#include "CutTuner.hh"
+
+#include "G4UIdirectory.hh"
+#include "G4UIcmdWithAString.hh"
+#include "G4UIcmdWithADouble.hh"
+#include "G4UIcmdWithADoubleAndUnit.hh"
+#include "G4UIcmdWithAnInteger.hh"
+#include "G4UIcmdWithoutParameter.hh"
+
+#include <sstream>
+#include <vector>
+
+namespace B4 {
+
+CutTunerMessenger::CutTunerMessenger(CutTuner* tuner)
+ : fTuner(tuner)
+{
+  fTuneDir = new G4UIdirectory("/tune/");
+  fTuneDir->SetGuidance("Raise the production cuts of a region while the detector entries stay compatible");
+
+  fRegionCmd = new G4UIcmdWithAString("/tune/region", this);
+  fRegionCmd->SetGuidance("Set the region whose cuts are tuned");
+  fRegionCmd->SetParameterName("region", false);
+  fRegionCmd->SetCandidates("World Target Detector");
+  fRegionCmd->AvailableForStates(G4State_PreInit, G4State_Idle);
+
+  fParticlesCmd = new G4UIcmdWithAString("/tune/particles", this);
+  fParticlesCmd->SetGuidance("Set the particles whose cuts are tuned together, e.g. gamma e- e+");
+  fParticlesCmd->SetParameterName("particles", false);
+  fParticlesCmd->AvailableForStates(G4State_PreInit, G4State_Idle);
+
+  fFactorCmd = new G4UIcmdWithADouble("/tune/factor", this);
+  fFactorCmd->SetGuidance("Set the factor by which the cut is raised at each step");
+  fFactorCmd->SetParameterName("factor", false);
+  fFactorCmd->SetRange("factor>1");
+  fFactorCmd->AvailableForStates(G4State_PreInit, G4State_Idle);
+
+  fMaxCutCmd = new G4UIcmdWithADoubleAndUnit("/tune/maxCut", this);
+  fMaxCutCmd->SetGuidance("Set the largest cut that is tried");
+  fMaxCutCmd->SetParameterName("cut", false);
+  fMaxCutCmd->SetDefaultUnit("mm");
+  fMaxCutCmd->AvailableForStates(G4State_PreInit, G4State_Idle);
+
+  fEventsCmd = new G4UIcmdWithAnInteger("/tune/events", this);
+  fEventsCmd->SetGuidance("Set the number of events of the reference and of every step");
+  fEventsCmd->SetParameterName("n", false);
+  fEventsCmd->SetRange("n>0");
+  fEventsCmd->AvailableForStates(G4State_PreInit, G4State_Idle);
+
+  fPValueCmd = new G4UIcmdWithADouble("/tune/pValue", this);
+  fPValueCmd->SetGuidance("Stop when any entry observable has a p-value below this limit");
+  fPValueCmd->SetParameterName("p", false);
+  fPValueCmd->SetRange("p>0 && p<1");
+  fPValueCmd->AvailableForStates(G4State_PreInit, G4State_Idle);
+
+  fRunCmd = new G4UIcmdWithoutParameter("/tune/run", this);
+  fRunCmd->SetGuidance("Run the reference and raise the cuts step by step");
+  fRunCmd->AvailableForStates(G4State_Idle);
+}
+
+CutTunerMessenger::~CutTunerMessenger()
+{
+  delete fRegionCmd;
+  delete fParticlesCmd;
+  delete fFactorCmd;
+  delete fMaxCutCmd;
+  delete fEventsCmd;
+  delete fPValueCmd;
+  delete fRunCmd;
+  delete fTuneDir;
+}
+
+void CutTunerMessenger::SetNewValue(G4UIcommand* cmd, G4String val)
+{
+  if (cmd == fRegionCmd) {
+    fTuner->SetRegion(val);
+  }
+  else if (cmd == fParticlesCmd) {
+    std::vector<G4String> names;
+    std::istringstream is(val);
+    G4String name;
+    while (is >> name) names.push_back(name);
+    fTuner->SetParticles(names);
+  }
+  else if (cmd == fFactorCmd) {
+    fTuner->SetFactor(fFactorCmd->GetNewDoubleValue(val));
+  }
+  else if (cmd == fMaxCutCmd) {
+    fTuner->SetMaxCut(fMaxCutCmd->GetNewDoubleValue(val));
+  }
+  else if (cmd == fEventsCmd) {
+    fTuner->SetNumberOfEvents(fEventsCmd->GetNewIntValue(val));
+  }
+  else if (cmd == fPValueCmd) {
+    fTuner->SetPValue(fPValueCmd->GetNewDoubleValue(val));
+  }
+  else if (cmd == fRunCmd) {
+    fTuner->Run();
+  }
+}
+
+}  // namespace B4
@@ -42,8 +42,21 @@
 #include "G4SystemOfUnits.hh"
 #include "G4VisAttributes.hh"
 #include "DetectorConstructionMessenger.hh"
+#include "DetectorSD.hh"
+#include "FastStart.hh"
+#include "MaterialRegistry.hh"
+#include "FastTarget.hh"
+#include "TargetFastModel.hh"
 #include "G4MultiFunctionalDetector.hh"
 #include "G4SubtractionSolid.hh"
+#include "G4Region.hh"
+#include "G4RegionStore.hh"
+#include "G4ProductionCuts.hh"
+#include "G4ProductionCutsTable.hh"
+#include "G4UserLimits.hh"
+#include "G4UnitsTable.hh"
+#include "G4RunManager.hh"
+#include "G4UImanager.hh"
 
 // Scoring includes
 #include "G4SDManager.hh"
@@ -51,12 +64,18 @@
 #include "G4PSFlatSurfaceFlux.hh"
 #include "G4Exception.hh"
 
+#include <algorithm>
+#include <cmath>
+#include <iomanip>
+#include <sstream>
+
 
 namespace B4
 {
 
 //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
 G4ThreadLocal G4GlobalMagFieldMessenger* DetectorConstruction::fMagFieldMessenger = nullptr;
+G4ThreadLocal TargetFastModel* DetectorConstruction::fFastModel = nullptr;
 
 DetectorConstruction::DetectorConstruction()
   : G4VUserDetectorConstruction(),
@@ -64,25 +83,37 @@ DetectorConstruction::DetectorConstruction()
     fTargetRadius(3.5*cm),
     fTargetMaterial(nullptr),
     fDetectorRadius(40.0*cm),
+    fDetectorThickness(1.0*cm),
     fDetectorLength(150.0*cm),
     fDetectorMaterial(nullptr),
     fTargetLogical(nullptr),
     fDetectorLogical(nullptr),
     fCheckOverlaps(true),
+    fEntryScoring(EntryScoring::SensitiveDetector),
     fMessenger(nullptr)
   {
+    DefineMaterials();
     fMessenger = new DetectorConstructionMessenger(this);
   }
 
 DetectorConstruction::~DetectorConstruction() {
   delete fMessenger;
+  delete fMaterials;
+  for (auto& item : fRegionSettings) delete item.second.limits;
 }
 //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
 
 G4VPhysicalVolume* DetectorConstruction::Construct()
 {
-  // Define materials
-  DefineMaterials();
+  // 材料在构造函数中定义 (只定义一次)，重建几何时保留当前的靶和探测器材料
+  // 打印材料表 (批处理只打印一行，/det/printMaterials 打印完整的表)
+  if (fPrintMaterials) {
+    PrintMaterials();
+  }
+  else {
+    G4cout << " " << G4Material::GetNumberOfMaterials()
+           << " materials defined (/det/printMaterials for the table)" << G4endl;
+  }
 
   // Define volumes
   return DefineVolumes();
@@ -92,41 +123,129 @@ G4VPhysicalVolume* DetectorConstruction::Construct()
 
 void DetectorConstruction::DefineMaterials()
 {
-  // 使用NIST材料数据库
-  G4NistManager* nistManager = G4NistManager::Instance();
-  
-  // 定义世界材料 - 真空
-  nistManager->FindOrBuildMaterial("G4_Galactic");
-  
-  // 定义液态氢材料
-  G4double density = 0.0708*g/cm3;  // 液态氢密度
-  G4Material* liquidH2 = new G4Material("liquidH2", density, 1);
-  liquidH2->AddElement(nistManager->FindOrBuildElement("H"), 2);
-  //G4Material* liquidH2 = nistManager->FindOrBuildMaterial("G4_Pb");
-  // 定义探测器材料 - 可以是塑料闪烁体
-  G4Material* gas = nistManager->FindOrBuildMaterial("G4_AIR");
-  
+  // 材料注册表：液氢等自定义材料只定义一次，切换材料时从中查找
+  fMaterials = new MaterialRegistry();
+
   // 设置靶材料和探测器材料
-  fTargetMaterial = liquidH2;
-  fDetectorMaterial = gas;
-  
-  // 打印材料表
+  fTargetMaterial = fMaterials->Find("liquidH2");
+  fDetectorMaterial = fMaterials->Find("G4_AIR");
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void DetectorConstruction::PrintMaterials() const
+{
   G4cout << *(G4Material::GetMaterialTable()) << G4endl;
 }
 
 //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
 
+G4Material* DetectorConstruction::FindMaterial(const G4String& name) const
+{
+  auto* material = fMaterials->Find(name);
+  if (!material) {
+    G4ExceptionDescription msg;
+    msg << "Material " << name << " not found, the material is not changed.";
+    G4Exception("DetectorConstruction::FindMaterial()", "MyCode0019", JustWarning, msg);
+  }
+  return material;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
 void DetectorConstruction::SetDetectorMaterial(const  G4String& name)
 {
-  auto* mat = G4NistManager::Instance()->FindOrBuildMaterial(name);
-  if ( mat )
-    fDetectorMaterial = mat;
+  auto* mat = FindMaterial(name);
+  if (!mat || mat == fDetectorMaterial) return;
+  fDetectorMaterial = mat;
+
+  if (!IsBuilt()) return;
+  fDetectorLogical->SetMaterial(mat);
+  if (fEndCapLogical) fEndCapLogical->SetMaterial(mat);
+  MaterialsModified();
 }
 void DetectorConstruction::SetTargetMaterial(const  G4String& name)
 {
-  auto* mat = G4NistManager::Instance()->FindOrBuildMaterial(name);
-  if ( mat )
-    fTargetMaterial = mat;
+  auto* mat = FindMaterial(name);
+  if (!mat || mat == fTargetMaterial) return;
+  fTargetMaterial = mat;
+
+  if (!IsBuilt()) return;
+  fTargetLogical->SetMaterial(mat);
+  MaterialsModified();
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void DetectorConstruction::SetTargetLength(G4double val)
+{
+  fTargetLength = val;
+  UpdatePlanes();
+  UpdateTargetShape();
+}
+void DetectorConstruction::SetTargetRadius(G4double val)
+{
+  fTargetRadius = val;
+  UpdateTargetShape();
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void DetectorConstruction::UpdateTargetShape()
+{
+  if (!IsBuilt()) return;
+
+  // 重要性抽样的并行世界按靶长度划分 slab，只能完整重建
+  if (GetNumberOfParallelWorld() > 0) {
+    fRebuildPending = true;
+    G4RunManager::GetRunManager()->ReinitializeGeometry();
+    return;
+  }
+
+  // 原地修改靶的实体 (各线程共享)；靶中心固定在探测器上游端面，
+  // 放置位置不变。只需在下一个 run 开始时重新体素化导航几何
+  fTargetSolid->SetOuterRadius(fTargetRadius);
+  fTargetSolid->SetZHalfLength(fTargetLength/2);
+  G4UImanager::GetUIpointer()->ApplyCommand("/run/geometryModified");
+
+  ValidateGeometry(fWorldPhysical);
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void DetectorConstruction::SetDetectorLength(G4double val)
+{
+  fDetectorLength = val;
+  UpdatePlanes();
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void DetectorConstruction::SetPlaneDepths(const std::vector<G4double>& depths)
+{
+  fPlaneDepths = depths;
+  std::sort(fPlaneDepths.begin(), fPlaneDepths.end());
+  fPlaneDepths.erase(std::unique(fPlaneDepths.begin(), fPlaneDepths.end()), fPlaneDepths.end());
+  UpdatePlanes();
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void DetectorConstruction::UpdatePlanes()
+{
+  // 深度从靶的前 (上游) 表面算起；靶中心固定，靶长度改变时前表面移动
+  G4double zFront = GetTargetPosition().z() - fTargetLength/2;
+  fPlaneZ.resize(fPlaneDepths.size());
+  for (std::size_t i = 0; i < fPlaneDepths.size(); ++i) fPlaneZ[i] = zFront + fPlaneDepths[i];
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void DetectorConstruction::MaterialsModified()
+{
+  // 逻辑体积换了材料：下一个 run 开始时更新物质-阈值对并重建物理表，
+  // worker 的逻辑体积从 master 复制新材料 (广播到 worker)
+  G4UImanager::GetUIpointer()->ApplyCommand("/run/physicsModified");
 }
 
 //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
@@ -137,7 +256,7 @@ G4VPhysicalVolume* DetectorConstruction::DefineVolumes()
   G4double worldSize = 300.0*cm;
   
   // 获取材料
-  G4Material* worldMaterial = G4Material::GetMaterial("G4_Galactic");
+  G4Material* worldMaterial = fMaterials->Find("G4_Galactic");
   
   // 检查材料是否定义成功
   if (!worldMaterial || !fTargetMaterial || !fDetectorMaterial) {
@@ -152,6 +271,8 @@ G4VPhysicalVolume* DetectorConstruction::DefineVolumes()
   //
   G4Box* worldSolid = new G4Box("World", worldSize/2, worldSize/2, worldSize/2);
   G4LogicalVolume* worldLV = new G4LogicalVolume(worldSolid, worldMaterial, "World");
+  fWorldLogical = worldLV;
+  fRebuildPending = false;
   G4VPhysicalVolume* worldPV = new G4PVPlacement(
     nullptr,               // 无旋转
     G4ThreeVector(),       // 位于原点
@@ -160,13 +281,14 @@ G4VPhysicalVolume* DetectorConstruction::DefineVolumes()
     nullptr,               // 母体积
     false,                 // 无布尔操作
     0,                     // 拷贝编号
-    fCheckOverlaps         // 检查重叠
+    false                  // 重叠在 ValidateGeometry 中统一检查
   );
+  fWorldPhysical = worldPV;
 
   // 
   // 液态氢靶 (圆柱体)
   //
-  G4Tubs* targetSolid = new G4Tubs(
+  fTargetSolid = new G4Tubs(
     "Target",              // 名称
     0.,                    // 内半径
     fTargetRadius,         // 外半径
@@ -176,26 +298,109 @@ G4VPhysicalVolume* DetectorConstruction::DefineVolumes()
   );
   
   fTargetLogical = new G4LogicalVolume(
-    targetSolid,           // 固体
+    fTargetSolid,          // 固体
     fTargetMaterial,       // 材料
     "Target"               // 名称
   );
   
   new G4PVPlacement(
     nullptr,               // 无旋转
-    G4ThreeVector(0, 0, -fDetectorLength/2), // 位于原点
+    GetTargetPosition(),   // 位于探测器上游端面
     fTargetLogical,        // 逻辑体积
     "Target",              // 物理体积名称
     worldLV,          // 母体积
     false,                 // 无布尔操作
     0,                     // 拷贝编号
-    fCheckOverlaps         // 检查重叠
+    false                  // 重叠在 ValidateGeometry 中统一检查
   );
   
   // 
-  // 敏感探测器 (使用布尔操作创建一个有入射面的盒子)
+  // 敏感探测器外壳：布尔实体，或者两个简单圆柱 (barrel + 下游端盖)
+  //
+  fEndCapLogical = nullptr;
+  if (fDetectorBuild == DetectorBuild::Boolean) {
+    BuildBooleanShell(worldLV);
+  }
+  else {
+    BuildPrimitiveShell(worldLV);
+  }
+
+  // 
+  // 设置可视化属性
   //
+  worldLV->SetVisAttributes(G4VisAttributes::GetInvisible());
   
+  G4VisAttributes* targetVis = new G4VisAttributes(G4Colour(0.2, 0.2, 1.0, 0.5));
+  targetVis->SetForceSolid(true);
+  fTargetLogical->SetVisAttributes(targetVis);
+  
+  G4VisAttributes* detectorVis = new G4VisAttributes(G4Colour(0.0, 1.0, 0.0, 0.3));
+  detectorVis->SetForceSolid(true);
+  fDetectorLogical->SetVisAttributes(detectorVis);
+  if (fEndCapLogical) fEndCapLogical->SetVisAttributes(detectorVis);
+
+  //
+  // 区域：靶和探测器各自的产生阈值与步长限制，其余属于世界默认区域
+  //
+  SetupRegion("Target", { fTargetLogical });
+  if (fEndCapLogical) SetupRegion("Detector", { fDetectorLogical, fEndCapLogical });
+  else SetupRegion("Detector", { fDetectorLogical });
+  ApplyRegionSettings();
+
+  ValidateGeometry(worldPV);
+
+  return worldPV;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+std::uint64_t DetectorConstruction::GeometryKey(const G4VPhysicalVolume* worldPV) const
+{
+  // 决定放置关系的参数：各体积的形状和位置 (不含材料，材料不影响重叠)
+  std::ostringstream text;
+  text << std::setprecision(17);
+  for (std::size_t i = 0; i < worldPV->GetLogicalVolume()->GetNoDaughters(); ++i) {
+    const auto* daughter = worldPV->GetLogicalVolume()->GetDaughter(i);
+    text << daughter->GetName() << ' ' << daughter->GetTranslation() << ' '
+         << daughter->GetLogicalVolume()->GetSolid()->GetEntityType() << ';';
+  }
+  text << fTargetLength << ' ' << fTargetRadius << ' ' << fDetectorRadius << ' '
+       << fDetectorThickness << ' ' << fDetectorLength << ' '
+       << static_cast<G4int>(fDetectorBuild);
+  return FastStart::Hash(text.str());
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void DetectorConstruction::ValidateGeometry(const G4VPhysicalVolume* worldPV) const
+{
+  if (!fCheckOverlaps) return;
+
+  // 相同几何参数已经检查过 (缓存目录中的 geometry.validated) 时跳过
+  auto key = GeometryKey(worldPV);
+  if (!fGeometryCache.empty()
+      && FastStart::HasKey(fGeometryCache, "geometry.validated", key)) {
+    G4cout << " Overlap check skipped: geometry already validated" << G4endl;
+    return;
+  }
+
+  G4bool overlaps = false;
+  const auto* worldLV = worldPV->GetLogicalVolume();
+  for (std::size_t i = 0; i < worldLV->GetNoDaughters(); ++i) {
+    overlaps = worldLV->GetDaughter(i)->CheckOverlaps() || overlaps;
+  }
+  // 只记录没有重叠的几何，有重叠时每次都会报告
+  if (!overlaps && !fGeometryCache.empty()) {
+    FastStart::AddKey(fGeometryCache, "geometry.validated", key);
+  }
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void DetectorConstruction::BuildBooleanShell(G4LogicalVolume* worldLV)
+{
+  // 敏感探测器 (使用布尔操作创建一个有入射面的盒子)
+
   // 外部大盒子
   G4Tubs* outerTubs = new G4Tubs(
     "outerTubs",              // 名称
@@ -210,7 +415,7 @@ G4VPhysicalVolume* DetectorConstruction::DefineVolumes()
   G4Tubs* innerTubs = new G4Tubs(
     "innerTubs",              // 名称
     0.,                    // 内半径
-    fDetectorRadius-1*cm,         // 外半径
+    fDetectorRadius-fDetectorThickness,         // 外半径
     fDetectorLength/2,       // 半长度
     0.*deg ,                    // 起始角度
     360.*deg                   // 终止角度
@@ -222,7 +427,7 @@ G4VPhysicalVolume* DetectorConstruction::DefineVolumes()
     outerTubs,              // 被减体
     innerTubs,              // 减体
     nullptr,               // 无旋转
-    G4ThreeVector(0, 0, -1*cm) 
+    G4ThreeVector(0, 0, -fDetectorThickness) 
   );
   
   fDetectorLogical = new G4LogicalVolume(
@@ -240,23 +445,228 @@ G4VPhysicalVolume* DetectorConstruction::DefineVolumes()
     worldLV,          // 母体积
     false,                 // 无布尔操作
     0,                     // 拷贝编号
-    fCheckOverlaps         // 检查重叠
+    false                  // 重叠在 ValidateGeometry 中统一检查
+  );
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void DetectorConstruction::BuildPrimitiveShell(G4LogicalVolume* worldLV)
+{
+  // 与布尔外壳相同的区域：
+  //   barrel : R-t < r < R, |z| < L/2
+  //   端盖   : r < R-t, L/2-t < z < L/2
+  // 上游端面开口。两个体积只在 r = R-t 的接缝处相接，不重叠
+  G4double innerRadius = fDetectorRadius - fDetectorThickness;
+
+  auto* barrelSolid = new G4Tubs(
+    "DetectorBarrel",      // 名称
+    innerRadius,           // 内半径
+    fDetectorRadius,       // 外半径
+    fDetectorLength/2,     // 半长度
+    0.*deg,                // 起始角度
+    360.*deg               // 终止角度
+  );
+  fDetectorLogical = new G4LogicalVolume(barrelSolid, fDetectorMaterial, "Detector");
+  new G4PVPlacement(
+    nullptr,               // 无旋转
+    G4ThreeVector(),       // 位置
+    fDetectorLogical,      // 逻辑体积
+    "Detector",            // 物理体积名称
+    worldLV,               // 母体积
+    false,                 // 无布尔操作
+    0,                     // 拷贝编号
+    false                  // 重叠在 ValidateGeometry 中统一检查
   );
 
-  // 
-  // 设置可视化属性
-  //
-  worldLV->SetVisAttributes(G4VisAttributes::GetInvisible());
-  
-  G4VisAttributes* targetVis = new G4VisAttributes(G4Colour(0.2, 0.2, 1.0, 0.5));
-  targetVis->SetForceSolid(true);
-  fTargetLogical->SetVisAttributes(targetVis);
-  
-  G4VisAttributes* detectorVis = new G4VisAttributes(G4Colour(0.0, 1.0, 0.0, 0.3));
-  detectorVis->SetForceSolid(true);
-  fDetectorLogical->SetVisAttributes(detectorVis);
+  auto* endCapSolid = new G4Tubs(
+    "DetectorEndCap",      // 名称
+    0.,                    // 内半径
+    innerRadius,           // 外半径
+    fDetectorThickness/2,  // 半长度
+    0.*deg,                // 起始角度
+    360.*deg               // 终止角度
+  );
+  fEndCapLogical = new G4LogicalVolume(endCapSolid, fDetectorMaterial, "DetectorEndCap");
+  new G4PVPlacement(
+    nullptr,               // 无旋转
+    G4ThreeVector(0, 0, fDetectorLength/2 - fDetectorThickness/2), // 下游端
+    fEndCapLogical,        // 逻辑体积
+    "DetectorEndCap",      // 物理体积名称
+    worldLV,               // 母体积
+    false,                 // 无布尔操作
+    0,                     // 拷贝编号
+    false                  // 重叠在 ValidateGeometry 中统一检查
+  );
+}
 
-  return worldPV;
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+G4bool DetectorConstruction::IsInternalJoin(const G4ThreeVector& position) const
+{
+  if (!fEndCapLogical) return false;
+
+  // 接缝：r = R-t，且 z 在端盖范围内 (那里 r = R-t 的另一侧不是空腔)
+  constexpr G4double tolerance = 1.*um;
+  G4double innerRadius = fDetectorRadius - fDetectorThickness;
+  return std::abs(position.perp() - innerRadius) < tolerance
+      && position.z() > fDetectorLength/2 - fDetectorThickness + tolerance;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void DetectorConstruction::SetupRegion(const G4String& name,
+                                       const std::vector<G4LogicalVolume*>& volumes)
+{
+  auto* region = G4RegionStore::GetInstance()->GetRegion(name, false);
+  if (!region) region = new G4Region(name);
+
+  // 重建几何时区域保留下来，去掉旧的根逻辑体积
+  std::vector<G4LogicalVolume*> oldRoots(region->GetRootLogicalVolumeIterator(),
+                                         region->GetRootLogicalVolumeIterator()
+                                           + region->GetNumberOfRootVolumes());
+  for (auto* lv : oldRoots) region->RemoveRootLogicalVolume(lv, false);
+
+  for (auto* volume : volumes) region->AddRootLogicalVolume(volume);
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+const std::vector<G4String>& DetectorConstruction::GetRegionNames()
+{
+  static const std::vector<G4String> names = { "World", "Target", "Detector" };
+  return names;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+G4Region* DetectorConstruction::FindRegion(const G4String& name) const
+{
+  // World 对应 run manager 建立的默认区域
+  G4String regionName = (name == "World") ? "DefaultRegionForTheWorld" : name;
+  return G4RegionStore::GetInstance()->GetRegion(regionName, false);
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+std::vector<G4LogicalVolume*> DetectorConstruction::FindRegionVolumes(const G4String& name) const
+{
+  if (name == "World") return { fWorldLogical };
+  if (name == "Target") return { fTargetLogical };
+  if (name == "Detector") {
+    if (fEndCapLogical) return { fDetectorLogical, fEndCapLogical };
+    return { fDetectorLogical };
+  }
+  return {};
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void DetectorConstruction::SetRegionCut(const G4String& region, const G4String& particle,
+                                        G4double cut)
+{
+  const auto& names = GetRegionNames();
+  if (std::find(names.begin(), names.end(), region) == names.end()) {
+    G4ExceptionDescription msg;
+    msg << "Unknown region " << region << ", cut not set.";
+    G4Exception("DetectorConstruction::SetRegionCut()", "MyCode0005", JustWarning, msg);
+    return;
+  }
+  fRegionSettings[region].cuts[particle] = cut;
+  ApplyRegionSettings();
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+G4double DetectorConstruction::GetRegionCut(const G4String& region,
+                                            const G4String& particle) const
+{
+  auto it = fRegionSettings.find(region);
+  if (it != fRegionSettings.end()) {
+    auto cut = it->second.cuts.find(particle);
+    if (cut != it->second.cuts.end()) return cut->second;
+  }
+  // 未单独设置：区域自己的阈值，或者默认阈值
+  auto* g4Region = FindRegion(region);
+  G4ProductionCuts* cuts = g4Region ? g4Region->GetProductionCuts() : nullptr;
+  if (!cuts) cuts = G4ProductionCutsTable::GetProductionCutsTable()->GetDefaultProductionCuts();
+  return cuts->GetProductionCut(particle);
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void DetectorConstruction::SetRegionMaxStep(const G4String& region, G4double step)
+{
+  fRegionSettings[region].maxStep = step;
+  ApplyRegionSettings();
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void DetectorConstruction::SetRegionMinEkin(const G4String& region, G4double ekin)
+{
+  fRegionSettings[region].minEkin = ekin;
+  ApplyRegionSettings();
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void DetectorConstruction::ApplyRegionSettings()
+{
+  // 几何还没有建立时只保存设置，在 DefineVolumes() 中应用
+  if (!fWorldLogical) return;
+
+  auto* defaultCuts = G4ProductionCutsTable::GetProductionCutsTable()->GetDefaultProductionCuts();
+  for (auto& [name, settings] : fRegionSettings) {
+    auto* region = FindRegion(name);
+    if (!region) continue;
+
+    if (!settings.cuts.empty()) {
+      // World 的阈值就是默认阈值；其他区域第一次设置时复制一份默认阈值
+      G4ProductionCuts* cuts = region->GetProductionCuts();
+      if (name == "World") {
+        cuts = defaultCuts;
+      }
+      else if (!cuts || cuts == defaultCuts) {
+        cuts = new G4ProductionCuts(*defaultCuts);
+        region->SetProductionCuts(cuts);
+      }
+      for (const auto& [particle, value] : settings.cuts) {
+        cuts->SetProductionCut(value, particle);
+      }
+    }
+
+    // G4UserLimits 需要 G4StepLimiterPhysics (maxStep 与 minEkin)
+    if (settings.maxStep < DBL_MAX || settings.minEkin > 0. || settings.limits) {
+      if (!settings.limits) settings.limits = new G4UserLimits();
+      settings.limits->SetMaxAllowedStep(settings.maxStep);
+      settings.limits->SetUserMinEkine(settings.minEkin);
+      for (auto* volume : FindRegionVolumes(name)) volume->SetUserLimits(settings.limits);
+    }
+  }
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void DetectorConstruction::PrintRegions() const
+{
+  static const std::vector<G4String> particles = { "gamma", "e-", "e+", "proton" };
+  G4cout << "========== Regions ==========" << G4endl;
+  for (const auto& name : GetRegionNames()) {
+    G4cout << " " << std::setw(10) << std::left << name << std::right;
+    for (const auto& particle : particles) {
+      G4cout << "  " << particle << " " << G4BestUnit(GetRegionCut(name, particle), "Length");
+    }
+    auto it = fRegionSettings.find(name);
+    if (it != fRegionSettings.end() && it->second.maxStep < DBL_MAX) {
+      G4cout << "  maxStep " << G4BestUnit(it->second.maxStep, "Length");
+    }
+    if (it != fRegionSettings.end() && it->second.minEkin > 0.) {
+      G4cout << "  minEkin " << G4BestUnit(it->second.minEkin, "Energy");
+    }
+    G4cout << G4endl;
+  }
+  G4cout << "=============================" << G4endl;
 }
 
 //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
@@ -269,6 +679,22 @@ void DetectorConstruction::ConstructSDandField()
   G4ThreeVector fieldValue;
   fMagFieldMessenger = new G4GlobalMagFieldMessenger(fieldValue);
   fMagFieldMessenger->SetVerboseLevel(1);
+
+  // 探测器外壳的入射记录：敏感探测器只在外壳内部的步上被调用
+  // (重建几何时复用已注册的 SD，避免重复注册)
+  auto* sdManager = G4SDManager::GetSDMpointer();
+  G4VSensitiveDetector* detectorSD = sdManager->FindSensitiveDetector("/DetectorSD", false);
+  if (!detectorSD) {
+    detectorSD = new DetectorSD("DetectorSD", this);
+    sdManager->AddNewDetector(detectorSD);
+  }
+  SetSensitiveDetector(fDetectorLogical, detectorSD);
+  if (fEndCapLogical) SetSensitiveDetector(fEndCapLogical, detectorSD);
+
+  // 靶快速模拟：Target 区域是模型的包络 (exampleB4a --fastsim)
+  if (fFastTarget && fFastTarget->IsModelRegistered() && !fFastModel) {
+    fFastModel = new TargetFastModel("TargetFastModel", FindRegion("Target"), fFastTarget, this);
+  }
 }
 
 //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
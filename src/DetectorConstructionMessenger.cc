@@ -1,9 +1,40 @@
 #include "DetectorConstructionMessenger.hh"
 #include "DetectorConstruction.hh"
+#include "G4UIdirectory.hh"
+#include "G4UIcommand.hh"
+#include "G4UIparameter.hh"
 #include "G4UIcmdWithAString.hh"
+#include "G4UIcmdWithoutParameter.hh"
+#include "G4UIcmdWithABool.hh"
+#include "G4UImanager.hh"
+#include "G4StateManager.hh"
 #include "G4UIcmdWithADoubleAndUnit.hh"
 #include "G4UnitsTable.hh"
 #include "G4RunManager.hh"
+#include "G4SystemOfUnits.hh"
+
+#include <cstdlib>
+#include <sstream>
+#include <vector>
+
+namespace
+{
+// <region> <value> [unit] 形式的区域命令
+G4UIcommand* MakeRegionCommand(const char* path, G4UImessenger* messenger,
+                               const char* defaultUnit)
+{
+  auto* cmd = new G4UIcommand(path, messenger);
+  auto* region = new G4UIparameter("region", 's', false);
+  region->SetParameterCandidates("World Target Detector");
+  cmd->SetParameter(region);
+  cmd->SetParameter(new G4UIparameter("value", 'd', false));
+  auto* unit = new G4UIparameter("unit", 's', true);
+  unit->SetDefaultValue(defaultUnit);
+  cmd->SetParameter(unit);
+  cmd->AvailableForStates(G4State_PreInit, G4State_Idle);
+  return cmd;
+}
+}  // namespace
 
 namespace B4 {
 
@@ -14,18 +45,85 @@ DetectorConstructionMessenger::DetectorConstructionMessenger(DetectorConstructio
   fTargetLengthCmd->SetGuidance("Set target length");
   fTargetLengthCmd->SetParameterName("length", false);
   fTargetLengthCmd->SetDefaultUnit("cm");
-  fTargetLengthCmd->AvailableForStates(G4State_PreInit);
+  fTargetLengthCmd->AvailableForStates(G4State_PreInit, G4State_Idle);
 
   fTargetRadiusCmd = new G4UIcmdWithADoubleAndUnit("/det/targetRadius", this);
   fTargetRadiusCmd->SetGuidance("Set target Radius");
   fTargetRadiusCmd->SetParameterName("radius", false);
   fTargetRadiusCmd->SetDefaultUnit("cm");
-  fTargetRadiusCmd->AvailableForStates(G4State_PreInit);
+  fTargetRadiusCmd->AvailableForStates(G4State_PreInit, G4State_Idle);
 
   fTargetMaterialCmd = new G4UIcmdWithAString("/det/targetMaterial", this);
   fTargetMaterialCmd->SetGuidance("Set target material (NIST name)");
   fTargetMaterialCmd->SetParameterName("material", false);
-  fTargetMaterialCmd->AvailableForStates(G4State_PreInit);
+  fTargetMaterialCmd->AvailableForStates(G4State_PreInit, G4State_Idle);
+
+  fEntryScoringCmd = new G4UIcmdWithAString("/det/entryScoring", this);
+  fEntryScoringCmd->SetGuidance("Select how detector entries are scored");
+  fEntryScoringCmd->SetGuidance("  stepping : volume check in SteppingAction on every step");
+  fEntryScoringCmd->SetGuidance("  sd       : sensitive detector on the detector shell (default)");
+  fEntryScoringCmd->SetParameterName("mode", false);
+  fEntryScoringCmd->SetCandidates("stepping sd");
+  fEntryScoringCmd->AvailableForStates(G4State_PreInit, G4State_Idle);
+
+  fDetectorBuildCmd = new G4UIcmdWithAString("/det/detectorBuild", this);
+  fDetectorBuildCmd->SetGuidance("Select how the detector shell is built");
+  fDetectorBuildCmd->SetGuidance("  boolean   : G4SubtractionSolid of two tubes (default)");
+  fDetectorBuildCmd->SetGuidance("  primitive : barrel and end-cap G4Tubs, same shape, faster navigation");
+  fDetectorBuildCmd->SetParameterName("mode", false);
+  fDetectorBuildCmd->SetCandidates("boolean primitive");
+  fDetectorBuildCmd->AvailableForStates(G4State_PreInit, G4State_Idle);
+
+  fRegionDir = new G4UIdirectory("/det/region/");
+  fRegionDir->SetGuidance("Production cuts and step limits of the World, Target and Detector regions");
+
+  fRegionCutCmd = new G4UIcommand("/det/region/cut", this);
+  fRegionCutCmd->SetGuidance("Set the production cut of one particle in a region");
+  fRegionCutCmd->SetGuidance("World sets the default cut, used by regions without their own");
+  auto* region = new G4UIparameter("region", 's', false);
+  region->SetParameterCandidates("World Target Detector");
+  fRegionCutCmd->SetParameter(region);
+  auto* particle = new G4UIparameter("particle", 's', false);
+  particle->SetParameterCandidates("gamma e- e+ proton all");
+  fRegionCutCmd->SetParameter(particle);
+  fRegionCutCmd->SetParameter(new G4UIparameter("value", 'd', false));
+  auto* unit = new G4UIparameter("unit", 's', true);
+  unit->SetDefaultValue("mm");
+  fRegionCutCmd->SetParameter(unit);
+  fRegionCutCmd->AvailableForStates(G4State_PreInit, G4State_Idle);
+
+  fRegionMaxStepCmd = MakeRegionCommand("/det/region/maxStep", this, "mm");
+  fRegionMaxStepCmd->SetGuidance("Limit the step length in the volume of a region (G4UserLimits)");
+
+  fRegionMinEkinCmd = MakeRegionCommand("/det/region/minEkin", this, "MeV");
+  fRegionMinEkinCmd->SetGuidance("Stop tracks below a kinetic energy in the volume of a region");
+  fRegionMinEkinCmd->SetGuidance("(G4UserLimits, applied by G4UserSpecialCuts)");
+
+  fRegionPrintCmd = new G4UIcmdWithoutParameter("/det/region/print", this);
+  fRegionPrintCmd->SetGuidance("Print the cuts and limits of all regions");
+  fRegionPrintCmd->AvailableForStates(G4State_PreInit, G4State_Idle);
+
+  fCheckOverlapsCmd = new G4UIcmdWithABool("/det/checkOverlaps", this);
+  fCheckOverlapsCmd->SetGuidance("Check the placements for overlaps after the geometry is built");
+  fCheckOverlapsCmd->SetGuidance("Skipped for geometry parameters already validated in the cache");
+  fCheckOverlapsCmd->SetParameterName("check", true);
+  fCheckOverlapsCmd->SetDefaultValue(true);
+  fCheckOverlapsCmd->AvailableForStates(G4State_PreInit, G4State_Idle);
+
+  fScoringPlanesCmd = new G4UIcmdWithAString("/det/scoringPlanes", this);
+  fScoringPlanesCmd->SetGuidance("Virtual scoring planes at depths from the target front face");
+  fScoringPlanesCmd->SetGuidance("  d1 d2 ... [unit] : depths inside or behind the target (default cm)");
+  fScoringPlanesCmd->SetGuidance("  none             : remove all planes");
+  fScoringPlanesCmd->SetGuidance("A plane is a disc of the target radius: crossings further from the");
+  fScoringPlanesCmd->SetGuidance("target axis are not counted");
+  fScoringPlanesCmd->SetGuidance("Crossings are written with their plane index next to the detector");
+  fScoringPlanesCmd->SetGuidance("entries; the transmission per plane is printed at the end of run");
+  fScoringPlanesCmd->SetParameterName("depths", false);
+  fScoringPlanesCmd->AvailableForStates(G4State_PreInit, G4State_Idle);
+
+  fPrintMaterialsCmd = new G4UIcmdWithoutParameter("/det/printMaterials", this);
+  fPrintMaterialsCmd->SetGuidance("Print the material table");
+  fPrintMaterialsCmd->AvailableForStates(G4State_PreInit, G4State_Idle);
 }
 
 DetectorConstructionMessenger::~DetectorConstructionMessenger()
@@ -33,24 +131,103 @@ DetectorConstructionMessenger::~DetectorConstructionMessenger()
   delete fTargetLengthCmd;
   delete fTargetRadiusCmd;
   delete fTargetMaterialCmd;
+  delete fEntryScoringCmd;
+  delete fDetectorBuildCmd;
+  delete fRegionCutCmd;
+  delete fRegionMaxStepCmd;
+  delete fRegionMinEkinCmd;
+  delete fRegionPrintCmd;
+  delete fCheckOverlapsCmd;
+  delete fScoringPlanesCmd;
+  delete fPrintMaterialsCmd;
+  delete fRegionDir;
 }
 
 void DetectorConstructionMessenger::SetNewValue(G4UIcommand* cmd, G4String val)
 {
+  // 靶的尺寸和材料由 DetectorConstruction 原地更新，不重建几何
   if (cmd == fTargetLengthCmd) {
     G4double length = fTargetLengthCmd->GetNewDoubleValue(val);
     fDet->SetTargetLength(length);
-    G4RunManager::GetRunManager()->ReinitializeGeometry();
   }
   else if (cmd == fTargetRadiusCmd) {
-  G4double radius = fTargetRadiusCmd->GetNewDoubleValue(val);
-  fDet->SetTargetRadius(radius);
-  G4RunManager::GetRunManager()->ReinitializeGeometry();
-}
+    G4double radius = fTargetRadiusCmd->GetNewDoubleValue(val);
+    fDet->SetTargetRadius(radius);
+  }
   else if (cmd == fTargetMaterialCmd) {
     fDet->SetTargetMaterial(val);
+  }
+  else if (cmd == fEntryScoringCmd) {
+    fDet->SetEntryScoring(val == "stepping"
+                            ? DetectorConstruction::EntryScoring::Stepping
+                            : DetectorConstruction::EntryScoring::SensitiveDetector);
+  }
+  else if (cmd == fDetectorBuildCmd) {
+    fDet->SetDetectorBuild(val == "primitive"
+                             ? DetectorConstruction::DetectorBuild::Primitive
+                             : DetectorConstruction::DetectorBuild::Boolean);
     G4RunManager::GetRunManager()->ReinitializeGeometry();
   }
+  else if (cmd == fRegionCutCmd) {
+    std::istringstream is(val);
+    G4String region, particle, unit;
+    G4double value = 0.;
+    is >> region >> particle >> value >> unit;
+    value *= G4UIcommand::ValueOf(unit);
+    if (particle == "all") {
+      for (const char* name : { "gamma", "e-", "e+", "proton" }) {
+        fDet->SetRegionCut(region, name, value);
+      }
+    }
+    else {
+      fDet->SetRegionCut(region, particle, value);
+    }
+    // 阈值改变后需要重建物理表 (广播到 worker)
+    if (G4StateManager::GetStateManager()->GetCurrentState() == G4State_Idle) {
+      G4UImanager::GetUIpointer()->ApplyCommand("/run/physicsModified");
+    }
+  }
+  else if (cmd == fRegionMaxStepCmd || cmd == fRegionMinEkinCmd) {
+    std::istringstream is(val);
+    G4String region, unit;
+    G4double value = 0.;
+    is >> region >> value >> unit;
+    value *= G4UIcommand::ValueOf(unit);
+    if (cmd == fRegionMaxStepCmd) fDet->SetRegionMaxStep(region, value);
+    else fDet->SetRegionMinEkin(region, value);
+  }
+  else if (cmd == fRegionPrintCmd) {
+    fDet->PrintRegions();
+  }
+  else if (cmd == fCheckOverlapsCmd) {
+    fDet->SetCheckOverlaps(fCheckOverlapsCmd->GetNewBoolValue(val));
+  }
+  else if (cmd == fScoringPlanesCmd) {
+    // 数值列表，最后一项可以是单位；none 删除所有平面
+    std::istringstream is(val);
+    std::vector<G4String> tokens;
+    G4String token;
+    while (is >> token) {
+      if (token != "none") tokens.push_back(token);
+    }
+    G4double unit = cm;
+    if (!tokens.empty()) {
+      char* end = nullptr;
+      std::strtod(tokens.back().c_str(), &end);
+      if (*end != '\0') {
+        unit = G4UIcommand::ValueOf(tokens.back());
+        tokens.pop_back();
+      }
+    }
+    std::vector<G4double> depths;
+    for (const auto& depth : tokens) {
+      depths.push_back(G4UIcommand::ConvertToDouble(depth) * unit);
+    }
+    fDet->SetPlaneDepths(depths);
+  }
+  else if (cmd == fPrintMaterialsCmd) {
+    fDet->PrintMaterials();
+  }
 
 }
 
@@ -0,0 +1,73 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+//
+/// \file B4/B4a/src/DetectorSD.cc
+/// \brief Implementation of the B4::DetectorSD class
+
+#include "DetectorSD.hh"
+#include "DetectorConstruction.hh"
+#include "EventAction.hh"
+
+#include "G4EventManager.hh"
+#include "G4Step.hh"
+#include "G4StepPoint.hh"
+
+namespace B4
+{
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+DetectorSD::DetectorSD(const G4String& name, DetectorConstruction* det)
+  : G4VSensitiveDetector(name),
+    fDet(det) {}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+G4bool DetectorSD::ProcessHits(G4Step* step, G4TouchableHistory* /*history*/)
+{
+  if (fDet->GetEntryScoring() != DetectorConstruction::EntryScoring::SensitiveDetector) {
+    return false;
+  }
+
+  // 入射：本步起点位于探测器边界上，即刚从外部跨入
+  auto* preStepPoint = step->GetPreStepPoint();
+  if (preStepPoint->GetStepStatus() != fGeomBoundary) return false;
+  // primitive 外壳：从端盖进入 barrel (或反之) 不是入射
+  if (fDet->IsInternalJoin(preStepPoint->GetPosition())) return false;
+
+  if (!fEventAction) {
+    fEventAction = static_cast<EventAction*>(
+      G4EventManager::GetEventManager()->GetUserEventAction());
+  }
+
+  fEventAction->RecordEntry(step->GetTrack(), preStepPoint);
+
+  return true;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+}  // namespace B4
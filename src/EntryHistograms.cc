@@ -0,0 +1,183 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+//
+/// \file B4/B4a/src/EntryHistograms.cc
+/// \brief Implementation of the B4::EntryHistograms class
+
+#include "EntryHistograms.hh"
+#include "EntryBuffer.hh"
+
+#include "G4AnalysisManager.hh"
+#include "G4SystemOfUnits.hh"
+
+#include <cmath>
+#include <limits>
+
+namespace
+{
+constexpr const char* kSpeciesNames[B4::EntryHistograms::kSpecies] = {
+  "gamma", "e-", "e+", "mu-", "mu+", "pi-", "pi+", "proton", "neutron", "other"};
+}  // namespace
+
+namespace B4
+{
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+G4int EntryHistograms::SpeciesIndex(G4int pdg)
+{
+  switch (pdg) {
+    case 22: return 0;
+    case 11: return 1;
+    case -11: return 2;
+    case 13: return 3;
+    case -13: return 4;
+    case -211: return 5;
+    case 211: return 6;
+    case 2212: return 7;
+    case 2112: return 8;
+    default: return 9;
+  }
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+const char* EntryHistograms::SpeciesName(G4int index)
+{
+  return kSpeciesNames[index];
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void EntryHistograms::Book(G4AnalysisManager* analysis)
+{
+  fFirstH2 = analysis->CreateH2("theta_px", "Theta vs Px", ThetaAxis::kBins, ThetaAxis::kMin,
+                                ThetaAxis::kMax, PtAxis::kBins, PtAxis::kMin, PtAxis::kMax);
+  analysis->CreateH2("theta_py", "Theta vs Py", ThetaAxis::kBins, ThetaAxis::kMin,
+                     ThetaAxis::kMax, PtAxis::kBins, PtAxis::kMin, PtAxis::kMax);
+  analysis->CreateH2("theta_pz", "Theta vs Pz", ThetaAxis::kBins, ThetaAxis::kMin,
+                     ThetaAxis::kMax, PAxis::kBins, PAxis::kMin, PAxis::kMax);
+  analysis->CreateH2("theta_p", "Theta vs P", ThetaAxis::kBins, ThetaAxis::kMin,
+                     ThetaAxis::kMax, PAxis::kBins, PAxis::kMin, PAxis::kMax);
+
+  for (G4int s = 0; s < kSpecies; ++s) {
+    G4String name = kSpeciesNames[s];
+    G4int id = analysis->CreateH1("logE_" + name, "log10(E/MeV) of " + name + " entries",
+                                  LogEAxis::kBins, LogEAxis::kMin, LogEAxis::kMax);
+    analysis->CreateH1("theta_" + name, "Theta of " + name + " entries",
+                       SpeciesThetaAxis::kBins, SpeciesThetaAxis::kMin, SpeciesThetaAxis::kMax);
+    if (s == 0) fFirstH1 = id;
+  }
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void EntryHistograms::Fill(const EntryBuffer& entries)
+{
+  const std::size_t n = entries.Size();
+  if (n == 0) return;
+  if (fPx.size() < n) {
+    for (auto* v : {&fPx, &fPy, &fPz, &fP, &fLog, &fThetaDeg, &fWeight}) v->resize(n);
+    for (auto* v : {&fSpecies, &fIxTheta, &fIxPx, &fIxPy, &fIxPz, &fIxP, &fIxLogE, &fIxTheta36}) {
+      v->resize(n);
+    }
+  }
+
+  // 1) 记录 -> 列
+  const EntryRecord* record = entries.begin();
+  for (std::size_t i = 0; i < n; ++i) {
+    fPx[i] = record[i].px;
+    fPy[i] = record[i].py;
+    fPz[i] = record[i].pz;
+    fLog[i] = record[i].E;
+    fThetaDeg[i] = record[i].theta;
+    fWeight[i] = record[i].weight;
+    fSpecies[i] = SpeciesIndex(record[i].pdg);
+  }
+
+  // 2) 导出量与 bin 索引：无分支的直线循环
+  for (std::size_t i = 0; i < n; ++i) {
+    fP[i] = std::sqrt(fPx[i] * fPx[i] + fPy[i] * fPy[i] + fPz[i] * fPz[i]);
+  }
+  for (std::size_t i = 0; i < n; ++i) {
+    // E = 0 -> 下溢 bin
+    G4double e = fLog[i] / MeV;
+    fLog[i] = e > 0. ? std::log10(e) : -std::numeric_limits<G4double>::max();
+  }
+  for (std::size_t i = 0; i < n; ++i) {
+    fIxTheta[i] = ThetaAxis::Index(fThetaDeg[i]);
+    fIxTheta36[i] = SpeciesThetaAxis::Index(fThetaDeg[i]);
+    fIxPx[i] = PtAxis::Index(fPx[i]);
+    fIxPy[i] = PtAxis::Index(fPy[i]);
+    fIxPz[i] = PAxis::Index(fPz[i]);
+    fIxP[i] = PAxis::Index(fP[i]);
+    fIxLogE[i] = LogEAxis::Index(fLog[i]);
+  }
+
+  // 3) 散布到 bin
+  for (std::size_t i = 0; i < n; ++i) {
+    fThetaPx.Fill(fIxTheta[i], fIxPx[i], fThetaDeg[i], fPx[i], fWeight[i]);
+    fThetaPy.Fill(fIxTheta[i], fIxPy[i], fThetaDeg[i], fPy[i], fWeight[i]);
+    fThetaPz.Fill(fIxTheta[i], fIxPz[i], fThetaDeg[i], fPz[i], fWeight[i]);
+    fThetaP.Fill(fIxTheta[i], fIxP[i], fThetaDeg[i], fP[i], fWeight[i]);
+  }
+  for (std::size_t i = 0; i < n; ++i) {
+    fLogE[fSpecies[i]].Fill(fIxLogE[i], fLog[i], fWeight[i]);
+    fTheta[fSpecies[i]].Fill(fIxTheta36[i], fThetaDeg[i], fWeight[i]);
+  }
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void EntryHistograms::MergeInto(G4AnalysisManager* analysis)
+{
+  if (fFirstH2 < 0) return;
+  fThetaPx.MergeInto(analysis->GetH2(fFirstH2, false, false));
+  fThetaPy.MergeInto(analysis->GetH2(fFirstH2 + 1, false, false));
+  fThetaPz.MergeInto(analysis->GetH2(fFirstH2 + 2, false, false));
+  fThetaP.MergeInto(analysis->GetH2(fFirstH2 + 3, false, false));
+  for (G4int s = 0; s < kSpecies; ++s) {
+    fLogE[s].MergeInto(analysis->GetH1(fFirstH1 + 2 * s, false, false));
+    fTheta[s].MergeInto(analysis->GetH1(fFirstH1 + 2 * s + 1, false, false));
+  }
+  Reset();
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void EntryHistograms::Reset()
+{
+  fThetaPx.Reset();
+  fThetaPy.Reset();
+  fThetaPz.Reset();
+  fThetaP.Reset();
+  for (auto& h : fLogE) h.Reset();
+  for (auto& h : fTheta) h.Reset();
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+}  // namespace B4
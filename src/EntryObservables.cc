@@ -0,0 +1,179 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+//
+/// \file B4/B4a/src/EntryObservables.cc
+/// \brief Implementation of the B4::EntryObservables class
+
+#include "EntryObservables.hh"
+#include "EntryBuffer.hh"
+#include "G4SystemOfUnits.hh"
+
+#include <algorithm>
+#include <cmath>
+#include <iomanip>
+
+namespace
+{
+// 卡方分布的上尾概率 (Wilson-Hilferty 近似，ndf 较大时足够精确)
+G4double Chi2PValue(G4double chi2, G4int ndf)
+{
+  if (ndf <= 0) return 1.;
+  G4double k = ndf;
+  G4double s = 2. / (9. * k);
+  G4double z = (std::cbrt(chi2 / k) - (1. - s)) / std::sqrt(s);
+  return 0.5 * std::erfc(z / std::sqrt(2.));
+}
+
+// 两个无权直方图的一致性卡方 (跳过两边都为空的 bin)
+template <std::size_t N>
+G4double HomogeneityChi2(const std::array<G4double, N>& a,
+                         const std::array<G4double, N>& b, G4int& ndf)
+{
+  G4double sumA = 0., sumB = 0.;
+  for (std::size_t i = 0; i < N; ++i) {
+    sumA += a[i];
+    sumB += b[i];
+  }
+  ndf = 0;
+  if (sumA <= 0. || sumB <= 0.) return 0.;
+
+  G4double chi2 = 0.;
+  G4int bins = 0;
+  for (std::size_t i = 0; i < N; ++i) {
+    G4double n = a[i] + b[i];
+    if (n <= 0.) continue;
+    G4double d = sumB * a[i] - sumA * b[i];
+    chi2 += d * d / (sumA * sumB * n);
+    ++bins;
+  }
+  ndf = bins - 1;
+  return chi2;
+}
+}  // namespace
+
+namespace B4
+{
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void EntryObservables::Fill(const EntryBuffer& entries)
+{
+  auto n = static_cast<G4long>(entries.Size());
+  ++fEvents;
+  fEntries += n;
+  fEntries2 += static_cast<G4double>(n) * n;
+
+  constexpr G4double energyScale = kEnergyBins / (kLogEMax - kLogEMin);
+  constexpr G4double thetaScale = kThetaBins / 180.;
+  for (const auto& entry : entries) {
+    if (entry.E > 0.) {
+      auto bin = static_cast<G4int>((std::log10(entry.E / MeV) - kLogEMin) * energyScale);
+      fEnergy[std::min(std::max(bin, 0), kEnergyBins - 1)] += 1.;
+    }
+    auto bin = static_cast<G4int>(entry.theta * thetaScale);
+    fTheta[std::min(std::max(bin, 0), kThetaBins - 1)] += 1.;
+  }
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void EntryObservables::Merge(const G4VAccumulable& other)
+{
+  const auto& rhs = static_cast<const EntryObservables&>(other);
+  fEvents += rhs.fEvents;
+  fEntries += rhs.fEntries;
+  fEntries2 += rhs.fEntries2;
+  for (G4int i = 0; i < kEnergyBins; ++i) fEnergy[i] += rhs.fEnergy[i];
+  for (G4int i = 0; i < kThetaBins; ++i) fTheta[i] += rhs.fTheta[i];
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void EntryObservables::Reset()
+{
+  fEvents = 0;
+  fEntries = 0;
+  fEntries2 = 0.;
+  fEnergy.fill(0.);
+  fTheta.fill(0.);
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void EntryObservables::Write(std::ostream& os, const G4String& key) const
+{
+  os << std::setprecision(17)
+     << key << ".events = " << fEvents << "\n"
+     << key << ".entries = " << fEntries << "\n"
+     << key << ".entries2 = " << fEntries2 << "\n"
+     << key << ".energy =";
+  for (G4double v : fEnergy) os << " " << v;
+  os << "\n" << key << ".theta =";
+  for (G4double v : fTheta) os << " " << v;
+  os << "\n";
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+G4double EntryObservables::GetEntriesPerEvent() const
+{
+  return fEvents > 0 ? static_cast<G4double>(fEntries) / fEvents : 0.;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+G4double EntryObservables::GetEntriesPerEventError() const
+{
+  if (fEvents < 2) return 0.;
+  G4double mean = GetEntriesPerEvent();
+  G4double variance = (fEntries2 / fEvents - mean * mean) * fEvents / (fEvents - 1);
+  return std::sqrt(std::max(variance, 0.) / fEvents);
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+EntryCompatibility EntryObservables::Compare(const EntryObservables& reference,
+                                             const EntryObservables& test)
+{
+  EntryCompatibility result;
+
+  G4double error = std::hypot(reference.GetEntriesPerEventError(),
+                              test.GetEntriesPerEventError());
+  if (error > 0.) {
+    result.rateZ = (test.GetEntriesPerEvent() - reference.GetEntriesPerEvent()) / error;
+    result.ratePValue = std::erfc(std::abs(result.rateZ) / std::sqrt(2.));
+  }
+
+  result.energyChi2 = HomogeneityChi2(reference.fEnergy, test.fEnergy, result.energyNdf);
+  result.energyPValue = Chi2PValue(result.energyChi2, result.energyNdf);
+  result.thetaChi2 = HomogeneityChi2(reference.fTheta, test.fTheta, result.thetaNdf);
+  result.thetaPValue = Chi2PValue(result.thetaChi2, result.thetaNdf);
+  return result;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+}  // namespace B4
@@ -0,0 +1,290 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+//
+/// \file B4/B4a/src/EntrySummary.cc
+/// \brief Implementation of the B4::EntrySummary class
+
+#include "EntrySummary.hh"
+#include "EntryBuffer.hh"
+
+#include "G4ParticleDefinition.hh"
+#include "G4ParticleTable.hh"
+#include "G4SystemOfUnits.hh"
+
+#include <algorithm>
+#include <cmath>
+#include <iomanip>
+#include <sstream>
+
+namespace
+{
+G4double Rms(G4double sum, G4double sum2, G4double w)
+{
+  if (w <= 0.) return 0.;
+  G4double mean = sum / w;
+  return std::sqrt(std::max(sum2 / w - mean * mean, 0.));
+}
+}  // namespace
+
+namespace B4
+{
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+EntrySummary::Species& EntrySummary::Find(G4int pdg, G4int primaryPdg, G4double primaryEnergy)
+{
+  auto match = [&](const Species& s) {
+    return s.pdg == pdg && s.primaryPdg == primaryPdg && s.primaryEnergy == primaryEnergy;
+  };
+  // 同一事件中大多是同一种粒子，先查上一次的 slot
+  if (fLast < fSpecies.size() && match(fSpecies[fLast])) return fSpecies[fLast];
+  for (std::size_t i = 0; i < fSpecies.size(); ++i) {
+    if (match(fSpecies[i])) {
+      fLast = i;
+      return fSpecies[i];
+    }
+  }
+  fLast = fSpecies.size();
+  Species& s = fSpecies.emplace_back();
+  s.pdg = pdg;
+  s.primaryPdg = primaryPdg;
+  s.primaryEnergy = primaryEnergy;
+  return s;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+EntrySummary::Primary& EntrySummary::FindPrimary(G4int pdg, G4double energy)
+{
+  for (auto& p : fPrimaries) {
+    if (p.pdg == pdg && p.energy == energy) return p;
+  }
+  Primary& p = fPrimaries.emplace_back();
+  p.pdg = pdg;
+  p.energy = energy;
+  return p;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void EntrySummary::SetPrimaryGrouping(G4bool enable, G4bool resolveEnergy)
+{
+  fGrouped = enable;
+  fResolveEnergy = enable && resolveEnergy;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void EntrySummary::Fill(const EntryBuffer& entries)
+{
+  constexpr G4double energyScale = kEnergyBins / (kLogEMax - kLogEMin);
+  for (const auto& entry : entries) {
+    G4double w = entry.weight;
+    Species& s = fGrouped ? Find(entry.pdg, entry.primaryPdg, GroupEnergy(entry.primaryE))
+                          : Find(entry.pdg, 0, 0.);
+    G4double p = std::sqrt(entry.px * entry.px + entry.py * entry.py + entry.pz * entry.pz);
+    ++s.entries;
+    s.sumW += w;
+    s.sumW2 += w * w;
+    s.sumE += w * entry.E;
+    s.sumE2 += w * entry.E * entry.E;
+    s.sumP += w * p;
+    s.sumP2 += w * p * p;
+    s.sumTheta += w * entry.theta;
+    s.sumTheta2 += w * entry.theta * entry.theta;
+    if (entry.E > 0.) {
+      auto bin = static_cast<G4int>((std::log10(entry.E / MeV) - kLogEMin) * energyScale);
+      s.logE[std::min(std::max(bin, 0), kEnergyBins - 1)] += w;
+    }
+  }
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void EntrySummary::AddPrimary(G4int pdg, G4double energy, G4double transmitted)
+{
+  if (!fGrouped) return;
+  Primary& p = FindPrimary(pdg, GroupEnergy(energy));
+  ++p.primaries;
+  p.sumT += transmitted;
+  p.sumT2 += transmitted * transmitted;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void EntrySummary::Merge(const G4VAccumulable& other)
+{
+  const auto& rhs = static_cast<const EntrySummary&>(other);
+  for (const auto& r : rhs.fSpecies) {
+    Species& s = Find(r.pdg, r.primaryPdg, r.primaryEnergy);
+    s.entries += r.entries;
+    s.sumW += r.sumW;
+    s.sumW2 += r.sumW2;
+    s.sumE += r.sumE;
+    s.sumE2 += r.sumE2;
+    s.sumP += r.sumP;
+    s.sumP2 += r.sumP2;
+    s.sumTheta += r.sumTheta;
+    s.sumTheta2 += r.sumTheta2;
+    for (G4int i = 0; i < kEnergyBins; ++i) s.logE[i] += r.logE[i];
+  }
+  for (const auto& r : rhs.fPrimaries) {
+    Primary& p = FindPrimary(r.pdg, r.energy);
+    p.primaries += r.primaries;
+    p.sumT += r.sumT;
+    p.sumT2 += r.sumT2;
+  }
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void EntrySummary::Reset()
+{
+  fSpecies.clear();
+  fPrimaries.clear();
+  fLast = 0;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+G4long EntrySummary::GetTotalEntries() const
+{
+  G4long total = 0;
+  for (const auto& s : fSpecies) total += s.entries;
+  return total;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void EntrySummary::Print(std::ostream& os) const
+{
+  auto* table = G4ParticleTable::GetParticleTable();
+  auto name = [table](G4int pdg) {
+    const auto* particle = table->FindParticle(pdg);
+    return particle ? particle->GetParticleName() : G4String(std::to_string(pdg));
+  };
+
+  // 分组时：每组初级粒子的透射率，粒子表为所有组之和
+  std::vector<Species> merged;
+  const std::vector<Species>* species = &fSpecies;
+  if (fGrouped) {
+    os << " " << std::left << std::setw(12) << "primary" << std::right << std::setw(14)
+       << "E [MeV]" << std::setw(12) << "primaries" << std::setw(26) << "transmission" << "\n";
+    for (const auto& p : fPrimaries) {
+      G4double mean = p.primaries > 0 ? p.sumT / p.primaries : 0.;
+      G4double error = p.primaries > 0
+        ? std::sqrt(std::max(p.sumT2 / p.primaries - mean * mean, 0.) / p.primaries) : 0.;
+      os << " " << std::left << std::setw(12) << name(p.pdg) << std::right << std::setw(14);
+      if (fResolveEnergy) os << p.energy / MeV;
+      else os << "all";
+      os << std::setw(12) << p.primaries << std::setw(14) << mean << " +- " << error << "\n";
+    }
+    for (const auto& s : fSpecies) {
+      auto it = std::find_if(merged.begin(), merged.end(),
+                             [&s](const Species& m) { return m.pdg == s.pdg; });
+      if (it == merged.end()) {
+        merged.push_back(s);
+        continue;
+      }
+      it->entries += s.entries;
+      it->sumW += s.sumW;
+      it->sumE += s.sumE;
+      it->sumE2 += s.sumE2;
+      it->sumP += s.sumP;
+      it->sumP2 += s.sumP2;
+      it->sumTheta += s.sumTheta;
+      it->sumTheta2 += s.sumTheta2;
+    }
+    species = &merged;
+  }
+
+  // 按数目从多到少
+  std::vector<const Species*> order;
+  for (const auto& s : *species) order.push_back(&s);
+  std::sort(order.begin(), order.end(),
+            [](const Species* a, const Species* b) { return a->entries > b->entries; });
+
+  os << " " << std::left << std::setw(12) << "particle" << std::right << std::setw(12)
+     << "entries" << std::setw(22) << "<E> +- rms [MeV]" << std::setw(22) << "<p> +- rms [MeV]"
+     << std::setw(20) << "<theta> +- rms [deg]" << "\n";
+  for (const auto* s : order) {
+    G4double w = s->sumW;
+    os << " " << std::left << std::setw(12) << name(s->pdg) << std::right << std::setw(12)
+       << s->entries
+       << std::fixed << std::setprecision(3)
+       << std::setw(12) << (w > 0. ? s->sumE / w / MeV : 0.) << " +- " << std::setw(6)
+       << Rms(s->sumE, s->sumE2, w) / MeV
+       << std::setw(12) << (w > 0. ? s->sumP / w / MeV : 0.) << " +- " << std::setw(6)
+       << Rms(s->sumP, s->sumP2, w) / MeV
+       << std::setprecision(2)
+       << std::setw(10) << (w > 0. ? s->sumTheta / w : 0.) << " +- " << std::setw(6)
+       << Rms(s->sumTheta, s->sumTheta2, w) << "\n";
+    os.unsetf(std::ios::fixed);
+  }
+  os << std::setprecision(6);
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void EntrySummary::Write(std::ostream& os, const G4String& key) const
+{
+  // 分组时的前缀：key.primary.<pdg>[@<E MeV>]
+  auto group = [&](G4int pdg, G4double energy) {
+    std::ostringstream label;
+    label << key << ".primary." << pdg;
+    if (fResolveEnergy) label << "@" << std::setprecision(10) << energy / MeV;
+    return G4String(label.str());
+  };
+
+  os << std::setprecision(17);
+  for (const auto& p : fPrimaries) {
+    G4String prefix = group(p.pdg, p.energy) + ".";
+    os << prefix << "primaries = " << p.primaries << "\n"
+       << prefix << "transmitted = " << p.sumT << "\n"
+       << prefix << "transmitted2 = " << p.sumT2 << "\n";
+  }
+  for (const auto& s : fSpecies) {
+    G4String prefix = (fGrouped ? group(s.primaryPdg, s.primaryEnergy) : key) + "."
+                      + std::to_string(s.pdg) + ".";
+    os << prefix << "entries = " << s.entries << "\n"
+       << prefix << "sum_w = " << s.sumW << "\n"
+       << prefix << "sum_w2 = " << s.sumW2 << "\n"
+       << prefix << "sum_E = " << s.sumE / MeV << "\n"
+       << prefix << "sum_E2 = " << s.sumE2 / (MeV * MeV) << "\n"
+       << prefix << "sum_p = " << s.sumP / MeV << "\n"
+       << prefix << "sum_p2 = " << s.sumP2 / (MeV * MeV) << "\n"
+       << prefix << "sum_theta = " << s.sumTheta << "\n"
+       << prefix << "sum_theta2 = " << s.sumTheta2 << "\n"
+       << prefix << "logE =";
+    for (G4double v : s.logE) os << " " << v;
+    os << "\n";
+  }
+  os << std::setprecision(6);
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+}  // namespace B4
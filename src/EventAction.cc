@@ -29,83 +29,300 @@
 
 #include "EventAction.hh"
 #include "RunAction.hh"
+#include "StackingPolicy.hh"
 #include "G4AnalysisManager.hh"
 #include "G4Event.hh"
 #include "G4RunManager.hh"
 #include "G4ios.hh"
 #include "PrimaryGeneratorAction.hh"
 #include "G4AccumulableManager.hh"
+#include "ColumnarWriter.hh"
+#include "FastStart.hh"
+#include "G4ParticleDefinition.hh"
+#include "G4Step.hh"
+#include "G4StepPoint.hh"
+#include "G4Track.hh"
+#include "G4PrimaryVertex.hh"
+#include "G4PrimaryParticle.hh"
+#include "G4VProcess.hh"
+
+#include <algorithm>
+#include <cmath>
 
 
 namespace B4
 {
 
-EventAction::EventAction()
-  : G4UserEventAction()
-    //fRecorded(false),
-    //fTheta(0.), fPhi(0.)
-{}
+EventAction::EventAction(RunAction* runAction, const StackingPolicy* policy)
+  : G4UserEventAction(),
+    fRunAction(runAction),
+    fPolicy(policy)
+{
+  fTrackLine.reserve(1024);
+  fLinePrimary.reserve(64);
+  fLineEntered.reserve(64);
+  fLineCrossed.reserve(256);
+  fTrackFlags.reserve(1024);
+  fEntryProducts.reserve(64);
+}
+
+void EventAction::BeginOfEventAction(const G4Event* event)
+{
+  if constexpr (kProfilingEnabled) fRunAction->GetProfile().BeginEvent();
+  FastStart::FirstEvent();
+
+  // 只重置填充位置，缓冲区内存保留给下一个事件
+  fEntries.Clear();
+  fCrossings.Clear();
+  fTrackFlags.clear();
+  fEntryProducts.clear();
+  // 规则只在 run 之间改变
+  fHasEntryKills = fPolicy && fPolicy->HasEntryKills();
+
+  // 初级粒子的径迹号为 1..n (按顶点和粒子的顺序)
+  G4int primaries = 0;
+  for (G4int i = 0; i < event->GetNumberOfPrimaryVertex(); ++i) {
+    primaries += event->GetPrimaryVertex(i)->GetNumberOfParticle();
+  }
+  fTrackLine.assign(primaries + 1, -1);
+  fLinePrimary.clear();
+  for (G4int i = 0; i < primaries; ++i) {
+    fTrackLine[i + 1] = i;
+    fLinePrimary.push_back(i);
+  }
+  fLineEntered.assign(primaries, 0);
+  fPrimaryWeight.assign(primaries, 0.);
+
+  // 虚拟计分平面 (run 开始时确定)
+  fPlanes = fRunAction->GetPlaneTally().GetNumberOfPlanes();
+  fPlaneWeight.assign(primaries * fPlanes, 0.);
+  fPlaneReturned.assign(primaries * fPlanes, 0.);
+  fLineCrossed.assign(primaries * fPlanes, 0);
+
+  fPrimaryPdg = 0;
+  fPrimaryEnergy = 0.;
+  if (primaries > 0) {
+    const auto* primary = event->GetPrimaryVertex(0)->GetPrimary(0);
+    fPrimaryPdg = primary->GetPDGcode();
+    fPrimaryEnergy = primary->GetKineticEnergy();
+  }
+
+  // 快速模拟训练：一个事件一个初级粒子
+  auto& targetExits = fRunAction->GetTargetExits();
+  if (targetExits.IsTraining()) targetExits.BeginPrimary();
+}
+
+void EventAction::NoteSecondary(const G4Track* track)
+{
+  // 重要性抽样分裂出的副本与母径迹属于同一个初级粒子
+  G4int parent = LineOf(track->GetParentID());
+  if (parent < 0) return;
+  const auto* creator = track->GetCreatorProcess();
+  if (creator && creator->GetProcessName() == "ImportanceProcess") {
+    G4int trackID = track->GetTrackID();
+    if (trackID >= static_cast<G4int>(fTrackLine.size())) fTrackLine.resize(trackID + 1, -1);
+    fTrackLine[trackID] = static_cast<G4int>(fLinePrimary.size());
+    fLinePrimary.push_back(fLinePrimary[parent]);
+    fLineEntered.push_back(0);
+    fLineCrossed.resize(fLineCrossed.size() + fPlanes, 0);
+  }
+}
+
+void EventAction::RecordEntry(G4Track* track, const G4StepPoint* point)
+{
+  G4int pdg = track->GetParticleDefinition()->GetPDGEncoding();
+  G4double E = point->GetKineticEnergy();
+  G4ThreeVector pMom = point->GetMomentum();
+
+  // 初级粒子 (或其副本) 到达探测器即为透射，按径迹权重计入
+  // (每条径迹只计一次；无偏置时每个初级粒子为 0 或 1)
+  G4int line = LineOf(track->GetTrackID());
+  if (line >= 0 && !fLineEntered[line]) {
+    fLineEntered[line] = 1;
+    fPrimaryWeight[fLinePrimary[line]] += point->GetWeight();
+  }
+
+  // 验证模式：这个入射在启用径迹杀除时会丢失
+  // (被杀掉粒子的后代，或入射时本应终止的径迹再次入射)
+  G4int trackID = track->GetTrackID();
+  char flags = TrackFlags(trackID);
+  G4bool entryKilled = (flags & kEntryKilled) != 0;
+  G4bool flagged = (flags & kFlagged) != 0;
+  if (entryKilled || flagged) {
+    fRunAction->AddValidationLoss(pdg, E);
+  }
+
+  EntryRecord& entry = fEntries.Append();
+  entry.pdg = pdg;
+  entry.px = pMom.x();
+  entry.py = pMom.y();
+  entry.pz = pMom.z();
+  entry.E = E;
+  entry.weight = point->GetWeight();
+  entry.primaryPdg = fPrimaryPdg;
+  entry.primaryE = fPrimaryEnergy;
+  // theta/phi 在事件结束时批量计算 (ComputeAngles)
+
+  // 计分到此为止：终止径迹，动能计入 entry_killed。入射之前产生的次级粒子
+  // 照常输运，入射那一步的次级粒子由 NoteEntryProducts/StackingAction 杀掉。
+  // 验证模式下只做记录，本径迹的再入射和入射之后产生的后代计为丢失
+  if (fHasEntryKills && !entryKilled && !flagged && fPolicy->KillOnEntry(pdg, E)) {
+    fRunAction->AddEntryKill(pdg, E);
+    SetTrackFlag(trackID, kEntryKilled);
+    if (!fPolicy->IsValidation()) track->SetTrackStatus(fStopAndKill);
+  }
+}
+
+void EventAction::NoteEntryProducts(const G4Step* step)
+{
+  if (!(TrackFlags(step->GetTrack()->GetTrackID()) & kEntryKilled)) return;
+  const auto* secondaries = step->GetSecondaryInCurrentStep();
+  if (secondaries) {
+    fEntryProducts.insert(fEntryProducts.end(), secondaries->begin(), secondaries->end());
+  }
+}
 
-void EventAction::BeginOfEventAction(const G4Event* /*event*/)
+G4bool EventAction::TakeEntryProduct(const G4Track* track)
 {
-  //fRecorded = false;
-  //fTheta = 0.;
-  //fPhi = 0.;
-  fPDGs.clear();
-  fThetas.clear();
-  fPhis.clear();
-  fpx.clear();
-  fpy.clear();
-  fpz.clear();
-  fE.clear();  
+  auto it = std::find(fEntryProducts.begin(), fEntryProducts.end(), track);
+  if (it == fEntryProducts.end()) return false;
+  *it = fEntryProducts.back();
+  fEntryProducts.pop_back();
+  return true;
 }
 
-void EventAction::RecordEntry(G4int pdg,G4double E,
-                              const G4ThreeVector& pDir,
-                              const G4ThreeVector& pMom)
+void EventAction::RecordCrossing(const G4Track* track, const G4StepPoint* point, G4int plane,
+                                 const G4ThreeVector& direction)
 {
-  // if (!fRecorded) {
-  //   fRecorded = true;
-  //   fTheta = pDir.theta() / CLHEP::deg;  // 以角度为单位
-  //   fPhi   = pDir.phi()   / CLHEP::deg;
-  // }
-  fPDGs.push_back(pdg);
-  fThetas.push_back(pDir.theta() / CLHEP::deg);  // 转换为角度
-  fPhis.push_back(pDir.phi() / CLHEP::deg);
-  fpx.push_back(pMom.x());
-  fpy.push_back(pMom.y());
-  fpz.push_back(pMom.z());
-  fE.push_back(E);
+  G4double weight = point->GetWeight();
+  G4bool forward = direction.z() > 0.;
+  fRunAction->GetPlaneTally().AddCrossing(plane, forward, weight);
+
+  // 初级粒子 (或其副本)：第一次向前穿过计入该平面的透射，
+  // 之后向后穿过计为返回 (来自平面后方材料的反散射)
+  G4int line = LineOf(track->GetTrackID());
+  if (line >= 0) {
+    std::size_t cell = std::size_t(fLinePrimary[line]) * fPlanes + plane;
+    char& state = fLineCrossed[std::size_t(line) * fPlanes + plane];
+    if (forward && state == 0) {
+      state = 1;
+      fPlaneWeight[cell] += weight;
+    }
+    else if (!forward && state == 1) {
+      state = 2;
+      fPlaneReturned[cell] += weight;
+    }
+  }
+
+  EntryRecord& entry = fCrossings.Append();
+  entry.pdg = track->GetParticleDefinition()->GetPDGEncoding();
+  G4ThreeVector pMom = point->GetMomentum().mag() * direction;
+  entry.px = pMom.x();
+  entry.py = pMom.y();
+  entry.pz = pMom.z();
+  entry.E = point->GetKineticEnergy();
+  entry.weight = weight;
+  entry.plane = plane;
+  entry.primaryPdg = fPrimaryPdg;
+  entry.primaryE = fPrimaryEnergy;
 }
 
 void EventAction::EndOfEventAction(const G4Event* event)
 {
-  auto* analysis = G4AnalysisManager::Instance();
-  G4int eventID = event->GetEventID();
-  // 为每个粒子填充一行数据
-  for (size_t i = 0; i < fThetas.size(); ++i) {
-    double p = sqrt(fpx[i]*fpx[i] + fpy[i]*fpy[i] + fpz[i]*fpz[i]);
-    analysis->FillNtupleIColumn(0, fPDGs[i]);
-    analysis->FillNtupleDColumn(1, fpx[i]); 
-    analysis->FillNtupleDColumn(2, fpy[i]); 
-    analysis->FillNtupleDColumn(3, fpz[i]); 
-    analysis->FillNtupleDColumn(4, fE[i]);
-    analysis->FillNtupleDColumn(5, fThetas[i]);  // θ
-    analysis->FillNtupleDColumn(6, fPhis[i]);    // φ
-    analysis->AddNtupleRow();  // 每粒子一行
-
-    analysis->FillH2(0, fThetas[i],fpx[i]);
-    analysis->FillH2(1, fThetas[i],fpy[i]);
-    analysis->FillH2(2, fThetas[i],fpz[i]);
-    analysis->FillH2(3, fThetas[i],p);    
-  // if (fRecorded) {
-  //   auto* analysis = G4AnalysisManager::Instance();
-  //   analysis->FillNtupleDColumn(0, fTheta);
-  //   analysis->FillNtupleDColumn(1, fPhi);
-  //   analysis->AddNtupleRow();
+  ComputeAngles(fEntries);
+  ComputeAngles(fCrossings);
+
+  // 初级粒子：透射 / 被阻挡，以及透射权重 (透射率的无偏估计)
+  G4int passed = 0;
+  for (G4double weight : fPrimaryWeight) {
+    if (weight > 0.) ++passed;
+    fRunAction->AddTransmission(weight);
+  }
+  fRunAction->AddPassedParticles(passed);
+  fRunAction->AddBlockedParticles(static_cast<G4int>(fPrimaryWeight.size()) - passed);
+
+  auto& targetExits = fRunAction->GetTargetExits();
+  if (targetExits.IsTraining()) targetExits.EndPrimary();
+
+  // 各平面：每个初级粒子的透射权重 (与探测器的透射相同的估计)
+  if (fPlanes > 0) {
+    auto& planes = fRunAction->GetPlaneTally();
+    planes.AddPrimaries(static_cast<G4long>(fPrimaryWeight.size()));
+    for (std::size_t i = 0; i < fPlaneWeight.size(); ++i) {
+      planes.AddPrimary(i % fPlanes, fPlaneWeight[i], fPlaneReturned[i]);
+    }
+  }
+
+  // 每个事件都计入 (包括没有入射的事件)，用于每事件入射数的统计
+  fRunAction->AddEventEntries(fEntries);
+  // 响应矩阵：没有入射的初级粒子也要计数 (归一化的分母)
+  if (fRunAction->IsOutputEnabled()
+      && fRunAction->GetOutputFormat() == RunAction::OutputFormat::Response) {
+    G4double transmitted = 0.;
+    for (G4double weight : fPrimaryWeight) transmitted += weight;
+    fRunAction->AddResponseEvent(fPrimaryPdg, fPrimaryEnergy, transmitted, fEntries);
   }
+  // 汇总格式：混合束流按初级粒子分组，每组的初级粒子数和透射
+  if (fRunAction->IsOutputEnabled()
+      && fRunAction->GetOutputFormat() == RunAction::OutputFormat::Summary) {
+    G4double transmitted = 0.;
+    for (G4double weight : fPrimaryWeight) transmitted += weight;
+    fRunAction->AddSummaryPrimary(fPrimaryPdg, fPrimaryEnergy, transmitted);
+  }
+  if (!fEntries.Empty() || !fCrossings.Empty()) FlushEntries();
+
+  // 事件耗时包括输出
+  if constexpr (kProfilingEnabled) fRunAction->GetProfile().EndEvent(event->GetEventID());
+}
+
+void EventAction::ComputeAngles(EntryBuffer& entries)
+{
+  // 与 G4ThreeVector::theta()/phi() 相同的定义，对整个事件一次计算
+  for (auto& entry : entries) {
+    G4double pt = std::sqrt(entry.px * entry.px + entry.py * entry.py);
+    entry.theta = std::atan2(pt, entry.pz) / CLHEP::deg;  // 转换为角度
+    entry.phi = std::atan2(entry.py, entry.px) / CLHEP::deg;
+  }
+}
 
+void EventAction::FlushEntries()
+{
+  // 列式输出：整个事件按列批量追加到本线程的 segment
+  if (auto* columnar = fRunAction->GetColumnarWriter()) {
+    columnar->Append(fEntries);
+    columnar->Append(fCrossings);
+    return;
+  }
+  // 汇总格式：只累加按粒子的统计，不写行
+  if (fRunAction->GetOutputFormat() == RunAction::OutputFormat::Summary) {
+    if (fRunAction->IsOutputEnabled()) fRunAction->AddSummaryEntries(fEntries);
+    return;
+  }
+  // 响应矩阵：已在 EndOfEventAction 中按事件累加
+  if (fRunAction->GetOutputFormat() == RunAction::OutputFormat::Response) return;
+
+  auto* analysis = G4AnalysisManager::Instance();
+
+  // 每粒子一行 ntuple (探测器的入射和平面的穿过，以 plane 列区分)
+  for (const auto* buffer : {&fEntries, &fCrossings}) {
+    for (const auto& entry : *buffer) {
+      analysis->FillNtupleIColumn(0, entry.pdg);
+      analysis->FillNtupleDColumn(1, entry.px);
+      analysis->FillNtupleDColumn(2, entry.py);
+      analysis->FillNtupleDColumn(3, entry.pz);
+      analysis->FillNtupleDColumn(4, entry.E);
+      analysis->FillNtupleDColumn(5, entry.theta);  // θ
+      analysis->FillNtupleDColumn(6, entry.phi);    // φ
+      analysis->FillNtupleDColumn(7, entry.weight);
+      analysis->FillNtupleIColumn(8, entry.plane);
+      analysis->FillNtupleIColumn(9, entry.primaryPdg);
+      analysis->FillNtupleDColumn(10, entry.primaryE);
+      analysis->AddNtupleRow();  // 每粒子一行
+    }
+  }
 
+  // 直方图：整个事件一次分箱，不经过分析管理器
+  if (auto* histograms = fRunAction->GetHistograms()) histograms->Fill(fEntries);
 }
 
 }  // namespace B4
\ No newline at end of file
@@ -0,0 +1,290 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+//
+/// \file B4/B4a/src/FastStart.cc
+/// \brief Implementation of the B4::FastStart class
+
+#include "FastStart.hh"
+
+#include "G4VUserPhysicsList.hh"
+#include "G4StateManager.hh"
+#include "G4ProductionCutsTable.hh"
+#include "G4ProductionCuts.hh"
+#include "G4RegionStore.hh"
+#include "G4Region.hh"
+#include "G4Material.hh"
+#include "G4Version.hh"
+#include "G4Exception.hh"
+#include "G4ios.hh"
+
+#include <atomic>
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include <sstream>
+#include <string>
+
+#ifdef __linux__
+#include <unistd.h>
+#endif
+
+namespace
+{
+using Clock = std::chrono::steady_clock;
+
+// 启动时刻：由主线程写入，第一个事件 (任意线程) 读取
+Clock::time_point gMain;
+Clock::time_point gRunManager;
+Clock::time_point gInitialized;
+Clock::time_point gTablesReady;
+G4double gProcessToMain = -1.;  // 进程启动到 main() 的毫秒数 (未知为负)
+G4String gTablesSource = "built";
+std::atomic<G4bool> gFirstEvent{false};
+
+G4double Milliseconds(Clock::time_point from, Clock::time_point to)
+{
+  return std::chrono::duration<G4double, std::milli>(to - from).count();
+}
+
+// 进程启动 (动态库加载、静态初始化) 到 main() 的时间，只在 Linux 上可得，
+// 分辨率为一个时钟滴答 (通常 10 ms)
+G4double ProcessAge()
+{
+#ifdef __linux__
+  std::ifstream stat("/proc/self/stat");
+  std::ifstream uptime("/proc/uptime");
+  std::string line;
+  G4double now = 0.;
+  if (!std::getline(stat, line) || !(uptime >> now)) return -1.;
+  // 第二个字段 (comm) 可能含空格，从最后一个 ')' 之后开始数；starttime 是第 22 个字段
+  std::istringstream fields(line.substr(line.rfind(')') + 2));
+  std::string field;
+  for (G4int i = 3; i <= 22 && (fields >> field); ++i) {
+    if (i == 22) return (now - std::stod(field) / sysconf(_SC_CLK_TCK)) * 1000.;
+  }
+#endif
+  return -1.;
+}
+
+G4String HexKey(std::uint64_t key)
+{
+  std::ostringstream text;
+  text << std::hex << std::setw(16) << std::setfill('0') << key;
+  return text.str();
+}
+}  // namespace
+
+namespace B4
+{
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+FastStart::FastStart()
+{
+  gMain = Clock::now();
+  gRunManager = gInitialized = gTablesReady = gMain;
+  gProcessToMain = ProcessAge();
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void FastStart::SetPhysicsList(G4VUserPhysicsList* physicsList, const G4String& description)
+{
+  fPhysicsList = physicsList;
+  fPhysicsDescription = description;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void FastStart::MarkRunManager()
+{
+  gRunManager = Clock::now();
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+G4bool FastStart::Notify(G4ApplicationState requestedState)
+{
+  // 通知时当前状态还是旧状态
+  auto current = G4StateManager::GetStateManager()->GetCurrentState();
+
+  // /run/initialize: PreInit -> Init -> Idle
+  if (current == G4State_Init && requestedState == G4State_Idle && !fInitialized) {
+    fInitialized = true;
+    gInitialized = Clock::now();
+  }
+  // run 开始：Idle -> Init (BuildPhysicsTables 之前)
+  else if (current == G4State_Idle && requestedState == G4State_Init) {
+    PreparePhysicsTables();
+  }
+  // 物理表已构建，几何已关闭
+  else if (current == G4State_Idle && requestedState == G4State_GeomClosed) {
+    if (!fTablesReady) {
+      fTablesReady = true;
+      gTablesReady = Clock::now();
+    }
+    if (!fPendingStore.empty()) StorePhysicsTables();
+  }
+  return true;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+std::uint64_t FastStart::PhysicsKey() const
+{
+  std::ostringstream text;
+  text << std::setprecision(17);
+  text << G4Version << '|' << fPhysicsDescription << '|';
+
+  // 存储的表对应物质-阈值对：所有区域的产生阈值和整个材料表
+  auto* cutsTable = G4ProductionCutsTable::GetProductionCutsTable();
+  text << cutsTable->GetLowEdgeEnergy() << ' ' << cutsTable->GetHighEdgeEnergy() << '|';
+  for (const auto* region : *G4RegionStore::GetInstance()) {
+    text << region->GetName();
+    if (const auto* cuts = region->GetProductionCuts()) {
+      for (G4int i = 0; i < NumberOfG4CutIndex; ++i) text << ' ' << cuts->GetProductionCut(i);
+    }
+    text << ';';
+  }
+  text << '|';
+  for (const auto* material : *G4Material::GetMaterialTable()) {
+    text << material->GetName() << ' ' << material->GetDensity() << ';';
+  }
+  return Hash(text.str());
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void FastStart::PreparePhysicsTables()
+{
+  fPendingStore.clear();
+  if (fCacheDir.empty() || !fPhysicsList) return;
+
+  std::filesystem::path dir(fCacheDir.c_str());
+  dir /= ("physics-" + HexKey(PhysicsKey())).c_str();
+  std::error_code error;
+  if (std::filesystem::is_directory(dir, error)) {
+    // 表还没构建过或者配置变了：从缓存读取
+    fPhysicsList->SetPhysicsTableRetrieved(dir.string());
+    if (!fTablesReady) gTablesSource = "retrieved from " + dir.string();
+  }
+  else {
+    fPhysicsList->ResetPhysicsTableRetrieved();
+    fPendingStore = dir.string();
+  }
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void FastStart::StorePhysicsTables()
+{
+  std::filesystem::path dir(fPendingStore.c_str());
+  fPendingStore.clear();
+
+  // 写到临时目录再改名：同时启动的作业不会读到写了一半的缓存
+  auto temporary = dir;
+  temporary += ".tmp" + std::to_string(Clock::now().time_since_epoch().count());
+  std::error_code error;
+  std::filesystem::create_directories(temporary, error);
+  if (error || !fPhysicsList->StorePhysicsTable(temporary.string())) {
+    G4ExceptionDescription msg;
+    msg << "Cannot store the physics tables in " << temporary.string()
+        << ", the cache is not used.";
+    G4Exception("FastStart::StorePhysicsTables()", "MyCode0018", JustWarning, msg);
+    std::filesystem::remove_all(temporary, error);
+    return;
+  }
+  std::filesystem::rename(temporary, dir, error);
+  if (error) {
+    // 另一个作业先保存了同一个键
+    std::filesystem::remove_all(temporary, error);
+    return;
+  }
+  G4cout << " Physics tables stored in " << dir.string() << G4endl;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void FastStart::FirstEvent()
+{
+  // 之后的事件只有一次读取
+  if (gFirstEvent.load(std::memory_order_relaxed) || gFirstEvent.exchange(true)) return;
+
+  auto now = Clock::now();
+  G4cout << std::fixed << std::setprecision(0)
+         << " Startup (ms since main()): run manager " << Milliseconds(gMain, gRunManager)
+         << ", /run/initialize " << Milliseconds(gMain, gInitialized)
+         << ", physics tables " << Milliseconds(gMain, gTablesReady)
+         << " (" << gTablesSource << ")"
+         << ", first event " << Milliseconds(gMain, now) << G4endl;
+  if (gProcessToMain >= 0.) {
+    G4cout << " Startup: process start to main() " << gProcessToMain
+           << " ms, to first event " << gProcessToMain + Milliseconds(gMain, now)
+           << " ms" << G4endl;
+  }
+  G4cout << std::defaultfloat << std::setprecision(6);
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+std::uint64_t FastStart::Hash(const G4String& text)
+{
+  // FNV-1a
+  std::uint64_t hash = 14695981039346656037ULL;
+  for (unsigned char c : text) {
+    hash ^= c;
+    hash *= 1099511628211ULL;
+  }
+  return hash;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+G4bool FastStart::HasKey(const G4String& dir, const G4String& file, std::uint64_t key)
+{
+  std::ifstream in((std::filesystem::path(dir.c_str()) / file.c_str()).string());
+  auto wanted = HexKey(key);
+  std::string line;
+  while (std::getline(in, line)) {
+    if (line == wanted) return true;
+  }
+  return false;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void FastStart::AddKey(const G4String& dir, const G4String& file, std::uint64_t key)
+{
+  std::error_code error;
+  std::filesystem::create_directories(dir.c_str(), error);
+  // 一行一个键，追加写入；并发的作业最多重复写同一个键
+  std::ofstream out((std::filesystem::path(dir.c_str()) / file.c_str()).string(), std::ios::app);
+  out << HexKey(key) << '\n';
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+}  // namespace B4
@@ -0,0 +1,295 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+//
+/// \file B4/B4a/src/FastTarget.cc
+/// \brief Implementation of the B4::FastTarget class
+
+#include "FastTarget.hh"
+#include "FastTargetMessenger.hh"
+#include "DetectorConstruction.hh"
+#include "EntryObservables.hh"
+#include "RunAction.hh"
+
+#include "G4RunManager.hh"
+#include "G4UImanager.hh"
+#include "G4UnitsTable.hh"
+#include "G4SystemOfUnits.hh"
+#include "G4Timer.hh"
+#include "G4Exception.hh"
+#include "G4ios.hh"
+
+#include <cmath>
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include <optional>
+#include <sstream>
+
+namespace
+{
+G4bool SameLength(G4double a, G4double b) { return std::abs(a - b) <= 1e-6 * std::max(a, b); }
+}  // namespace
+
+namespace B4
+{
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+FastTarget::FastTarget(DetectorConstruction* det)
+  : fDet(det)
+{
+  fMessenger = new FastTargetMessenger(this);
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+FastTarget::~FastTarget()
+{
+  delete fMessenger;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+TargetExitTable* FastTarget::FindKey(const TargetExitTable& key) const
+{
+  for (const auto& table : fTables) {
+    if (table->GetParticle() == key.GetParticle() && table->GetMaterial() == key.GetMaterial()
+        && SameLength(table->GetLength(), key.GetLength())
+        && SameLength(table->GetEnergy(), key.GetEnergy())) {
+      return table.get();
+    }
+  }
+  return nullptr;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void FastTarget::AddTable(const TargetExitTable& table)
+{
+  // 同一配置的表被替换
+  auto copy = std::make_unique<TargetExitTable>(table);
+  copy->SetTraining(false);
+  copy->Prepare();
+  if (auto* old = FindKey(table)) {
+    for (auto& item : fTables) {
+      if (item.get() == old) item = std::move(copy);
+    }
+  }
+  else {
+    fTables.push_back(std::move(copy));
+  }
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void FastTarget::AddTrainingResult(const TargetExitTable& table)
+{
+  if (table.GetPrimaries() <= 0.) return;
+
+  if (!fTrainingDir.empty()) {
+    std::filesystem::create_directories(fTrainingDir.c_str());
+    G4String path = fTrainingDir + "/" + table.FileName();
+    std::ofstream file(path);
+    if (!file) {
+      G4ExceptionDescription msg;
+      msg << "Cannot write the fast-simulation table " << path;
+      G4Exception("FastTarget::AddTrainingResult()", "MyCode0015", JustWarning, msg);
+    }
+    else {
+      table.Write(file);
+      G4cout << "快速模拟训练表: " << path << " (" << table.GetPrimaries() << " primaries, "
+             << table.GetMeanMultiplicity() << " exits/primary)" << G4endl;
+    }
+  }
+
+  // 验证时保留已经读入的表，被验证的是它
+  if (!fValidating || !FindKey(table)) AddTable(table);
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void FastTarget::Load(const G4String& path)
+{
+  std::vector<std::filesystem::path> files;
+  std::filesystem::path input(path.c_str());
+  if (std::filesystem::is_directory(input)) {
+    for (const auto& item : std::filesystem::directory_iterator(input)) {
+      if (item.path().extension() == ".fastsim") files.push_back(item.path());
+    }
+  }
+  else {
+    files.push_back(input);
+  }
+
+  G4int nofLoaded = 0;
+  for (const auto& file : files) {
+    std::ifstream is(file);
+    TargetExitTable table;
+    if (!is || !table.Read(is)) {
+      G4ExceptionDescription msg;
+      msg << "Cannot read the fast-simulation table " << file.string()
+          << " (missing file, other format or binning).";
+      G4Exception("FastTarget::Load()", "MyCode0015", JustWarning, msg);
+      continue;
+    }
+    AddTable(table);
+    ++nofLoaded;
+  }
+  G4cout << "快速模拟: 读入 " << nofLoaded << " 个表 (共 " << fTables.size() << " 个)" << G4endl;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+const TargetExitTable* FastTarget::Find(const G4String& particle, G4double energy) const
+{
+  G4String material = fDet->GetTargetMaterialName();
+  G4double length = fDet->GetTargetLength();
+
+  const TargetExitTable* best = nullptr;
+  G4double bestDifference = kEnergyTolerance;
+  for (const auto& table : fTables) {
+    if (table->GetParticle() != particle || table->GetMaterial() != material
+        || !SameLength(table->GetLength(), length)) {
+      continue;
+    }
+    G4double difference = std::abs(energy / table->GetEnergy() - 1.);
+    if (difference <= bestDifference) {
+      best = table.get();
+      bestDifference = difference;
+    }
+  }
+  return best;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void FastTarget::Print() const
+{
+  G4cout << "========== Fast Simulation ==========\n"
+         << " model                 : "
+         << (IsModelRegistered() ? (fEnabled ? "enabled" : "disabled") : "not registered")
+         << "\n"
+         << " training              : " << (fTrainingDir.empty() ? "off" : fTrainingDir) << "\n"
+         << " tables                : " << fTables.size() << "\n";
+  for (const auto& table : fTables) {
+    G4cout << "  " << table->GetParticle() << " " << G4BestUnit(table->GetEnergy(), "Energy")
+           << " " << table->GetMaterial() << " " << G4BestUnit(table->GetLength(), "Length")
+           << ": " << table->GetPrimaries() << " primaries, " << table->GetMeanMultiplicity()
+           << " exits/primary\n";
+  }
+  G4cout << "=====================================" << G4endl;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void FastTarget::Validate(G4int nofEvents)
+{
+  auto* runManager = G4RunManager::GetRunManager();
+  auto* runAction = dynamic_cast<const RunAction*>(runManager->GetUserRunAction());
+  if (!runAction || !IsModelRegistered()) {
+    G4ExceptionDescription msg;
+    msg << "Validation needs the run action and the fast model (exampleB4a --fastsim).";
+    G4Exception("FastTarget::Validate()", "MyCode0015", JustWarning, msg);
+    return;
+  }
+
+  // 验证过程中不写输出文件
+  auto* uiManager = G4UImanager::GetUIpointer();
+  G4bool outputEnabled = runAction->IsOutputEnabled();
+  uiManager->ApplyCommand("/run/output/enableRoot false");
+  G4bool enabled = fEnabled;
+
+  struct Result
+  {
+    G4double wallTime = 0.;
+    G4long steps = 0;
+    G4double transmission = 0.;
+    G4double transmissionError = 0.;
+    std::optional<EntryObservables> observables;
+  };
+  auto beamOn = [&](Result& result) {
+    G4Timer timer;
+    timer.Start();
+    runManager->BeamOn(nofEvents);
+    timer.Stop();
+    result.wallTime = timer.GetRealElapsed();
+    result.steps = runAction->GetSteps();
+    result.transmission = runAction->GetTransmission(result.transmissionError);
+    result.observables.emplace(runAction->GetEntryObservables());
+  };
+
+  // 完整模拟；当前配置还没有表时，同时训练出一个
+  Result full;
+  std::size_t nofTables = fTables.size();
+  G4cout << "===== Fast simulation validation: full simulation" << G4endl;
+  fEnabled = false;
+  fValidating = true;
+  beamOn(full);
+  fValidating = false;
+  G4bool trained = fTables.size() > nofTables;
+
+  Result fast;
+  G4cout << "===== Fast simulation validation: fast simulation" << G4endl;
+  fEnabled = true;
+  beamOn(fast);
+
+  fEnabled = enabled;
+  if (outputEnabled) uiManager->ApplyCommand("/run/output/enableRoot true");
+
+  auto compatibility = EntryObservables::Compare(*full.observables, *fast.observables);
+  auto rate = [&](const Result& result) {
+    return result.wallTime > 0. ? nofEvents / result.wallTime : 0.;
+  };
+
+  std::ostringstream os;
+  os << "========== Fast Simulation Validation ==========\n"
+     << " " << nofEvents << " events each, " << fDet->GetTargetMaterialName() << " "
+     << G4BestUnit(fDet->GetTargetLength(), "Length") << ", table "
+     << (trained ? "trained in the full run" : "loaded") << "\n"
+     << std::setw(8) << "" << std::setw(12) << "events/s" << std::setw(12) << "steps/evt"
+     << std::setw(24) << "transmission" << std::setw(24) << "entries/event" << "\n"
+     << std::setprecision(4);
+  for (const auto* result : { &full, &fast }) {
+    std::ostringstream transmission, entries;
+    transmission << std::setprecision(4) << result->transmission << " +- "
+                 << result->transmissionError;
+    entries << std::setprecision(4) << result->observables->GetEntriesPerEvent() << " +- "
+            << result->observables->GetEntriesPerEventError();
+    os << std::setw(8) << (result == &full ? "full" : "fast") << std::setw(12) << rate(*result)
+       << std::setw(12) << (nofEvents > 0 ? (G4double)result->steps / nofEvents : 0.)
+       << std::setw(24) << transmission.str() << std::setw(24) << entries.str() << "\n";
+  }
+  os << " speed-up              : " << (fast.wallTime > 0. ? full.wallTime / fast.wallTime : 0.)
+     << "\n"
+     << " p-values              : rate " << compatibility.ratePValue << ", energy "
+     << compatibility.energyPValue << ", theta " << compatibility.thetaPValue << "\n"
+     << "================================================";
+  G4cout << os.str() << G4endl;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+}  // namespace B4
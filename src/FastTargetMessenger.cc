@@ -0,0 +1,93 @@
+#include "FastTargetMessenger.hh"
+#include "FastTarget.hh"
+
+#include "G4UIdirectory.hh"
+#include "G4UIcommand.hh"
+#include "G4UIcmdWithAString.hh"
+#include "G4UIcmdWithABool.hh"
+#include "G4UIcmdWithAnInteger.hh"
+#include "G4UIcmdWithoutParameter.hh"
+
+namespace B4 {
+
+FastTargetMessenger::FastTargetMessenger(FastTarget* fastTarget)
+ : fFastTarget(fastTarget)
+{
+  fFastSimDir = new G4UIdirectory("/fastsim/");
+  fFastSimDir->SetGuidance("Fast-simulation parameterisation of the target (exampleB4a --fastsim)");
+
+  fEnableCmd = new G4UIcmdWithABool("/fastsim/enable", this);
+  fEnableCmd->SetGuidance("Replace primaries entering the target by a sample of the table");
+  fEnableCmd->SetGuidance("of the current configuration (needs exampleB4a --fastsim)");
+  fEnableCmd->SetParameterName("flag", false);
+  fEnableCmd->AvailableForStates(G4State_PreInit, G4State_Idle);
+  fEnableCmd->SetToBeBroadcasted(false);
+
+  fTrainCmd = new G4UIcmdWithAString("/fastsim/train", this);
+  fTrainCmd->SetGuidance("Record the particles leaving the target in the following (full)");
+  fTrainCmd->SetGuidance("runs and write one table per run into this directory; none stops");
+  fTrainCmd->SetGuidance("(single-species beams only: runs with /beam/species are not trained)");
+  fTrainCmd->SetParameterName("directory", false);
+  fTrainCmd->AvailableForStates(G4State_PreInit, G4State_Idle);
+  fTrainCmd->SetToBeBroadcasted(false);
+
+  fLoadCmd = new G4UIcmdWithAString("/fastsim/load", this);
+  fLoadCmd->SetGuidance("Load a .fastsim table, or all tables of a directory");
+  fLoadCmd->SetParameterName("path", false);
+  fLoadCmd->AvailableForStates(G4State_PreInit, G4State_Idle);
+  fLoadCmd->SetToBeBroadcasted(false);
+
+  fClearCmd = new G4UIcmdWithoutParameter("/fastsim/clear", this);
+  fClearCmd->SetGuidance("Remove all tables");
+  fClearCmd->AvailableForStates(G4State_PreInit, G4State_Idle);
+  fClearCmd->SetToBeBroadcasted(false);
+
+  fPrintCmd = new G4UIcmdWithoutParameter("/fastsim/print", this);
+  fPrintCmd->SetGuidance("Print the state of the fast model and the loaded tables");
+  fPrintCmd->AvailableForStates(G4State_PreInit, G4State_Idle);
+  fPrintCmd->SetToBeBroadcasted(false);
+
+  fValidateCmd = new G4UIcmdWithAnInteger("/fastsim/validate", this);
+  fValidateCmd->SetGuidance("Run n events in full and n events fast with the current gun and");
+  fValidateCmd->SetGuidance("geometry, and compare the detector entries and the event rate");
+  fValidateCmd->SetParameterName("n", true);
+  fValidateCmd->SetDefaultValue(1000);
+  fValidateCmd->SetRange("n>0");
+  fValidateCmd->AvailableForStates(G4State_Idle);
+  fValidateCmd->SetToBeBroadcasted(false);
+}
+
+FastTargetMessenger::~FastTargetMessenger()
+{
+  delete fEnableCmd;
+  delete fTrainCmd;
+  delete fLoadCmd;
+  delete fClearCmd;
+  delete fPrintCmd;
+  delete fValidateCmd;
+  delete fFastSimDir;
+}
+
+void FastTargetMessenger::SetNewValue(G4UIcommand* cmd, G4String val)
+{
+  if (cmd == fEnableCmd) {
+    fFastTarget->SetEnabled(fEnableCmd->GetNewBoolValue(val));
+  }
+  else if (cmd == fTrainCmd) {
+    fFastTarget->SetTrainingDirectory(val == "none" ? G4String() : val);
+  }
+  else if (cmd == fLoadCmd) {
+    fFastTarget->Load(val);
+  }
+  else if (cmd == fClearCmd) {
+    fFastTarget->Clear();
+  }
+  else if (cmd == fPrintCmd) {
+    fFastTarget->Print();
+  }
+  else if (cmd == fValidateCmd) {
+    fFastTarget->Validate(fValidateCmd->GetNewIntValue(val));
+  }
+}
+
+}  // namespace B4
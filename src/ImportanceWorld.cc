@@ -0,0 +1,155 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+//
+/// \file B4/B4a/src/ImportanceWorld.cc
+/// \brief Implementation of the B4::ImportanceWorld class
+
+#include "ImportanceWorld.hh"
+#include "ImportanceWorldMessenger.hh"
+#include "DetectorConstruction.hh"
+
+#include "G4GeometryCell.hh"
+#include "G4IStore.hh"
+#include "G4LogicalVolume.hh"
+#include "G4PVPlacement.hh"
+#include "G4SystemOfUnits.hh"
+#include "G4Tubs.hh"
+#include "G4UnitsTable.hh"
+#include "G4Exception.hh"
+#include "G4ios.hh"
+
+#include <algorithm>
+#include <cmath>
+
+namespace B4
+{
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+ImportanceWorld::ImportanceWorld(const G4String& worldName, const DetectorConstruction* det)
+  : G4VUserParallelWorld(worldName),
+    fDet(det)
+{
+  fMessenger = new ImportanceWorldMessenger(this);
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+ImportanceWorld::~ImportanceWorld()
+{
+  delete fMessenger;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void ImportanceWorld::SetRatio(G4double ratio)
+{
+  fRatio = ratio;
+  fValues.clear();
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+G4double ImportanceWorld::GetImportance(G4int slab) const
+{
+  if (!fValues.empty()) {
+    return fValues[std::min<std::size_t>(slab, fValues.size() - 1)];
+  }
+  return std::pow(fRatio, slab);
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void ImportanceWorld::Construct()
+{
+  fGhostWorld = GetWorld();
+  G4LogicalVolume* worldLV = fGhostWorld->GetLogicalVolume();
+
+  // 重建几何 (靶长度、slab 数改变) 时先移除旧的 cell
+  for (auto* cell : fCells) {
+    worldLV->RemoveDaughter(cell);
+    delete cell;
+  }
+  fCells.clear();
+
+  G4double length = fDet->GetTargetLength();
+  G4double zFront = fDet->GetTargetPosition().z() - length / 2;
+  G4double zEnd = zFront + length;
+  G4double zDetectorEnd = fDet->GetDetectorLength() / 2;
+  G4double radius = std::max(fDet->GetDetectorRadius(), fDet->GetTargetRadius());
+  G4double slabLength = length / fNofSlabs;
+
+  // 并行世界中的体积不需要材料
+  auto* slabSolid = new G4Tubs("ImportanceSlab", 0., radius, slabLength / 2, 0., 360. * deg);
+  auto* slabLV = new G4LogicalVolume(slabSolid, nullptr, "ImportanceSlab");
+  for (G4int i = 0; i < fNofSlabs; ++i) {
+    G4double z = zFront + (i + 0.5) * slabLength;
+    fCells.push_back(new G4PVPlacement(nullptr, G4ThreeVector(0., 0., z), slabLV,
+                                       "ImportanceSlab", worldLV, false, i));
+  }
+
+  // 靶后到探测器末端：保持最后一个 slab 的重要性，穿出的粒子不被轮盘赌
+  if (zDetectorEnd > zEnd) {
+    G4double half = (zDetectorEnd - zEnd) / 2;
+    auto* exitSolid = new G4Tubs("ImportanceExit", 0., radius, half, 0., 360. * deg);
+    auto* exitLV = new G4LogicalVolume(exitSolid, nullptr, "ImportanceExit");
+    fCells.push_back(new G4PVPlacement(nullptr, G4ThreeVector(0., 0., zEnd + half), exitLV,
+                                       "ImportanceExit", worldLV, false, fNofSlabs));
+  }
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void ImportanceWorld::ConstructSD()
+{
+  // 每个线程 (重新) 填充自己的重要性表
+  G4IStore* store = G4IStore::GetInstance(GetName());
+  store->Clear();
+  store->AddImportanceGeometryCell(1., *fGhostWorld);
+  for (std::size_t i = 0; i < fCells.size(); ++i) {
+    G4int slab = std::min<G4int>(static_cast<G4int>(i), fNofSlabs - 1);
+    store->AddImportanceGeometryCell(GetImportance(slab), *fCells[i], fCells[i]->GetCopyNo());
+  }
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void ImportanceWorld::Print() const
+{
+  G4cout << "========== Importance Geometry ==========\n"
+         << " target                : " << fDet->GetTargetMaterialName() << ", "
+         << G4BestUnit(fDet->GetTargetLength(), "Length") << "\n"
+         << " slabs                 : " << fNofSlabs << " x "
+         << G4BestUnit(fDet->GetTargetLength() / fNofSlabs, "Length") << "\n"
+         << " importances           :";
+  for (G4int i = 0; i < fNofSlabs; ++i) G4cout << " " << GetImportance(i);
+  G4cout << "\n (world 1, downstream of the target " << GetImportance(fNofSlabs - 1) << ")\n"
+         << "=================================" << G4endl;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+}  // namespace B4
@@ -0,0 +1,94 @@
+#include "ImportanceWorldMessenger.hh"
+#include "ImportanceWorld.hh"
+
+#include "G4RunManager.hh"
+#include "G4UIdirectory.hh"
+#include "G4UIcommand.hh"
+#include "G4UIcmdWithAString.hh"
+#include "G4UIcmdWithADouble.hh"
+#include "G4UIcmdWithAnInteger.hh"
+#include "G4UIcmdWithoutParameter.hh"
+#include "G4Exception.hh"
+
+#include <sstream>
+#include <vector>
+
+namespace B4 {
+
+ImportanceWorldMessenger::ImportanceWorldMessenger(ImportanceWorld* world)
+ : fWorld(world)
+{
+  fImportanceDir = new G4UIdirectory("/det/importance/");
+  fImportanceDir->SetGuidance("Importance slabs along z through the target (--importance)");
+
+  fSlabsCmd = new G4UIcmdWithAnInteger("/det/importance/slabs", this);
+  fSlabsCmd->SetGuidance("Set the number of equal slabs the target is divided into");
+  fSlabsCmd->SetParameterName("n", false);
+  fSlabsCmd->SetRange("n>0");
+  fSlabsCmd->AvailableForStates(G4State_PreInit, G4State_Idle);
+  fSlabsCmd->SetToBeBroadcasted(false);
+
+  fRatioCmd = new G4UIcmdWithADouble("/det/importance/ratio", this);
+  fRatioCmd->SetGuidance("Importance of slab i is ratio^i (slab 0 at the upstream face);");
+  fRatioCmd->SetGuidance("roughly the attenuation over one slab. Replaces explicit values.");
+  fRatioCmd->SetParameterName("ratio", false);
+  fRatioCmd->SetRange("ratio>0");
+  fRatioCmd->AvailableForStates(G4State_PreInit, G4State_Idle);
+  fRatioCmd->SetToBeBroadcasted(false);
+
+  fValuesCmd = new G4UIcmdWithAString("/det/importance/values", this);
+  fValuesCmd->SetGuidance("Set the importance of every slab, upstream first, e.g. 1 2 4 8;");
+  fValuesCmd->SetGuidance("missing values repeat the last one");
+  fValuesCmd->SetParameterName("values", false);
+  fValuesCmd->AvailableForStates(G4State_PreInit, G4State_Idle);
+  fValuesCmd->SetToBeBroadcasted(false);
+
+  fPrintCmd = new G4UIcmdWithoutParameter("/det/importance/print", this);
+  fPrintCmd->SetGuidance("Print the slabs and their importances");
+  fPrintCmd->AvailableForStates(G4State_PreInit, G4State_Idle);
+  fPrintCmd->SetToBeBroadcasted(false);
+}
+
+ImportanceWorldMessenger::~ImportanceWorldMessenger()
+{
+  delete fSlabsCmd;
+  delete fRatioCmd;
+  delete fValuesCmd;
+  delete fPrintCmd;
+  delete fImportanceDir;
+}
+
+void ImportanceWorldMessenger::SetNewValue(G4UIcommand* cmd, G4String val)
+{
+  if (cmd == fPrintCmd) {
+    fWorld->Print();
+    return;
+  }
+
+  if (cmd == fSlabsCmd) {
+    fWorld->SetNumberOfSlabs(fSlabsCmd->GetNewIntValue(val));
+  }
+  else if (cmd == fRatioCmd) {
+    fWorld->SetRatio(fRatioCmd->GetNewDoubleValue(val));
+  }
+  else if (cmd == fValuesCmd) {
+    std::vector<G4double> values;
+    std::istringstream is(val);
+    G4double value = 0.;
+    while (is >> value) {
+      if (value <= 0.) {
+        G4ExceptionDescription msg;
+        msg << "Importances must be positive: " << val;
+        G4Exception("ImportanceWorldMessenger::SetNewValue()", "MyCode0014", JustWarning, msg);
+        return;
+      }
+      values.push_back(value);
+    }
+    fWorld->SetImportances(values);
+  }
+
+  // 各线程的重要性表在几何 (重新) 构造时填充
+  G4RunManager::GetRunManager()->ReinitializeGeometry();
+}
+
+}  // namespace B4
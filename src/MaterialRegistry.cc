@@ -0,0 +1,75 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+//
+/// \file B4/B4a/src/MaterialRegistry.cc
+/// \brief Implementation of the B4::MaterialRegistry class
+
+#include "MaterialRegistry.hh"
+
+#include "G4Material.hh"
+#include "G4NistManager.hh"
+#include "G4SystemOfUnits.hh"
+
+namespace B4
+{
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+MaterialRegistry::MaterialRegistry()
+{
+  // 使用NIST材料数据库
+  G4NistManager* nistManager = G4NistManager::Instance();
+
+  // 定义世界材料 - 真空
+  fMaterials["G4_Galactic"] = nistManager->FindOrBuildMaterial("G4_Galactic");
+
+  // 定义液态氢材料
+  G4double density = 0.0708*g/cm3;  // 液态氢密度
+  auto* liquidH2 = new G4Material("liquidH2", density, 1);
+  liquidH2->AddElement(nistManager->FindOrBuildElement("H"), 2);
+  fMaterials["liquidH2"] = liquidH2;
+
+  // 定义探测器材料 - 空气
+  fMaterials["G4_AIR"] = nistManager->FindOrBuildMaterial("G4_AIR");
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+G4Material* MaterialRegistry::Find(const G4String& name)
+{
+  auto it = fMaterials.find(name);
+  if (it != fMaterials.end()) return it->second;
+
+  // 其他地方定义的材料，或者按需构建的 NIST 材料
+  G4Material* material = G4Material::GetMaterial(name, false);
+  if (!material) material = G4NistManager::Instance()->FindOrBuildMaterial(name);
+  if (material) fMaterials[name] = material;
+  return material;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+}  // namespace B4
@@ -0,0 +1,143 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+//
+/// \file B4/B4a/src/PlaneTally.cc
+/// \brief Implementation of the B4::PlaneTally class
+
+#include "PlaneTally.hh"
+#include "G4SystemOfUnits.hh"
+
+#include <algorithm>
+#include <cmath>
+#include <iomanip>
+
+namespace B4
+{
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void PlaneTally::SetPlanes(const std::vector<G4double>& depths)
+{
+  fPlanes.assign(depths.size(), Plane());
+  for (std::size_t i = 0; i < depths.size(); ++i) fPlanes[i].depth = depths[i];
+  fPrimaries = 0;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void PlaneTally::Merge(const G4VAccumulable& other)
+{
+  const auto& rhs = static_cast<const PlaneTally&>(other);
+  // 所有线程的平面相同 (run 开始时设置)
+  for (std::size_t i = 0; i < std::min(fPlanes.size(), rhs.fPlanes.size()); ++i) {
+    Plane& p = fPlanes[i];
+    const Plane& q = rhs.fPlanes[i];
+    p.transmitted += q.transmitted;
+    p.transmitted2 += q.transmitted2;
+    p.returned += q.returned;
+    p.forward += q.forward;
+    p.backward += q.backward;
+    p.forwardWeight += q.forwardWeight;
+    p.backwardWeight += q.backwardWeight;
+  }
+  fPrimaries += rhs.fPrimaries;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void PlaneTally::Reset()
+{
+  for (auto& plane : fPlanes) {
+    G4double depth = plane.depth;
+    plane = Plane();
+    plane.depth = depth;
+  }
+  fPrimaries = 0;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+G4double PlaneTally::GetTransmission(std::size_t plane, G4double& error) const
+{
+  // 与 RunAction::GetTransmission 相同：每个初级粒子的透射权重的平均值
+  error = 0.;
+  if (fPrimaries == 0) return 0.;
+  const Plane& p = fPlanes[plane];
+  G4double mean = p.transmitted / fPrimaries;
+  G4double variance = p.transmitted2 / fPrimaries - mean * mean;
+  error = std::sqrt(std::max(variance, 0.) / fPrimaries);
+  return mean;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void PlaneTally::Print(std::ostream& os) const
+{
+  os << "========== Scoring Planes ==========\n"
+     << " Primaries             : " << fPrimaries << "\n"
+     << "  plane   depth[cm]   transmission            returned   forward   backward"
+     << "   backscatter\n";
+  for (std::size_t i = 0; i < fPlanes.size(); ++i) {
+    const Plane& p = fPlanes[i];
+    G4double error = 0.;
+    G4double transmission = GetTransmission(i, error);
+    // 返回：穿过平面后又穿回的初级粒子 (占透射的比例)；
+    // 反散射：所有粒子向后与向前穿过的权重之比
+    G4double returned = p.transmitted > 0. ? p.returned / p.transmitted : 0.;
+    G4double albedo = p.forwardWeight > 0. ? p.backwardWeight / p.forwardWeight : 0.;
+    os << std::setw(7) << i << std::setw(12) << p.depth / cm << "   " << std::left
+       << std::setw(10) << transmission << " +- " << std::setw(10) << error << std::right
+       << std::setw(10) << returned << std::setw(10) << p.forward << std::setw(11)
+       << p.backward << std::setw(14) << albedo << "\n";
+  }
+  os << "=================================" << std::endl;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void PlaneTally::Write(std::ostream& os, const G4String& key) const
+{
+  auto list = [&](const char* name, auto value) {
+    os << key << "." << name << " =";
+    for (const auto& plane : fPlanes) os << " " << value(plane);
+    os << "\n";
+  };
+  os << std::setprecision(17);
+  list("depth_cm", [](const Plane& p) { return p.depth / cm; });
+  os << key << ".primaries = " << fPrimaries << "\n";
+  list("transmitted", [](const Plane& p) { return p.transmitted; });
+  list("transmitted2", [](const Plane& p) { return p.transmitted2; });
+  list("returned", [](const Plane& p) { return p.returned; });
+  list("forward", [](const Plane& p) { return p.forward; });
+  list("backward", [](const Plane& p) { return p.backward; });
+  list("forward_weight", [](const Plane& p) { return p.forwardWeight; });
+  list("backward_weight", [](const Plane& p) { return p.backwardWeight; });
+  os << std::setprecision(6);
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+}  // namespace B4
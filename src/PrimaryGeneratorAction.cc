@@ -39,19 +39,28 @@
 #include "G4SystemOfUnits.hh"
 #include "globals.hh"
 #include "G4Event.hh"
+#include "G4PrimaryParticle.hh"
+#include "G4PrimaryVertex.hh"
+#include "BeamFile.hh"
 #include "Randomize.hh"
 #include "G4PhysicalConstants.hh"
+#include "G4RunManager.hh"
+#include "G4Run.hh"
+
+#include <algorithm>
+
 namespace B4
 {
 
 //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
 
-PrimaryGeneratorAction::PrimaryGeneratorAction()
+PrimaryGeneratorAction::PrimaryGeneratorAction(const BeamSource* beam, const SeedService* seeds)
 : G4VUserPrimaryGeneratorAction(),
   fParticleGun(new G4ParticleGun(1)),
   fBeamRate(50000), // 500,000 粒子/秒
   //fTimeWindow(1.0)   // 1秒时间窗口
-  fBeamRadius(2.5*cm) // 束斑半径2.5cm
+  fBeam(beam),
+  fSeeds(seeds)
 {
 
   // set particle information
@@ -71,21 +80,12 @@ PrimaryGeneratorAction::~PrimaryGeneratorAction()
 
 //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
 
-void PrimaryGeneratorAction::GeneratePrimaries(G4Event* event)
+void PrimaryGeneratorAction::PrepareRun()
 {
-  // This function is called at the begining of event
-
   // In order to avoid dependence of PrimaryGeneratorAction
   // on DetectorConstruction class we get world volume
-  // from G4LogicalVolumeStore
+  // from G4LogicalVolumeStore (once per run, the geometry is fixed during a run)
   //
-  
-  //在圆形截面内随机生成位置
-  G4double r = fBeamRadius * std::sqrt(G4UniformRand());
-  G4double phi = twopi * G4UniformRand();
-  G4double x = r * std::cos(phi);
-  G4double y = r * std::sin(phi);
-  //设置粒子位置 (假设在Z=-worldZHalfLength平面发射)
   G4double worldZHalfLength = 0.;
   auto worldLV = G4LogicalVolumeStore::GetInstance()->GetVolume("World");
 
@@ -102,19 +102,90 @@ void PrimaryGeneratorAction::GeneratePrimaries(G4Event* event)
     msg << "World volume of box shape not found." << G4endl;
     msg << "Perhaps you have changed geometry." << G4endl;
     msg << "The gun will be place in the center.";
-    G4Exception("PrimaryGeneratorAction::GeneratePrimaries()", "MyCode0002", JustWarning, msg);
+    G4Exception("PrimaryGeneratorAction::PrepareRun()", "MyCode0002", JustWarning, msg);
+  }
+  // 在Z=-worldZHalfLength平面发射
+  fSourceZ = -worldZHalfLength;
+
+  // 束流设置或 /gun/energy 在两次 run 之间可能改变：丢弃旧批次
+  fNominalEnergy = fParticleGun->GetParticleEnergy();
+  fSpecies.clear();
+  if (fBeam) {
+    auto* table = G4ParticleTable::GetParticleTable();
+    for (const auto& name : fBeam->GetSpecies()) fSpecies.push_back(table->FindParticle(name));
   }
+  fBatch.Clear();
+  fBatchBlock = -1;
+
+  const auto* run = G4RunManager::GetRunManager()->GetCurrentRun();
+  fRunID = run ? run->GetRunID() : 0;
+  fEventsInRun = run ? run->GetNumberOfEventToBeProcessed() : 0;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void PrimaryGeneratorAction::GeneratePrimaries(G4Event* event)
+{
+  // This function is called at the begining of event
+
+  // 事件的身份 (分片、replay 时平移)：决定种子、束流记录和事件时间
+  SeedService::EventKey key{fRunID, event->GetEventID()};
+  if (fSeeds) key = fSeeds->KeyFor(fRunID, event->GetEventID(), fEventsInRun);
 
-  // Set gun position
-  fParticleGun->SetParticlePosition(G4ThreeVector(x, y, -worldZHalfLength));
   // 计算当前事件的时间
-  G4double eventTime = event->GetEventID() / fBeamRate;
+  G4double eventTime = key.event / fBeamRate;
+  G4ThreeVector origin(0., 0., fSourceZ);
+
+  if (!fBeam) {
+    if (fSeeds) fSeeds->Reseed(key, SeedService::Stream::Physics);
+    fParticleGun->SetParticlePosition(origin);
+    fParticleGun->SetParticleTime(eventTime);
+    fParticleGun->GeneratePrimaryVertex(event);
+    return;
+  }
 
-  // 设置粒子生成时间
-  fParticleGun->SetParticleTime(eventTime);
-    
-  fParticleGun->GeneratePrimaryVertex(event); //把“准备好的”粒子封装到模拟事件里
+  // 实测束流文件：第 eventID mod N 条记录，与线程分配无关
+  BeamParticle particle;
+  if (const auto* file = fBeam->GetBeamFile()) {
+    const auto& record = (*file)[key.event % file->Size()];
+    particle.position.set(record.x * mm, record.y * mm, record.z * mm);
+    particle.direction = G4ThreeVector(record.dx, record.dy, record.dz).unit();
+    particle.energy = record.energy * MeV;
+    particle.time = record.time * ns;
+  }
+  else if (fSeeds) {
+    // 块 b 固定包含事件 b*n ... b*n+n-1，由块自己的种子抽样，
+    // 与本线程之前模拟过哪些事件无关
+    const auto n = static_cast<G4long>(std::max<std::size_t>(fBeam->GetBatchSize(), 1));
+    G4long block = key.event / n;
+    if (block != fBatchBlock || fBatch.particles.empty()) {
+      fSeeds->Reseed({key.run, block}, SeedService::Stream::Beam);
+      fBeam->Fill(fBatch, fNominalEnergy);
+      fBatchBlock = block;
+    }
+    particle = fBatch.particles[key.event - block * n];
+  }
+  else {
+    // 批次用完时整批重新抽样
+    if (fBatch.Empty()) fBeam->Fill(fBatch, fNominalEnergy);
+    particle = fBatch.particles[fBatch.next++];
+  }
 
+  // 物理过程的随机数只取决于 (run, event)
+  if (fSeeds) fSeeds->Reseed(key, SeedService::Stream::Physics);
+
+  // 直接构造初级顶点，粒子枪本身的状态 (能量等) 保持不变
+  auto* vertex = new G4PrimaryVertex(origin + particle.position, eventTime + particle.time);
+  auto* definition = fParticleGun->GetParticleDefinition();
+  if (particle.species >= 0 && particle.species < static_cast<G4int>(fSpecies.size())
+      && fSpecies[particle.species]) {
+    definition = fSpecies[particle.species];
+  }
+  auto* primary = new G4PrimaryParticle(definition);
+  primary->SetKineticEnergy(particle.energy);
+  primary->SetMomentumDirection(particle.direction);
+  vertex->SetPrimary(primary);
+  event->AddPrimaryVertex(vertex);
 }
 
 void PrimaryGeneratorAction::SetParticle(const G4String& name){
@@ -0,0 +1,320 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+//
+/// \file B4/B4a/src/ResponseMatrix.cc
+/// \brief Implementation of the B4::ResponseMatrix class
+
+#include "ResponseMatrix.hh"
+#include "EntryBuffer.hh"
+#include "ResponseFormat.hh"
+
+#include "G4Exception.hh"
+#include "G4SystemOfUnits.hh"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+namespace B4
+{
+
+namespace
+{
+constexpr std::size_t kCells = std::size_t(Response::kEnergyBins) * Response::kThetaBins;
+
+// 均值的方差：s1、s2 为 N 个事件的和及其平方之和
+G4double MeanVariance(G4double s1, G4double s2, G4double n)
+{
+  return n > 0. ? std::max(s2 - s1 * s1 / n, 0.) / (n * n) : 0.;
+}
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+ResponseMatrix::ResponseMatrix(const G4String& name)
+  : G4VAccumulable(name),
+    fEmin(10. * MeV),
+    fEmax(10. * GeV),
+    fBins(30)
+{}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void ResponseMatrix::SetGrid(G4double emin, G4double emax, G4int nbins)
+{
+  if (emin <= 0. || emax <= emin || nbins < 1) {
+    G4ExceptionDescription msg;
+    msg << "Invalid response grid " << emin / MeV << " - " << emax / MeV << " MeV, " << nbins
+        << " bins; keeping " << fEmin / MeV << " - " << fEmax / MeV << " MeV, " << fBins
+        << " bins.";
+    G4Exception("ResponseMatrix::SetGrid()", "MyCode0016", JustWarning, msg);
+    return;
+  }
+  fEmin = emin;
+  fEmax = emax;
+  fBins = nbins;
+  Reset();
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+G4int ResponseMatrix::PrimaryBin(G4double energy) const
+{
+  if (energy < fEmin || energy >= fEmax) return -1;
+  auto bin = static_cast<G4int>(fBins * std::log(energy / fEmin) / std::log(fEmax / fEmin));
+  return std::min(bin, fBins - 1);
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+ResponseMatrix::Primary& ResponseMatrix::FindPrimary(G4int pdg)
+{
+  for (auto& primary : fPrimaries) {
+    if (primary.pdg == pdg) return primary;
+  }
+  Primary& primary = fPrimaries.emplace_back();
+  primary.pdg = pdg;
+  primary.primaries.assign(fBins, 0.);
+  primary.transmitted.assign(fBins, 0.);
+  primary.transmitted2.assign(fBins, 0.);
+  return primary;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+ResponseMatrix::Block& ResponseMatrix::FindBlock(G4int primaryPdg, G4int entryPdg)
+{
+  // 同一事件中大多是同一种粒子，先查上一次的块
+  if (fLastBlock < fBlocks.size() && fBlocks[fLastBlock].entryPdg == entryPdg
+      && fBlocks[fLastBlock].primaryPdg == primaryPdg) {
+    return fBlocks[fLastBlock];
+  }
+  for (std::size_t i = 0; i < fBlocks.size(); ++i) {
+    if (fBlocks[i].entryPdg == entryPdg && fBlocks[i].primaryPdg == primaryPdg) {
+      fLastBlock = i;
+      return fBlocks[i];
+    }
+  }
+  fLastBlock = fBlocks.size();
+  Block& block = fBlocks.emplace_back();
+  block.primaryPdg = primaryPdg;
+  block.entryPdg = entryPdg;
+  block.sumW.assign(fBins * kCells, 0.);
+  block.sumW2.assign(fBins * kCells, 0.);
+  block.sumT2.assign(fBins, 0.);
+  block.sumE2.assign(fBins * Response::kEnergyBins, 0.);
+  block.sumTheta2.assign(fBins * Response::kThetaBins, 0.);
+  return block;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void ResponseMatrix::Fill(G4int primaryPdg, G4double primaryEnergy, G4double transmitted,
+                          const EntryBuffer& entries)
+{
+  G4int bin = PrimaryBin(primaryEnergy);
+  if (bin < 0) {
+    ++fOutOfRange;
+    return;
+  }
+  Primary& primary = FindPrimary(primaryPdg);
+  primary.primaries[bin] += 1.;
+  primary.transmitted[bin] += transmitted;
+  primary.transmitted2[bin] += transmitted * transmitted;
+
+  constexpr G4double energyScale =
+    Response::kEnergyBins / (Response::kLogEMax - Response::kLogEMin);
+  constexpr G4double thetaScale = Response::kThetaBins / Response::kThetaMax;
+  fEvent.clear();
+  for (const auto& entry : entries) {
+    if (entry.E <= 0.) continue;
+    auto e = static_cast<G4int>((std::log10(entry.E / MeV) - Response::kLogEMin) * energyScale);
+    auto t = static_cast<G4int>(entry.theta * thetaScale);
+    e = std::min(std::max(e, 0), G4int(Response::kEnergyBins) - 1);
+    t = std::min(std::max(t, 0), G4int(Response::kThetaBins) - 1);
+    FindBlock(primaryPdg, entry.pdg);
+    fEvent.push_back({fLastBlock, std::size_t(e) * Response::kThetaBins + t, entry.weight});
+  }
+  if (fEvent.empty()) return;
+
+  // 同一事件的入射是相关的 (簇射、多次入射)：先求出本事件在每个单元、
+  // 每种入射粒子和每个投影区间的权重和，方差用这些和的平方累加
+  std::sort(fEvent.begin(), fEvent.end(), [](const Deposit& a, const Deposit& b) {
+    return a.block != b.block ? a.block < b.block : a.cell < b.cell;
+  });
+  const std::size_t offset = bin * kCells;
+  for (std::size_t i = 0; i < fEvent.size();) {
+    const std::size_t index = fEvent[i].block;
+    Block& block = fBlocks[index];
+    fEventE.assign(Response::kEnergyBins, 0.);
+    fEventTheta.assign(Response::kThetaBins, 0.);
+    G4double total = 0.;
+    while (i < fEvent.size() && fEvent[i].block == index) {
+      const std::size_t cell = fEvent[i].cell;
+      G4double w = 0.;
+      for (; i < fEvent.size() && fEvent[i].block == index && fEvent[i].cell == cell; ++i) {
+        w += fEvent[i].weight;
+      }
+      block.sumW[offset + cell] += w;
+      block.sumW2[offset + cell] += w * w;
+      fEventE[cell / Response::kThetaBins] += w;
+      fEventTheta[cell % Response::kThetaBins] += w;
+      total += w;
+    }
+    block.sumT2[bin] += total * total;
+    for (std::size_t e = 0; e < Response::kEnergyBins; ++e) {
+      block.sumE2[bin * Response::kEnergyBins + e] += fEventE[e] * fEventE[e];
+    }
+    for (std::size_t t = 0; t < Response::kThetaBins; ++t) {
+      block.sumTheta2[bin * Response::kThetaBins + t] += fEventTheta[t] * fEventTheta[t];
+    }
+  }
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void ResponseMatrix::Merge(const G4VAccumulable& other)
+{
+  const auto& rhs = static_cast<const ResponseMatrix&>(other);
+  if (rhs.fBins != fBins || rhs.fEmin != fEmin || rhs.fEmax != fEmax) {
+    G4ExceptionDescription msg;
+    msg << "Response grids of the threads differ; the thread matrix is dropped.";
+    G4Exception("ResponseMatrix::Merge()", "MyCode0016", JustWarning, msg);
+    return;
+  }
+  for (const auto& r : rhs.fPrimaries) {
+    Primary& primary = FindPrimary(r.pdg);
+    for (G4int i = 0; i < fBins; ++i) {
+      primary.primaries[i] += r.primaries[i];
+      primary.transmitted[i] += r.transmitted[i];
+      primary.transmitted2[i] += r.transmitted2[i];
+    }
+  }
+  for (const auto& r : rhs.fBlocks) {
+    Block& block = FindBlock(r.primaryPdg, r.entryPdg);
+    for (std::size_t i = 0; i < block.sumW.size(); ++i) {
+      block.sumW[i] += r.sumW[i];
+      block.sumW2[i] += r.sumW2[i];
+    }
+    for (std::size_t i = 0; i < block.sumT2.size(); ++i) block.sumT2[i] += r.sumT2[i];
+    for (std::size_t i = 0; i < block.sumE2.size(); ++i) block.sumE2[i] += r.sumE2[i];
+    for (std::size_t i = 0; i < block.sumTheta2.size(); ++i) {
+      block.sumTheta2[i] += r.sumTheta2[i];
+    }
+  }
+  fOutOfRange += rhs.fOutOfRange;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void ResponseMatrix::Reset()
+{
+  fPrimaries.clear();
+  fBlocks.clear();
+  fLastBlock = 0;
+  fOutOfRange = 0;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+G4double ResponseMatrix::GetPrimaries() const
+{
+  G4double total = 0.;
+  for (const auto& primary : fPrimaries) {
+    for (G4double n : primary.primaries) total += n;
+  }
+  return total;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+G4bool ResponseMatrix::Write(const G4String& path, const G4String& material, G4double length,
+                             G4double radius) const
+{
+  Response::Matrix m;
+  m.header = Response::MakeHeader(fEmin / MeV, fEmax / MeV, fBins);
+  m.header.targetLength = length / mm;
+  m.header.targetRadius = radius / mm;
+  m.header.outOfRange = fOutOfRange;
+  std::strncpy(m.header.material, material.c_str(), sizeof(m.header.material) - 1);
+
+  // 按 pdg 排序，输出与线程的填充顺序无关
+  std::vector<const Primary*> primaries;
+  for (const auto& primary : fPrimaries) primaries.push_back(&primary);
+  std::sort(primaries.begin(), primaries.end(),
+            [](const Primary* a, const Primary* b) { return a->pdg < b->pdg; });
+  std::vector<const Block*> blocks;
+  for (const auto& block : fBlocks) blocks.push_back(&block);
+  std::sort(blocks.begin(), blocks.end(), [](const Block* a, const Block* b) {
+    return a->primaryPdg != b->primaryPdg ? a->primaryPdg < b->primaryPdg
+                                          : a->entryPdg < b->entryPdg;
+  });
+
+  for (const auto* primary : primaries) {
+    for (G4int i = 0; i < fBins; ++i) {
+      m.bins.push_back({primary->pdg, i, primary->primaries[i], primary->transmitted[i],
+                        primary->transmitted2[i]});
+    }
+  }
+  // 均值 = S1 / N，均值的方差 = (S2 - S1^2 / N) / N^2，S1、S2 为每个事件
+  // 的和及其平方之和；总数和投影的 S1 由单元求和得到
+  for (const auto* block : blocks) {
+    m.blocks.push_back({block->primaryPdg, block->entryPdg});
+    const G4double* n = nullptr;
+    for (const auto* primary : primaries) {
+      if (primary->pdg == block->primaryPdg) n = primary->primaries.data();
+    }
+    for (G4int i = 0; i < fBins; ++i) {
+      G4double events = n ? n[i] : 0.;
+      G4double scale = events > 0. ? 1. / events : 0.;
+      const G4double* sumW = &block->sumW[i * kCells];
+      std::vector<G4double> sumE(Response::kEnergyBins, 0.);
+      std::vector<G4double> sumTheta(Response::kThetaBins, 0.);
+      G4double total = 0.;
+      for (std::size_t j = 0; j < kCells; ++j) {
+        m.mean.push_back(sumW[j] * scale);
+        m.variance.push_back(MeanVariance(sumW[j], block->sumW2[i * kCells + j], events));
+        sumE[j / Response::kThetaBins] += sumW[j];
+        sumTheta[j % Response::kThetaBins] += sumW[j];
+        total += sumW[j];
+      }
+      m.totalVariance.push_back(MeanVariance(total, block->sumT2[i], events));
+      for (std::size_t e = 0; e < Response::kEnergyBins; ++e) {
+        m.energyVariance.push_back(
+          MeanVariance(sumE[e], block->sumE2[i * Response::kEnergyBins + e], events));
+      }
+      for (std::size_t t = 0; t < Response::kThetaBins; ++t) {
+        m.thetaVariance.push_back(
+          MeanVariance(sumTheta[t], block->sumTheta2[i * Response::kThetaBins + t], events));
+      }
+    }
+  }
+  return Response::Write(path, m);
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+}  // namespace B4
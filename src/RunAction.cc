@@ -40,25 +40,172 @@
 #include "G4Run.hh"
 #include "G4ios.hh"
 #include "DetectorConstruction.hh"
+#include "FastTarget.hh"
 #include "Randomize.hh"
 #include "G4Types.hh"
 #include "RunActionMessenger.hh"
+#include "EventAction.hh"
+#include "SteppingAction.hh"
+#include "ColumnarWriter.hh"
+#include "SeedService.hh"
+#include "G4UImanager.hh"
+#include "G4LogicalVolume.hh"
+#include "G4Material.hh"
+#include "G4VModularPhysicsList.hh"
+#include "G4VPhysicsConstructor.hh"
+#include "BeamSource.hh"
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
 #include <ctime>
+#include <fstream>
+#include <iomanip>
 #include <iostream>
+#include <sstream>
 #include <filesystem>
 
+namespace
+{
+// xxx.root -> xxx.cols (列式输出目录)
+G4String ColumnarDirectory(const G4String& name)
+{
+  G4String dir = name;
+  if (G4StrUtil::ends_with(dir, ".root")) dir.erase(dir.size() - 5);
+  return dir + ".cols";
+}
+
+// xxx.root -> xxx.shard (分片元数据)
+G4String ShardInfoPath(const G4String& name)
+{
+  G4String path = name;
+  if (G4StrUtil::ends_with(path, ".root")) path.erase(path.size() - 5);
+  return path + ".shard";
+}
+
+// xxx.root -> xxx.summary (summary 格式的输出)
+G4String SummaryPath(const G4String& name)
+{
+  G4String path = name;
+  if (G4StrUtil::ends_with(path, ".root")) path.erase(path.size() - 5);
+  return path + ".summary";
+}
+
+// xxx.root -> xxx.resp (response 格式的输出)
+G4String ResponsePath(const G4String& name)
+{
+  G4String path = name;
+  if (G4StrUtil::ends_with(path, ".root")) path.erase(path.size() - 5);
+  return path + ".resp";
+}
+
+}  // namespace
+
 namespace B4
 {
 
+G4String RunAction::fgOutputName;
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+// 配置的指纹：master 上执行过的全部命令 (不含输出、显示、线程数、检查点等
+// 不影响结果的命令) 的 FNV-1a 散列，再加上实际的几何、初级粒子和物理列表状态
+// (命令历史只是间接的记录，可能被截断或绕过)。所有分片 (及检查点的各 chunk) 必须一致
+std::uint64_t RunAction::ConfigHash()
+{
+  static const char* kIgnored[] = {"/control/", "/run/output/", "/run/numberOfThreads",
+                                   "/run/printProgress", "/run/verbose", "/tracking/verbose",
+                                   "/event/verbose", "/vis/", "/seed/print", "/random/",
+                                   "/run/checkpoint/", "/det/printMaterials", "/det/checkOverlaps"};
+  std::uint64_t hash = 0xcbf29ce484222325ULL;
+  auto mix = [&hash](const G4String& text) {
+    for (char c : text + "\n") {
+      hash ^= static_cast<unsigned char>(c);
+      hash *= 0x100000001b3ULL;
+    }
+  };
+  auto* ui = G4UImanager::GetUIpointer();
+  for (G4int i = 0; i < ui->GetNumberOfHistory(); ++i) {
+    G4String command = ui->GetPreviousCommand(i);
+    G4bool ignored = false;
+    for (const char* prefix : kIgnored) ignored = ignored || G4StrUtil::starts_with(command, prefix);
+    if (!ignored) mix(command);
+  }
+
+  // 实际状态：取本线程 (master，或串行模式下唯一的) RunAction 的几何和生成器
+  auto* runManager = G4RunManager::GetRunManager();
+  const auto* runAction = dynamic_cast<const RunAction*>(runManager->GetUserRunAction());
+  std::ostringstream state;
+  state << std::setprecision(17);
+  if (const auto* det = runAction ? runAction->fDet : nullptr) {
+    const auto* detectorLogical = det->GetDetectorLogical();
+    state << "det " << det->GetTargetMaterialName() << ' ' << det->GetTargetLength() << ' '
+          << det->GetTargetRadius() << ' '
+          << (detectorLogical ? detectorLogical->GetMaterial()->GetName() : G4String("unknown"))
+          << ' ' << det->GetDetectorRadius() << ' ' << det->GetDetectorThickness() << ' '
+          << det->GetDetectorLength() << ' ' << static_cast<G4int>(det->GetDetectorBuild()) << ' '
+          << static_cast<G4int>(det->GetEntryScoring()) << " planes";
+    for (G4double depth : det->GetPlaneDepths()) state << ' ' << depth;
+    state << " cuts";
+    for (const auto& region : DetectorConstruction::GetRegionNames()) {
+      for (const char* particle : {"gamma", "e-", "e+", "proton"}) {
+        state << ' ' << det->GetRegionCut(region, particle);
+      }
+    }
+    state << '|';
+  }
+  if (const auto* gen = runAction ? runAction->fGenAction : nullptr) {
+    const auto* gun = gen->GetParticleGun();
+    const auto* particle = gun ? gun->GetParticleDefinition() : nullptr;
+    if (gun) {
+      state << "gun " << (particle ? particle->GetParticleName() : G4String("none")) << ' '
+            << gun->GetParticleEnergy() << ' ' << gun->GetParticleMomentumDirection() << ' '
+            << gun->GetParticlePosition();
+    }
+    if (const auto* beam = gen->GetBeamSource()) {
+      state << " beam " << static_cast<G4int>(beam->GetSpectrum());
+      for (const auto& name : beam->GetSpecies()) state << ' ' << name;
+      if (beam->GetBeamFile()) state << " file";
+    }
+    state << '|';
+  }
+  if (const auto* physics = runManager->GetUserPhysicsList()) {
+    state << "physics " << physics->GetDefaultCutValue();
+    if (const auto* modular = dynamic_cast<const G4VModularPhysicsList*>(physics)) {
+      for (G4int i = 0; modular->GetPhysics(i) != nullptr; ++i) {
+        state << ' ' << modular->GetPhysics(i)->GetPhysicsName();
+      }
+    }
+  }
+  mix(state.str());
+  return hash;
+}
+
 //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
 
-RunAction::RunAction(bool isMaster, PrimaryGeneratorAction* genAction, DetectorConstruction* det)
+RunAction::RunAction(bool isMaster, PrimaryGeneratorAction* genAction, DetectorConstruction* det,
+                     const SeedService* seeds)
   : G4UserRunAction(),
     fIsMaster(isMaster),
     fGenAction(genAction),
     fDet(det),
+    fSeeds(seeds),
     fPassed("Passed", 0),
     fBlocked("Blocked", 0),
+    fTransmitted("Transmitted", 0.),
+    fTransmitted2("Transmitted2", 0.),
+    fSteps("Steps", 0),
+    fObservables("EntryObservables"),
+    fSummary("EntrySummary"),
+    fStackKilled("StackKilled"),
+    fValidationLost("ValidationLost"),
+    fEntryKilled("EntryKilled"),
+    fKilledByEnergy("KilledByEnergy", 0),
+    fKilledByTime("KilledByTime", 0),
+    fKilledByGeometry("KilledByGeometry", 0),
+    fTargetExits("TargetExits"),
+    fResponse("ResponseMatrix"),
+    fPlaneTally("PlaneTally"),
+    fProfile("RunProfile"),
     fEnableOutput(true),
     fFileName(""),
     fDirectory(""),
@@ -69,6 +216,21 @@ RunAction::RunAction(bool isMaster, PrimaryGeneratorAction* genAction, DetectorC
   auto* mgr = G4AccumulableManager::Instance();
   mgr->RegisterAccumulable(&fPassed);
   mgr->RegisterAccumulable(&fBlocked);
+  mgr->RegisterAccumulable(&fTransmitted);
+  mgr->RegisterAccumulable(&fTransmitted2);
+  mgr->RegisterAccumulable(&fSteps);
+  mgr->RegisterAccumulable(&fObservables);
+  mgr->RegisterAccumulable(&fSummary);
+  mgr->RegisterAccumulable(&fStackKilled);
+  mgr->RegisterAccumulable(&fValidationLost);
+  mgr->RegisterAccumulable(&fEntryKilled);
+  mgr->RegisterAccumulable(&fKilledByEnergy);
+  mgr->RegisterAccumulable(&fKilledByTime);
+  mgr->RegisterAccumulable(&fKilledByGeometry);
+  mgr->RegisterAccumulable(&fTargetExits);
+  mgr->RegisterAccumulable(&fResponse);
+  mgr->RegisterAccumulable(&fPlaneTally);
+  if constexpr (kProfilingEnabled) mgr->RegisterAccumulable(&fProfile);
   // if you are using higher version of G4(like 11.3.2), you need to replace `RegisterAccumulable` with `Register`.
 
   fRunMessenger = new RunActionMessenger(this);
@@ -89,12 +251,16 @@ RunAction::RunAction(bool isMaster, PrimaryGeneratorAction* genAction, DetectorC
     fAnalysisManager->CreateNtupleDColumn("pE");
     fAnalysisManager->CreateNtupleDColumn("theta");
     fAnalysisManager->CreateNtupleDColumn("phi");
+    fAnalysisManager->CreateNtupleDColumn("weight");
+    fAnalysisManager->CreateNtupleIColumn("plane");  // -1: 探测器的入射
+    fAnalysisManager->CreateNtupleIColumn("primaryPDG");  // 本事件的初级粒子
+    fAnalysisManager->CreateNtupleDColumn("primaryE");
     fAnalysisManager->FinishNtuple();
 
-    fAnalysisManager->CreateH2("theta_px", "Theta vs Px", 90, 0, 180,100, -20.0, 20.0);
-    fAnalysisManager->CreateH2("theta_py", "Theta vs Py", 90, 0, 180,100, -20.0, 20.0);
-    fAnalysisManager->CreateH2("theta_pz", "Theta vs Pz", 90, 0, 180,100, 0.0, 6000.0);
-    fAnalysisManager->CreateH2("theta_p", "Theta vs P", 90, 0, 180,100, 0.0, 6000.0);
+    // theta vs px/py/pz/p (H2) 以及按粒子种类的能谱和角分布 (H1)，
+    // 在线程私有的稠密数组中填充，run 结束时并入
+    fHistograms = std::make_unique<EntryHistograms>();
+    fHistograms->Book(fAnalysisManager);
   }
   // set printing event number per each event
   G4RunManager::GetRunManager()->SetPrintProgress(100);
@@ -102,6 +268,17 @@ RunAction::RunAction(bool isMaster, PrimaryGeneratorAction* genAction, DetectorC
 
 //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
 
+RunAction::~RunAction() = default;
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+const BeamSource* RunAction::GetBeamSource() const
+{
+  return fGenAction ? fGenAction->GetBeamSource() : nullptr;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
 void RunAction::BeginOfRunAction(const G4Run* /*run*/)
 {
   auto* mgr = G4AccumulableManager::Instance();
@@ -119,6 +296,12 @@ void RunAction::BeginOfRunAction(const G4Run* /*run*/)
     fEnergy = gen->GetParticleGun()->GetParticleEnergy();
   }
 
+  // 混合束流：初级粒子逐个抽样，汇总按初级粒子 (和离散能量) 分组
+  const auto* beam = gen ? gen->GetBeamSource() : nullptr;
+  G4bool mixed = beam && beam->IsMixed();
+  if (mixed && !beam->GetSpecies().empty()) fPtype = "mixed";
+  fSummary.SetPrimaryGrouping(mixed, mixed && beam->GetSpectrum() == BeamSource::Spectrum::List);
+
   // 获取屏蔽层信息
   const auto* baseDet = G4RunManager::GetRunManager()->GetUserDetectorConstruction();
   auto* det = dynamic_cast<const DetectorConstruction*>(baseDet);
@@ -126,56 +309,387 @@ void RunAction::BeginOfRunAction(const G4Run* /*run*/)
   fTargetRadius = (det ? det->GetTargetRadius() : 0.);
   fTargetMaterial = (det ? det->GetTargetMaterialName() : "unknown");
 
+  // 快速模拟训练 (/fastsim/train, /fastsim/validate)：记录穿出靶的粒子。
+  // 表按单一初级粒子种类建立，混合束流 (/beam/species) 的 run 不训练
+  auto* fastTarget = fDet ? fDet->GetFastTarget() : nullptr;
+  G4bool training = fastTarget && fastTarget->IsTraining();
+  if (training && fPtype == "mixed") {
+    if (fIsMaster || !G4Threading::IsMultithreadedApplication()) {
+      G4ExceptionDescription msg;
+      msg << "Fast-simulation tables are built per primary species; no table is trained"
+          << " in this run while /beam/species is set." << G4endl
+          << "Use /beam/species (no argument) and /gun/particle for training.";
+      G4Exception("RunAction::BeginOfRunAction()", "MyCode0020", JustWarning, msg);
+    }
+    training = false;
+  }
+  fTargetExits.SetTraining(training);
+
+  // 虚拟计分平面：各线程使用同一组深度，合并时逐平面相加
+  fPlaneTally.SetPlanes(fDet ? fDet->GetPlaneDepths() : std::vector<G4double>());
+
+  // 文件名由 master 确定 (时间戳在各线程间可能不同)；串行模式下自己确定。
+  // 分片元数据也用这个名字，所以关闭输出时也确定
+  if (fIsMaster || !G4Threading::IsMultithreadedApplication()) {
+    fgOutputName = BuildOutputName();
+  }
+
   if (fEnableOutput) {
-    // 1) 确定基础文件名
-    std::string name;
-    if (fFileName.empty()) {
-      // 格式：类型_能量MeV_材料_厚度cm_时间戳.root
-      std::ostringstream oss;
-      oss << fPtype << "_"
-          << std::fixed << std::setprecision(0) << fEnergy << "MeV_"
-          << fTargetMaterial << "_"
-          << std::fixed << std::setprecision(0)
-          << (fTargetRadius/cm) << "cm_" 
-          << (fTargetLength/cm) << "cm_";
-  
+    const G4String& name = fgOutputName;
+
+    if (fOutputFormat == OutputFormat::Root) {
+      // 打开 ROOT 文件
+      G4AnalysisManager::Instance()->OpenFile(name);
+      G4cout << "打开输出文件: " << name << G4endl;
+    }
+    else if (fOutputFormat == OutputFormat::Summary) {
+      // 不写任何行，run 结束时由 master 写出汇总
+      if (fIsMaster || !G4Threading::IsMultithreadedApplication()) {
+        G4cout << "汇总输出: " << SummaryPath(name) << G4endl;
+      }
+    }
+    else if (fOutputFormat == OutputFormat::Response) {
+      // 同样不写行，run 结束时由 master 写出响应矩阵
+      if (fIsMaster || !G4Threading::IsMultithreadedApplication()) {
+        G4cout << "响应矩阵输出: " << ResponsePath(name) << " ("
+               << G4BestUnit(fResponse.GetEmin(), "Energy") << " - "
+               << G4BestUnit(fResponse.GetEmax(), "Energy") << ", " << fResponse.GetBins()
+               << " bins)" << G4endl;
+      }
+    }
+    else {
+      // 列式输出：每个 worker 一个 segment，只追加，无需加锁
+      G4String dir = ColumnarDirectory(name);
+      std::filesystem::create_directories(dir.c_str());
+      if (!fIsMaster) {
+        fColumnar = std::make_unique<ColumnarWriter>(
+          dir, std::max(0, G4Threading::G4GetThreadId()));
+      }
+      else {
+        G4cout << "打开列式输出目录: " << dir << G4endl;
+      }
+    }
+  }
+
+  // worker (或串行模式)：束流源平面每个 run 只确定一次
+  if (!fIsMaster && fGenAction) fGenAction->PrepareRun();
+  // 训练和计分平面已在上面确定
+  if (fSteppingAction) fSteppingAction->BeginRun();
+
+  if constexpr (kProfilingEnabled) fProfile.BeginRun();
+
+  // 串行模式 (--runManager serial) 只有一个 RunAction (isMaster = false)
+  if (fIsMaster || !G4Threading::IsMultithreadedApplication()) fTimer.Start();
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+G4String RunAction::BuildOutputName() const
+{
+  // 1) 确定基础文件名
+  std::string name;
+  // 分片：名字中用分片号和 run 号代替时间戳，各分片的输出可按名字找到并合并；
+  // beamUntil 的 chunk 只用 run 号
+  G4String shard;
+  const auto* run = G4RunManager::GetRunManager()->GetCurrentRun();
+  G4String runTag = fOutputTag.empty() ? "run" + std::to_string(run ? run->GetRunID() : 0)
+                                       : fOutputTag;
+  if (fSeeds && fSeeds->IsSharded()) {
+    shard = "shard" + std::to_string(fSeeds->GetShardIndex()) + "of"
+            + std::to_string(fSeeds->GetShardCount()) + "_" + runTag;
+  }
+  else if (fRunTagging || !fOutputTag.empty()) {
+    shard = runTag;
+  }
+  if (fFileName.empty()) {
+    // 格式：类型_能量MeV_材料_厚度cm_时间戳.root
+    std::ostringstream oss;
+    oss << fPtype << "_"
+        << std::fixed << std::setprecision(0) << fEnergy << "MeV_"
+        << fTargetMaterial << "_"
+        << std::fixed << std::setprecision(0)
+        << (fTargetRadius/cm) << "cm_" 
+        << (fTargetLength/cm) << "cm_";
+
+    if (!shard.empty()) {
+      oss << shard;
+    }
+    else {
       auto t  = std::time(nullptr);
       auto tm = *std::localtime(&t);
-      oss << std::put_time(&tm, "%Y%m%d_%H%M%S")
-          << ".root";
-      name = oss.str();
-    } else {
-      name = fFileName;  // 用户在宏里指定了完整文件名（需含 .root）
-    }
-  
-    // 2) 如用户指定目录，则去掉末尾斜杠并创建
-    if (!fDirectory.empty()) {
-      std::string dir = fDirectory;
-      // 去掉所有末尾的 '/' 或 '\'
-      while (!dir.empty() && (dir.back()=='/' || dir.back()=='\\')) {
-        dir.pop_back();
-      }
-      // 递归创建目录（若已存在，此调用也不会报错）
-      std::filesystem::create_directories(dir);
-      // 最终路径 = 目录 + '/' + 文件名
-      name = dir + "/" + name;
+      oss << std::put_time(&tm, "%Y%m%d_%H%M%S");
     }
-  
-    // 3) 打开 ROOT 文件
-    G4AnalysisManager::Instance()->OpenFile(name);
-    G4cout << "打开输出文件: " << name << G4endl;
+    oss << ".root";
+    name = oss.str();
+  } else {
+    name = fFileName;  // 用户在宏里指定了完整文件名（需含 .root）
+    if (!shard.empty()) {
+      if (G4StrUtil::ends_with(name, ".root")) name.erase(name.size() - 5);
+      name += "_" + shard + ".root";
+    }
+  }
+
+  // 2) 如用户指定目录，则去掉末尾斜杠并创建
+  if (!fDirectory.empty()) {
+    std::string dir = fDirectory;
+    // 去掉所有末尾的 '/' 或 '\'
+    while (!dir.empty() && (dir.back()=='/' || dir.back()=='\\')) {
+      dir.pop_back();
+    }
+    // 递归创建目录（若已存在，此调用也不会报错）
+    std::filesystem::create_directories(dir);
+    // 最终路径 = 目录 + '/' + 文件名
+    name = dir + "/" + name;
+  }
+  return name;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void RunAction::WriteColumnarRunInfo(const G4Run* run) const
+{
+  // 与各 segment 放在同一目录下的运行描述 (key = value)
+  G4String path = ColumnarDirectory(fgOutputName) + "/" + Columnar::kRunInfoFile;
+  std::ofstream info(path.c_str());
+  info << "format = B4COLS\n"
+       << "version = " << Columnar::kVersion << "\n"
+       << "particle = " << fPtype << "\n"
+       << "energy_MeV = " << fEnergy/MeV << "\n"
+       << "material = " << fTargetMaterial << "\n"
+       << "target_radius_cm = " << fTargetRadius/cm << "\n"
+       << "target_length_cm = " << fTargetLength/cm << "\n"
+       << "events = " << run->GetNumberOfEvent() << "\n";
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+G4String RunAction::GetShardInfoPath() const
+{
+  return ShardInfoPath(fgOutputName);
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void RunAction::WriteShardInfo(const G4Run* run) const
+{
+  // key = value，与 run.info 相同的格式；accumulables 按原始和写出
+  G4String path = ShardInfoPath(fgOutputName);
+  std::ofstream info(path.c_str());
+  if (!info) {
+    G4ExceptionDescription msg;
+    msg << "Cannot write the shard metadata " << path;
+    G4Exception("RunAction::WriteShardInfo()", "MyCode0011", JustWarning, msg);
+    return;
+  }
+  G4long eventsInRun = run->GetNumberOfEventToBeProcessed();
+  // 事件键的 run (检查点的各 chunk 共用一个)
+  G4int keyRun = fSeeds->KeyFor(run->GetRunID(), 0, eventsInRun).run;
+  G4bool columnar = (fOutputFormat == OutputFormat::Columnar);
+  G4bool summary = (fOutputFormat == OutputFormat::Summary);
+  G4bool response = (fOutputFormat == OutputFormat::Response);
+  G4String format = columnar ? "columnar" : (summary ? "summary" : (response ? "response" : "root"));
+  G4String output = columnar   ? ColumnarDirectory(fgOutputName)
+                    : summary  ? SummaryPath(fgOutputName)
+                    : response ? ResponsePath(fgOutputName)
+                               : fgOutputName;
+  info << "format = B4SHARD\n"
+       << "version = 1\n"
+       << "config_hash = " << std::hex << ConfigHash() << std::dec << "\n"
+       << "master_seed = " << fSeeds->GetMasterSeed() << "\n"
+       << "engine = " << fSeeds->GetEngineName() << "\n"
+       << "shard = " << fSeeds->GetShardIndex() << "\n"
+       << "shards = " << fSeeds->GetShardCount() << "\n"
+       << "run = " << keyRun << "\n"
+       << "first_event = " << fSeeds->GetFirstEvent(eventsInRun) << "\n"
+       << "events = " << run->GetNumberOfEvent() << "\n"
+       << "output_format = " << (fEnableOutput ? format : G4String("none")) << "\n"
+       << "output = " << output << "\n"
+       << "particle = " << fPtype << "\n"
+       << "energy_MeV = " << fEnergy/MeV << "\n"
+       << "material = " << fTargetMaterial << "\n"
+       << "target_radius_cm = " << fTargetRadius/cm << "\n"
+       << "target_length_cm = " << fTargetLength/cm << "\n"
+       << "passed = " << fPassed.GetValue() << "\n"
+       << "blocked = " << fBlocked.GetValue() << "\n"
+       << std::setprecision(17)
+       << "transmitted = " << fTransmitted.GetValue() << "\n"
+       << "transmitted2 = " << fTransmitted2.GetValue() << "\n"
+       << std::setprecision(6)
+       << "steps = " << fSteps.GetValue() << "\n"
+       << "killed_energy = " << fKilledByEnergy.GetValue() << "\n"
+       << "killed_time = " << fKilledByTime.GetValue() << "\n"
+       << "killed_geometry = " << fKilledByGeometry.GetValue() << "\n";
+  fObservables.Write(info, "observables");
+  fStackKilled.Write(info, "stack_killed");
+  fValidationLost.Write(info, "validation_lost");
+  fEntryKilled.Write(info, "entry_killed");
+  if (fEnableOutput && summary) fSummary.Write(info, "summary");
+  if (fPlaneTally.GetNumberOfPlanes() > 0) fPlaneTally.Write(info, "planes");
+  G4cout << "分片元数据已写入: " << path << G4endl;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+G4double RunAction::GetTransmission(G4double& error) const
+{
+  // 每个初级粒子的透射权重 t (无偏置时为 0 或 1)：<t> 及其标准误差
+  G4long primaries = fPassed.GetValue() + fBlocked.GetValue();
+  error = 0.;
+  if (primaries == 0) return 0.;
+  G4double mean = fTransmitted.GetValue() / primaries;
+  G4double variance = fTransmitted2.GetValue() / primaries - mean * mean;
+  error = std::sqrt(std::max(variance, 0.) / primaries);
+  return mean;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void RunAction::WriteSummary(const G4Run* run) const
+{
+  G4long passed = fPassed.GetValue();
+  G4long primaries = passed + fBlocked.GetValue();
+  G4double error = 0.;
+  G4double transmission = GetTransmission(error);
+
+  G4cout << "========== Entry Summary ==========\n"
+         << " Primaries             : " << primaries << "\n"
+         << " Transmitted           : " << passed << "\n"
+         << " Transmission          : " << transmission << " +- " << error << "\n";
+  fSummary.Print(G4cout);
+  G4cout << "=================================" << G4endl;
+
+  // key = value，与分片元数据相同的格式
+  G4String path = SummaryPath(fgOutputName);
+  std::ofstream out(path.c_str());
+  if (!out) {
+    G4ExceptionDescription msg;
+    msg << "Cannot write the summary " << path;
+    G4Exception("RunAction::WriteSummary()", "MyCode0012", JustWarning, msg);
+    return;
+  }
+  out << "format = B4SUMMARY\n"
+      << "version = 1\n"
+      << "particle = " << fPtype << "\n"
+      << "energy_MeV = " << fEnergy/MeV << "\n"
+      << "material = " << fTargetMaterial << "\n"
+      << "target_radius_cm = " << fTargetRadius/cm << "\n"
+      << "target_length_cm = " << fTargetLength/cm << "\n"
+      << "events = " << run->GetNumberOfEvent() << "\n"
+      << "passed = " << passed << "\n"
+      << "blocked = " << fBlocked.GetValue() << "\n"
+      << std::setprecision(17)
+      << "transmitted = " << fTransmitted.GetValue() << "\n"
+      << "transmitted2 = " << fTransmitted2.GetValue() << "\n"
+      << "transmission = " << transmission << "\n"
+      << "transmission_error = " << error << "\n"
+      << std::setprecision(6)
+      << "steps = " << fSteps.GetValue() << "\n";
+  fObservables.Write(out, "observables");
+  fSummary.Write(out, "summary");
+  if (!fEntryKilled.GetEntries().empty()) fEntryKilled.Write(out, "entry_killed");
+  if (fPlaneTally.GetNumberOfPlanes() > 0) fPlaneTally.Write(out, "planes");
+  G4cout << "汇总已写入: " << path << G4endl;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void RunAction::WriteResponse(const G4Run* run) const
+{
+  G4String path = ResponsePath(fgOutputName);
+  if (!fResponse.Write(path, fTargetMaterial, fTargetLength, fTargetRadius)) {
+    G4ExceptionDescription msg;
+    msg << "Cannot write the response matrix " << path;
+    G4Exception("RunAction::WriteResponse()", "MyCode0016", JustWarning, msg);
+    return;
+  }
+  G4cout << "========== Response Matrix ==========\n"
+         << " Events                : " << run->GetNumberOfEvent() << "\n"
+         << " Primaries in grid     : " << fResponse.GetPrimaries() << "\n"
+         << " Outside the grid      : " << fResponse.GetOutOfRange() << "\n"
+         << " Blocks (primary,entry): " << fResponse.GetBlockCount() << "\n"
+         << "=================================" << G4endl;
+  G4cout << "响应矩阵已写入: " << path << G4endl;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void RunAction::AddStackKill(G4int pdg, G4double energy, StackingPolicy::KillReason reason)
+{
+  fStackKilled.Add(pdg, energy);
+  switch (reason) {
+    case StackingPolicy::KillReason::Energy: fKilledByEnergy += 1; break;
+    case StackingPolicy::KillReason::Time: fKilledByTime += 1; break;
+    case StackingPolicy::KillReason::Geometry: fKilledByGeometry += 1; break;
+    default: break;
+  }
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void RunAction::PrintStackingSummary() const
+{
+  if (fStackKilled.GetEntries().empty() && fEntryKilled.GetEntries().empty()) return;
+
+  G4cout << "========== Stacking Summary ==========\n"
+         << " by energy cut         : " << fKilledByEnergy.GetValue() << "\n"
+         << " by time cut           : " << fKilledByTime.GetValue() << "\n"
+         << " unreachable           : " << fKilledByGeometry.GetValue() << "\n"
+         << " on detector entry     : " << fEntryKilled.GetTotalCount() << " ("
+         << G4BestUnit(fEntryKilled.GetTotalEnergy(), "Energy") << " not tracked further)\n";
+  fStackKilled.Print(G4cout, "killed (or flagged)");
+  if (!fEntryKilled.GetEntries().empty()) {
+    fEntryKilled.Print(G4cout, "killed on entry (or flagged)");
   }
+
+  // 验证模式下：本应杀掉的径迹 (含后代) 贡献的入射
+  G4long lost = fValidationLost.GetTotalCount();
+  G4long entries = fObservables.GetEntries();
+  if (lost > 0) fValidationLost.Print(G4cout, "entries lost by policy");
+  G4cout << " lost entry fraction   : "
+         << (entries > 0 ? (G4double)lost / entries : 0.)
+         << "  (" << lost << " of " << entries << ", validation mode only)\n"
+         << "=================================" << G4endl;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void RunAction::WriteProfile(const G4Run* run) const
+{
+  fProfile.Print(G4cout);
+  if (fProfileFile.empty()) return;
+
+  // xxx.json -> xxx_run<N>.json，每个 run 一个报告
+  std::filesystem::path path(fProfileFile.c_str());
+  G4String stem = path.stem().string();
+  G4String ext = path.has_extension() ? path.extension().string() : ".json";
+  path.replace_filename(stem + "_run" + std::to_string(run->GetRunID()) + ext);
+  if (path.has_parent_path()) std::filesystem::create_directories(path.parent_path());
+
+  std::ofstream out(path);
+  if (!out) {
+    G4ExceptionDescription msg;
+    msg << "Cannot write the profile report " << path.string();
+    G4Exception("RunAction::WriteProfile()", "MyCode0009", JustWarning, msg);
+    return;
+  }
+  fProfile.WriteJson(out, run->GetRunID());
+  G4cout << "性能剖析报告已写入: " << path.string() << G4endl;
 }
 
 //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
 
 void RunAction::EndOfRunAction(const G4Run* run)
 {
+  // Worker: 线程私有的剖析缓存在合并之前折叠
+  if constexpr (kProfilingEnabled) {
+    if (!fIsMaster) fProfile.EndRun(std::max(0, G4Threading::G4GetThreadId()));
+  }
+
   // Master: 合并全局信息
   G4AccumulableManager::Instance()->Merge();
 
-  // 打印全局事件数
-  if (fIsMaster){
+  // 打印全局事件数 (串行模式下由唯一的 RunAction 打印)
+  if (fIsMaster || !G4Threading::IsMultithreadedApplication()) {
     G4int totalPassed = fPassed.GetValue();
     G4cout << "The totalPassed=" << totalPassed << G4endl;
     G4int totalBlocked = fBlocked.GetValue();
@@ -185,20 +699,104 @@ void RunAction::EndOfRunAction(const G4Run* run)
     G4double efficiency = totalPrim > 0 ? (100 - 100. * totalPassed / totalPrim) : 0.;
 
 
+    // 事件循环的吞吐量 (用于比较不同的记录方式、几何模式等)
+    fTimer.Stop();
+    G4int nofEvents = run->GetNumberOfEvent();
+    G4long totalSteps = fSteps.GetValue();
+    G4double wallTime = fTimer.GetRealElapsed();
+    // 品质因数 FOM = 1 / (相对误差^2 * 时间)，比较偏置与否的效率
+    G4double transmissionError = 0.;
+    G4double transmission = GetTransmission(transmissionError);
+    G4double fom = (transmissionError > 0. && wallTime > 0.)
+      ? transmission * transmission / (transmissionError * transmissionError * wallTime) : 0.;
+    G4String scoring = "unknown";
+    G4String build = "unknown";
+    if (fDet) {
+      scoring = (fDet->GetEntryScoring() == DetectorConstruction::EntryScoring::Stepping)
+                  ? "stepping" : "sd";
+      build = (fDet->GetDetectorBuild() == DetectorConstruction::DetectorBuild::Boolean)
+                ? "boolean" : "primitive";
+    }
+
     // 计算并打印全局所有信息
     G4cout
       << "========== Merged Run Summary ==========\n"
       << " Particle type         : " << fPtype << "\n"
       << " Particle energy       : " << G4BestUnit(fEnergy, "Energy") << "\n"
+      << " Target material       : " << fTargetMaterial << " ("
+      << G4BestUnit(fTargetLength, "Length") << ")\n"
+      << " Entry scoring         : " << scoring << "\n"
+      << " Detector build        : " << build << "\n"
+      << " Events                : " << nofEvents << "\n"
+      << " Steps                 : " << totalSteps << "\n"
+      << " Wall time             : " << wallTime << " s\n"
+      << " Events/s              : " << (wallTime > 0. ? nofEvents / wallTime : 0.) << "\n"
+      << " Wall time/event       : " << (nofEvents > 0 ? 1e3 * wallTime / nofEvents : 0.) << " ms\n"
+      << " Steps/s               : " << (wallTime > 0. ? totalSteps / wallTime : 0.) << "\n"
+      << " Detector entries      : " << fObservables.GetEntries()
+      << " (" << fObservables.GetEntriesPerEvent() << " +- "
+      << fObservables.GetEntriesPerEventError() << " per event)\n"
+      << " Transmission          : " << transmission << " +- " << transmissionError << "\n"
+      << " Figure of merit       : " << fom << " /s\n"
       << "=================================\n";
+
+    PrintStackingSummary();
+    if (fPlaneTally.GetNumberOfPlanes() > 0) fPlaneTally.Print(G4cout);
+  }
+
+  // 训练 run：合并后的穿出表交给快速模拟 (写文件并加入表库)
+  if (fTargetExits.IsTraining() && (fIsMaster || !G4Threading::IsMultithreadedApplication())) {
+    fTargetExits.SetKey(fPtype, fEnergy, fTargetMaterial, fTargetLength);
+    fDet->GetFastTarget()->AddTrainingResult(fTargetExits);
+  }
+
+  if constexpr (kProfilingEnabled) {
+    if (fIsMaster || !G4Threading::IsMultithreadedApplication()) {
+      fProfile.MarkRunEnd();
+      WriteProfile(run);
+    }
+  }
+
+  if (fSeeds && (fSeeds->IsSharded() || fWriteShardInfo)
+      && (fIsMaster || !G4Threading::IsMultithreadedApplication())) {
+    WriteShardInfo(run);
+  }
+
+  // Worker: 入射缓冲区的内存高水位
+  if (!fIsMaster) {
+    auto* evtAction = dynamic_cast<const EventAction*>(
+      G4RunManager::GetRunManager()->GetUserEventAction());
+    if (evtAction) {
+      const auto& entries = evtAction->GetEntryBuffer();
+      G4cout << "Entry buffer (thread " << G4Threading::G4GetThreadId() << ")"
+             << " : high water " << entries.HighWater() << " entries/event, "
+             << entries.MemoryBytes() / 1024. << " kB reserved" << G4endl;
+    }
   }
 
   // fAnalysisManager = G4AnalysisManager::Instance();
-  if(fEnableOutput){
+  if (fEnableOutput && fOutputFormat == OutputFormat::Root) {
+    if (fHistograms) fHistograms->MergeInto(fAnalysisManager);
     fAnalysisManager->Write();
     fAnalysisManager->CloseFile();
     G4cout << "ROOT 文件已写入并关闭" << G4endl;
   }
+  else if (fEnableOutput && fOutputFormat == OutputFormat::Summary) {
+    if (fIsMaster || !G4Threading::IsMultithreadedApplication()) WriteSummary(run);
+  }
+  else if (fEnableOutput && fOutputFormat == OutputFormat::Response) {
+    if (fIsMaster || !G4Threading::IsMultithreadedApplication()) WriteResponse(run);
+  }
+  else if (fEnableOutput) {
+    if (fColumnar) {
+      fColumnar->Close();
+      fColumnar.reset();
+    }
+    if (fIsMaster || !G4Threading::IsMultithreadedApplication()) {
+      WriteColumnarRunInfo(run);
+      G4cout << "列式输出已写入: " << ColumnarDirectory(fgOutputName) << G4endl;
+    }
+  }
 }
 //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
 
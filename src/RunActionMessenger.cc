@@ -4,6 +4,9 @@
 #include "G4UIdirectory.hh"
 #include "G4UIcmdWithABool.hh"
 #include "G4UIcmdWithAString.hh"
+#include "G4UIparameter.hh"
+
+#include <sstream>
 
 namespace B4
 {
@@ -34,10 +37,47 @@ RunActionMessenger::RunActionMessenger(RunAction* runAction)
   fCmdDirectory->SetParameterName("dir", true);
   fCmdDirectory->SetDefaultValue("");
   fCmdDirectory->AvailableForStates(G4State_PreInit, G4State_Idle);
+
+  // format
+  fCmdFormat = new G4UIcmdWithAString("/run/output/format", this);
+  fCmdFormat->SetGuidance("设置探测器入射记录的输出格式");
+  fCmdFormat->SetGuidance("  root     : ROOT ntuple + H2 (默认)");
+  fCmdFormat->SetGuidance("  columnar : 每线程一个 segment 的定长列文件 (xxx.cols/ 目录，可 mmap 读取)");
+  fCmdFormat->SetGuidance("  summary  : 不写入射记录，只写按粒子的计数和矩、透射率 (xxx.summary)");
+  fCmdFormat->SetGuidance("  response : 按初级粒子种类和能量分箱的响应矩阵 (xxx.resp，用 b4fold 折叠束流谱)");
+  fCmdFormat->SetParameterName("format", false);
+  fCmdFormat->SetCandidates("root columnar summary response");
+  fCmdFormat->AvailableForStates(G4State_PreInit, G4State_Idle);
+
+  // profile
+  fCmdProfile = new G4UIcmdWithAString("/run/output/profile", this);
+  fCmdProfile->SetGuidance("设置性能剖析报告 (JSON) 的文件名，实际写入 <名>_run<N>.json");
+  fCmdProfile->SetGuidance("空字符串只打印剖析表不写文件；需编译时打开 B4_PROFILING");
+  fCmdProfile->SetParameterName("file", true);
+  fCmdProfile->SetDefaultValue("");
+  fCmdProfile->AvailableForStates(G4State_PreInit, G4State_Idle);
+
+  // responseGrid
+  fCmdResponseGrid = new G4UIcommand("/run/output/responseGrid", this);
+  fCmdResponseGrid->SetGuidance("设置响应矩阵的初级粒子动能网格：emin emax [unit] [nbins]，对数分箱");
+  fCmdResponseGrid->SetGuidance("束流用 /beam/spectrum logflat 覆盖同一范围，每个区间的初级粒子数相同");
+  fCmdResponseGrid->SetParameter(new G4UIparameter("emin", 'd', false));
+  fCmdResponseGrid->SetParameter(new G4UIparameter("emax", 'd', false));
+  auto* unit = new G4UIparameter("unit", 's', true);
+  unit->SetDefaultValue("MeV");
+  fCmdResponseGrid->SetParameter(unit);
+  auto* bins = new G4UIparameter("nbins", 'i', true);
+  bins->SetDefaultValue(30);
+  bins->SetParameterRange("nbins>0");
+  fCmdResponseGrid->SetParameter(bins);
+  fCmdResponseGrid->AvailableForStates(G4State_PreInit, G4State_Idle);
 }
 
 RunActionMessenger::~RunActionMessenger()
 {
+  delete fCmdResponseGrid;
+  delete fCmdProfile;
+  delete fCmdFormat;
   delete fCmdDirectory;
   delete fCmdFileName;
   delete fCmdEnable;
@@ -55,6 +95,24 @@ void RunActionMessenger::SetNewValue(G4UIcommand* cmd, G4String val)
   else if (cmd == fCmdDirectory) {
     fRunAction->SetDirectory(val);
   }
+  else if (cmd == fCmdFormat) {
+    if (val == "columnar") fRunAction->SetOutputFormat(RunAction::OutputFormat::Columnar);
+    else if (val == "summary") fRunAction->SetOutputFormat(RunAction::OutputFormat::Summary);
+    else if (val == "response") fRunAction->SetOutputFormat(RunAction::OutputFormat::Response);
+    else fRunAction->SetOutputFormat(RunAction::OutputFormat::Root);
+  }
+  else if (cmd == fCmdProfile) {
+    fRunAction->SetProfileFile(val);
+  }
+  else if (cmd == fCmdResponseGrid) {
+    std::istringstream is(val);
+    G4double emin = 0., emax = 0.;
+    G4String unit;
+    G4int nbins = 30;
+    is >> emin >> emax >> unit >> nbins;
+    G4double scale = G4UIcommand::ValueOf(unit);
+    fRunAction->SetResponseGrid(emin * scale, emax * scale, nbins);
+  }
 }
 
 } // namespace B4
\ No newline at end of file
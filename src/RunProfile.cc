@@ -0,0 +1,316 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+//
+/// \file B4/B4a/src/RunProfile.cc
+/// \brief Implementation of the B4::RunProfile class
+
+#include "RunProfile.hh"
+
+#include "G4LogicalVolume.hh"
+#include "G4ParticleDefinition.hh"
+#include "G4ParticleTable.hh"
+#include "G4Track.hh"
+
+#include <algorithm>
+#include <cmath>
+#include <iomanip>
+
+namespace
+{
+using Seconds = std::chrono::duration<G4double>;
+
+// 同一进程内各线程的 steady_clock 可以直接比较
+G4double Since(std::chrono::steady_clock::time_point t)
+{
+  return Seconds(t.time_since_epoch()).count();
+}
+
+G4String SpeciesName(G4int pdg)
+{
+  auto* particle = G4ParticleTable::GetParticleTable()->FindParticle(pdg);
+  return particle ? particle->GetParticleName() : G4String(std::to_string(pdg));
+}
+
+// 体积名、粒子名只含普通字符，这里只需转义引号和反斜杠
+G4String JsonString(const G4String& s)
+{
+  G4String out = "\"";
+  for (char c : s) {
+    if (c == '"' || c == '\\') out += '\\';
+    out += c;
+  }
+  return out + "\"";
+}
+}  // namespace
+
+namespace B4
+{
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void RunProfile::BeginRun()
+{
+  fVolumeCache.clear();
+  fLastVolume = nullptr;
+  fLastSlot = 0;
+  fRunStart = Clock::now();
+  fLastEventEnd = fRunStart;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void RunProfile::MarkRunEnd()
+{
+  fWall = Seconds(Clock::now() - fRunStart).count();
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void RunProfile::EndRun(G4int threadID)
+{
+  // 指针缓存 -> 按体积名合并 (不同线程的同名体积是同一个 LV)
+  G4long steps = 0;
+  for (const auto& [volume, count] : fVolumeCache) {
+    fVolumeSteps[volume ? volume->GetName() : G4String("unknown")] += count;
+    steps += count;
+  }
+  fVolumeCache.clear();
+  fLastVolume = nullptr;
+
+  auto& thread = fThreads[threadID];
+  thread.events += fEvents;
+  thread.steps += steps;
+  thread.eventTime += fEventTime;
+  thread.runTime += Seconds(Clock::now() - fRunStart).count();
+  thread.finished = std::max(thread.finished, Since(fLastEventEnd));
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void RunProfile::EndEvent(G4int eventID)
+{
+  fLastEventEnd = Clock::now();
+  G4double t = Seconds(fLastEventEnd - fEventStart).count();
+  ++fEvents;
+  fEventTime += t;
+  fEventTime2 += t * t;
+  if (t > fMaxEventTime) {
+    fMaxEventTime = t;
+    fSlowestEvent = eventID;
+  }
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void RunProfile::EndTrack(const G4Track* track)
+{
+  auto& species = fSpecies[track->GetDefinition()->GetPDGEncoding()];
+  ++species.tracks;
+  species.steps += track->GetCurrentStepNumber();
+  species.time += Seconds(Clock::now() - fTrackStart).count();
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void RunProfile::SelectVolume(const G4LogicalVolume* volume)
+{
+  // 体积数很少 (世界、靶、探测器...)，线性查找即可
+  auto it = std::find_if(fVolumeCache.begin(), fVolumeCache.end(),
+                         [volume](const auto& slot) { return slot.first == volume; });
+  if (it == fVolumeCache.end()) {
+    fVolumeCache.emplace_back(volume, 0);
+    it = fVolumeCache.end() - 1;
+  }
+  fLastVolume = volume;
+  fLastSlot = it - fVolumeCache.begin();
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void RunProfile::Merge(const G4VAccumulable& other)
+{
+  const auto& o = static_cast<const RunProfile&>(other);
+  for (const auto& [name, count] : o.fVolumeSteps) fVolumeSteps[name] += count;
+  for (const auto& [pdg, s] : o.fSpecies) {
+    auto& mine = fSpecies[pdg];
+    mine.tracks += s.tracks;
+    mine.steps += s.steps;
+    mine.time += s.time;
+  }
+  for (const auto& [id, t] : o.fThreads) {
+    auto& mine = fThreads[id];
+    mine.events += t.events;
+    mine.steps += t.steps;
+    mine.eventTime += t.eventTime;
+    mine.runTime += t.runTime;
+    mine.finished = std::max(mine.finished, t.finished);
+  }
+  fEvents += o.fEvents;
+  fEventTime += o.fEventTime;
+  fEventTime2 += o.fEventTime2;
+  if (o.fMaxEventTime > fMaxEventTime) {
+    fMaxEventTime = o.fMaxEventTime;
+    fSlowestEvent = o.fSlowestEvent;
+  }
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void RunProfile::Reset()
+{
+  fVolumeSteps.clear();
+  fSpecies.clear();
+  fThreads.clear();
+  fEvents = 0;
+  fEventTime = 0.;
+  fEventTime2 = 0.;
+  fMaxEventTime = 0.;
+  fSlowestEvent = -1;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+std::pair<G4double, G4double> RunProfile::IdleAndTail() const
+{
+  G4double idle = 0.;
+  G4double first = 0., last = 0.;
+  G4bool any = false;
+  for (const auto& [id, t] : fThreads) {
+    idle += std::max(0., fWall - t.eventTime);
+    if (t.events == 0) continue;
+    first = any ? std::min(first, t.finished) : t.finished;
+    last = any ? std::max(last, t.finished) : t.finished;
+    any = true;
+  }
+  return {idle, last - first};
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void RunProfile::Print(std::ostream& os) const
+{
+  G4long totalSteps = 0;
+  for (const auto& [name, count] : fVolumeSteps) totalSteps += count;
+  G4double mean = fEvents > 0 ? fEventTime / fEvents : 0.;
+  G4double rms =
+    fEvents > 0 ? std::sqrt(std::max(0., fEventTime2 / fEvents - mean * mean)) : 0.;
+
+  os << "========== Profile ==========\n"
+     << std::fixed << std::setprecision(3)
+     << " Event time            : " << 1e3 * mean << " +- " << 1e3 * rms << " ms (max "
+     << 1e3 * fMaxEventTime << " ms, event " << fSlowestEvent << ")\n"
+     << " Steps per volume      :\n";
+  for (const auto& [name, count] : fVolumeSteps) {
+    os << "   " << std::left << std::setw(20) << name << std::right << std::setw(14) << count
+       << std::setw(9) << (totalSteps > 0 ? 100. * count / totalSteps : 0.) << " %\n";
+  }
+
+  // 按耗时排序
+  std::vector<std::pair<G4int, SpeciesStats>> species(fSpecies.begin(), fSpecies.end());
+  std::sort(species.begin(), species.end(),
+            [](const auto& a, const auto& b) { return a.second.time > b.second.time; });
+  os << "   " << std::left << std::setw(20) << "species" << std::right << std::setw(12)
+     << "tracks" << std::setw(14) << "steps" << std::setw(12) << "time [s]" << "\n";
+  for (const auto& [pdg, s] : species) {
+    os << "   " << std::left << std::setw(20) << SpeciesName(pdg) << std::right
+       << std::setw(12) << s.tracks << std::setw(14) << s.steps << std::setw(12) << s.time
+       << "\n";
+  }
+
+  // 空闲 = master 的 run 时间 - 事件时间；完成时刻相对 master 的 run 开始
+  G4double start = Since(fRunStart);
+  os << "   " << std::left << std::setw(20) << "thread" << std::right << std::setw(12)
+     << "events" << std::setw(14) << "steps" << std::setw(12) << "busy [%]" << std::setw(12)
+     << "idle [s]" << std::setw(12) << "done [s]" << "\n";
+  for (const auto& [id, t] : fThreads) {
+    os << "   " << std::left << std::setw(20) << id << std::right << std::setw(12) << t.events
+       << std::setw(14) << t.steps << std::setw(12)
+       << (fWall > 0. ? 100. * t.eventTime / fWall : 0.) << std::setw(12)
+       << std::max(0., fWall - t.eventTime) << std::setw(12) << t.finished - start << "\n";
+  }
+  auto [idle, tail] = IdleAndTail();
+  os << " Run wall time         : " << fWall << " s\n"
+     << " Idle (all threads)    : " << idle << " s ("
+     << (fWall > 0. && !fThreads.empty() ? 100. * idle / (fWall * fThreads.size()) : 0.)
+     << " % of thread time)\n"
+     << " Tail                  : " << tail << " s (first to last thread done)\n"
+     << "=================================" << std::defaultfloat << std::endl;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void RunProfile::WriteJson(std::ostream& os, G4int runID) const
+{
+  G4double mean = fEvents > 0 ? fEventTime / fEvents : 0.;
+  G4double rms =
+    fEvents > 0 ? std::sqrt(std::max(0., fEventTime2 / fEvents - mean * mean)) : 0.;
+
+  auto [idle, tail] = IdleAndTail();
+  G4double start = Since(fRunStart);
+  os << std::setprecision(9) << "{\n"
+     << "  \"run\": " << runID << ",\n"
+     << "  \"events\": " << fEvents << ",\n"
+     << "  \"wall_s\": " << fWall << ",\n"
+     << "  \"idle_s\": " << idle << ",\n"
+     << "  \"tail_s\": " << tail << ",\n"
+     << "  \"event_time_s\": {\"sum\": " << fEventTime << ", \"mean\": " << mean
+     << ", \"rms\": " << rms << ", \"max\": " << fMaxEventTime
+     << ", \"slowest_event\": " << fSlowestEvent << "},\n";
+
+  os << "  \"volumes\": [";
+  G4bool first = true;
+  for (const auto& [name, count] : fVolumeSteps) {
+    os << (first ? "\n" : ",\n") << "    {\"name\": " << JsonString(name)
+       << ", \"steps\": " << count << "}";
+    first = false;
+  }
+  os << "\n  ],\n";
+
+  os << "  \"species\": [";
+  first = true;
+  for (const auto& [pdg, s] : fSpecies) {
+    os << (first ? "\n" : ",\n") << "    {\"pdg\": " << pdg
+       << ", \"name\": " << JsonString(SpeciesName(pdg)) << ", \"tracks\": " << s.tracks
+       << ", \"steps\": " << s.steps << ", \"time_s\": " << s.time << "}";
+    first = false;
+  }
+  os << "\n  ],\n";
+
+  os << "  \"threads\": [";
+  first = true;
+  for (const auto& [id, t] : fThreads) {
+    os << (first ? "\n" : ",\n") << "    {\"id\": " << id << ", \"events\": " << t.events
+       << ", \"steps\": " << t.steps << ", \"event_time_s\": " << t.eventTime
+       << ", \"run_time_s\": " << t.runTime << ", \"idle_s\": " << std::max(0., fWall - t.eventTime)
+       << ", \"finished_s\": " << t.finished - start << "}";
+    first = false;
+  }
+  os << "\n  ]\n}\n";
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+}  // namespace B4
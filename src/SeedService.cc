@@ -0,0 +1,192 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+//
+/// \file B4/B4a/src/SeedService.cc
+/// \brief Implementation of the B4::SeedService class
+
+#include "SeedService.hh"
+#include "SeedServiceMessenger.hh"
+
+#include "CLHEP/Random/MTwistEngine.h"
+#include "CLHEP/Random/MixMaxRng.h"
+#include "CLHEP/Random/RanecuEngine.h"
+#include "CLHEP/Random/RanluxppEngine.h"
+#include "G4ios.hh"
+#include "Randomize.hh"
+
+#include <chrono>
+#include <random>
+#include <unistd.h>
+
+namespace
+{
+// splitmix64：相邻的输入给出互不相关的输出
+std::uint64_t SplitMix64(std::uint64_t x)
+{
+  x += 0x9e3779b97f4a7c15ULL;
+  x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ULL;
+  x = (x ^ (x >> 27)) * 0x94d049bb133111ebULL;
+  return x ^ (x >> 31);
+}
+}  // namespace
+
+namespace B4
+{
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+SeedService::SeedService()
+{
+  fMessenger = new SeedServiceMessenger(this);
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+SeedService::~SeedService()
+{
+  delete fMessenger;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+G4bool SeedService::InstallEngine(const G4String& name)
+{
+  CLHEP::HepRandomEngine* engine = nullptr;
+  if (name == "mixmax") engine = new CLHEP::MixMaxRng;
+  else if (name == "ranecu") engine = new CLHEP::RanecuEngine;
+  else if (name == "ranluxpp") engine = new CLHEP::RanluxppEngine;
+  else if (name == "mtwist") engine = new CLHEP::MTwistEngine;
+
+  if (!engine) {
+    G4ExceptionDescription msg;
+    msg << "Unknown random engine \"" << name << "\" (mixmax, ranecu, ranluxpp, mtwist)."
+        << " Keeping " << fEngineName << ".";
+    G4Exception("SeedService::InstallEngine()", "MyCode0010", JustWarning, msg);
+    return false;
+  }
+
+  // worker 在启动时按 master 引擎的类型创建自己的引擎
+  G4Random::setTheEngine(engine);
+  fEngineName = name;
+  if (fMasterSeed != 0) SetMasterSeed(fMasterSeed);
+  return true;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void SeedService::SetMasterSeed(std::uint64_t seed)
+{
+  fMasterSeed = seed;
+  // master 自身 (以及 MT 内核给 worker 的种子队列) 也由主种子确定
+  Reseed({-1, -1}, Stream::Physics);
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+std::uint64_t SeedService::MakeUniqueSeed()
+{
+  // 同一秒内启动的多个作业也得到不同的种子
+  auto now = std::chrono::high_resolution_clock::now().time_since_epoch().count();
+  std::uint64_t seed = SplitMix64(static_cast<std::uint64_t>(now));
+  seed = SplitMix64(seed ^ static_cast<std::uint64_t>(getpid()));
+  std::random_device device;
+  seed = SplitMix64(seed ^ ((static_cast<std::uint64_t>(device()) << 32) | device()));
+  return seed != 0 ? seed : 1;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void SeedService::SetReplay(G4long event, G4int run)
+{
+  fReplayEvent = event;
+  fReplayRun = event >= 0 ? run : -1;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void SeedService::SetShard(G4int index, G4int count)
+{
+  if (count < 1 || index < 0 || index >= count) {
+    G4ExceptionDescription msg;
+    msg << "Invalid shard " << index << "/" << count << ": need 0 <= k < N.";
+    G4Exception("SeedService::SetShard()", "MyCode0011", FatalException, msg);
+    return;
+  }
+  fShardIndex = index;
+  fShardCount = count;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+SeedService::EventKey SeedService::KeyFor(G4int runID, G4int eventID, G4long eventsInRun) const
+{
+  EventKey key{runID, GetFirstEvent(eventsInRun) + eventID};
+  if (fWindowFirst >= 0) key.run = fWindowRun;
+  if (fReplayEvent >= 0) {
+    key.event = fReplayEvent + eventID;
+    if (fReplayRun >= 0) key.run = fReplayRun;
+  }
+  return key;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void SeedService::Reseed(const EventKey& key, Stream stream) const
+{
+  std::uint64_t h = SplitMix64(fMasterSeed);
+  h = SplitMix64(h ^ static_cast<std::uint64_t>(static_cast<std::int64_t>(key.run)));
+  h = SplitMix64(h ^ static_cast<std::uint64_t>(key.event));
+  h = SplitMix64(h ^ static_cast<std::uint64_t>(stream));
+
+  // 与 G4WorkerRunManager 相同的约定：两个正的 31 位种子，0 结尾
+  long seeds[3] = {static_cast<long>((h & 0x7ffffffeULL) + 1),
+                   static_cast<long>(((h >> 32) & 0x7ffffffeULL) + 1), 0};
+  G4Random::setTheSeeds(seeds);
+  // RandGauss 缓存的第二个高斯数属于上一个事件
+  CLHEP::RandGauss::setFlag(false);
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void SeedService::Print() const
+{
+  G4cout << "========== Seeding ==========\n"
+         << " Engine                : " << fEngineName << "\n"
+         << " Master seed           : " << fMasterSeed << "  (exampleB4a -s "
+         << fMasterSeed << " or /seed/master to reproduce)\n";
+  if (fShardCount > 0) {
+    G4cout << " Shard                 : " << fShardIndex << " of " << fShardCount << "\n";
+  }
+  if (fReplayEvent >= 0) {
+    G4cout << " Replay                : from event " << fReplayEvent << " of run "
+           << (fReplayRun >= 0 ? std::to_string(fReplayRun) : G4String("(current)")) << "\n";
+  }
+  G4cout << "=================================" << G4endl;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+}  // namespace B4
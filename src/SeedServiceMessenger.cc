@@ -0,0 +1,74 @@
+#include "SeedServiceMessenger.hh"
+#include "SeedService.hh"
+
+#include "G4UIdirectory.hh"
+#include "G4UIcommand.hh"
+#include "G4UIparameter.hh"
+#include "G4UIcmdWithAString.hh"
+#include "G4UIcmdWithoutParameter.hh"
+
+#include <sstream>
+#include <string>
+
+namespace B4 {
+
+SeedServiceMessenger::SeedServiceMessenger(SeedService* seeds)
+ : fSeeds(seeds)
+{
+  fSeedDir = new G4UIdirectory("/seed/");
+  fSeedDir->SetGuidance("Deterministic per-event seeding and single-event replay");
+
+  fMasterCmd = new G4UIcmdWithAString("/seed/master", this);
+  fMasterCmd->SetGuidance("Set the 64-bit master seed (same as exampleB4a -s).");
+  fMasterCmd->SetGuidance("Every event is seeded from (master seed, run, event).");
+  fMasterCmd->SetParameterName("seed", false);
+  fMasterCmd->AvailableForStates(G4State_PreInit, G4State_Idle);
+
+  fReplayCmd = new G4UIcommand("/seed/replay", this);
+  fReplayCmd->SetGuidance("Re-simulate events without running the ones before them:");
+  fReplayCmd->SetGuidance("event i of the next runs is simulated as event <event>+i of run <run>");
+  fReplayCmd->SetGuidance("(default: the current run). /run/beamOn 1 replays a single event.");
+  fReplayCmd->SetGuidance("A negative event switches replay off.");
+  auto* event = new G4UIparameter("event", 'i', false);
+  fReplayCmd->SetParameter(event);
+  auto* run = new G4UIparameter("run", 'i', true);
+  run->SetDefaultValue(-1);
+  fReplayCmd->SetParameter(run);
+  fReplayCmd->AvailableForStates(G4State_PreInit, G4State_Idle);
+
+  fPrintCmd = new G4UIcmdWithoutParameter("/seed/print", this);
+  fPrintCmd->SetGuidance("Print the engine, the master seed and the replay setting");
+  fPrintCmd->AvailableForStates(G4State_PreInit, G4State_Idle);
+
+  // SeedService 只有一个 (main 所有)，worker 上没有这些命令
+  for (G4UIcommand* c : {(G4UIcommand*)fMasterCmd, fReplayCmd, (G4UIcommand*)fPrintCmd}) {
+    c->SetToBeBroadcasted(false);
+  }
+}
+
+SeedServiceMessenger::~SeedServiceMessenger()
+{
+  delete fPrintCmd;
+  delete fReplayCmd;
+  delete fMasterCmd;
+  delete fSeedDir;
+}
+
+void SeedServiceMessenger::SetNewValue(G4UIcommand* cmd, G4String val)
+{
+  if (cmd == fMasterCmd) {
+    fSeeds->SetMasterSeed(std::stoull(val));
+  }
+  else if (cmd == fReplayCmd) {
+    std::istringstream is(val);
+    G4long event = -1;
+    G4int run = -1;
+    is >> event >> run;
+    fSeeds->SetReplay(event, run);
+  }
+  else if (cmd == fPrintCmd) {
+    fSeeds->Print();
+  }
+}
+
+}  // namespace B4
@@ -0,0 +1,100 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+//
+/// \file B4/B4a/src/SpeciesTally.cc
+/// \brief Implementation of the B4::SpeciesTally class
+
+#include "SpeciesTally.hh"
+
+#include "G4ParticleDefinition.hh"
+#include "G4ParticleTable.hh"
+#include "G4SystemOfUnits.hh"
+#include "G4UnitsTable.hh"
+
+#include <iomanip>
+
+namespace B4
+{
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void SpeciesTally::Merge(const G4VAccumulable& other)
+{
+  const auto& otherTally = static_cast<const SpeciesTally&>(other);
+  for (const auto& [pdg, entry] : otherTally.fEntries) {
+    auto& mine = fEntries[pdg];
+    mine.count += entry.count;
+    mine.energy += entry.energy;
+  }
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void SpeciesTally::Write(std::ostream& os, const G4String& key) const
+{
+  os << std::setprecision(17) << key << " =";
+  for (const auto& [pdg, entry] : fEntries) {
+    os << " " << pdg << ":" << entry.count << ":" << entry.energy / MeV;
+  }
+  os << "\n";
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+G4long SpeciesTally::GetTotalCount() const
+{
+  G4long total = 0;
+  for (const auto& item : fEntries) total += item.second.count;
+  return total;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+G4double SpeciesTally::GetTotalEnergy() const
+{
+  G4double total = 0.;
+  for (const auto& item : fEntries) total += item.second.energy;
+  return total;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void SpeciesTally::Print(std::ostream& os, const G4String& title) const
+{
+  os << " " << title << " : " << GetTotalCount() << " tracks, "
+     << G4BestUnit(GetTotalEnergy(), "Energy") << "\n";
+  for (const auto& [pdg, entry] : fEntries) {
+    auto* particle = G4ParticleTable::GetParticleTable()->FindParticle(pdg);
+    G4String name = particle ? particle->GetParticleName() : std::to_string(pdg);
+    os << "   " << std::setw(14) << std::left << name << std::right
+       << std::setw(12) << entry.count << "   "
+       << G4BestUnit(entry.energy, "Energy") << "\n";
+  }
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+}  // namespace B4
@@ -0,0 +1,101 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+//
+/// \file B4/B4a/src/StackingAction.cc
+/// \brief Implementation of the B4::StackingAction class
+
+#include "StackingAction.hh"
+#include "StackingPolicy.hh"
+#include "RunAction.hh"
+#include "EventAction.hh"
+
+#include "G4Event.hh"
+#include "G4EventManager.hh"
+#include "G4ParticleDefinition.hh"
+#include "G4PrimaryVertex.hh"
+#include "G4Track.hh"
+
+namespace B4
+{
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+StackingAction::StackingAction(const StackingPolicy* policy, RunAction* runAction,
+                               EventAction* eventAction)
+  : G4UserStackingAction(),
+    fPolicy(policy),
+    fRunAction(runAction),
+    fEventAction(eventAction) {}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void StackingAction::PrepareNewEvent()
+{
+  fEventT0 = 0.;
+  const auto* event = G4EventManager::GetEventManager()->GetConstCurrentEvent();
+  if (event && event->GetNumberOfPrimaryVertex() > 0) {
+    fEventT0 = event->GetPrimaryVertex(0)->GetT0();
+  }
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+G4ClassificationOfNewTrack StackingAction::ClassifyNewTrack(const G4Track* track)
+{
+  if (track->GetParentID() > 0) fEventAction->NoteSecondary(track);
+
+  // 初级粒子不处理
+  if (track->GetParentID() == 0 || !fPolicy->IsActive()) return fUrgent;
+
+  G4bool validation = fPolicy->IsValidation();
+  if (fEventAction->TakeEntryProduct(track)) {
+    // 入射时终止的径迹在入射那一步产生的次级粒子 (验证模式下还有之后各步的)
+    fRunAction->AddEntryKill(track->GetDefinition()->GetPDGEncoding(),
+                             track->GetKineticEnergy());
+    if (!validation) return fKill;
+    fEventAction->FlagTrack(track->GetTrackID());
+  }
+  else if (validation && fEventAction->IsFlagged(track->GetParentID())) {
+    // 被"杀掉"的粒子的后代：本来不会产生，只做标记
+    fEventAction->FlagTrack(track->GetTrackID());
+  }
+  else {
+    auto reason = fPolicy->Classify(track, fEventT0);
+    if (reason != StackingPolicy::KillReason::None) {
+      fRunAction->AddStackKill(track->GetDefinition()->GetPDGEncoding(),
+                               track->GetKineticEnergy(), reason);
+      if (!validation) return fKill;
+      fEventAction->FlagTrack(track->GetTrackID());
+    }
+  }
+
+  if (fPolicy->IsWaiting(track->GetDefinition()->GetPDGEncoding())) return fWaiting;
+  return fUrgent;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+}  // namespace B4
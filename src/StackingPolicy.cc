@@ -0,0 +1,238 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+//
+/// \file B4/B4a/src/StackingPolicy.cc
+/// \brief Implementation of the B4::StackingPolicy class
+
+#include "StackingPolicy.hh"
+#include "StackingPolicyMessenger.hh"
+#include "DetectorConstruction.hh"
+
+#include "G4FieldManager.hh"
+#include "G4ParticleDefinition.hh"
+#include "G4ParticleTable.hh"
+#include "G4Track.hh"
+#include "G4TransportationManager.hh"
+#include "G4UnitsTable.hh"
+#include "G4ios.hh"
+
+#include <cmath>
+#include <limits>
+
+namespace
+{
+// 射线 position + t*direction (t >= 0) 是否与圆柱 r <= radius, zmin <= z <= zmax 相交
+G4bool RayHitsCylinder(const G4ThreeVector& pos, const G4ThreeVector& dir,
+                       G4double radius, G4double zmin, G4double zmax)
+{
+  G4double tmin = 0.;
+  G4double tmax = std::numeric_limits<G4double>::max();
+
+  // z 方向的平板
+  if (std::abs(dir.z()) < 1e-12) {
+    if (pos.z() < zmin || pos.z() > zmax) return false;
+  }
+  else {
+    G4double t1 = (zmin - pos.z()) / dir.z();
+    G4double t2 = (zmax - pos.z()) / dir.z();
+    if (t1 > t2) std::swap(t1, t2);
+    tmin = std::max(tmin, t1);
+    tmax = std::min(tmax, t2);
+  }
+
+  // 径向：x^2 + y^2 <= radius^2
+  G4double a = dir.x()*dir.x() + dir.y()*dir.y();
+  G4double b = 2. * (pos.x()*dir.x() + pos.y()*dir.y());
+  G4double c = pos.x()*pos.x() + pos.y()*pos.y() - radius*radius;
+  if (a < 1e-24) {
+    if (c > 0.) return false;
+  }
+  else {
+    G4double disc = b*b - 4.*a*c;
+    if (disc < 0.) return false;
+    G4double sq = std::sqrt(disc);
+    tmin = std::max(tmin, (-b - sq) / (2.*a));
+    tmax = std::min(tmax, (-b + sq) / (2.*a));
+  }
+  return tmin <= tmax;
+}
+}  // namespace
+
+namespace B4
+{
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+StackingPolicy::StackingPolicy(const DetectorConstruction* det)
+  : fDet(det)
+{
+  fMessenger = new StackingPolicyMessenger(this);
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+StackingPolicy::~StackingPolicy()
+{
+  delete fMessenger;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void StackingPolicy::Reset()
+{
+  fEnergyCuts.clear();
+  fTimeCuts.clear();
+  fWaiting.clear();
+  fEntryKills.clear();
+  fKillUnreachable = false;
+  fValidation = false;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+G4bool StackingPolicy::IsActive() const
+{
+  return !fEnergyCuts.empty() || !fTimeCuts.empty() || !fWaiting.empty() || fKillUnreachable
+         || !fEntryKills.empty();
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+G4bool StackingPolicy::KillOnEntry(G4int pdg, G4double energy) const
+{
+  for (const auto& rule : fEntryKills) {
+    if ((rule.pdg == 0 || rule.pdg == pdg) && energy >= rule.emin
+        && (rule.emax <= 0. || energy < rule.emax)) {
+      return true;
+    }
+  }
+  return false;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+G4double StackingPolicy::FindCut(const std::map<G4int, G4double>& cuts, G4int pdg)
+{
+  auto it = cuts.find(pdg);
+  if (it == cuts.end()) it = cuts.find(0);
+  return (it == cuts.end()) ? -1. : it->second;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+StackingPolicy::KillReason StackingPolicy::Classify(const G4Track* track, G4double eventT0) const
+{
+  G4int pdg = track->GetDefinition()->GetPDGEncoding();
+
+  if (!fEnergyCuts.empty()) {
+    G4double cut = FindCut(fEnergyCuts, pdg);
+    if (cut > 0. && track->GetKineticEnergy() < cut) return KillReason::Energy;
+  }
+
+  if (!fTimeCuts.empty()) {
+    G4double cut = FindCut(fTimeCuts, pdg);
+    if (cut > 0. && track->GetGlobalTime() - eventT0 > cut) return KillReason::Time;
+  }
+
+  if (fKillUnreachable
+      && !CanReachDetector(track->GetPosition(), track->GetMomentumDirection())) {
+    return KillReason::Geometry;
+  }
+
+  return KillReason::None;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+G4bool StackingPolicy::CanReachDetector(const G4ThreeVector& position,
+                                        const G4ThreeVector& direction) const
+{
+  // 有磁场时轨迹不是直线，不做几何判断
+  auto* fieldManager = G4TransportationManager::GetTransportationManager()->GetFieldManager();
+  if (fieldManager && fieldManager->GetDetectorField()) return true;
+
+  // 靶内 (或将穿过靶) 的粒子可能散射到任何方向
+  G4double targetZ = fDet->GetTargetPosition().z();
+  G4double targetHalfLength = fDet->GetTargetLength() / 2;
+  if (RayHitsCylinder(position, direction, fDet->GetTargetRadius(),
+                      targetZ - targetHalfLength, targetZ + targetHalfLength)) {
+    return true;
+  }
+
+  // 探测器包络：外半径 R，z 在 [-L/2, L/2]，上游端面敞开
+  G4double radius = fDet->GetDetectorRadius();
+  G4double innerRadius = radius - fDet->GetDetectorThickness();
+  G4double zmin = -fDet->GetDetectorLength() / 2;
+  G4double zmax = fDet->GetDetectorLength() / 2;
+
+  G4bool inside = position.perp2() < radius*radius
+               && position.z() > zmin && position.z() < zmax;
+  if (!inside) {
+    // 包络外的真空：射线进入包络后必然打到外壳 (从上游开口进入也无法再从开口离开)
+    return RayHitsCylinder(position, direction, radius, zmin, zmax);
+  }
+
+  // 包络内：只有从上游开口 (r < 内半径) 飞出才到不了外壳
+  if (direction.z() >= 0.) return true;
+  G4double t = (zmin - position.z()) / direction.z();
+  G4ThreeVector exitPoint = position + t * direction;
+  return exitPoint.perp2() >= innerRadius*innerRadius;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void StackingPolicy::Print() const
+{
+  auto name = [](G4int pdg) -> G4String {
+    if (pdg == 0) return "all";
+    auto* particle = G4ParticleTable::GetParticleTable()->FindParticle(pdg);
+    return particle ? particle->GetParticleName() : std::to_string(pdg);
+  };
+
+  G4cout << "========== Stacking policy ==========\n";
+  for (const auto& [pdg, cut] : fEnergyCuts) {
+    G4cout << " energy cut  " << name(pdg) << " : " << G4BestUnit(cut, "Energy") << "\n";
+  }
+  for (const auto& [pdg, cut] : fTimeCuts) {
+    G4cout << " time cut    " << name(pdg) << " : " << G4BestUnit(cut, "Time") << "\n";
+  }
+  for (auto pdg : fWaiting) {
+    G4cout << " waiting     " << name(pdg) << "\n";
+  }
+  for (const auto& rule : fEntryKills) {
+    G4cout << " kill on entry " << name(rule.pdg) << " : " << G4BestUnit(rule.emin, "Energy")
+           << " - ";
+    if (rule.emax > 0.) G4cout << G4BestUnit(rule.emax, "Energy") << "\n";
+    else G4cout << "inf\n";
+  }
+  G4cout << " kill unreachable : " << (fKillUnreachable ? "on" : "off") << "\n"
+         << " validation mode  : " << (fValidation ? "on" : "off") << "\n"
+         << "=====================================" << G4endl;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+}  // namespace B4
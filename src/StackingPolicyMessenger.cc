@@ -0,0 +1,162 @@
+#include "StackingPolicyMessenger.hh"
+#include "StackingPolicy.hh"
+
+#include "G4UIdirectory.hh"
+#include "G4UIcommand.hh"
+#include "G4UIparameter.hh"
+#include "G4UIcmdWithAString.hh"
+#include "G4UIcmdWithABool.hh"
+#include "G4UIcmdWithoutParameter.hh"
+#include "G4ParticleDefinition.hh"
+#include "G4ParticleTable.hh"
+#include "G4ios.hh"
+
+#include <sstream>
+
+namespace B4 {
+
+StackingPolicyMessenger::StackingPolicyMessenger(StackingPolicy* policy)
+ : fPolicy(policy)
+{
+  fStackDir = new G4UIdirectory("/stack/");
+  fStackDir->SetGuidance("Kill secondaries that cannot contribute and set stack priorities");
+
+  fEnergyCutCmd = new G4UIcommand("/stack/energyCut", this);
+  fEnergyCutCmd->SetGuidance("Kill new secondaries of a species below a kinetic energy");
+  fEnergyCutCmd->SetGuidance("particle = all applies to species without their own cut");
+  fEnergyCutCmd->SetParameter(new G4UIparameter("particle", 's', false));
+  fEnergyCutCmd->SetParameter(new G4UIparameter("value", 'd', false));
+  auto* energyUnit = new G4UIparameter("unit", 's', true);
+  energyUnit->SetDefaultValue("MeV");
+  fEnergyCutCmd->SetParameter(energyUnit);
+  fEnergyCutCmd->AvailableForStates(G4State_PreInit, G4State_Idle);
+
+  fTimeCutCmd = new G4UIcommand("/stack/timeCut", this);
+  fTimeCutCmd->SetGuidance("Kill new secondaries of a species created later than a time");
+  fTimeCutCmd->SetGuidance("after the primary vertex (e.g. thermalising neutrons)");
+  fTimeCutCmd->SetParameter(new G4UIparameter("particle", 's', false));
+  fTimeCutCmd->SetParameter(new G4UIparameter("value", 'd', false));
+  auto* timeUnit = new G4UIparameter("unit", 's', true);
+  timeUnit->SetDefaultValue("ns");
+  fTimeCutCmd->SetParameter(timeUnit);
+  fTimeCutCmd->AvailableForStates(G4State_PreInit, G4State_Idle);
+
+  fWaitingCmd = new G4UIcmdWithAString("/stack/waiting", this);
+  fWaitingCmd->SetGuidance("Push new secondaries of this species to the waiting stack,");
+  fWaitingCmd->SetGuidance("so they are tracked after all urgent tracks of the event");
+  fWaitingCmd->SetParameterName("particle", false);
+  fWaitingCmd->AvailableForStates(G4State_PreInit, G4State_Idle);
+
+  fUnreachableCmd = new G4UIcmdWithABool("/stack/killUnreachable", this);
+  fUnreachableCmd->SetGuidance("Kill new secondaries whose straight path misses both");
+  fUnreachableCmd->SetGuidance("the target and the detector shell (ignored with a magnetic field)");
+  fUnreachableCmd->SetParameterName("flag", true);
+  fUnreachableCmd->SetDefaultValue(true);
+  fUnreachableCmd->AvailableForStates(G4State_PreInit, G4State_Idle);
+
+  fKillOnEntryCmd = new G4UIcommand("/stack/killOnEntry", this);
+  fKillOnEntryCmd->SetGuidance("Stop a track (and kill the secondaries of that step) once its entry");
+  fKillOnEntryCmd->SetGuidance("into the detector shell is recorded: particle [emin emax unit].");
+  fKillOnEntryCmd->SetGuidance("particle = all for every species; emax = 0 means no upper limit.");
+  fKillOnEntryCmd->SetGuidance("Repeat the command to add species or energy ranges");
+  fKillOnEntryCmd->SetParameter(new G4UIparameter("particle", 's', false));
+  auto* emin = new G4UIparameter("emin", 'd', true);
+  emin->SetDefaultValue(0.);
+  fKillOnEntryCmd->SetParameter(emin);
+  auto* emax = new G4UIparameter("emax", 'd', true);
+  emax->SetDefaultValue(0.);
+  fKillOnEntryCmd->SetParameter(emax);
+  auto* entryUnit = new G4UIparameter("unit", 's', true);
+  entryUnit->SetDefaultValue("MeV");
+  fKillOnEntryCmd->SetParameter(entryUnit);
+  fKillOnEntryCmd->AvailableForStates(G4State_PreInit, G4State_Idle);
+
+  fValidateCmd = new G4UIcmdWithABool("/stack/validate", this);
+  fValidateCmd->SetGuidance("Validation mode: nothing is killed, but tracks that would be");
+  fValidateCmd->SetGuidance("killed and their descendants are followed, and every detector");
+  fValidateCmd->SetGuidance("entry they make is counted as an entry lost by the policy");
+  fValidateCmd->SetGuidance("(for /stack/killOnEntry: re-entries of the track and entries of the");
+  fValidateCmd->SetGuidance("secondaries it makes from the entry step on)");
+  fValidateCmd->SetParameterName("flag", true);
+  fValidateCmd->SetDefaultValue(true);
+  fValidateCmd->AvailableForStates(G4State_PreInit, G4State_Idle);
+
+  fResetCmd = new G4UIcmdWithoutParameter("/stack/reset", this);
+  fResetCmd->SetGuidance("Remove all cuts and switch off killing and validation");
+  fResetCmd->AvailableForStates(G4State_PreInit, G4State_Idle);
+
+  fPrintCmd = new G4UIcmdWithoutParameter("/stack/print", this);
+  fPrintCmd->SetGuidance("Print the current stacking policy");
+  fPrintCmd->AvailableForStates(G4State_PreInit, G4State_Idle);
+}
+
+StackingPolicyMessenger::~StackingPolicyMessenger()
+{
+  delete fEnergyCutCmd;
+  delete fTimeCutCmd;
+  delete fWaitingCmd;
+  delete fUnreachableCmd;
+  delete fKillOnEntryCmd;
+  delete fValidateCmd;
+  delete fResetCmd;
+  delete fPrintCmd;
+  delete fStackDir;
+}
+
+G4bool StackingPolicyMessenger::ParticleCode(const G4String& name, G4int& pdg) const
+{
+  if (name == "all") {
+    pdg = 0;
+    return true;
+  }
+  auto* particle = G4ParticleTable::GetParticleTable()->FindParticle(name);
+  if (!particle) {
+    G4cerr << "Unknown particle " << name << " - command ignored" << G4endl;
+    return false;
+  }
+  pdg = particle->GetPDGEncoding();
+  return true;
+}
+
+void StackingPolicyMessenger::SetNewValue(G4UIcommand* cmd, G4String val)
+{
+  if (cmd == fEnergyCutCmd || cmd == fTimeCutCmd) {
+    std::istringstream is(val);
+    G4String name, unit;
+    G4double value = 0.;
+    is >> name >> value >> unit;
+    G4int pdg = 0;
+    if (!ParticleCode(name, pdg)) return;
+    value *= G4UIcommand::ValueOf(unit);
+    if (cmd == fEnergyCutCmd) fPolicy->SetEnergyCut(pdg, value);
+    else fPolicy->SetTimeCut(pdg, value);
+  }
+  else if (cmd == fWaitingCmd) {
+    G4int pdg = 0;
+    if (ParticleCode(val, pdg) && pdg != 0) fPolicy->AddWaiting(pdg);
+  }
+  else if (cmd == fKillOnEntryCmd) {
+    std::istringstream is(val);
+    G4String name, unit;
+    G4double emin = 0., emax = 0.;
+    is >> name >> emin >> emax >> unit;
+    G4int pdg = 0;
+    if (!ParticleCode(name, pdg)) return;
+    G4double scale = G4UIcommand::ValueOf(unit);
+    fPolicy->AddEntryKill(pdg, emin * scale, emax * scale);
+  }
+  else if (cmd == fUnreachableCmd) {
+    fPolicy->SetKillUnreachable(fUnreachableCmd->GetNewBoolValue(val));
+  }
+  else if (cmd == fValidateCmd) {
+    fPolicy->SetValidation(fValidateCmd->GetNewBoolValue(val));
+  }
+  else if (cmd == fResetCmd) {
+    fPolicy->Reset();
+  }
+  else if (cmd == fPrintCmd) {
+    fPolicy->Print();
+  }
+}
+
+}  // namespace B4
@@ -31,6 +31,7 @@
 #include "PrimaryGeneratorAction.hh"
 #include "DetectorConstruction.hh"
 #include "EventAction.hh"
+#include "TargetExitTable.hh"
 #include "G4LogicalVolume.hh"
 #include "G4AnalysisManager.hh"
 #include "G4Step.hh"
@@ -40,18 +41,52 @@
 #include "G4Track.hh"
 #include "G4ParticleDefinition.hh"
 
+#include <algorithm>
+
 namespace B4
 {
 
 //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
 
-SteppingAction::SteppingAction(DetectorConstruction* detConstruction, EventAction* eventAction, PrimaryGeneratorAction* genAction)
-  : fDet(detConstruction), fEventAction(eventAction), fGenAction(genAction) {}
+SteppingAction::SteppingAction(DetectorConstruction* detConstruction, EventAction* eventAction,
+                               PrimaryGeneratorAction* genAction, RunProfile* profile,
+                               TargetExitTable* targetExits)
+  : fGenAction(genAction), fDet(detConstruction), fEventAction(eventAction), fProfile(profile),
+    fTargetExits(targetExits) {}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void SteppingAction::BeginRun()
+{
+  fTraining = fTargetExits->IsTraining();
+  fPlanes = !fDet->GetPlaneZ().empty();
+  // 默认由 DetectorSD 记录入射，逐步检查路径只保留用于对比
+  fSteppingEntry = fDet->GetEntryScoring() == DetectorConstruction::EntryScoring::Stepping;
+  fStepWork = fTraining || fPlanes || fSteppingEntry;
+}
 
 //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
 
 void SteppingAction::UserSteppingAction(const G4Step* step)
 {
+  if constexpr (kProfilingEnabled) {
+    fProfile->AddStep(step->GetPreStepPoint()->GetPhysicalVolume()->GetLogicalVolume());
+  }
+
+  // 生产 run (SD 计分，无训练、平面和入射终止)：每步只有这一个判断
+  G4bool entryKills = fEventAction->HasEntryKills();
+  if (!fStepWork && !entryKills) return;
+
+  if (fTraining) RecordTargetExit(step);
+
+  // /stack/killOnEntry：入射时终止的径迹在这一步产生的次级粒子。须在下面的
+  // 逐步入射检查之前：跨入外壳的那一步产生在探测器之外，不杀
+  if (entryKills) fEventAction->NoteEntryProducts(step);
+
+  if (fPlanes) RecordPlaneCrossings(step, fDet->GetPlaneZ());
+
+  if (!fSteppingEntry) return;
+
    // 前后逻辑体积
   auto* prePV  = step->GetPreStepPoint()->GetTouchableHandle()->GetVolume();
   auto* postPV = step->GetPostStepPoint()->GetTouchableHandle()->GetVolume();
@@ -59,18 +94,74 @@ void SteppingAction::UserSteppingAction(const G4Step* step)
   auto* preVol  = prePV->GetLogicalVolume();
   auto* postVol = postPV->GetLogicalVolume();
 
-  auto* DetectorLV = fDet->GetDetectorLogical();
+  // 入射：从外壳以外跨入外壳 (primitive 模式下外壳由 barrel 和端盖组成)。
+  // 记录本步终点，即外壳边界上的点：DetectorSD 记录的是下一步的起点，是同一个点
+  if (!fDet->IsDetectorVolume(preVol) && fDet->IsDetectorVolume(postVol)) {
+    fEventAction->RecordEntry(step->GetTrack(), step->GetPostStepPoint());
+  }
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void SteppingAction::RecordPlaneCrossings(const G4Step* step, const std::vector<G4double>& planes)
+{
+  // 平面不限制步长：本步起点和终点的 z 之间的平面即被穿过。
+  // 向前：z0 < zp <= z1；向后：z1 < zp <= z0 (停在平面上再离开不重复计数)。
+  // 平面是靶横截面大小的圆盘：只计穿过点 (弦上插值) 在靶半径以内的
+  const auto* pre = step->GetPreStepPoint();
+  G4ThreeVector chord = step->GetPostStepPoint()->GetPosition() - pre->GetPosition();
+  G4double z0 = pre->GetPosition().z();
+  G4double z1 = z0 + chord.z();
+  if (z0 == z1) return;
+
+  auto first = std::upper_bound(planes.begin(), planes.end(), std::min(z0, z1));
+  auto last = std::upper_bound(first, planes.end(), std::max(z0, z1));
+  if (first == last) return;
+
+  const G4ThreeVector axis = fDet->GetTargetPosition();
+  const G4double radius2 = fDet->GetTargetRadius() * fDet->GetTargetRadius();
+  auto inside = [&](G4double zp) {
+    G4ThreeVector p = pre->GetPosition() + chord * ((zp - z0) / chord.z());
+    return (p - axis).perp2() <= radius2;
+  };
 
+  // 方向取本步的弦 (中性粒子即为真实方向)，能量取本步起点
+  G4ThreeVector direction = chord.unit();
+  if (z1 > z0) {
+    for (auto it = first; it != last; ++it) {
+      if (!inside(*it)) continue;
+      fEventAction->RecordCrossing(step->GetTrack(), pre, G4int(it - planes.begin()), direction);
+    }
+  }
+  else {
+    for (auto it = last; it != first; --it) {
+      if (!inside(*(it - 1))) continue;
+      fEventAction->RecordCrossing(step->GetTrack(), pre, G4int(it - 1 - planes.begin()),
+                                   direction);
+    }
+  }
+}
 
-  // 入射：跨入 Shield
-  if (preVol != DetectorLV && postVol == DetectorLV) {
-    G4Track* track = step->GetTrack(); 
-    fEventAction->RecordEntry(
-      track->GetParticleDefinition()->GetPDGEncoding(),
-      step->GetPreStepPoint()->GetKineticEnergy(),
-      step->GetPreStepPoint()->GetMomentumDirection(),
-      step->GetPreStepPoint()->GetMomentum());
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void SteppingAction::RecordTargetExit(const G4Step* step)
+{
+  // 穿过靶表面离开靶：初级粒子本身，或者在靶中产生的粒子
+  const auto* pre = step->GetPreStepPoint();
+  const auto* post = step->GetPostStepPoint();
+  if (post->GetStepStatus() != fGeomBoundary
+      || pre->GetPhysicalVolume()->GetLogicalVolume() != fDet->GetTargetLogical()) {
+    return;
   }
+  const G4Track* track = step->GetTrack();
+  G4bool survivor = track->GetParentID() == 0;
+  if (!survivor && track->GetLogicalVolumeAtVertex() != fDet->GetTargetLogical()) return;
+
+  G4ThreeVector local = post->GetPosition() - fDet->GetTargetPosition();
+  fTargetExits->AddExit(track->GetTrackID(), track->GetDefinition()->GetPDGEncoding(), survivor,
+                        post->GetKineticEnergy(), post->GetMomentumDirection().z(),
+                        TargetExitTable::SurfaceCoordinate(local, fDet->GetTargetRadius(),
+                                                           fDet->GetTargetLength()));
 }
 
 //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
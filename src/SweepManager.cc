@@ -0,0 +1,192 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+//
+/// \file B4/B4a/src/SweepManager.cc
+/// \brief Implementation of the B4::SweepManager class
+
+#include "SweepManager.hh"
+#include "SweepMessenger.hh"
+#include "DetectorConstruction.hh"
+#include "RunAction.hh"
+#include "BeamSource.hh"
+
+#include "G4RunManager.hh"
+#include "G4UImanager.hh"
+#include "G4UIcommand.hh"
+#include "G4SystemOfUnits.hh"
+#include "G4Timer.hh"
+#include "G4Exception.hh"
+#include "G4ios.hh"
+
+#include <algorithm>
+#include <iomanip>
+#include <sstream>
+
+namespace B4
+{
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+SweepManager::SweepManager(DetectorConstruction* det)
+  : fDet(det)
+{
+  fMessenger = new SweepMessenger(this);
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+SweepManager::~SweepManager()
+{
+  delete fMessenger;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void SweepManager::Clear()
+{
+  fParticles.clear();
+  fEnergies.clear();
+  fMaterials.clear();
+  fLengths.clear();
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+std::size_t SweepManager::GetNumberOfPoints() const
+{
+  // 材料、长度列表为空时沿用当前几何
+  return fParticles.size() * fEnergies.size()
+       * std::max<std::size_t>(fMaterials.size(), 1)
+       * std::max<std::size_t>(fLengths.size(), 1);
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+G4String SweepManager::PointFileName(const G4String& particle, G4double energy,
+                                     const G4String& material, G4double length) const
+{
+  // 格式：sweep_类型_能量MeV_材料_厚度cm.root (同一次扫描内唯一，不需要时间戳)。
+  // 能量和厚度按最短的精确形式写出：整数不带小数点，0.5 cm 与 1 cm 不会重名
+  std::ostringstream oss;
+  oss << std::defaultfloat << std::setprecision(12)
+      << "sweep_" << particle << "_"
+      << energy/MeV << "MeV_"
+      << material << "_"
+      << (length/cm) << "cm.root";
+  return oss.str();
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void SweepManager::Run()
+{
+  if (fParticles.empty() || fEnergies.empty()) {
+    G4ExceptionDescription msg;
+    msg << "No sweep particles or energies defined." << G4endl
+        << "Use /sweep/particles and /sweep/energies before /sweep/run.";
+    G4Exception("SweepManager::Run()", "MyCode0003", JustWarning, msg);
+    return;
+  }
+
+  auto* runManager = G4RunManager::GetRunManager();
+  auto* uiManager = G4UImanager::GetUIpointer();
+
+  // 混合束流逐个抽样初级粒子种类，扫描的 /gun/particle 不起作用，
+  // 输出和快速模拟表会按错误的粒子命名
+  const auto* runAction = dynamic_cast<const RunAction*>(runManager->GetUserRunAction());
+  const auto* beam = runAction ? runAction->GetBeamSource() : nullptr;
+  if (beam && !beam->GetSpecies().empty()) {
+    G4ExceptionDescription msg;
+    msg << "The sweep particles would be ignored while /beam/species is set." << G4endl
+        << "Use /beam/species (no argument) before /sweep/run.";
+    G4Exception("SweepManager::Run()", "MyCode0020", JustWarning, msg);
+    return;
+  }
+
+  std::vector<G4String> materials = fMaterials;
+  if (materials.empty()) materials.push_back(fDet->GetTargetMaterialName());
+  std::vector<G4double> lengths = fLengths;
+  if (lengths.empty()) lengths.push_back(fDet->GetTargetLength());
+
+  if (!fDirectory.empty()) {
+    uiManager->ApplyCommand("/run/output/directory " + fDirectory);
+  }
+
+  G4Timer sweepTimer;
+  sweepTimer.Start();
+  std::size_t nofPoints = GetNumberOfPoints();
+  std::size_t point = 0;
+
+  // 几何在外层循环：材料或长度变化时原地更新靶 (换材料、改尺寸)，
+  // 内层只改变粒子枪，物理表和可视化都只初始化一次
+  for (const auto& material : materials) {
+    for (auto length : lengths) {
+      if (material != fDet->GetTargetMaterialName() || length != fDet->GetTargetLength()) {
+        fDet->SetTargetMaterial(material);
+        fDet->SetTargetLength(length);
+      }
+      // 文件名按请求的材料命名：若几何没有真正用上该材料 (未知材料名或
+      // 重建时被默认值覆盖)，跳过这一几何点，不写出标错的数据
+      if (fDet->GetTargetMaterialName() != material) {
+        G4ExceptionDescription msg;
+        msg << "Sweep material " << material << " was not applied, the target is "
+            << fDet->GetTargetMaterialName() << "." << G4endl
+            << "Skipping " << fParticles.size() * fEnergies.size() << " points.";
+        G4Exception("SweepManager::Run()", "MyCode0021", JustWarning, msg);
+        point += fParticles.size() * fEnergies.size();
+        continue;
+      }
+
+      for (const auto& particle : fParticles) {
+        for (auto energy : fEnergies) {
+          ++point;
+          G4cout << "===== Sweep point " << point << "/" << nofPoints << " : "
+                 << particle << " " << G4UIcommand::ConvertToString(energy, "MeV")
+                 << " | " << material << " " << G4UIcommand::ConvertToString(length, "cm")
+                 << G4endl;
+
+          // UI 命令会同时广播到 worker 线程的粒子枪和 RunAction
+          uiManager->ApplyCommand("/gun/particle " + particle);
+          uiManager->ApplyCommand("/gun/energy " + G4UIcommand::ConvertToString(energy, "MeV"));
+          uiManager->ApplyCommand("/run/output/fileName "
+                                  + PointFileName(particle, energy, material, length));
+          runManager->BeamOn(fNofEvents);
+        }
+      }
+    }
+  }
+
+  // 恢复默认的时间戳文件名
+  uiManager->ApplyCommand("/run/output/fileName");
+
+  sweepTimer.Stop();
+  G4cout << "===== Sweep finished: " << point << " points in "
+         << sweepTimer.GetRealElapsed() << " s" << G4endl;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+}  // namespace B4
@@ -0,0 +1,133 @@
+#include "SweepMessenger.hh"
+#include "SweepManager.hh"
+
+#include "G4UIdirectory.hh"
+#include "G4UIcommand.hh"
+#include "G4UIcmdWithAString.hh"
+#include "G4UIcmdWithAnInteger.hh"
+#include "G4UIcmdWithoutParameter.hh"
+
+#include <sstream>
+#include <vector>
+
+namespace
+{
+// "a b c" -> {a, b, c}
+std::vector<G4String> SplitWords(const G4String& val)
+{
+  std::vector<G4String> words;
+  std::istringstream is(val);
+  G4String word;
+  while (is >> word) words.push_back(word);
+  return words;
+}
+
+// "1 1.5 2 GeV" -> {1 GeV, 1.5 GeV, 2 GeV}; the last word is the unit
+std::vector<G4double> ParseValuesWithUnit(const G4String& val)
+{
+  std::vector<G4double> values;
+  auto words = SplitWords(val);
+  if (words.size() < 2) return values;
+  G4double unit = G4UIcommand::ValueOf(words.back());
+  words.pop_back();
+  for (const auto& word : words) {
+    values.push_back(G4UIcommand::ConvertToDouble(word) * unit);
+  }
+  return values;
+}
+}  // namespace
+
+namespace B4 {
+
+SweepMessenger::SweepMessenger(SweepManager* sweep)
+ : fSweep(sweep)
+{
+  fSweepDir = new G4UIdirectory("/sweep/");
+  fSweepDir->SetGuidance("In-process parameter sweep (one run manager for all points)");
+
+  fParticlesCmd = new G4UIcmdWithAString("/sweep/particles", this);
+  fParticlesCmd->SetGuidance("Set the list of primary particles, e.g. pi+ pi- mu+ mu-");
+  fParticlesCmd->SetGuidance("(the sweep refuses to run while /beam/species is set)");
+  fParticlesCmd->SetParameterName("particles", false);
+  fParticlesCmd->AvailableForStates(G4State_PreInit, G4State_Idle);
+
+  fEnergiesCmd = new G4UIcmdWithAString("/sweep/energies", this);
+  fEnergiesCmd->SetGuidance("Set the list of primary energies followed by the unit,");
+  fEnergiesCmd->SetGuidance("e.g. 1 1.5 2 3 GeV");
+  fEnergiesCmd->SetParameterName("energies", false);
+  fEnergiesCmd->AvailableForStates(G4State_PreInit, G4State_Idle);
+
+  fMaterialsCmd = new G4UIcmdWithAString("/sweep/materials", this);
+  fMaterialsCmd->SetGuidance("Set the list of target materials (NIST names)");
+  fMaterialsCmd->SetParameterName("materials", false);
+  fMaterialsCmd->AvailableForStates(G4State_PreInit, G4State_Idle);
+
+  fLengthsCmd = new G4UIcmdWithAString("/sweep/lengths", this);
+  fLengthsCmd->SetGuidance("Set the list of target lengths followed by the unit,");
+  fLengthsCmd->SetGuidance("e.g. 50 60 70 cm");
+  fLengthsCmd->SetParameterName("lengths", false);
+  fLengthsCmd->AvailableForStates(G4State_PreInit, G4State_Idle);
+
+  fEventsCmd = new G4UIcmdWithAnInteger("/sweep/events", this);
+  fEventsCmd->SetGuidance("Set the number of events per sweep point");
+  fEventsCmd->SetParameterName("n", false);
+  fEventsCmd->SetRange("n>0");
+  fEventsCmd->AvailableForStates(G4State_PreInit, G4State_Idle);
+
+  fDirectoryCmd = new G4UIcmdWithAString("/sweep/directory", this);
+  fDirectoryCmd->SetGuidance("Set the output directory of the sweep points");
+  fDirectoryCmd->SetParameterName("dir", true);
+  fDirectoryCmd->SetDefaultValue("");
+  fDirectoryCmd->AvailableForStates(G4State_PreInit, G4State_Idle);
+
+  fClearCmd = new G4UIcmdWithoutParameter("/sweep/clear", this);
+  fClearCmd->SetGuidance("Clear all sweep lists");
+  fClearCmd->AvailableForStates(G4State_PreInit, G4State_Idle);
+
+  fRunCmd = new G4UIcmdWithoutParameter("/sweep/run", this);
+  fRunCmd->SetGuidance("Run all sweep points; empty lists keep the current setting");
+  fRunCmd->AvailableForStates(G4State_Idle);
+}
+
+SweepMessenger::~SweepMessenger()
+{
+  delete fParticlesCmd;
+  delete fEnergiesCmd;
+  delete fMaterialsCmd;
+  delete fLengthsCmd;
+  delete fEventsCmd;
+  delete fDirectoryCmd;
+  delete fClearCmd;
+  delete fRunCmd;
+  delete fSweepDir;
+}
+
+void SweepMessenger::SetNewValue(G4UIcommand* cmd, G4String val)
+{
+  if (cmd == fParticlesCmd) {
+    fSweep->SetParticles(SplitWords(val));
+  }
+  else if (cmd == fEnergiesCmd) {
+    fSweep->SetEnergies(ParseValuesWithUnit(val));
+  }
+  else if (cmd == fMaterialsCmd) {
+    fSweep->SetMaterials(SplitWords(val));
+  }
+  else if (cmd == fLengthsCmd) {
+    fSweep->SetLengths(ParseValuesWithUnit(val));
+  }
+  else if (cmd == fEventsCmd) {
+    fSweep->SetNumberOfEvents(fEventsCmd->GetNewIntValue(val));
+  }
+  else if (cmd == fDirectoryCmd) {
+    fSweep->SetDirectory(val);
+  }
+  else if (cmd == fClearCmd) {
+    fSweep->Clear();
+  }
+  else if (cmd == fRunCmd) {
+    fSweep->Run();
+  }
+}
+
+}  // namespace B4
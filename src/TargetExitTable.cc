@@ -0,0 +1,377 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+//
+/// \file B4/B4a/src/TargetExitTable.cc
+/// \brief Implementation of the B4::TargetExitTable class
+
+#include "TargetExitTable.hh"
+
+#include "G4PhysicalConstants.hh"
+#include "G4SystemOfUnits.hh"
+#include "Randomize.hh"
+
+#include <algorithm>
+#include <cmath>
+#include <iomanip>
+#include <map>
+#include <numeric>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+
+namespace
+{
+constexpr G4double kSurfaceOffset = 1. * um;  // 抽样的粒子放在靶表面外侧
+
+G4int Clamp(G4int i, G4int n) { return std::min(std::max(i, 0), n - 1); }
+
+G4double Below1(G4double x) { return std::min(std::max(x, 0.), 1. - 1e-9); }
+
+// 按累积分布抽一个 bin，分布为空时返回 -1
+G4int SampleBin(const std::vector<G4double>& cdf)
+{
+  if (cdf.empty() || cdf.back() <= 0.) return -1;
+  G4double x = G4UniformRand() * cdf.back();
+  auto it = std::upper_bound(cdf.begin(), cdf.end(), x);
+  return Clamp(static_cast<G4int>(it - cdf.begin()), static_cast<G4int>(cdf.size()));
+}
+
+std::vector<G4double> Cumulative(const G4double* begin, const G4double* end)
+{
+  std::vector<G4double> cdf(end - begin);
+  std::partial_sum(begin, end, cdf.begin());
+  return cdf;
+}
+
+template <typename Container>
+void ReadValues(const std::string& text, Container& values)
+{
+  std::istringstream is(text);
+  for (auto& v : values) is >> v;
+}
+}  // namespace
+
+namespace B4
+{
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+std::size_t TargetExitTable::Find(G4int pdg, G4bool survivor)
+{
+  for (std::size_t i = 0; i < fSpecies.size(); ++i) {
+    if (fSpecies[i].pdg == pdg && fSpecies[i].survivor == survivor) return i;
+  }
+  auto& species = fSpecies.emplace_back();
+  species.pdg = pdg;
+  species.survivor = survivor;
+  return fSpecies.size() - 1;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void TargetExitTable::BeginPrimary()
+{
+  std::fill(fCounts.begin(), fCounts.end(), 0);
+  fExited.clear();
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void TargetExitTable::AddExit(G4int trackID, G4int pdg, G4bool survivor, G4double energy,
+                              G4double cosTheta, G4double surface)
+{
+  // 每条径迹只记第一次穿出 (从探测器散射回来再穿过靶的不重复计)
+  if (energy <= 0. || !fExited.insert(trackID).second) return;
+
+  std::size_t index = Find(pdg, survivor);
+  if (fCounts.size() < fSpecies.size()) fCounts.resize(fSpecies.size(), 0);
+  ++fCounts[index];
+
+  constexpr G4double energyScale = kEnergyBins / (kLogEMax - kLogEMin);
+  G4int ie = Clamp(static_cast<G4int>(std::floor((std::log10(energy / MeV) - kLogEMin)
+                                                 * energyScale)), kEnergyBins);
+  G4int ic = Clamp(static_cast<G4int>(std::floor((cosTheta + 1.) / 2. * kCosBins)), kCosBins);
+  G4int iu = Clamp(static_cast<G4int>(std::floor(surface / 3. * kPositionBins)), kPositionBins);
+
+  auto& species = fSpecies[index];
+  species.energyAngle[ie * kCosBins + ic] += 1.;
+  species.position[iu] += 1.;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void TargetExitTable::EndPrimary()
+{
+  fPrimaries += 1.;
+  for (std::size_t i = 0; i < fCounts.size(); ++i) {
+    if (fCounts[i] > 0) fSpecies[i].multiplicity[std::min(fCounts[i], kMaxMultiplicity)] += 1.;
+    fCounts[i] = 0;
+  }
+  fExited.clear();
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void TargetExitTable::Merge(const G4VAccumulable& other)
+{
+  const auto& table = static_cast<const TargetExitTable&>(other);
+  fPrimaries += table.fPrimaries;
+  for (const auto& species : table.fSpecies) {
+    auto& mine = fSpecies[Find(species.pdg, species.survivor)];
+    for (std::size_t i = 0; i < mine.multiplicity.size(); ++i) {
+      mine.multiplicity[i] += species.multiplicity[i];
+    }
+    for (std::size_t i = 0; i < mine.energyAngle.size(); ++i) {
+      mine.energyAngle[i] += species.energyAngle[i];
+    }
+    for (std::size_t i = 0; i < mine.position.size(); ++i) {
+      mine.position[i] += species.position[i];
+    }
+  }
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void TargetExitTable::Reset()
+{
+  fPrimaries = 0.;
+  fSpecies.clear();
+  fCounts.clear();
+  fExited.clear();
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void TargetExitTable::SetKey(const G4String& particle, G4double energy,
+                             const G4String& material, G4double length)
+{
+  fParticle = particle;
+  fEnergy = energy;
+  fMaterial = material;
+  fLength = length;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+G4double TargetExitTable::GetMeanMultiplicity() const
+{
+  if (fPrimaries <= 0.) return 0.;
+  G4double sum = 0.;
+  for (const auto& species : fSpecies) {
+    for (G4int n = 1; n <= kMaxMultiplicity; ++n) sum += n * species.multiplicity[n];
+  }
+  return sum / fPrimaries;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+G4String TargetExitTable::FileName() const
+{
+  std::ostringstream os;
+  os << fParticle << "_" << fEnergy / MeV << "MeV_" << fMaterial << "_" << fLength / mm
+     << "mm.fastsim";
+  return os.str();
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void TargetExitTable::Write(std::ostream& os) const
+{
+  os << std::setprecision(17)
+     << "format = B4FASTSIM\n"
+     << "particle = " << fParticle << "\n"
+     << "energy_MeV = " << fEnergy / MeV << "\n"
+     << "material = " << fMaterial << "\n"
+     << "length_mm = " << fLength / mm << "\n"
+     << "primaries = " << fPrimaries << "\n"
+     << "binning = " << kMaxMultiplicity << " " << kEnergyBins << " " << kLogEMin << " "
+     << kLogEMax << " " << kCosBins << " " << kPositionBins << "\n"
+     << "species = " << fSpecies.size() << "\n";
+  for (std::size_t i = 0; i < fSpecies.size(); ++i) {
+    const auto& species = fSpecies[i];
+    G4String prefix = "species." + std::to_string(i) + ".";
+    os << prefix << "pdg = " << species.pdg << "\n"
+       << prefix << "survivor = " << (species.survivor ? 1 : 0) << "\n"
+       << prefix << "multiplicity =";
+    for (G4double v : species.multiplicity) os << " " << v;
+    os << "\n" << prefix << "position =";
+    for (G4double v : species.position) os << " " << v;
+    // 能量-角度直方图大多是空的，只写非零的 bin
+    os << "\n" << prefix << "energy_angle =";
+    for (std::size_t bin = 0; bin < species.energyAngle.size(); ++bin) {
+      if (species.energyAngle[bin] != 0.) os << " " << bin << ":" << species.energyAngle[bin];
+    }
+    os << "\n";
+  }
+  os << std::setprecision(6);
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+G4bool TargetExitTable::Read(std::istream& is)
+{
+  std::map<std::string, std::string> values;
+  std::string line;
+  while (std::getline(is, line)) {
+    auto pos = line.find(" = ");
+    if (pos == std::string::npos) continue;
+    values[line.substr(0, pos)] = line.substr(pos + 3);
+  }
+
+  // 缺少的键或不是数字的值 (截断、手工修改的文件)：整个表无效
+  auto value = [&values](const std::string& key) -> const std::string& {
+    auto it = values.find(key);
+    if (it == values.end()) throw std::runtime_error("missing key " + key);
+    return it->second;
+  };
+
+  std::ostringstream binning;
+  binning << std::setprecision(17) << kMaxMultiplicity << " " << kEnergyBins << " " << kLogEMin
+          << " " << kLogEMax << " " << kCosBins << " " << kPositionBins;
+
+  Reset();
+  try {
+    if (value("format") != "B4FASTSIM" || value("binning") != binning.str()) return false;
+    fParticle = value("particle");
+    fEnergy = std::stod(value("energy_MeV")) * MeV;
+    fMaterial = value("material");
+    fLength = std::stod(value("length_mm")) * mm;
+    fPrimaries = std::stod(value("primaries"));
+
+    G4int nofSpecies = std::stoi(value("species"));
+    for (G4int i = 0; i < nofSpecies; ++i) {
+      std::string prefix = "species." + std::to_string(i) + ".";
+      auto& species = fSpecies.emplace_back();
+      species.pdg = std::stoi(value(prefix + "pdg"));
+      species.survivor = value(prefix + "survivor") == "1";
+      ReadValues(value(prefix + "multiplicity"), species.multiplicity);
+      ReadValues(value(prefix + "position"), species.position);
+      std::istringstream bins(value(prefix + "energy_angle"));
+      std::string item;
+      while (bins >> item) {
+        auto colon = item.find(':');
+        if (colon == std::string::npos) throw std::runtime_error("bad bin " + item);
+        std::size_t bin = std::stoul(item.substr(0, colon));
+        if (bin >= species.energyAngle.size()) throw std::runtime_error("bad bin " + item);
+        species.energyAngle[bin] = std::stod(item.substr(colon + 1));
+      }
+    }
+  }
+  catch (const std::exception&) {
+    Reset();
+    return false;
+  }
+  return fPrimaries > 0.;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void TargetExitTable::Prepare()
+{
+  for (auto& species : fSpecies) {
+    // n = 0：没有这种粒子穿出的初级粒子
+    auto& m = species.multiplicity;
+    m[0] = std::max(fPrimaries - std::accumulate(m.begin() + 1, m.end(), 0.), 0.);
+    species.multiplicityCdf = Cumulative(m.data(), m.data() + m.size());
+    species.energyAngleCdf = Cumulative(species.energyAngle.data(),
+                                        species.energyAngle.data() + species.energyAngle.size());
+    species.positionCdf = Cumulative(species.position.data(),
+                                     species.position.data() + species.position.size());
+  }
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void TargetExitTable::Sample(G4double radius, G4double length, const G4ThreeVector& center,
+                             std::vector<TargetExit>& exits) const
+{
+  exits.clear();
+  constexpr G4double logEWidth = (kLogEMax - kLogEMin) / kEnergyBins;
+  for (const auto& species : fSpecies) {
+    G4int n = SampleBin(species.multiplicityCdf);
+    for (G4int k = 0; k < n; ++k) {
+      G4int bin = SampleBin(species.energyAngleCdf);
+      G4int iu = SampleBin(species.positionCdf);
+      if (bin < 0 || iu < 0) break;
+
+      TargetExit exit;
+      exit.pdg = species.pdg;
+      exit.survivor = species.survivor;
+      G4double logE = kLogEMin + (bin / kCosBins + G4UniformRand()) * logEWidth;
+      exit.energy = std::pow(10., logE) * MeV;
+      G4double cosTheta = -1. + (bin % kCosBins + G4UniformRand()) * 2. / kCosBins;
+      G4double sinTheta = std::sqrt(std::max(1. - cosTheta * cosTheta, 0.));
+      G4double phi = twopi * G4UniformRand();
+      exit.direction.set(sinTheta * std::cos(phi), sinTheta * std::sin(phi), cosTheta);
+
+      // 出射点与方向分开抽样：端面与方向不一致时换到另一个端面，
+      // 侧面上的横向方向翻转为朝外
+      G4double u = (iu + G4UniformRand()) * 3. / kPositionBins;
+      if (u < 1. && cosTheta > 0.) u += 2.;
+      else if (u >= 2. && cosTheta < 0.) u -= 2.;
+
+      G4double phiPos = twopi * G4UniformRand();
+      G4ThreeVector radial(std::cos(phiPos), std::sin(phiPos), 0.);
+      G4ThreeVector local, normal;
+      if (u < 1.) {
+        local = u * radius * radial + G4ThreeVector(0., 0., -length / 2);
+        normal.set(0., 0., -1.);
+      }
+      else if (u < 2.) {
+        local = radius * radial + G4ThreeVector(0., 0., -length / 2 + (u - 1.) * length);
+        normal = radial;
+        if (exit.direction.x() * normal.x() + exit.direction.y() * normal.y() < 0.) {
+          exit.direction.setX(-exit.direction.x());
+          exit.direction.setY(-exit.direction.y());
+        }
+      }
+      else {
+        local = (u - 2.) * radius * radial + G4ThreeVector(0., 0., length / 2);
+        normal.set(0., 0., 1.);
+      }
+      exit.position = center + local + kSurfaceOffset * normal;
+      exits.push_back(exit);
+    }
+  }
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+G4double TargetExitTable::SurfaceCoordinate(const G4ThreeVector& local, G4double radius,
+                                            G4double length)
+{
+  G4double r = local.perp();
+  G4double dUp = std::abs(local.z() + length / 2);
+  G4double dDown = std::abs(local.z() - length / 2);
+  G4double dSide = std::abs(radius - r);
+  if (dSide <= dUp && dSide <= dDown) return 1. + Below1((local.z() + length / 2) / length);
+  if (dUp < dDown) return Below1(r / radius);
+  return 2. + Below1(r / radius);
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+}  // namespace B4
@@ -0,0 +1,115 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+//
+/// \file B4/B4a/src/TargetFastModel.cc
+/// \brief Implementation of the B4::TargetFastModel class
+
+#include "TargetFastModel.hh"
+#include "DetectorConstruction.hh"
+#include "FastTarget.hh"
+
+#include "G4DynamicParticle.hh"
+#include "G4FastStep.hh"
+#include "G4FastTrack.hh"
+#include "G4IonTable.hh"
+#include "G4ParticleTable.hh"
+#include "G4Track.hh"
+
+#include <algorithm>
+
+namespace B4
+{
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+TargetFastModel::TargetFastModel(const G4String& name, G4Region* envelope,
+                                 const FastTarget* fastTarget, const DetectorConstruction* det)
+  : G4VFastSimulationModel(name, envelope),
+    fFastTarget(fastTarget),
+    fDet(det)
+{}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+G4bool TargetFastModel::ModelTrigger(const G4FastTrack& fastTrack)
+{
+  // 只替换初级粒子：次级粒子 (包括本模型产生的) 正常输运
+  const G4Track* track = fastTrack.GetPrimaryTrack();
+  if (!fFastTarget->IsEnabled() || track->GetParentID() != 0) return false;
+
+  fTable = fFastTarget->Find(track->GetDefinition()->GetParticleName(),
+                             track->GetKineticEnergy());
+  return fTable != nullptr;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void TargetFastModel::DoIt(const G4FastTrack& fastTrack, G4FastStep& fastStep)
+{
+  const G4Track* track = fastTrack.GetPrimaryTrack();
+  fTable->Sample(fDet->GetTargetRadius(), fDet->GetTargetLength(), fDet->GetTargetPosition(),
+                 fExits);
+
+  const TargetExit* survivor = nullptr;
+  G4int nofSecondaries = 0;
+  for (const auto& exit : fExits) {
+    if (exit.survivor && !survivor) survivor = &exit;
+    else ++nofSecondaries;
+  }
+
+  // 穿出的粒子放在靶表面外侧，从那里开始正常输运
+  auto* particleTable = G4ParticleTable::GetParticleTable();
+  G4double carried = 0.;
+  fastStep.SetNumberOfSecondaryTracks(nofSecondaries);
+  for (const auto& exit : fExits) {
+    if (&exit == survivor) continue;
+    G4ParticleDefinition* definition = particleTable->FindParticle(exit.pdg);
+    if (!definition && exit.pdg > 1000000000) {
+      definition = G4IonTable::GetIonTable()->GetIon(exit.pdg);
+    }
+    if (!definition) continue;  // 能量计入靶中的沉积
+    G4DynamicParticle particle(definition, exit.direction, exit.energy);
+    G4Track* secondary =
+      fastStep.CreateSecondaryTrack(particle, exit.position, track->GetGlobalTime(), false);
+    if (secondary) secondary->SetWeight(track->GetWeight());
+    carried += exit.energy;
+  }
+
+  if (survivor) {
+    fastStep.ProposePrimaryTrackFinalPosition(survivor->position, false);
+    fastStep.ProposePrimaryTrackFinalMomentumDirection(survivor->direction, false);
+    fastStep.ProposePrimaryTrackFinalKineticEnergy(survivor->energy);
+    carried += survivor->energy;
+  }
+  else {
+    fastStep.KillPrimaryTrack();
+  }
+  fastStep.ProposeTotalEnergyDeposited(std::max(track->GetKineticEnergy() - carried, 0.));
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+}  // namespace B4
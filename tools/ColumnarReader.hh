@@ -0,0 +1,192 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+//
+/// \file B4/B4a/tools/ColumnarReader.hh
+/// \brief Memory-mapped reader of the B4 columnar output
+///
+/// Header-only and Geant4-free. A MappedColumn maps one segment file and
+/// exposes its values in place (no copy, no deserialisation); a
+/// ColumnarDataset lists the segments of every column in a ".cols"
+/// directory written with /run/output/format columnar.
+///
+///   B4::Columnar::ColumnarDataset data("pi+_2000MeV_G4_Pb_4cm_50cm_xxx.cols");
+///   for (const auto& seg : data.Segments("pE")) {
+///     const double* E = seg.Data<double>();
+///     for (std::size_t i = 0; i < seg.Size(); ++i) sum += E[i];
+///   }
+
+#ifndef B4ColumnarReader_h
+#define B4ColumnarReader_h 1
+
+#include "ColumnarFormat.hh"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cstddef>
+#include <filesystem>
+#include <fstream>
+#include <map>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace B4
+{
+namespace Columnar
+{
+
+class MappedColumn
+{
+  public:
+    explicit MappedColumn(const std::string& path)
+    {
+      int fd = ::open(path.c_str(), O_RDONLY);
+      if (fd < 0) throw std::runtime_error("cannot open " + path);
+      struct stat st;
+      if (::fstat(fd, &st) != 0 || (std::size_t)st.st_size < sizeof(FileHeader)) {
+        ::close(fd);
+        throw std::runtime_error("not a columnar segment: " + path);
+      }
+      fLength = st.st_size;
+      void* addr = ::mmap(nullptr, fLength, PROT_READ, MAP_SHARED, fd, 0);
+      ::close(fd);
+      if (addr == MAP_FAILED) throw std::runtime_error("cannot map " + path);
+      fBase = static_cast<const char*>(addr);
+      ::madvise(addr, fLength, MADV_SEQUENTIAL);
+
+      const auto* header = reinterpret_cast<const FileHeader*>(fBase);
+      if (!IsValid(*header)) {
+        Unmap();
+        throw std::runtime_error("bad columnar header: " + path);
+      }
+      // 未正常关闭的 segment (行数未回写) 按文件长度推断
+      std::size_t available = (fLength - sizeof(FileHeader)) / header->elemSize;
+      fSize = header->nrows ? std::min<std::size_t>(header->nrows, available) : available;
+    }
+
+    ~MappedColumn() { Unmap(); }
+
+    MappedColumn(const MappedColumn&) = delete;
+    MappedColumn& operator=(const MappedColumn&) = delete;
+    MappedColumn(MappedColumn&& other) noexcept
+      : fBase(other.fBase), fLength(other.fLength), fSize(other.fSize)
+    {
+      other.fBase = nullptr;
+    }
+
+    const FileHeader& Header() const { return *reinterpret_cast<const FileHeader*>(fBase); }
+    std::string Name() const { return Header().column; }
+    DType Type() const { return static_cast<DType>(Header().dtype); }
+    std::size_t Size() const { return fSize; }
+
+    template <typename T>
+    const T* Data() const
+    {
+      if (sizeof(T) != Header().elemSize) throw std::runtime_error("column type mismatch");
+      return reinterpret_cast<const T*>(fBase + sizeof(FileHeader));
+    }
+
+  private:
+    void Unmap()
+    {
+      if (fBase) ::munmap(const_cast<char*>(fBase), fLength);
+      fBase = nullptr;
+    }
+
+    const char* fBase = nullptr;
+    std::size_t fLength = 0;
+    std::size_t fSize = 0;
+};
+
+class ColumnarDataset
+{
+  public:
+    explicit ColumnarDataset(const std::string& directory)
+      : fDirectory(directory)
+    {
+      namespace fs = std::filesystem;
+      if (!fs::is_directory(directory)) throw std::runtime_error("no such dataset: " + directory);
+      for (const auto& item : fs::directory_iterator(directory)) {
+        if (item.path().extension() != ".col") continue;
+        // <column>.<segment>.col
+        std::string stem = item.path().stem().string();
+        auto dot = stem.rfind('.');
+        if (dot == std::string::npos) continue;
+        fFiles[stem.substr(0, dot)].push_back(item.path().string());
+      }
+      for (auto& column : fFiles) std::sort(column.second.begin(), column.second.end());
+    }
+
+    std::vector<std::string> Columns() const
+    {
+      std::vector<std::string> names;
+      for (const auto& column : fFiles) names.push_back(column.first);
+      return names;
+    }
+
+    // 所有 segment 按文件名排序，各列的 segment 顺序一致
+    std::vector<MappedColumn> Segments(const std::string& column) const
+    {
+      std::vector<MappedColumn> segments;
+      auto it = fFiles.find(column);
+      if (it == fFiles.end()) throw std::runtime_error("no column " + column);
+      for (const auto& path : it->second) segments.emplace_back(path);
+      return segments;
+    }
+
+    std::size_t NumberOfRows(const std::string& column) const
+    {
+      std::size_t n = 0;
+      for (const auto& segment : Segments(column)) n += segment.Size();
+      return n;
+    }
+
+    // run.info 中的 key = value
+    std::map<std::string, std::string> RunInfo() const
+    {
+      std::map<std::string, std::string> info;
+      std::ifstream in(fDirectory + "/" + kRunInfoFile);
+      std::string line;
+      while (std::getline(in, line)) {
+        auto eq = line.find(" = ");
+        if (eq != std::string::npos) info[line.substr(0, eq)] = line.substr(eq + 3);
+      }
+      return info;
+    }
+
+  private:
+    std::string fDirectory;
+    std::map<std::string, std::vector<std::string>> fFiles;
+};
+
+}  // namespace Columnar
+}  // namespace B4
+
+#endif
@@ -0,0 +1,98 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+//
+/// \file B4/B4a/tools/b4beamconv.cc
+/// \brief Convert a text beam description into a B4 beam file
+///
+/// Input: one primary per line, "x y z dx dy dz E [t]" with positions in
+/// mm relative to the source plane centre, a direction (not necessarily
+/// normalised), the kinetic energy in MeV and an optional time in ns.
+/// Empty lines and lines starting with '#' are skipped.
+/// The output is read with /beam/file (see BeamFileFormat.hh).
+///
+/// usage: b4beamconv <input.txt> <output.beam>
+
+#include "BeamFileFormat.hh"
+
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+int main(int argc, char** argv)
+{
+  if (argc != 3) {
+    std::cerr << "Usage: " << argv[0] << " <input.txt> <output.beam>" << std::endl;
+    return 1;
+  }
+
+  std::ifstream in(argv[1]);
+  if (!in) {
+    std::cerr << "Error: cannot open " << argv[1] << std::endl;
+    return 1;
+  }
+
+  std::vector<B4::BeamFormat::Record> records;
+  std::string line;
+  std::size_t lineNumber = 0;
+  while (std::getline(in, line)) {
+    ++lineNumber;
+    if (line.empty() || line[0] == '#') continue;
+    std::istringstream is(line);
+    B4::BeamFormat::Record record{};
+    if (!(is >> record.x >> record.y >> record.z >> record.dx >> record.dy >> record.dz
+             >> record.energy)) {
+      std::cerr << "Error: line " << lineNumber << " needs x y z dx dy dz E [t]" << std::endl;
+      return 1;
+    }
+    if (!(is >> record.time)) record.time = 0.;
+    if (record.dx == 0. && record.dy == 0. && record.dz == 0.) {
+      std::cerr << "Error: line " << lineNumber << " has a null direction" << std::endl;
+      return 1;
+    }
+    records.push_back(record);
+  }
+
+  auto header = B4::BeamFormat::MakeHeader(records.size());
+  std::FILE* out = std::fopen(argv[2], "wb");
+  if (!out) {
+    std::cerr << "Error: cannot create " << argv[2] << std::endl;
+    return 1;
+  }
+  bool ok = std::fwrite(&header, sizeof(header), 1, out) == 1
+         && std::fwrite(records.data(), sizeof(B4::BeamFormat::Record), records.size(), out)
+              == records.size();
+  ok = (std::fclose(out) == 0) && ok;
+  if (!ok) {
+    std::cerr << "Error: cannot write " << argv[2] << std::endl;
+    return 1;
+  }
+
+  std::cout << records.size() << " primaries written to " << argv[2] << std::endl;
+  return 0;
+}
@@ -0,0 +1,111 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+//
+/// \file B4/B4a/tools/b4col2root.cc
+/// \brief Converter of a B4 columnar dataset to the ROOT ntuple layout
+///
+/// Writes a TTree "tree" with the same branches as the ntuple booked in
+/// RunAction (PDG, px, py, pz, pE, theta, phi, weight, plane, primaryPDG,
+/// primaryE), so draw.cpp and the other ROOT tooling can be used on
+/// columnar output.
+///
+/// compile: built by CMake when ROOT is found, or
+///   g++ -o b4col2root b4col2root.cc -I../include $(root-config --libs --cflags)
+/// usage:   b4col2root <dataset.cols> <output.root>
+
+#include "ColumnarReader.hh"
+
+#include "TFile.h"
+#include "TTree.h"
+
+#include <cstdint>
+#include <iostream>
+#include <map>
+#include <string>
+#include <vector>
+
+int main(int argc, char** argv)
+{
+  if (argc != 3) {
+    std::cerr << "Usage: " << argv[0] << " <dataset.cols> <output.root>" << std::endl;
+    return 1;
+  }
+
+  try {
+    B4::Columnar::ColumnarDataset dataset(argv[1]);
+    auto names = dataset.Columns();
+
+    std::map<std::string, std::vector<B4::Columnar::MappedColumn>> columns;
+    for (const auto& name : names) columns.emplace(name, dataset.Segments(name));
+
+    TFile file(argv[2], "RECREATE");
+    if (file.IsZombie()) {
+      std::cerr << "Error: cannot create " << argv[2] << std::endl;
+      return 1;
+    }
+    TTree tree("tree", "TransmittedParticles");
+
+    // 每列一个 branch，类型与列类型一致
+    std::map<std::string, Int_t> intValues;
+    std::map<std::string, Double_t> doubleValues;
+    for (const auto& name : names) {
+      const auto& first = columns.at(name).front();
+      if (first.Type() == B4::Columnar::DType::Int32) {
+        tree.Branch(name.c_str(), &intValues[name], (name + "/I").c_str());
+      }
+      else {
+        tree.Branch(name.c_str(), &doubleValues[name], (name + "/D").c_str());
+      }
+    }
+
+    std::size_t nofSegments = columns.at(names.front()).size();
+    for (std::size_t s = 0; s < nofSegments; ++s) {
+      std::size_t rows = columns.at(names.front())[s].Size();
+      for (std::size_t i = 0; i < rows; ++i) {
+        for (const auto& name : names) {
+          const auto& segment = columns.at(name)[s];
+          if (segment.Type() == B4::Columnar::DType::Int32) {
+            intValues[name] = segment.Data<std::int32_t>()[i];
+          }
+          else {
+            doubleValues[name] = segment.Data<double>()[i];
+          }
+        }
+        tree.Fill();
+      }
+    }
+
+    tree.Write();
+    file.Close();
+    std::cout << "Converted " << dataset.NumberOfRows(names.front()) << " rows to "
+              << argv[2] << std::endl;
+  }
+  catch (const std::exception& e) {
+    std::cerr << "Error: " << e.what() << std::endl;
+    return 1;
+  }
+  return 0;
+}
@@ -0,0 +1,112 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+//
+/// \file B4/B4a/tools/b4colstat.cc
+/// \brief Column statistics of a B4 columnar dataset
+///
+/// Scans every column of a ".cols" directory in place through the mapped
+/// segments and prints rows, min, mean and max per column together with
+/// the scan rate.
+///
+/// usage: b4colstat <dataset.cols>
+
+#include "ColumnarReader.hh"
+
+#include <chrono>
+#include <cstdint>
+#include <iomanip>
+#include <iostream>
+#include <limits>
+
+namespace
+{
+template <typename T>
+void Scan(const T* data, std::size_t n, double& sum, double& min, double& max)
+{
+  for (std::size_t i = 0; i < n; ++i) {
+    double v = data[i];
+    sum += v;
+    min = std::min(min, v);
+    max = std::max(max, v);
+  }
+}
+}  // namespace
+
+int main(int argc, char** argv)
+{
+  if (argc != 2) {
+    std::cerr << "Usage: " << argv[0] << " <dataset.cols>" << std::endl;
+    return 1;
+  }
+
+  try {
+    B4::Columnar::ColumnarDataset dataset(argv[1]);
+    for (const auto& item : dataset.RunInfo()) {
+      std::cout << item.first << " = " << item.second << "\n";
+    }
+
+    std::cout << std::left << std::setw(10) << "column" << std::right
+              << std::setw(14) << "rows" << std::setw(16) << "min"
+              << std::setw(16) << "mean" << std::setw(16) << "max"
+              << std::setw(12) << "GB/s" << "\n";
+
+    for (const auto& name : dataset.Columns()) {
+      auto segments = dataset.Segments(name);
+      double sum = 0.;
+      double min = std::numeric_limits<double>::max();
+      double max = std::numeric_limits<double>::lowest();
+      std::size_t rows = 0;
+      std::size_t bytes = 0;
+
+      auto start = std::chrono::steady_clock::now();
+      for (const auto& segment : segments) {
+        if (segment.Type() == B4::Columnar::DType::Int32) {
+          Scan(segment.Data<std::int32_t>(), segment.Size(), sum, min, max);
+        }
+        else {
+          Scan(segment.Data<double>(), segment.Size(), sum, min, max);
+        }
+        rows += segment.Size();
+        bytes += segment.Size() * segment.Header().elemSize;
+      }
+      std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+
+      std::cout << std::left << std::setw(10) << name << std::right
+                << std::setw(14) << rows
+                << std::setw(16) << (rows ? min : 0.)
+                << std::setw(16) << (rows ? sum / rows : 0.)
+                << std::setw(16) << (rows ? max : 0.)
+                << std::setw(12) << std::setprecision(3)
+                << (elapsed.count() > 0. ? bytes / elapsed.count() / 1e9 : 0.)
+                << std::setprecision(6) << "\n";
+    }
+  }
+  catch (const std::exception& e) {
+    std::cerr << "Error: " << e.what() << std::endl;
+    return 1;
+  }
+  return 0;
+}
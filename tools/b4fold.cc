@@ -0,0 +1,369 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+//
+/// \file B4/B4a/tools/b4fold.cc
+/// \brief Folds beam spectra through a B4 transmission response matrix
+///
+/// The matrix (exampleB4a with /run/output/format response, see
+/// ResponseFormat.hh) holds, per primary species and primary energy bin,
+/// the mean detector entries per primary in (log10 E, theta) cells. A beam
+/// is given as one spectrum per primary species:
+///
+///   <particle>=<spectrum.txt>[*scale]   binned spectrum, same format as
+///                                       /beam/spectrumFile: lines "lower
+///                                       edge [MeV] weight", the last line
+///                                       gives the upper edge
+///   <particle>=@<E_MeV>[*scale]         monoenergetic, interpolated in
+///                                       log E between the bin centres
+///
+/// The particle is a Geant4 name (proton, neutron, e-, pi+, ...) or a PDG
+/// code. Spectrum weights are relative intensities (uniform in E inside a
+/// spectrum bin); all results are per primary of the combined beam. The
+/// response is the bin average for the logflat primaries of the matrix, so
+/// spectra varying strongly inside one primary bin need a finer grid.
+///
+/// Prints, per entry species, the entries per primary with their error,
+/// <E> and <theta>, the transmission and the beam fraction outside the
+/// grid. With -o the E and theta projections are written as a table.
+/// Several matrices with the same grid (e.g. one run per primary species)
+/// are combined before folding.
+///
+/// usage: b4fold <matrix.resp> ... <particle>=<spectrum> ... [-o projections.txt]
+
+#include "ResponseFormat.hh"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace
+{
+using B4::Response::Matrix;
+
+const std::map<std::string, int> kParticles = {
+  {"gamma", 22},        {"e-", 11},           {"e+", -11},          {"mu-", 13},
+  {"mu+", -13},         {"pi+", 211},         {"pi-", -211},        {"pi0", 111},
+  {"kaon+", 321},       {"kaon-", -321},      {"kaon0L", 130},      {"kaon0S", 310},
+  {"proton", 2212},     {"anti_proton", -2212}, {"neutron", 2112},  {"anti_neutron", -2112},
+  {"lambda", 3122},     {"nu_e", 12},         {"anti_nu_e", -12},   {"nu_mu", 14},
+  {"anti_nu_mu", -14},  {"deuteron", 1000010020}, {"triton", 1000010030},
+  {"He3", 1000020030},  {"alpha", 1000020040}};
+
+int ParticleCode(const std::string& name)
+{
+  auto it = kParticles.find(name);
+  if (it != kParticles.end()) return it->second;
+  std::size_t used = 0;
+  int pdg = 0;
+  try {
+    pdg = std::stoi(name, &used);
+  }
+  catch (const std::exception&) {
+    used = 0;
+  }
+  if (used != name.size() || name.empty()) throw std::runtime_error("unknown particle " + name);
+  return pdg;
+}
+
+std::string ParticleName(int pdg)
+{
+  for (const auto& [name, code] : kParticles) {
+    if (code == pdg) return name;
+  }
+  return std::to_string(pdg);
+}
+
+// 一个初级粒子种类的束流：每个初级能量区间的强度
+struct Beam
+{
+  int pdg = 0;
+  std::vector<double> phi;  // per primary bin
+  double total = 0.;        // 包括网格之外的部分
+};
+
+// 分段常数谱 (区间内按 E 均匀) 与对数网格的交叠
+void AddSpectrum(const Matrix& m, const std::string& path, double scale, Beam& beam)
+{
+  std::ifstream in(path);
+  if (!in) throw std::runtime_error("cannot read " + path);
+  std::vector<double> edges, weights;
+  std::string line;
+  while (std::getline(in, line)) {
+    if (line.empty() || line[0] == '#') continue;
+    std::istringstream is(line);
+    double edge = 0., weight = 0.;
+    if (!(is >> edge)) continue;
+    is >> weight;
+    edges.push_back(edge);
+    weights.push_back(std::max(weight, 0.));
+  }
+  if (edges.size() < 2 || !std::is_sorted(edges.begin(), edges.end())) {
+    throw std::runtime_error(path + ": expected lines \"lower edge [MeV] weight\" with increasing edges");
+  }
+  const std::size_t nbins = m.header.nPrimaryBins;
+  for (std::size_t k = 0; k + 1 < edges.size(); ++k) {
+    double lo = edges[k], hi = edges[k + 1];
+    double w = weights[k] * scale;
+    beam.total += w;
+    if (hi <= lo || w <= 0.) continue;
+    for (std::size_t i = 0; i < nbins; ++i) {
+      double a = std::max(lo, m.PrimaryEdge(i));
+      double b = std::min(hi, m.PrimaryEdge(i + 1));
+      if (b > a) beam.phi[i] += w * (b - a) / (hi - lo);
+    }
+  }
+}
+
+// 单能：在相邻两个区间的 (几何) 中心之间按 log E 线性插值
+void AddLine(const Matrix& m, double energy, double scale, Beam& beam)
+{
+  beam.total += scale;
+  const auto& h = m.header;
+  if (energy < h.primaryEmin || energy >= h.primaryEmax) return;
+  const int nbins = static_cast<int>(h.nPrimaryBins);
+  double x = nbins * std::log(energy / h.primaryEmin) / std::log(h.primaryEmax / h.primaryEmin)
+             - 0.5;
+  int lo = static_cast<int>(std::floor(x));
+  double f = x - lo;
+  if (lo < 0) {
+    beam.phi[0] += scale;
+  }
+  else if (lo >= nbins - 1) {
+    beam.phi[nbins - 1] += scale;
+  }
+  else {
+    beam.phi[lo] += scale * (1. - f);
+    beam.phi[lo + 1] += scale * f;
+  }
+}
+
+// 同一事件的入射相关，总数和投影的方差取矩阵中按事件求出的值，
+// 而不是单元方差之和；不同初级能量区间和种类的事件相互独立
+struct Folded
+{
+  std::vector<double> value;           // (E, theta) cells
+  double totalVariance = 0.;
+  std::vector<double> energyVariance;  // E projection
+  std::vector<double> thetaVariance;   // theta projection
+};
+
+}  // namespace
+
+int main(int argc, char** argv)
+{
+  std::string output;
+  std::vector<std::string> matrices, specs;
+  for (int i = 1; i < argc; ++i) {
+    std::string arg = argv[i];
+    if (arg == "-o" && i + 1 < argc) output = argv[++i];
+    else if (arg.find('=') != std::string::npos) specs.push_back(arg);
+    else matrices.push_back(arg);
+  }
+  if (matrices.empty() || specs.empty()) {
+    std::cerr << "Usage: " << argv[0]
+              << " <matrix.resp> ... <particle>=<spectrum.txt|@E_MeV>[*scale] ... [-o out.txt]"
+              << std::endl;
+    return 1;
+  }
+
+  try {
+    Matrix m;
+    for (std::size_t i = 0; i < matrices.size(); ++i) {
+      Matrix matrix;
+      if (!B4::Response::Read(matrices[i], matrix)) {
+        throw std::runtime_error("cannot read a response matrix from " + matrices[i]);
+      }
+      if (i == 0) m = std::move(matrix);
+      else if (!B4::Response::Merge(m, matrix)) {
+        throw std::runtime_error("response grids differ (" + matrices[i] + ")");
+      }
+    }
+    const auto& h = m.header;
+    const std::size_t nbins = h.nPrimaryBins;
+    const std::size_t cells = m.Cells();
+
+    // 1) 束流：每个初级粒子种类一个谱
+    auto start = std::chrono::steady_clock::now();
+    std::vector<Beam> beams;
+    for (const auto& spec : specs) {
+      auto eq = spec.find('=');
+      if (eq == std::string::npos) throw std::runtime_error("expected <particle>=<spectrum>: " + spec);
+      std::string source = spec.substr(eq + 1);
+      double scale = 1.;
+      auto star = source.rfind('*');
+      if (star != std::string::npos) {
+        scale = std::stod(source.substr(star + 1));
+        source.erase(star);
+      }
+      int pdg = ParticleCode(spec.substr(0, eq));
+      if (!m.FindPrimary(pdg)) {
+        throw std::runtime_error("the matrix has no primary " + spec.substr(0, eq));
+      }
+      auto it = std::find_if(beams.begin(), beams.end(), [pdg](const Beam& b) { return b.pdg == pdg; });
+      if (it == beams.end()) {
+        it = beams.insert(beams.end(), Beam{pdg, std::vector<double>(nbins, 0.), 0.});
+      }
+      if (!source.empty() && source[0] == '@') AddLine(m, std::stod(source.substr(1)), scale, *it);
+      else AddSpectrum(m, source, scale, *it);
+    }
+    double beamTotal = 0., inGrid = 0., unsimulated = 0.;
+    for (const auto& beam : beams) {
+      beamTotal += beam.total;
+      const auto* bins = m.FindPrimary(beam.pdg);
+      for (std::size_t i = 0; i < nbins; ++i) {
+        inGrid += beam.phi[i];
+        if (beam.phi[i] > 0. && bins[i].primaries <= 0.) unsimulated += beam.phi[i];
+      }
+    }
+    if (beamTotal <= 0.) throw std::runtime_error("the beam has no intensity");
+    double outside = beamTotal - inGrid;
+    if (outside < 1e-12 * beamTotal) outside = 0.;  // 舍入误差
+
+    // 2) 折叠：entries(E, theta) = sum_i phi_i / W * R_i(E, theta)
+    double transmission = 0., transmissionVariance = 0.;
+    for (const auto& beam : beams) {
+      const auto* bins = m.FindPrimary(beam.pdg);
+      for (std::size_t i = 0; i < nbins; ++i) {
+        double n = bins[i].primaries;
+        if (beam.phi[i] <= 0. || n <= 0.) continue;
+        double f = beam.phi[i] / beamTotal;
+        double t = bins[i].transmitted / n;
+        transmission += f * t;
+        transmissionVariance += f * f * std::max(bins[i].transmitted2 / n - t * t, 0.) / n;
+      }
+    }
+    std::map<int, Folded> folded;
+    for (std::size_t k = 0; k < m.blocks.size(); ++k) {
+      auto beam = std::find_if(beams.begin(), beams.end(), [&](const Beam& b) {
+        return b.pdg == m.blocks[k].primaryPdg;
+      });
+      if (beam == beams.end()) continue;
+      Folded& result = folded[m.blocks[k].entryPdg];
+      result.value.resize(cells, 0.);
+      result.energyVariance.resize(h.nEnergyBins, 0.);
+      result.thetaVariance.resize(h.nThetaBins, 0.);
+      for (std::size_t i = 0; i < nbins; ++i) {
+        if (beam->phi[i] <= 0.) continue;
+        double f = beam->phi[i] / beamTotal;
+        const double* mean = &m.mean[m.Offset(k, i)];
+        for (std::size_t j = 0; j < cells; ++j) result.value[j] += f * mean[j];
+        result.totalVariance += f * f * m.totalVariance[m.TotalOffset(k, i)];
+        const double* energyVariance = &m.energyVariance[m.EnergyOffset(k, i)];
+        for (std::size_t e = 0; e < h.nEnergyBins; ++e) {
+          result.energyVariance[e] += f * f * energyVariance[e];
+        }
+        const double* thetaVariance = &m.thetaVariance[m.ThetaOffset(k, i)];
+        for (std::size_t t = 0; t < h.nThetaBins; ++t) {
+          result.thetaVariance[t] += f * f * thetaVariance[t];
+        }
+      }
+    }
+    double foldMs =
+      std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+    // 3) 按入射粒子的结果 (E、theta 取区间中心)
+    const double dlogE = (h.logEMax - h.logEMin) / h.nEnergyBins;
+    const double dTheta = h.thetaMax / h.nThetaBins;
+    std::vector<std::pair<double, int>> order;
+    for (const auto& [pdg, result] : folded) {
+      double total = 0.;
+      for (double v : result.value) total += v;
+      order.emplace_back(total, pdg);
+    }
+    std::sort(order.rbegin(), order.rend());
+
+    std::cout << "matrix        : " << matrices.front()
+              << (matrices.size() > 1 ? " + " + std::to_string(matrices.size() - 1) + " more" : "")
+              << " (" << h.material << ", "
+              << h.targetLength << " mm, " << h.nPrimaryBins << " bins "
+              << h.primaryEmin << " - " << h.primaryEmax << " MeV)\n"
+              << "outside grid  : " << outside / beamTotal << " of the beam\n";
+    if (unsimulated > 0.) {
+      std::cout << "not simulated : " << unsimulated / beamTotal
+                << " of the beam falls in bins without primaries (no response)\n";
+    }
+    std::cout << "transmission  : " << transmission << " +- " << std::sqrt(transmissionVariance)
+              << "\n"
+              << " " << std::left << std::setw(12) << "particle" << std::right << std::setw(26)
+              << "entries/primary" << std::setw(14) << "<E> [MeV]" << std::setw(14)
+              << "<theta> [deg]" << "\n";
+    for (const auto& [total, pdg] : order) {
+      const Folded& result = folded[pdg];
+      double sumE = 0., sumTheta = 0.;
+      for (std::size_t j = 0; j < cells; ++j) {
+        std::size_t e = j / h.nThetaBins, t = j % h.nThetaBins;
+        sumE += result.value[j] * std::pow(10., h.logEMin + (e + 0.5) * dlogE);
+        sumTheta += result.value[j] * (t + 0.5) * dTheta;
+      }
+      std::cout << " " << std::left << std::setw(12) << ParticleName(pdg) << std::right
+                << std::setw(12) << total << " +- " << std::setw(10)
+                << std::sqrt(result.totalVariance)
+                << std::setw(14) << (total > 0. ? sumE / total : 0.) << std::setw(14)
+                << (total > 0. ? sumTheta / total : 0.) << "\n";
+    }
+    std::cout << "fold time     : " << foldMs << " ms" << std::endl;
+
+    // 4) 投影：particle pdg axis low high value error
+    if (!output.empty()) {
+      std::ofstream out(output);
+      if (!out) throw std::runtime_error("cannot write " + output);
+      out << "# particle pdg axis low high entries_per_primary error\n"
+          << "# axis E: kinetic energy [MeV], axis theta: [deg]\n"
+          << std::setprecision(8);
+      for (const auto& [total, pdg] : order) {
+        const Folded& result = folded[pdg];
+        for (std::size_t e = 0; e < h.nEnergyBins; ++e) {
+          double value = 0.;
+          for (std::size_t t = 0; t < h.nThetaBins; ++t) value += result.value[e * h.nThetaBins + t];
+          out << ParticleName(pdg) << " " << pdg << " E "
+              << std::pow(10., h.logEMin + e * dlogE) << " "
+              << std::pow(10., h.logEMin + (e + 1) * dlogE) << " " << value << " "
+              << std::sqrt(result.energyVariance[e]) << "\n";
+        }
+        for (std::size_t t = 0; t < h.nThetaBins; ++t) {
+          double value = 0.;
+          for (std::size_t e = 0; e < h.nEnergyBins; ++e) value += result.value[e * h.nThetaBins + t];
+          out << ParticleName(pdg) << " " << pdg << " theta " << t * dTheta << " "
+              << (t + 1) * dTheta << " " << value << " " << std::sqrt(result.thetaVariance[t]) << "\n";
+        }
+      }
+      std::cout << "projections   : " << output << std::endl;
+    }
+  }
+  catch (const std::exception& e) {
+    std::cerr << "b4fold: " << e.what() << std::endl;
+    return 1;
+  }
+  return 0;
+}
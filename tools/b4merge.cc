@@ -0,0 +1,393 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+//
+/// \file B4/B4a/tools/b4merge.cc
+/// \brief Merges the outputs of a sharded B4 job
+///
+/// Every shard of exampleB4a --shard k/N writes "<output>.shard" (key =
+/// value) next to its ROOT file or columnar directory. b4merge checks that
+/// the shards belong together (same configuration hash, master seed,
+/// engine and run) and that their event ranges are disjoint, reports
+/// missing shards, and combines them exactly. The chunks of a checkpointed
+/// run (/run/checkpoint/beamOn) write the same metadata and are merged the
+/// same way (several files per shard, consecutive event ranges):
+///
+///  - accumulables: counters, entry observables and species tallies are
+///    summed, giving "<merged>.shard"
+///  - columnar output: the segments of all shards are copied into
+///    "<merged>.cols" with renumbered segments
+///  - ROOT output: ntuples and H2 are merged with TFileMerger when built
+///    with ROOT, otherwise the equivalent hadd command is printed
+///  - summary output: the per-species sums (summary.<pdg>.*, or
+///    summary.primary.<group>.* for a mixed beam) are summed into
+///    "<merged>.shard"
+///  - response output: the matrices are combined, weighted with the
+///    primaries per bin, into "<merged>.resp"
+///  - scoring planes (/det/scoringPlanes): the per-plane sums (planes.*)
+///    are summed; the plane depths must agree
+///
+/// usage: b4merge -o <merged> <a.shard> <b.shard> ...
+
+#include "ColumnarFormat.hh"
+#include "ResponseFormat.hh"
+
+#ifdef B4_WITH_ROOT
+#include "TFileMerger.h"
+#endif
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <set>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace
+{
+namespace fs = std::filesystem;
+
+using Info = std::map<std::string, std::string>;
+
+// 所有分片必须相同的键
+const char* kIdentity[] = {"format", "version", "config_hash", "master_seed", "engine",
+                           "shards", "run", "output_format", "particle", "energy_MeV",
+                           "material", "target_radius_cm", "target_length_cm"};
+// 逐元素相加的键 (整数保持整数)
+const char* kSums[] = {"events", "passed", "blocked", "transmitted", "transmitted2",
+                       "steps", "killed_energy", "killed_time", "killed_geometry",
+                       "observables.events", "observables.entries", "observables.entries2",
+                       "observables.energy", "observables.theta"};
+// pdg:count:energy 列表
+const char* kTallies[] = {"stack_killed", "validation_lost", "entry_killed"};
+
+Info ReadInfo(const std::string& path)
+{
+  Info info;
+  std::ifstream in(path);
+  if (!in) throw std::runtime_error("cannot read " + path);
+  std::string line;
+  while (std::getline(in, line)) {
+    auto eq = line.find(" =");
+    if (eq == std::string::npos) continue;
+    std::string value = line.substr(eq + 2);
+    if (!value.empty() && value[0] == ' ') value.erase(0, 1);
+    info[line.substr(0, eq)] = value;
+  }
+  if (info["format"] != "B4SHARD") throw std::runtime_error("not a shard file: " + path);
+  return info;
+}
+
+bool IsInteger(const std::string& token)
+{
+  return token.find_first_of(".eEinfINF") == std::string::npos;
+}
+
+std::string SumValues(const std::string& a, const std::string& b)
+{
+  std::istringstream ia(a), ib(b);
+  std::ostringstream out;
+  out << std::setprecision(17);
+  std::string ta, tb;
+  bool first = true;
+  while (ia >> ta) {
+    if (!(ib >> tb)) throw std::runtime_error("value lists of different length");
+    if (!first) out << " ";
+    first = false;
+    if (IsInteger(ta) && IsInteger(tb)) out << std::stoll(ta) + std::stoll(tb);
+    else out << std::stod(ta) + std::stod(tb);
+  }
+  return out.str();
+}
+
+std::string SumTallies(const std::string& a, const std::string& b)
+{
+  std::map<long, std::pair<long long, double>> tally;
+  for (const auto* list : {&a, &b}) {
+    std::istringstream in(*list);
+    std::string item;
+    while (in >> item) {
+      long pdg = 0;
+      long long count = 0;
+      double energy = 0.;
+      char c1, c2;
+      std::istringstream is(item);
+      if (is >> pdg >> c1 >> count >> c2 >> energy) {
+        tally[pdg].first += count;
+        tally[pdg].second += energy;
+      }
+    }
+  }
+  std::ostringstream out;
+  out << std::setprecision(17);
+  bool first = true;
+  for (const auto& [pdg, entry] : tally) {
+    out << (first ? "" : " ") << pdg << ":" << entry.first << ":" << entry.second;
+    first = false;
+  }
+  return out.str();
+}
+
+// 各分片的 segment 复制到合并目录，segment 号依次平移
+std::size_t MergeColumnar(const std::vector<Info>& shards, const std::string& directory)
+{
+  fs::create_directories(directory);
+  std::int32_t offset = 0;
+  std::size_t files = 0;
+  for (const auto& shard : shards) {
+    std::int32_t maxSegment = -1;
+    for (const auto& item : fs::directory_iterator(shard.at("output"))) {
+      if (item.path().extension() != ".col") continue;
+      std::ifstream in(item.path(), std::ios::binary);
+      B4::Columnar::FileHeader header;
+      if (!in.read(reinterpret_cast<char*>(&header), sizeof(header))
+          || !B4::Columnar::IsValid(header)) {
+        throw std::runtime_error("bad columnar segment " + item.path().string());
+      }
+      maxSegment = std::max(maxSegment, header.segment);
+      header.segment += offset;
+      std::string name = B4::Columnar::SegmentFileName(header.column, header.segment);
+      std::ofstream out(directory + "/" + name, std::ios::binary | std::ios::trunc);
+      out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+      out << in.rdbuf();
+      ++files;
+    }
+    offset += maxSegment + 1;
+  }
+
+  // run.info：第一个分片的描述，事件数为总数
+  std::ifstream first(shards.front().at("output") + "/" + B4::Columnar::kRunInfoFile);
+  std::ofstream info(directory + "/" + B4::Columnar::kRunInfoFile);
+  std::string line;
+  long long events = 0;
+  for (const auto& shard : shards) events += std::stoll(shard.at("events"));
+  while (std::getline(first, line)) {
+    if (line.rfind("events = ", 0) == 0) line = "events = " + std::to_string(events);
+    info << line << "\n";
+  }
+  return files;
+}
+
+void MergeResponse(const std::vector<Info>& shards, const std::string& output)
+{
+  B4::Response::Matrix total;
+  for (std::size_t i = 0; i < shards.size(); ++i) {
+    const std::string& path = shards[i].at("output");
+    B4::Response::Matrix matrix;
+    if (!B4::Response::Read(path, matrix)) throw std::runtime_error("bad response matrix " + path);
+    if (i == 0) total = std::move(matrix);
+    else if (!B4::Response::Merge(total, matrix)) {
+      throw std::runtime_error("response grids differ (" + path + ")");
+    }
+  }
+  if (!B4::Response::Write(output, total)) throw std::runtime_error("cannot write " + output);
+}
+
+bool MergeRoot(const std::vector<Info>& shards, const std::string& output)
+{
+#ifdef B4_WITH_ROOT
+  TFileMerger merger(false);
+  if (!merger.OutputFile(output.c_str(), "RECREATE")) return false;
+  for (const auto& shard : shards) merger.AddFile(shard.at("output").c_str());
+  return merger.Merge();
+#else
+  std::cout << "built without ROOT; merge the ntuples and histograms with:\n  hadd " << output;
+  for (const auto& shard : shards) std::cout << " " << shard.at("output");
+  std::cout << std::endl;
+  return true;
+#endif
+}
+
+}  // namespace
+
+int main(int argc, char** argv)
+{
+  std::string merged;
+  std::vector<std::string> inputs;
+  for (int i = 1; i < argc; ++i) {
+    std::string arg = argv[i];
+    if (arg == "-o" && i + 1 < argc) merged = argv[++i];
+    else inputs.push_back(arg);
+  }
+  if (merged.empty() || inputs.empty()) {
+    std::cerr << "Usage: " << argv[0] << " -o <merged> <a.shard> <b.shard> ..." << std::endl;
+    return 1;
+  }
+  if (merged.size() > 5 && merged.compare(merged.size() - 5, 5, ".root") == 0) {
+    merged.erase(merged.size() - 5);
+  }
+
+  try {
+    std::vector<Info> shards;
+    for (const auto& path : inputs) shards.push_back(ReadInfo(path));
+    std::sort(shards.begin(), shards.end(), [](const Info& a, const Info& b) {
+      return std::stoll(a.at("first_event")) < std::stoll(b.at("first_event"));
+    });
+
+    // 1) 是否属于同一个作业
+    for (const auto& shard : shards) {
+      for (const char* key : kIdentity) {
+        if (shard.count(key) ? shard.at(key) != shards.front().at(key) : true) {
+          throw std::runtime_error(std::string("shards differ in ") + key + " (shard "
+                                   + shard.at("shard") + ")");
+        }
+      }
+    }
+
+    // 2) 事件范围不重叠；缺少的分片只警告
+    std::set<long> seen;
+    long long end = -1;
+    for (const auto& shard : shards) {
+      long index = std::stol(shard.at("shard"));
+      long long first = std::stoll(shard.at("first_event"));
+      seen.insert(index);
+      if (first < end) {
+        throw std::runtime_error("overlapping event ranges (shard " + shard.at("shard") + ")");
+      }
+      if (end >= 0 && first > end) {
+        std::cerr << "warning: events " << end << " ... " << first - 1 << " are missing"
+                  << std::endl;
+      }
+      end = first + std::stoll(shard.at("events"));
+    }
+    // 不分片的检查点 chunk：shards = 0
+    long nShards = std::max(1L, std::stol(shards.front().at("shards")));
+    if ((long)seen.size() != nShards) {
+      std::cerr << "warning: " << seen.size() << " of " << nShards << " shards merged"
+                << std::endl;
+    }
+
+    // 3) accumulables
+    Info total = shards.front();
+    for (std::size_t i = 1; i < shards.size(); ++i) {
+      for (const char* key : kSums) {
+        if (total.count(key)) total[key] = SumValues(total[key], shards[i].at(key));
+      }
+      for (const char* key : kTallies) {
+        if (total.count(key)) total[key] = SumTallies(total[key], shards[i].at(key));
+      }
+      // summary 格式：summary.<pdg>.xxx，各分片的粒子种类可以不同
+      for (const auto& [key, value] : shards[i]) {
+        if (key.compare(0, 8, "summary.") != 0) continue;
+        auto it = total.find(key);
+        if (it == total.end()) total[key] = value;
+        else it->second = SumValues(it->second, value);
+      }
+      // 虚拟计分平面：planes.xxx 为逐平面的列表，平面深度必须相同
+      auto depth = shards[i].find("planes.depth_cm");
+      if ((depth == shards[i].end()) != (total.count("planes.depth_cm") == 0)
+          || (depth != shards[i].end() && depth->second != total["planes.depth_cm"])) {
+        throw std::runtime_error("shards differ in planes.depth_cm (shard "
+                                 + shards[i].at("shard") + ")");
+      }
+      for (const auto& [key, value] : shards[i]) {
+        if (key.compare(0, 7, "planes.") != 0 || key == "planes.depth_cm") continue;
+        total[key] = SumValues(total.at(key), value);
+      }
+    }
+    std::ostringstream list;
+    for (long index : seen) list << (list.tellp() > 0 ? " " : "") << index;
+    total["shard"] = list.str();
+    total["first_event"] = shards.front().at("first_event");
+
+    // 4) 输出本身
+    const std::string& format = total["output_format"];
+    if (format == "columnar") {
+      total["output"] = merged + ".cols";
+      std::size_t files = MergeColumnar(shards, total["output"]);
+      std::cout << "columnar : " << files << " segment files -> " << total["output"] << "\n";
+    }
+    else if (format == "root") {
+      total["output"] = merged + ".root";
+      if (!MergeRoot(shards, total["output"])) throw std::runtime_error("ROOT merge failed");
+    }
+    else if (format == "summary") {
+      // 汇总已全部在元数据中
+      total["output"] = merged + ".shard";
+    }
+    else if (format == "response") {
+      total["output"] = merged + ".resp";
+      MergeResponse(shards, total["output"]);
+      std::cout << "response : " << shards.size() << " matrices -> " << total["output"] << "\n";
+    }
+
+    std::ofstream out(merged + ".shard");
+    for (const auto& [key, value] : total) out << key << " = " << value << "\n";
+
+    // 合并结果摘要
+    double events = std::stod(total["observables.events"]);
+    double entries = std::stod(total["observables.entries"]);
+    double entries2 = std::stod(total["observables.entries2"]);
+    double mean = events > 0 ? entries / events : 0.;
+    double error = events > 1
+      ? std::sqrt(std::max(0., (entries2 / events - mean * mean) * events / (events - 1)) / events)
+      : 0.;
+    // 每个初级粒子的透射权重的平均值 (重要性抽样下也无偏)
+    double primaries = std::stod(total["passed"]) + std::stod(total["blocked"]);
+    double transmission = 0., transmissionError = 0.;
+    if (primaries > 0 && total.count("transmitted")) {
+      transmission = std::stod(total["transmitted"]) / primaries;
+      double variance = std::stod(total["transmitted2"]) / primaries - transmission * transmission;
+      transmissionError = std::sqrt(std::max(0., variance) / primaries);
+    }
+    std::cout << "shards   : " << shards.size() << " of " << nShards << "\n"
+              << "events   : " << total["events"] << "\n"
+              << "passed   : " << total["passed"] << "\n"
+              << "blocked  : " << total["blocked"] << "\n"
+              << "transmit : " << transmission << " +- " << transmissionError << "\n"
+              << "steps    : " << total["steps"] << "\n"
+              << "entries  : " << total["observables.entries"] << " (" << mean << " +- "
+              << error << " per event)\n"
+              << "metadata : " << merged << ".shard" << std::endl;
+
+    // 各平面的透射率 (每个初级粒子在该深度的透射权重的平均值)
+    if (total.count("planes.depth_cm")) {
+      std::istringstream depths(total["planes.depth_cm"]);
+      std::istringstream sums(total["planes.transmitted"]);
+      std::istringstream sums2(total["planes.transmitted2"]);
+      double planePrimaries = std::stod(total["planes.primaries"]);
+      double depthCm = 0., t = 0., t2 = 0.;
+      while (depths >> depthCm && sums >> t && sums2 >> t2) {
+        double mean = planePrimaries > 0 ? t / planePrimaries : 0.;
+        double variance = planePrimaries > 0 ? t2 / planePrimaries - mean * mean : 0.;
+        double err = planePrimaries > 0 ? std::sqrt(std::max(0., variance) / planePrimaries) : 0.;
+        std::cout << "plane    : " << depthCm << " cm  transmit " << mean << " +- " << err
+                  << "\n";
+      }
+      std::cout << std::flush;
+    }
+  }
+  catch (const std::exception& e) {
+    std::cerr << "b4merge: " << e.what() << std::endl;
+    return 1;
+  }
+  return 0;
+}